@@ -6,20 +6,46 @@ in vec3 surfaceNormal;
 in vec3 toLightVector;
 in vec3 FragPos;
 in vec4 FragPosLightSpace;
+in float lodFade;
 
 out vec4 outputColor;
 
 uniform sampler2D basic_texture;
 uniform bool enable_transparency;
-uniform float view_distance;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 uniform vec4 distanceColor;
 
 uniform float ambientStrength = 0.45;
 uniform float diffuseStrength = 0.55;
-uniform float time;
 uniform sampler2D shadowMap;
 uniform vec3 lightDirection = vec3(0.5, -1.0, 0.5);
 uniform bool enableShadows = false;
+uniform float lodDistance = 0.0;
+uniform float lodFadeBand = 0.0;
+uniform bool lodFadeOut = true; // true for the full model, false for the billboard
+
+// Screen-door cross-fade between the full model and its billboard; the two LODs use complementary pixels
+void lodDither()
+{
+    if (lodDistance <= 0.0 || lodFadeBand <= 0.0) return;
+
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 cell = ivec2(gl_FragCoord.xy) & 3;
+    float threshold = (bayer[cell.y * 4 + cell.x] + 0.5) / 16.0;
+
+    if (lodFadeOut ? lodFade > threshold : lodFade <= threshold) {
+        discard;
+    }
+}
 
 float ShadowCalculation(vec4 fragPosLightSpace)
 {
@@ -68,6 +94,8 @@ float ShadowCalculation(vec4 fragPosLightSpace)
 
 void main()
 {
+    lodDither();
+
     vec4 sC = texture(basic_texture, texCoord0);
 
     // Transparency discard (do this first)
@@ -93,8 +121,8 @@ void main()
     }
 
     // Fog effect
-    float min_distance = view_distance * 0.50;
-    float max_distance = view_distance;
+    float min_distance = frame.viewDistance * 0.50;
+    float max_distance = frame.viewDistance;
     float fogFactor = 0.0;
     float distance = gl_FragCoord.z / gl_FragCoord.w;
 
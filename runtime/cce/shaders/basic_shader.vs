@@ -12,18 +12,27 @@ out vec3 surfaceNormal;
 out vec3 toLightVector;
 out vec3 FragPos;
 out vec4 FragPosLightSpace;
+out float lodFade;
 
 uniform highp mat4 MVP;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 uniform float terrainWidth;
 uniform float terrainHeight;
 uniform float tileWidth;
-uniform vec3 cameraPos;
-uniform float time;
 uniform mat4 lightSpaceMatrix;
 uniform bool enableShadows = false;
+uniform float lodDistance = 0.0;
+uniform float lodFadeBand = 0.0;
 
 void main()
 {
@@ -33,11 +42,17 @@ void main()
     surfaceNormal = mat3(transpose(inverse(model))) * normal; // Transform normal to world space
     toLightVector = lightPosition - worldPosition.xyz;
 
-    vec4 viewPosition = view * worldPosition;
-    vec4 projectedPosition = projection * viewPosition;
+    vec4 viewPosition = frame.view * worldPosition;
+    vec4 projectedPosition = frame.projection * viewPosition;
 
     texCoord0 = texCoord;
     faceAlpha0 = faceAlpha;
+    // 0 = full geometry, 1 = far billboard, ramped across the fade band centred on lodDistance
+    lodFade = 0.0;
+    if (lodFadeBand > 0.0) {
+        float instanceDistance = distance((model * instancedMatrix[3]).xyz, frame.cameraPos);
+        lodFade = clamp((instanceDistance - (lodDistance - lodFadeBand * 0.5)) / lodFadeBand, 0.0, 1.0);
+    }
     FragPos = worldPosition.xyz;
     
     if (enableShadows) {
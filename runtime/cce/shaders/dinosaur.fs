@@ -9,12 +9,20 @@ out vec4 outputColor;
 
 uniform sampler2D basic_texture;
 uniform bool enable_transparency;
-uniform float view_distance;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 uniform vec4 distanceColor;
 
 uniform float ambientStrength = 0.8;
 uniform float diffuseStrength = 0.2;
-uniform float time;
 
 void main()
 {
@@ -31,8 +39,8 @@ void main()
     vec3 finalColor = vec3(sC.b, sC.g, sC.r) * brightness;
 
     // Fog effect
-    float min_distance = view_distance * 0.50; // Start fog at half distance
-    float max_distance = view_distance;
+    float min_distance = frame.viewDistance * 0.50; // Start fog at half distance
+    float max_distance = frame.viewDistance;
     float fogFactor = 0.0;
 
     float distance = gl_FragCoord.z / gl_FragCoord.w;
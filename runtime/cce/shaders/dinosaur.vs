@@ -5,6 +5,7 @@ layout(location = 1) in vec2 texCoord;
 layout(location = 2) in vec3 normal;
 layout(location = 3) in float faceAlpha;
 layout(location = 4) in mat4 instancedMatrix;
+layout(location = 8) in vec3 instanceAnimation; // frameA, frameB, blend of a shared (batched) mesh
 
 out vec2 texCoord0;
 out float faceAlpha0;
@@ -13,13 +14,55 @@ out vec3 toLightVector;
 
 uniform mat4 MVP;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
+
+// GPU vertex animation. Keyframes are the raw .CAR shorts (frames * vertices * xyz), and the
+// vertex map gives the source vertex of each face corner. When off, position is already animated.
+// Batched characters take their frames from instanceAnimation, single meshes from the uniforms
+uniform bool gpuAnimation = false;
+uniform bool instancedAnimation = false;
+uniform isamplerBuffer animationFrames;
+uniform isamplerBuffer animationVertexMap;
+uniform int animationVertexCount;
+uniform int animationFrameA;
+uniform int animationFrameB;
+uniform float animationBlend;
+
+vec3 keyframePosition(int frameIndex, int vertexIndex)
+{
+    int base = (frameIndex * animationVertexCount + vertexIndex) * 3;
+    return vec3(texelFetch(animationFrames, base).r,
+                texelFetch(animationFrames, base + 1).r,
+                texelFetch(animationFrames, base + 2).r);
+}
+
+vec3 animatedPosition()
+{
+    if (!gpuAnimation) {
+        return position;
+    }
+
+    vec3 state = instancedAnimation ? instanceAnimation
+                                    : vec3(animationFrameA, animationFrameB, animationBlend);
+    int vertexIndex = texelFetch(animationVertexMap, gl_VertexID).r;
+    vec3 a = keyframePosition(int(state.x), vertexIndex);
+    vec3 b = keyframePosition(int(state.y), vertexIndex);
+    return mix(a, b, state.z) / 8.0;
+}
 
 void main()
 {
     // Apply model and instanced transformations to the animated position
-    vec4 worldPosition = model * instancedMatrix * vec4(position, 1.0);
+    vec4 worldPosition = model * instancedMatrix * vec4(animatedPosition(), 1.0);
     vec3 lightPosition = vec3(0.0, 0.0, 20000.0);
 
     // Transform normal to world space
@@ -29,8 +72,8 @@ void main()
     toLightVector = lightPosition - worldPosition.xyz;
 
     // Apply view and projection transformations
-    vec4 viewPosition = view * worldPosition;
-    vec4 projectedPosition = projection * viewPosition;
+    vec4 viewPosition = frame.view * worldPosition;
+    vec4 projectedPosition = frame.projection * viewPosition;
 
     // Pass through texture coordinates and face alpha
     texCoord0 = texCoord;
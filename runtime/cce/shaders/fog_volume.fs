@@ -14,10 +14,17 @@ out vec4 outputColor;
 
 uniform sampler2D basic_texture;
 uniform sampler2D skyTexture;
-uniform float time;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 uniform vec4 skyColor;
-uniform float view_distance;
-uniform vec3 cameraPos;
 uniform float fogTransparency;
 uniform vec3 fogColor;
 
@@ -27,11 +34,11 @@ uniform float diffuseStrength = 0.4;
 void main()
 {
     // Calculate distance from camera for depth-based effects
-    float distanceFromCamera = length(worldPos - cameraPos);
+    float distanceFromCamera = length(worldPos - frame.cameraPos);
     
     // Sample noise texture for volumetric density variation
-    vec2 noiseCoord1 = texCoord0 * 4.0 + vec2(time * 0.02, time * 0.015);
-    vec2 noiseCoord2 = texCoord0 * 2.0 + vec2(time * -0.01, time * 0.025);
+    vec2 noiseCoord1 = texCoord0 * 4.0 + vec2(frame.time * 0.02, frame.time * 0.015);
+    vec2 noiseCoord2 = texCoord0 * 2.0 + vec2(frame.time * -0.01, frame.time * 0.025);
     vec4 noise1 = texture(basic_texture, noiseCoord1);
     vec4 noise2 = texture(basic_texture, noiseCoord2);
     
@@ -53,9 +60,9 @@ void main()
     float fogAlpha;
     
     // More subtle, swirl-like atmospheric effects
-    float swirl = sin(worldPos.x * 0.02 + time * 0.3) * 0.08 + 
-                  cos(worldPos.z * 0.015 + time * 0.25) * 0.06 +
-                  sin((worldPos.x + worldPos.z) * 0.01 + time * 0.2) * 0.05;
+    float swirl = sin(worldPos.x * 0.02 + frame.time * 0.3) * 0.08 + 
+                  cos(worldPos.z * 0.015 + frame.time * 0.25) * 0.06 +
+                  sin((worldPos.x + worldPos.z) * 0.01 + frame.time * 0.2) * 0.05;
     
     // Use the actual fog color from map data as primary color
     baseColor = fogColor;
@@ -67,12 +74,12 @@ void main()
         // Danger fog - ADD heat effects on top of atmospheric base
         
         // Heat shimmer effect
-        float heatIntensity = sin(time * 4.0 + worldPos.x * 0.1) * 0.3 + 
-                              cos(time * 3.5 + worldPos.z * 0.12) * 0.2 +
-                              sin(time * 5.0 + worldPos.y * 0.08) * 0.15;
+        float heatIntensity = sin(frame.time * 4.0 + worldPos.x * 0.1) * 0.3 + 
+                              cos(frame.time * 3.5 + worldPos.z * 0.12) * 0.2 +
+                              sin(frame.time * 5.0 + worldPos.y * 0.08) * 0.15;
         
         // Animated embers/sparks effect
-        vec2 emberCoord = texCoord0 * 8.0 + vec2(time * 0.1, time * -0.15);
+        vec2 emberCoord = texCoord0 * 8.0 + vec2(frame.time * 0.1, frame.time * -0.15);
         float emberNoise = texture(basic_texture, emberCoord).r;
         float emberEffect = step(0.85, emberNoise) * heatIntensity * 0.3; // Reduced intensity
         
@@ -90,7 +97,7 @@ void main()
     baseColor *= brightness;
     
     // Distance-based opacity fade
-    float distanceFade = 1.0 - clamp((distanceFromCamera - 100.0) / (view_distance - 100.0), 0.0, 1.0);
+    float distanceFade = 1.0 - clamp((distanceFromCamera - 100.0) / (frame.viewDistance - 100.0), 0.0, 1.0);
     fogAlpha *= distanceFade;
     
     // View angle dependent transparency - fog is more transparent when looking through it
@@ -21,8 +21,16 @@ uniform mat4 model;
 uniform float terrainWidth;
 uniform float terrainHeight;
 uniform float tileWidth;
-uniform float time;
-uniform vec3 cameraPos;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 
 const float waveAmplitude = 0.5;  // Scaled down 16x for new world scale (was 8.0)
 const float waveFrequency = 0.375; // Scaled down 16x for new world scale (was 6.0)
@@ -35,11 +43,11 @@ void main()
     vec3 lightPosition = vec3((tileWidth * terrainWidth * 0.5), (tileWidth * terrainHeight * 0.5), 20000.0);
 
     // Add layered noise for volumetric fog movement
-    float noiseX = sin(position.x * 0.02 + time * 0.5) * 0.3 + 
-                   cos(position.x * 0.015 + time * 0.3) * 0.2;
-    float noiseZ = cos(position.z * 0.02 + time * 0.4) * 0.3 + 
-                   sin(position.z * 0.018 + time * 0.6) * 0.2;
-    float noiseY = sin(position.x * 0.01 + position.z * 0.01 + time * 0.8) * 0.15;
+    float noiseX = sin(position.x * 0.02 + frame.time * 0.5) * 0.3 + 
+                   cos(position.x * 0.015 + frame.time * 0.3) * 0.2;
+    float noiseZ = cos(position.z * 0.02 + frame.time * 0.4) * 0.3 + 
+                   sin(position.z * 0.018 + frame.time * 0.6) * 0.2;
+    float noiseY = sin(position.x * 0.01 + position.z * 0.01 + frame.time * 0.8) * 0.15;
 
     // Apply noise displacement - more subtle than water
     animatedPosition.x += noiseX * waveAmplitude * 0.5;
@@ -66,12 +74,12 @@ void main()
 
     // Calculate cloud texture coordinates with different movement for fog
     cloudTexCoord = vec2(
-        1.0 - (position.z / (tileWidth * 128.0)) - (time * 0.002), 
-        1.0 - (position.x / (tileWidth * 128.0)) - (time * 0.003)
+        1.0 - (position.z / (tileWidth * 128.0)) - (frame.time * 0.002), 
+        1.0 - (position.x / (tileWidth * 128.0)) - (frame.time * 0.003)
     ); // Auto-scales with tileWidth
     
     // Calculate view direction for fog effects
-    viewDirection = normalize(cameraPos - worldPosition.xyz);
+    viewDirection = normalize(frame.cameraPos - worldPosition.xyz);
     
     // Pass fog type information (1 = danger/lava fog, 0 = normal fog)
     fogType = flags;
@@ -4,6 +4,18 @@ out vec4 FragColor;
 in vec2 texCoord0;
 in vec3 FragPos;
 in vec4 FragPosLightSpace;
+in float lodFade;
+
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 
 uniform sampler2D basic_texture;
 uniform sampler2D shadowMap;
@@ -16,6 +28,29 @@ uniform float diffuseStrength = 0.7;
 uniform bool useCustomColor = false;
 uniform vec3 customColor = vec3(1.0, 0.0, 0.0);
 
+// World object billboards: colour-keyed C2 bitmaps with distance fog
+uniform bool enable_transparency = false;
+uniform bool swapRedBlue = false;
+uniform bool enableFog = false;
+uniform vec4 distanceColor;
+uniform float lodDistance = 0.0;
+uniform float lodFadeBand = 0.0;
+uniform bool lodFadeOut = true; // true for the full model, false for the billboard
+
+// Screen-door cross-fade between the full model and its billboard; the two LODs use complementary pixels
+void lodDither()
+{
+    if (lodDistance <= 0.0 || lodFadeBand <= 0.0) return;
+
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 cell = ivec2(gl_FragCoord.xy) & 3;
+    float threshold = (bayer[cell.y * 4 + cell.x] + 0.5) / 16.0;
+
+    if (lodFadeOut ? lodFade > threshold : lodFade <= threshold) {
+        discard;
+    }
+}
+
 float ShadowCalculation(vec4 fragPosLightSpace)
 {
     if (!enableShadows) return 0.0;
@@ -42,8 +77,18 @@ void main()
         return;
     }
     
+    lodDither();
+
     // Use texture for normal rendering
     vec4 texColor = texture(basic_texture, texCoord0);
+    if (swapRedBlue) {
+        texColor.rgb = texColor.bgr;
+    }
+
+    float trans = 0.095;
+    if (enable_transparency && texColor.r <= trans && texColor.g <= trans && texColor.b <= trans) {
+        discard;
+    }
     
     // Apply basic lighting
     vec3 lightDir = normalize(-lightDirection);
@@ -61,5 +106,13 @@ void main()
     }
     
     vec3 finalColor = texColor.rgb * lightFactor * (1.0 - shadow * 0.5);
+
+    // Same fog curve as basic_shader so billboards match the models they replace
+    if (enableFog) {
+        float distance = gl_FragCoord.z / gl_FragCoord.w;
+        float min_distance = frame.viewDistance * 0.50;
+        float fogFactor = clamp((distance - min_distance) / (frame.viewDistance - min_distance), 0.0, 0.45);
+        finalColor = mix(finalColor, distanceColor.rgb, fogFactor);
+    }
     FragColor = vec4(finalColor, texColor.a);
 }
@@ -6,20 +6,38 @@ layout (location = 3) in mat4 instancedMatrix;
 out vec2 texCoord0;
 out vec3 FragPos;
 out vec4 FragPosLightSpace;
+out float lodFade;
 
 uniform mat4 MVP;
-uniform mat4 projection_view;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 uniform mat4 lightSpaceMatrix;
 uniform bool enableShadows = false;
+uniform float lodDistance = 0.0;
+uniform float lodFadeBand = 0.0;
 
 void main()
 {
     vec4 v = vec4(aPos, 1);
     vec4 worldPos = instancedMatrix * v;
-    vec4 pos = projection_view * worldPos;
+    vec4 pos = frame.projectionView * worldPos;
 
     texCoord0 = uv;
     FragPos = worldPos.xyz;
+    // 0 = full geometry, 1 = far billboard, ramped across the fade band centred on lodDistance
+    lodFade = 0.0;
+    if (lodFadeBand > 0.0) {
+        float instanceDistance = distance(instancedMatrix[3].xyz, frame.cameraPos);
+        lodFade = clamp((instanceDistance - (lodDistance - lodFadeBand * 0.5)) / lodFadeBand, 0.0, 1.0);
+    }
     
     if (enableShadows) {
         FragPosLightSpace = lightSpaceMatrix * worldPos;
@@ -5,7 +5,16 @@ in vec3 TexCoords;
 
 uniform samplerCube skybox;
 uniform vec4 sky_color;
-uniform float time; // Pass the elapsed time from your application
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 
 // Simple pseudo-random function
 float random(vec2 st) {
@@ -6,16 +6,24 @@ out vec2 TexCoords0;
 out vec3 WorldPos;
 
 uniform mat4 projection;
-uniform mat4 view;
-uniform float time;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 
 void main()
 {
     // Very slow cloud movement for distant sky effect
-    TexCoords0 = TexCoords + vec2(time * 0.001, time * 0.0005);
+    TexCoords0 = TexCoords + vec2(frame.time * 0.001, frame.time * 0.0005);
     
     // Pass world position for circular fade calculation
     WorldPos = aPos;
 
-    gl_Position = projection * view * vec4(aPos, 1.0);
+    gl_Position = projection * mat4(mat3(frame.view)) * vec4(aPos, 1.0);
 }
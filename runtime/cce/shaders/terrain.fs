@@ -14,8 +14,16 @@ out vec4 outputColor;
 
 uniform sampler2D basic_texture;
 uniform sampler2D skyTexture;
-uniform float view_distance;
-uniform vec4 distanceColor;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 
 uniform float ambientStrength = 0.25;
 uniform float diffuseStrength = 0.75;
@@ -80,8 +88,8 @@ void main()
     }
 
     // Ambient and fade
-    float min_distance = view_distance * 0.50; // Start fog at half distance
-    float max_distance = view_distance;
+    float min_distance = frame.viewDistance * 0.50; // Start fog at half distance
+    float max_distance = frame.viewDistance;
     float fogFactor = 0.0;
     float distance = gl_FragCoord.z / gl_FragCoord.w;
 
@@ -115,7 +123,7 @@ void main()
         finalColor = finalColor * (1.0 - shadow * 0.3); // 30% shadow intensity
     }
 
-    finalColor = mix(finalColor, distanceColor.rgb, fogFactor);
+    finalColor = mix(finalColor, frame.fogColor.rgb, fogFactor);
 
     // Apply a wetness effect
     // if (wetness > 0.0) {
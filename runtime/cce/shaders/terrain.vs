@@ -15,39 +15,240 @@ out vec3 FragPos;
 out vec4 FragPosLightSpace;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 uniform float terrainWidth;
 uniform float terrainHeight;
 uniform float tileWidth;
 uniform sampler2D underwaterStateTexture;
-uniform highp float time;
 uniform mat4 lightSpaceMatrix;
 uniform bool enableShadows = false;
 uniform vec3 lightPosition;
 
+// Geomipmapping: vertices of LOD n start at lodBaseVertex[n]; chunkLodTexture holds the LOD chosen per chunk
+uniform bool lodEnabled = false;
+uniform int lodBaseVertex[4];
+uniform int chunkSize;
+uniform sampler2D terrainHeightTexture;
+uniform usampler2D chunkLodTexture;
+
+// Vertex pulling: no vertex attributes. Each chunk is (chunkSize >> lod)^2 cells of 6 vertices, and
+// terrainTileTexture holds primary texture, secondary texture, texture rotation and quad split per tile
+uniform bool vertexPulling = false;
+uniform int chunksPerRow;
+uniform usampler2D terrainTileTexture;
+// Streamed worlds keep a window of the map in the height and tile textures, addressed with wrap-around
+uniform ivec2 tileWindowMask;
+uniform vec2 atlasSize;
+uniform float atlasPadding;
+
+// Triangle corners (LL, LR, UL, UR) per quad split, same winding as the CPU mesh
+const int CELL_CORNERS[12] = int[12](0, 3, 1, 0, 2, 3,   // regular
+                                     0, 2, 1, 1, 2, 3);  // reversed
+// Corner UVs per texture rotation, as in TerrainRenderer::calcUVMapForQuad
+const vec2 ROTATED_UVS[16] = vec2[16](vec2(0, 0), vec2(1, 0), vec2(0, 1), vec2(1, 1),
+                                      vec2(0, 1), vec2(0, 0), vec2(1, 1), vec2(1, 0),
+                                      vec2(1, 1), vec2(0, 1), vec2(1, 0), vec2(0, 0),
+                                      vec2(1, 0), vec2(1, 1), vec2(0, 0), vec2(0, 1));
+
+ivec2 mapSize()
+{
+    return ivec2(int(terrainWidth), int(terrainHeight));
+}
+
+float gridHeight(ivec2 g)
+{
+    return texelFetch(terrainHeightTexture, clamp(g, ivec2(0), mapSize() - 1) & tileWindowMask, 0).r;
+}
+
+int vertexLod()
+{
+    if (!lodEnabled) return 0;
+
+    for (int i = 3; i > 0; i--) {
+        if (gl_VertexID >= lodBaseVertex[i]) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// Cell and corner of this vertex in the CPU mesh: 4 vertices per cell, cells row-major over the map
+void meshVertexCell(int lod, out ivec2 cellTile, out int corner)
+{
+    int step = 1 << lod;
+    int cellsPerRow = (int(terrainWidth) + step - 1) / step;
+    int local = gl_VertexID - lodBaseVertex[lod];
+    int cell = local / 4;
+    corner = local - (cell * 4); // LL, LR, UL, UR
+
+    cellTile = ivec2(cell % cellsPerRow, cell / cellsPerRow) * step;
+}
+
+// Move vertices on a chunk border onto the edge of a coarser neighbouring chunk to close T-junction cracks
+vec3 stitchToNeighbours(vec3 p, int lod, ivec2 cellTile, int corner)
+{
+    if (!lodEnabled) return p;
+
+    int step = 1 << lod;
+    ivec2 grid = cellTile + ivec2(corner & 1, corner >> 1) * step;
+    ivec2 chunk = cellTile / chunkSize;
+    ivec2 inChunk = grid - (chunk * chunkSize);
+
+    bool onEdgeX = (inChunk.x == 0 || inChunk.x == chunkSize);
+    bool onEdgeY = (inChunk.y == 0 || inChunk.y == chunkSize);
+    // Interior vertices need nothing; chunk corners are shared by every LOD
+    if (onEdgeX == onEdgeY) return p;
+
+    ivec2 neighbour = chunk;
+    if (onEdgeX) {
+        neighbour.x += (inChunk.x == 0) ? -1 : 1;
+    } else {
+        neighbour.y += (inChunk.y == 0) ? -1 : 1;
+    }
+
+    ivec2 chunkCount = textureSize(chunkLodTexture, 0);
+    if (any(lessThan(neighbour, ivec2(0))) || any(greaterThanEqual(neighbour, chunkCount))) return p;
+
+    int neighbourLod = int(texelFetch(chunkLodTexture, neighbour, 0).r);
+    if (neighbourLod <= lod) return p;
+
+    int neighbourStep = 1 << neighbourLod;
+    if (onEdgeX) {
+        int start = (grid.y / neighbourStep) * neighbourStep;
+        float t = float(grid.y - start) / float(neighbourStep);
+        p.y = mix(gridHeight(ivec2(grid.x, start)), gridHeight(ivec2(grid.x, start + neighbourStep)), t);
+    } else {
+        int start = (grid.x / neighbourStep) * neighbourStep;
+        float t = float(grid.x - start) / float(neighbourStep);
+        p.y = mix(gridHeight(ivec2(start, grid.y)), gridHeight(ivec2(start + neighbourStep, grid.y)), t);
+    }
+
+    return p;
+}
+
+// Face normals of quad q as built on the CPU; the first face is shared by three corners, the second only by UR
+void quadFaceNormals(ivec2 q, out vec3 first, out vec3 second)
+{
+    ivec2 q1 = min(q + ivec2(1), mapSize() - 1);
+    vec3 ll = vec3(float(q.x) * tileWidth, gridHeight(q), float(q.y) * tileWidth);
+    vec3 lr = vec3(float(q1.x) * tileWidth, gridHeight(ivec2(q1.x, q.y)), float(q.y) * tileWidth);
+    vec3 ul = vec3(float(q.x) * tileWidth, gridHeight(ivec2(q.x, q1.y)), float(q1.y) * tileWidth);
+    vec3 ur = vec3(float(q1.x) * tileWidth, gridHeight(q1), float(q1.y) * tileWidth);
+
+    if (texelFetch(terrainTileTexture, q & tileWindowMask, 0).a != 0u) {
+        first = cross(ul - ll, lr - ll);
+        second = cross(ul - lr, ur - lr);
+    } else {
+        first = cross(ur - ll, lr - ll);
+        second = cross(ul - ll, ur - ll);
+    }
+
+    // Quads on the far map edge collapse to a line; leave them out rather than normalizing zero
+    first = length(first) > 0.0 ? normalize(first) : vec3(0.0);
+    second = length(second) > 0.0 ? normalize(second) : vec3(0.0);
+}
+
+// Averaged vertex normal, matching the accumulation in TerrainRenderer::loadIntoHardwareMemory
+vec3 gridNormal(ivec2 g)
+{
+    vec3 first, second;
+    quadFaceNormals(g, first, second);
+    vec3 n = first;
+
+    if (g.x > 0) {
+        quadFaceNormals(g - ivec2(1, 0), first, second);
+        n += first;
+    }
+    if (g.y > 0) {
+        quadFaceNormals(g - ivec2(0, 1), first, second);
+        n += first;
+    }
+    if (g.x > 0 && g.y > 0) {
+        quadFaceNormals(g - ivec2(1), first, second);
+        n += second;
+    }
+
+    return length(n) > 0.0 ? normalize(n) : vec3(0.0, 1.0, 0.0);
+}
+
+// Same inset and layout as TerrainRenderer::scaleAtlasUV
+vec2 atlasUV(vec2 uv, uint textureId)
+{
+    float tileScale = 1.0 / atlasSize.x;
+    float row = floor(float(textureId) / atlasSize.x);
+    vec2 inset = mix(vec2(atlasPadding), vec2(1.0 - atlasPadding), uv) * tileScale;
+
+    return vec2(float(textureId) * tileScale, row * tileScale) + inset;
+}
+
 void main()
 {
-    vec4 worldPosition = model * vec4(position, 1.0);
+    int lod = vertexLod();
+    ivec2 cellTile = ivec2(0);
+    int corner = 0;
+    vec3 vertexPosition = position;
+    vec3 vertexNormal = normal;
+    vec4 vertexTexCoords = texCoords;
+
+    if (vertexPulling) {
+        int cellsPerSide = chunkSize >> lod;
+        int verticesPerChunk = cellsPerSide * cellsPerSide * 6;
+        int local = gl_VertexID - lodBaseVertex[lod];
+        int chunk = local / verticesPerChunk;
+        int inChunk = local - (chunk * verticesPerChunk);
+        int cell = inChunk / 6;
+
+        cellTile = (ivec2(chunk % chunksPerRow, chunk / chunksPerRow) * chunkSize) + (ivec2(cell % cellsPerSide, cell / cellsPerSide) << lod);
+
+        if (any(greaterThanEqual(cellTile, mapSize()))) {
+            // Past the edge of a partial chunk; every vertex of the cell lands here so nothing is drawn
+            gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+            return;
+        }
+
+        uvec4 tile = texelFetch(terrainTileTexture, cellTile & tileWindowMask, 0);
+        corner = CELL_CORNERS[(tile.a != 0u ? 6 : 0) + (inChunk - (cell * 6))];
+
+        ivec2 grid = min(cellTile + (ivec2(corner & 1, corner >> 1) << lod), mapSize() - 1);
+        vertexPosition = vec3((float(grid.x) + 0.5) * tileWidth, gridHeight(grid), (float(grid.y) + 0.5) * tileWidth);
+        vertexNormal = gridNormal(grid);
+
+        vec2 uv = ROTATED_UVS[int(tile.b) * 4 + corner];
+        vertexTexCoords = vec4(atlasUV(uv, tile.g), atlasUV(uv, tile.r));
+    } else if (lodEnabled) {
+        meshVertexCell(lod, cellTile, corner);
+    }
+
+    vec3 terrainPosition = stitchToNeighbours(vertexPosition, lod, cellTile, corner);
+    vec4 worldPosition = model * vec4(terrainPosition, 1.0);
 
     // Calculate quad coordinates for sampling water height texture
-    quadCoord = vec2(position.x / tileWidth, position.z / tileWidth) / vec2(terrainWidth, terrainHeight);
+    quadCoord = vec2(terrainPosition.x / tileWidth, terrainPosition.z / tileWidth) / vec2(terrainWidth, terrainHeight);
 
     // Sample water height and calculate wetness factor
     float waterHeight = texture(underwaterStateTexture, quadCoord).r;
-    wetness = clamp((waterHeight - position.y) / tileWidth, 0.0, 1.0);
+    wetness = clamp((waterHeight - terrainPosition.y) / tileWidth, 0.0, 1.0);
 
-    surfaceNormal = mat3(transpose(inverse(model))) * normal; // Transform normal to world space
+    surfaceNormal = mat3(transpose(inverse(model))) * vertexNormal; // Transform normal to world space
     toLightVector = lightPosition - worldPosition.xyz; // Use world object light position
 
-    vec4 viewPosition = view * worldPosition;
-    vec4 projectedPosition = projection * viewPosition;
+    vec4 viewPosition = frame.view * worldPosition;
+    vec4 projectedPosition = frame.projection * viewPosition;
 
-    texCoord0 = vec2(texCoords[0], texCoords[1]);
-    texCoord1 = vec2(texCoords[2], texCoords[3]);
+    texCoord0 = vec2(vertexTexCoords[0], vertexTexCoords[1]);
+    texCoord1 = vec2(vertexTexCoords[2], vertexTexCoords[3]);
 
     // Calculate cloud texture coordinates
-    out_textCoord_clouds = vec2(1.0 - (position.z / (tileWidth * 128.0)) - (time * 0.008), 1.0 - (position.x / (tileWidth * 128.0)) - (time * 0.008));
+    out_textCoord_clouds = vec2(1.0 - (terrainPosition.z / (tileWidth * 128.0)) - (frame.time * 0.008), 1.0 - (terrainPosition.x / (tileWidth * 128.0)) - (frame.time * 0.008));
 
     FragPos = worldPosition.xyz;
     
@@ -15,11 +15,17 @@ out vec4 outputColor;
 uniform sampler2D basic_texture;
 uniform sampler2D skyTexture;
 uniform sampler2D heightmapTexture;
-uniform float time; // Time for wave animation
-uniform vec4 skyColor;
-uniform float view_distance;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 
-uniform vec3 cameraPos;
 uniform float waterLevel;
 uniform float heightmapScale;
 
@@ -50,14 +56,14 @@ void main()
     // Handle danger water (lava) differently
     if (isDangerWater == 1u) {
         // Subtle bubbling animation for lava effect
-        float bubblingWaves = sin(time * 3.0 + texCoord0.x * 8.0) * 0.3 + 
-                              cos(time * 2.5 + texCoord0.y * 6.0) * 0.2 +
-                              sin(time * 4.0 + texCoord0.x * 4.0 + texCoord0.y * 4.0) * 0.15;
+        float bubblingWaves = sin(frame.time * 3.0 + texCoord0.x * 8.0) * 0.3 + 
+                              cos(frame.time * 2.5 + texCoord0.y * 6.0) * 0.2 +
+                              sin(frame.time * 4.0 + texCoord0.x * 4.0 + texCoord0.y * 4.0) * 0.15;
         
         // Subtle heat distortion offset for UV coordinates
         vec2 heatDistortion = vec2(
-            sin(time * 2.0 + texCoord0.x * 15.0) * 0.002,
-            cos(time * 2.5 + texCoord0.y * 12.0) * 0.002
+            sin(frame.time * 2.0 + texCoord0.x * 15.0) * 0.002,
+            cos(frame.time * 2.5 + texCoord0.y * 12.0) * 0.002
         );
         
         // Sample texture with heat distortion
@@ -85,22 +91,22 @@ void main()
         // Basic fog calculation
         float dist = gl_FragCoord.z / gl_FragCoord.w;
         float min_distance = 16.0 * 6.0;
-        float max_distance = view_distance;
+        float max_distance = frame.viewDistance;
         float fogFactor = 0.0;
         if (dist > min_distance) {
             fogFactor = clamp((dist - min_distance) / (max_distance - min_distance), 0.0, 1.0);
             fogFactor = min(fogFactor, 0.65);
         }
         
-        vec3 finalColor = mix(baseColor, skyColor.rgb, fogFactor);
-        outputColor = mix(vec4(finalColor, dangerAlpha), skyColor, 1.0 - EdgeFactor);
+        vec3 finalColor = mix(baseColor, frame.fogColor.rgb, fogFactor);
+        outputColor = mix(vec4(finalColor, dangerAlpha), frame.fogColor, 1.0 - EdgeFactor);
         return;
     }
     
     // Normal water processing continues below
     // Ambient and fade
     float min_distance = 16.0 * 6.0; // Start fog
-    float max_distance = view_distance;
+    float max_distance = frame.viewDistance;
     float fogFactor = 0.0;
     float dist = gl_FragCoord.z / gl_FragCoord.w;
 
@@ -123,8 +129,8 @@ void main()
     float cloudLuminance = (0.299 * cloudColor.b + 0.587 * cloudColor.g + 0.114 * cloudColor.r) * 2.0;
 
     // Calculate wave influence on shadow intensity
-    float waveInfluence = sin(10.0 + time * wave_speed) * wave_scale +
-                          cos(10.0 + time * wave_speed) * wave_scale;
+    float waveInfluence = sin(10.0 + frame.time * wave_speed) * wave_scale +
+                          cos(10.0 + frame.time * wave_speed) * wave_scale;
 
     // Modulate shadow intensity by vertex height (using surface normal y-component as proxy for height)
     float heightFactor = surfaceNormal.y; // Assuming surfaceNormal.y correlates with wave height
@@ -152,7 +158,7 @@ void main()
     vec3 depthTintedColor = mix(shallowWaterColor, deepWaterColor, depthColorFactor);
     
     // Mix in the sky color
-    vec3 finalColor = mix(depthTintedColor, skyColor.rgb, fogFactor);
+    vec3 finalColor = mix(depthTintedColor, frame.fogColor.rgb, fogFactor);
 
     // Depth-based and view-dependent transparency
     
@@ -180,5 +186,5 @@ void main()
     float minAlpha = mix(0.0, 1.0, shallowTransparencyFactor); // Fully transparent at 0 depth, opaque at 1+ world units
     float finalAlpha = mix(minAlpha, 1.0, viewDependentTransparency); // Max out at full opacity
 
-    outputColor = mix(vec4(finalColor, finalAlpha), skyColor, 1.0 - EdgeFactor);
+    outputColor = mix(vec4(finalColor, finalAlpha), frame.fogColor, 1.0 - EdgeFactor);
 }
@@ -21,8 +21,16 @@ uniform mat4 model;
 uniform float terrainWidth;
 uniform float terrainHeight;
 uniform float tileWidth;
-uniform float time;
-uniform vec3 cameraPos;
+// Per-frame constants shared by every world shader; filled once per frame by CEFrameConstants
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 projectionView;
+    vec3 cameraPos;
+    float time;
+    vec4 fogColor;
+    float viewDistance;
+} frame;
 uniform float waterLevel;
 uniform sampler2D heightmapTexture;
 
@@ -48,8 +56,8 @@ void main()
         float attenuatedAmplitude = waveAmplitude * depthFactor;
         
         // Only animate the main body of the surface and not the edges or shallow pools
-        animatedPosition.y += sin(position.x * waveFrequency + time * waveSpeed) * attenuatedAmplitude;
-        animatedPosition.y += cos(position.z * waveFrequency + time * waveSpeed) * attenuatedAmplitude;
+        animatedPosition.y += sin(position.x * waveFrequency + frame.time * waveSpeed) * attenuatedAmplitude;
+        animatedPosition.y += cos(position.z * waveFrequency + frame.time * waveSpeed) * attenuatedAmplitude;
     }
 
     vec4 worldPosition = model * vec4(animatedPosition, 1.0);
@@ -70,10 +78,10 @@ void main()
     alpha0 = alpha;
 
     // Calculate cloud texture coordinates (auto-scales with tileWidth)
-    cloudTexCoord = vec2(1.0 - (position.z / (tileWidth * 128.0)) - (time * 0.004), 1.0 - (position.x / (tileWidth * 128.0)) - (time * 0.004));
+    cloudTexCoord = vec2(1.0 - (position.z / (tileWidth * 128.0)) - (frame.time * 0.004), 1.0 - (position.x / (tileWidth * 128.0)) - (frame.time * 0.004));
     
     // Calculate view direction for depth-dependent transparency
-    viewDirection = normalize(cameraPos - worldPosition.xyz);
+    viewDirection = normalize(frame.cameraPos - worldPosition.xyz);
     
     // Calculate heightmap texture coordinates (normalized to [0,1])
     heightmapCoord = vec2(position.x / (terrainWidth * tileWidth), position.z / (terrainHeight * tileWidth));
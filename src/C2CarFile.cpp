@@ -22,10 +22,10 @@
 #include "dependency/libAF/af2-sound.h"
 #include "CEAudioSource.hpp"
 
-C2CarFile::C2CarFile(std::string file_name, bool pixelPerfectTextures)
+C2CarFile::C2CarFile(std::string file_name, bool pixelPerfectTextures, bool deferUpload)
 {
   std::cout << "Loading " << file_name << std::endl;
-  this->load_file(file_name, pixelPerfectTextures);
+  this->load_file(file_name, pixelPerfectTextures, deferUpload);
 }
 
 C2CarFile::~C2CarFile()
@@ -47,12 +47,44 @@ std::weak_ptr<CEAnimation> C2CarFile::getFirstAnimation()
   }
 }
 
+const std::map<std::string, std::shared_ptr<CEAnimation> >& C2CarFile::getAnimations() const
+{
+  return this->m_animations;
+}
+
 std::weak_ptr<CEAnimation> C2CarFile::getAnimationByName(std::string animation_name)
 {
-  return this->m_animations[animation_name];
+  // find() rather than operator[]: AI threads look animations up concurrently
+  auto it = this->m_animations.find(animation_name);
+  if (it == this->m_animations.end()) {
+    return std::weak_ptr<CEAnimation>();
+  }
+  return it->second;
+}
+
+void C2CarFile::upload()
+{
+  if (this->m_uploaded) return;
+
+  if (this->m_geometry) {
+    this->m_geometry->upload();
+  }
+
+  // The sound data is already raw PCM; all that's left is giving each sound an AL source
+  for (const auto& snd : this->m_animation_sounds) {
+    std::unique_ptr<CEAudioSource> src(new CEAudioSource(snd));
+
+    // TODO: use tile length
+    src->setGain(1.1f);
+    src->setLooped(false);
+
+    this->m_animation_audio_sources.push_back(std::move(src));
+  }
+
+  this->m_uploaded = true;
 }
 
-void C2CarFile::load_file(std::string file_name, bool pixelPerfectTextures)
+void C2CarFile::load_file(std::string file_name, bool pixelPerfectTextures, bool deferUpload)
 {
   std::ifstream infile;
   TCharacterInfo c_char_info;
@@ -89,7 +121,7 @@ void C2CarFile::load_file(std::string file_name, bool pixelPerfectTextures)
 
     _texture_data.resize(tsize);
     infile.read(reinterpret_cast<char *>(_texture_data.data()), tsize);
-    m_texture = std::unique_ptr<CETexture>(new CETexture(_texture_data, 256*256, 256, 256, pixelPerfectTextures));
+    m_texture = std::unique_ptr<CETexture>(new CETexture(_texture_data, 256*256, 256, 256, pixelPerfectTextures, true));
     
     std::vector<std::string> orderedAniNames;
 
@@ -136,16 +168,8 @@ void C2CarFile::load_file(std::string file_name, bool pixelPerfectTextures)
       snd->setWaveData(16, 1, length, 22050, snd_data);
 
       this->m_animation_sounds.push_back(snd);
-
-      std::unique_ptr<CEAudioSource> src(new CEAudioSource(snd));
-
-      // TODO: use tile length
-      src->setGain(1.1f);
-      src->setLooped(false);
       
       std::cout << "Loaded audio " << sndName << std::endl;
-
-      this->m_animation_audio_sources.push_back(std::move(src));
     }
     
     // Load the lookup table
@@ -196,7 +220,11 @@ void C2CarFile::load_file(std::string file_name, bool pixelPerfectTextures)
   std::unique_ptr<IndexedMeshLoader> m_loader(new IndexedMeshLoader(_vertices, _faces));
   
   // Note we transfer ownership of the texture
-  this->m_geometry = std::unique_ptr<CEGeometry>(new CEGeometry(m_loader->getVertices(), m_loader->getIndices(), std::move(m_texture), "dinosaur"));
+  this->m_geometry = std::unique_ptr<CEGeometry>(new CEGeometry(m_loader->getVertices(), m_loader->getIndices(), std::move(m_texture), "dinosaur", true));
+
+  if (!deferUpload) {
+    this->upload();
+  }
 }
 
 std::shared_ptr<CEAudioSource> C2CarFile::getSoundForAnimation(std::string animation_name) const
@@ -38,13 +38,17 @@ class Vertex;
 class C2CarFile {
     
 public:
-    C2CarFile(std::string file_name, bool pixelPerfectTextures = false);
+    // deferUpload: parse only, so the file can be loaded on a loader thread; upload() creates the GL and AL objects
+    C2CarFile(std::string file_name, bool pixelPerfectTextures = false, bool deferUpload = false);
     ~C2CarFile();
-    void load_file(std::string file_name, bool pixelPerfectTextures = false);
+    void load_file(std::string file_name, bool pixelPerfectTextures = false, bool deferUpload = false);
+    // Main thread only; does nothing once uploaded
+    void upload();
     
     std::shared_ptr<CEGeometry> getGeometry();
     std::weak_ptr<CEAnimation> getAnimationByName(std::string animation_name);
     std::weak_ptr<CEAnimation> getFirstAnimation();
+    const std::map<std::string, std::shared_ptr<CEAnimation> >& getAnimations() const;
     
   std::shared_ptr<CEAudioSource> getSoundForAnimation(std::string animation_name) const;
     
@@ -55,6 +59,7 @@ private:
     std::vector<std::shared_ptr<Sound>> m_animation_sounds;
     std::vector<std::shared_ptr<CEAudioSource>> m_animation_audio_sources;
     std::vector<int32_t> m_fx_lookup;
+    bool m_uploaded = false;
 };
 
 #endif
@@ -9,15 +9,34 @@
 #include "C2CarFilePreloader.h"
 
 #include "C2CarFile.h"
+#include "CELoadPipeline.h"
 
 #include <iostream>
 
+std::string C2CarFilePreloader::cacheKey(const std::filesystem::path& file_name, bool pixelPerfectTextures)
+{
+  // Create different cache keys based on texture filtering to avoid conflicts
+  return file_name.string() + (pixelPerfectTextures ? "_pixelperfect" : "_linear");
+}
+
 const std::shared_ptr<C2CarFile>& C2CarFilePreloader::fetch(std::filesystem::path file_name, bool pixelPerfectTextures) {
   bool enable = false;
   std::map<std::string, std::shared_ptr<C2CarFile>>::iterator it;
   
-  // Create different cache keys based on texture filtering to avoid conflicts
-  std::string cache_key = file_name.string() + (pixelPerfectTextures ? "_pixelperfect" : "_linear");
+  std::string cache_key = cacheKey(file_name, pixelPerfectTextures);
+
+  {
+    std::lock_guard<std::mutex> lock(_preloaded_mutex);
+    auto preloaded = _preloaded.find(cache_key);
+    if (preloaded != _preloaded.end() && !preloaded->second.empty()) {
+      _files[cache_key] = std::move(preloaded->second.front());
+      preloaded->second.pop_front();
+
+      // Normally already done by the pipeline; cheap if so
+      _files[cache_key]->upload();
+      return _files[cache_key];
+    }
+  }
   
   it = _files.find(cache_key);
 
@@ -29,3 +48,27 @@ const std::shared_ptr<C2CarFile>& C2CarFilePreloader::fetch(std::filesystem::pat
     return _files[cache_key];
   }
 }
+
+void C2CarFilePreloader::preload(const std::vector<std::pair<std::filesystem::path, bool>>& files, CELoadPipeline& pipeline)
+{
+  pipeline.parallelFor("car parse", files.size(), [&](size_t i) {
+    const std::filesystem::path& file_name = files[i].first;
+    bool pixelPerfectTextures = files[i].second;
+
+    std::shared_ptr<C2CarFile> car;
+    try {
+      car = std::shared_ptr<C2CarFile>(new C2CarFile(file_name.string(), pixelPerfectTextures, true));
+    } catch (const std::exception& e) {
+      // fetch() loads it again and its caller reports the error as before
+      std::cerr << "Failed to preload " << file_name.string() << ": " << e.what() << std::endl;
+      return;
+    }
+
+    pipeline.upload("car upload", [car]() {
+      car->upload();
+    });
+
+    std::lock_guard<std::mutex> lock(_preloaded_mutex);
+    _preloaded[cacheKey(file_name, pixelPerfectTextures)].push_back(std::move(car));
+  });
+}
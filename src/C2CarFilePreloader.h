@@ -11,17 +11,31 @@
 
 #include <memory>
 #include <map>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 #include <filesystem>
 
 class C2CarFile;
+class CELoadPipeline;
 
 class C2CarFilePreloader
 {
     std::map<std::string, std::shared_ptr<C2CarFile> > _files;
+    // One instance per preload request; fetch() hands each out once
+    std::map<std::string, std::deque<std::shared_ptr<C2CarFile>> > _preloaded;
+    std::mutex _preloaded_mutex;
+
+    static std::string cacheKey(const std::filesystem::path& file_name, bool pixelPerfectTextures);
   
 public:
 	const std::shared_ptr<C2CarFile>& fetch(std::filesystem::path file_name, bool pixelPerfectTextures = false);
+
+	// Parses the files on the pipeline's workers and queues their uploads; list a file once per fetch()
+	// that should get a preloaded copy. Files that fail are left to fetch(). Safe to run inside a pipeline job
+	void preload(const std::vector<std::pair<std::filesystem::path, bool>>& files, CELoadPipeline& pipeline);
 };
 
 #endif /* defined(__CE_Character_Lab__C2CarFilePreloader__) */
@@ -14,31 +14,260 @@
   // TODO: DRY this up and remove interdeps
 #include "C2MapRscFile.h"
 #include "CEWaterEntity.h"
+#include "CEMapCache.h"
+#include "CEMapPage.h"
+#include "vertex.h"
 
 #include <math.h>
+#include <nlohmann/json.hpp>
 
-C2MapFile::C2MapFile(const CEMapType type, const std::string& map_file_name, std::weak_ptr<C2MapRscFile> rsc) : m_type(type)
+using json = nlohmann::json;
+
+// How long an evicted page is kept before it is freed. Covers lookups that read a page pointer and
+// use it straight away; those never wait on anything. Ground builds, which wait on m_ground_mutex
+// and can take far longer, are counted in m_ground_builders instead
+static const std::chrono::milliseconds PAGE_RETIRE_GRACE(1000);
+
+C2MapFile::C2MapFile(const CEMapType type, const std::string& map_file_name, std::weak_ptr<C2MapRscFile> rsc, std::shared_ptr<CEMapCache> cache, bool memory_mapped) : m_rsc(rsc), m_memory_mapped(memory_mapped), m_type(type)
 {
   if (!std::filesystem::exists(map_file_name)) {
       throw std::runtime_error("File not found: " + map_file_name);
   } else {
     std::cout << "Found " << map_file_name << "; OK. Loading..." << std::endl;
   }
-  
-  switch (m_type) {
-  case CEMapType::C2:
-      this->load(map_file_name, rsc);
-      break;
-  case CEMapType::C1:
-      this->load_c1(map_file_name, rsc);
+
+  if (std::filesystem::path(map_file_name).extension() == ".world") {
+    // Pages are brought in by CEWorldStreamer; the map cache only covers single-page maps
+    this->loadWorld(map_file_name);
+    return;
   }
 
+  // A classic map is a world of one page that never leaves
+  m_page_size = (m_type == CEMapType::C2) ? SIZE : SIZE_C1;
+  m_width = m_height = m_page_size;
+  m_page_shift = (int)std::log2(m_page_size);
+  m_pages = std::make_unique<std::atomic<CEMapPage*>[]>(1);
+  m_pages[0].store(nullptr, std::memory_order_relaxed);
+  m_page_storage.resize(1);
+
+  try {
+    auto page = std::make_unique<CEMapPage>(0, 0, 0, m_page_size);
+    page->load(m_type, map_file_name, memory_mapped);
+    this->postProcessCached(*page, rsc, cache.get());
+    this->installPage(std::move(page));
+  } catch (const std::runtime_error& e) {
+      std::cerr << "Runtime error: " << e.what() << std::endl;
+    throw;
+  } catch (...) {
+      std::cerr << "An unknown error occurred." << std::endl;
+    
+    throw;
+  }
 }
 
 C2MapFile::~C2MapFile()
 {
 }
 
+/*
+ * A .world manifest names the page grid; pages themselves are .map files of pageSize tiles:
+ *   { "pageSize": 256, "pagesX": 8, "pagesY": 8, "pages": "pages", "start": [1024, 1024] }
+ */
+void C2MapFile::loadWorld(const std::string& file_name)
+{
+  std::ifstream f(file_name);
+  json world = json::parse(f);
+
+  m_page_size = world.at("pageSize").get<int>();
+  m_pages_x = world.at("pagesX").get<int>();
+  m_pages_y = world.at("pagesY").get<int>();
+  if (m_page_size < 64 || (m_page_size & (m_page_size - 1)) != 0 || m_pages_x < 1 || m_pages_y < 1) {
+    throw std::runtime_error("Invalid page grid in " + file_name);
+  }
+
+  m_streamed = true;
+  m_page_shift = (int)std::log2(m_page_size);
+  m_width = m_page_size * m_pages_x;
+  m_height = m_page_size * m_pages_y;
+  m_page_directory = (std::filesystem::path(file_name).parent_path() / world.value("pages", std::string("pages"))).string();
+
+  if (world.contains("start")) {
+    m_start_tile = glm::vec2(world["start"][0].get<float>(), world["start"][1].get<float>());
+  } else {
+    m_start_tile = glm::vec2(m_width / 2, m_height / 2);
+  }
+
+  int page_count = m_pages_x * m_pages_y;
+  m_pages = std::make_unique<std::atomic<CEMapPage*>[]>(page_count);
+  for (int p = 0; p < page_count; p++) {
+    m_pages[p].store(nullptr, std::memory_order_relaxed);
+  }
+  m_page_storage.resize(page_count);
+
+  std::cout << "World: " << m_pages_x << "x" << m_pages_y << " pages of " << m_page_size << " tiles from " << m_page_directory << std::endl;
+}
+
+std::string C2MapFile::getPageFileName(int page) const
+{
+  int px = page % m_pages_x, py = page / m_pages_x;
+  return (std::filesystem::path(m_page_directory) / (std::to_string(px) + "_" + std::to_string(py) + ".map")).string();
+}
+
+int C2MapFile::getPageAt(int x, int y) const
+{
+  if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+    return -1;
+  }
+  return ((y >> m_page_shift) * m_pages_x) + (x >> m_page_shift);
+}
+
+bool C2MapFile::isPageResident(int page) const
+{
+  return page >= 0 && page < m_pages_x * m_pages_y && m_pages[page].load(std::memory_order_acquire) != nullptr;
+}
+
+/*
+ * Runs on the streamer's loader thread. The page is not visible to anyone until installPage()
+ */
+std::unique_ptr<CEMapPage> C2MapFile::loadPage(int page)
+{
+  int px = page % m_pages_x, py = page / m_pages_x;
+  auto map_page = std::make_unique<CEMapPage>(page, px * m_page_size, py * m_page_size, m_page_size);
+
+  std::string file_name = this->getPageFileName(page);
+  if (std::filesystem::exists(file_name)) {
+    try {
+      map_page->load(m_type, file_name, m_memory_mapped);
+    } catch (const std::runtime_error& e) {
+      // A broken page reads as a blank one rather than ending the session
+      std::cerr << "Runtime error: " << e.what() << std::endl;
+      map_page->loadBlank(m_type);
+    }
+  } else {
+    map_page->loadBlank(m_type);
+  }
+
+  this->postProcess(*map_page, m_rsc.lock());
+  return map_page;
+}
+
+void C2MapFile::installPage(std::unique_ptr<CEMapPage> page)
+{
+  int index = page->m_index;
+  if (m_page_storage[index]) {
+    this->evictPage(index);
+  }
+
+  m_page_storage[index] = std::move(page);
+  m_pages[index].store(m_page_storage[index].get(), std::memory_order_release);
+  this->invalidateGroundAround(index);
+}
+
+void C2MapFile::evictPage(int page)
+{
+  if (!m_page_storage[page]) return;
+
+  m_pages[page].store(nullptr, std::memory_order_seq_cst);
+  m_retired_pages.emplace_back(std::chrono::steady_clock::now(), std::move(m_page_storage[page]));
+  this->invalidateGroundAround(page);
+}
+
+void C2MapFile::releaseRetiredPages()
+{
+  // A build may still be using a page retired while it waited; try again next frame
+  if (m_ground_builders.load(std::memory_order_seq_cst) != 0) {
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  m_retired_pages.erase(std::remove_if(m_retired_pages.begin(), m_retired_pages.end(), [&](const auto& retired) {
+    return now - retired.first > PAGE_RETIRE_GRACE;
+  }), m_retired_pages.end());
+}
+
+/*
+ * Ground data near a page edge is derived from up to two tiles of the next page, so the edge
+ * regions of the neighbours are rebuilt whenever a page comes or goes
+ */
+void C2MapFile::invalidateGroundAround(int page)
+{
+  std::lock_guard<std::mutex> lock(m_ground_mutex);
+
+  int px = page % m_pages_x, py = page / m_pages_x;
+  for (int dy = -1; dy <= 1; dy++) {
+    for (int dx = -1; dx <= 1; dx++) {
+      int nx = px + dx, ny = py + dy;
+      if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= m_pages_x || ny >= m_pages_y) continue;
+
+      CEMapPage* neighbour = m_pages[(ny * m_pages_x) + nx].load(std::memory_order_acquire);
+      if (!neighbour) continue;
+
+      // The neighbour's regions that face the changed page
+      int last = neighbour->m_ground_regions_per_row - 1;
+      int rx0 = (dx < 0) ? last : 0, rx1 = (dx > 0) ? 0 : last;
+      int ry0 = (dy < 0) ? last : 0, ry1 = (dy > 0) ? 0 : last;
+      for (int ry = ry0; ry <= ry1; ry++) {
+        for (int rx = rx0; rx <= rx1; rx++) {
+          neighbour->m_ground_region_ready[(ry * neighbour->m_ground_regions_per_row) + rx].store(false, std::memory_order_release);
+        }
+      }
+    }
+  }
+}
+
+CEMapPage* C2MapFile::pageAt(int xy, int& local) const
+{
+  if (xy < 0 || xy >= m_width * m_height) {
+    return nullptr;
+  }
+
+  if (!m_streamed) {
+    local = xy;
+    return m_pages[0].load(std::memory_order_acquire);
+  }
+
+  return this->pageAt(xy % m_width, xy / m_width, local);
+}
+
+CEMapPage* C2MapFile::pageAt(int x, int y, int& local) const
+{
+  if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+    return nullptr;
+  }
+
+  int mask = m_page_size - 1;
+  local = ((y & mask) << m_page_shift) + (x & mask);
+  return m_pages[((y >> m_page_shift) * m_pages_x) + (x >> m_page_shift)].load(std::memory_order_acquire);
+}
+
+// Fog and ambient sound zones cover 2x2 tiles
+CEMapPage* C2MapFile::zoneAt(int x, int y, int& local) const
+{
+  CEMapPage* page = this->pageAt(x, y, local);
+  if (page) {
+    local = page->localZoneIndex(x, y);
+  }
+  return page;
+}
+
+uint8_t C2MapFile::getRawHeightAt(int xy) const
+{
+  if (xy < 0 || xy >= m_width * m_height) throw std::out_of_range("map layer index out of range");
+
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  return page ? page->m_heightmap_data.at(local) : 0;
+}
+
+uint8_t C2MapFile::getRawWaterAt(int xy) const
+{
+  if (xy < 0 || xy >= m_width * m_height) throw std::out_of_range("map layer index out of range");
+
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  return page ? page->m_watermap_data.at(local) : 0;
+}
+
 // Take tile x,y and return actual x,y,z marking the center of the tile
 // at world coordinates and at ground or water level
 glm::vec3 C2MapFile::getPositionAtCenterTile(glm::vec2 pos)
@@ -68,31 +297,23 @@ glm::vec2 C2MapFile::getWorldTilePosition(glm::vec3 pos)
 int C2MapFile::getAmbientAudioIDAt(int x, int y)
 {
   // Covers a 4x4 zone area
-  x = x>>1;
-  y = y>>1;
-  int w = (int)getWidth()>>1;
-  
-  int xy = (y * w) + x;
+  int zone;
+  CEMapPage* page = this->zoneAt(x, y, zone);
+  if (!page) {
+    return 0;
+  }
 
-  return this->m_soundfx_data.at(xy);
+  return page->m_soundfx_data.at(zone);
 }
 
 int C2MapFile::getWidth()
 {
-  if (m_type == CEMapType::C2) {
-    return SIZE;
-  } else {
-    return SIZE_C1;
-  }
+  return m_width;
 }
 
 int C2MapFile::getHeight()
 {
-  if (m_type == CEMapType::C2) {
-    return SIZE;
-  } else {
-    return SIZE_C1;
-  }
+  return m_height;
 }
 
 float C2MapFile::getTileLength()
@@ -107,8 +328,14 @@ int C2MapFile::getWaterTextureIDAt(int xy, int water_texture_id)
   } else {
     int water_texture;
 
-    uint32_t texture_a = this->m_texturec1_A_index_data.at(xy);
-    uint32_t texture_b = this->m_texturec1_B_index_data.at(xy);
+    int local;
+    CEMapPage* page = this->pageAt(xy, local);
+    if (!page) {
+      return 0;
+    }
+
+    uint32_t texture_a = page->m_texturec1_A_index_data.at(local);
+    uint32_t texture_b = page->m_texturec1_B_index_data.at(local);
 
     if (!texture_a || !texture_b) {
       water_texture = 0;
@@ -123,10 +350,16 @@ int C2MapFile::getWaterTextureIDAt(int xy, int water_texture_id)
 
 int C2MapFile::getTextureIDAt(int xy)
 {
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  if (!page) {
+    return 0;
+  }
+
   if (m_type == CEMapType::C2) {
-    return int(this->m_texture_A_index_data.at(xy));
+    return int(page->m_texture_A_index_data.at(local));
   } else {
-    int id = int(this->m_texturec1_A_index_data.at(xy));
+    int id = int(page->m_texturec1_A_index_data.at(local));
     if (this->hasWaterAt(xy)) {
       if (!id) {
         return 1;
@@ -140,12 +373,18 @@ int C2MapFile::getTextureIDAt(int xy)
 
 int C2MapFile::getSecondaryTextureIDAt(int xy)
 {
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  if (!page) {
+    return 0;
+  }
+
   if (m_type == CEMapType::C2) {
     // C2 doesn't use secondary textures - texture map B is used for alternative purposes
     // For now, just return the primary texture
-    return int(this->m_texture_A_index_data.at(xy));
+    return int(page->m_texture_A_index_data.at(local));
   } else {
-    int id = int(this->m_texturec1_B_index_data.at(xy));
+    int id = int(page->m_texturec1_B_index_data.at(local));
     if (this->hasWaterAt(xy)) {
       if (!id) {
         return 1;
@@ -166,7 +405,13 @@ float C2MapFile::getBrightnessAt(int x, int y)
 
 float C2MapFile::getBrightnessAt(int xy)
 {
-  int brightness = this->m_day_brightness_data.at(xy); // uint8 (max 255)
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  if (!page) {
+    return 0.f;
+  }
+
+  int brightness = page->m_day_brightness_data.at(local); // uint8 (max 255)
 
   if (m_type == CEMapType::C1) {
     float p = float(55.f - brightness) / 55.f;
@@ -185,16 +430,16 @@ uint16_t C2MapFile::getFlagsAt(int x, int y)
 
 uint16_t C2MapFile::getFlagsAt(int xy)
 {
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  if (!page) {
+    return 0;
+  }
+
   if (m_type == CEMapType::C2) {
-    if (xy <0 || xy >= this->m_flags_data.size()) {
-      return 0;
-    }
-    return this->m_flags_data.at(xy);
+    return page->m_flags_data.at(local);
   } else {
-    if (xy <0 || xy >= this->m_c1_flags_data.size()) {
-      return 0;
-    }
-    return this->m_c1_flags_data.at(xy);
+    return page->m_c1_flags_data.at(local);
   }
 }
 
@@ -243,10 +488,10 @@ float C2MapFile::GetLandHeightAt(glm::vec3 position)
   glm::vec2 quadOffset = glm::vec2(static_cast<int>(position.x) % tileLength, static_cast<int>(position.z) % tileLength);
   
   std::array<int, 4> unscaledHeights = {
-    isC2Style ? m_heightmap_data.at(XY(tilePosition)) : m_watermap_data.at(XY(tilePosition)),
-    isC2Style ? m_heightmap_data.at(XY(tilePosition + glm::vec2(1, 0))) : m_watermap_data.at(XY(tilePosition + glm::vec2(1, 0))),
-    isC2Style ? m_heightmap_data.at(XY(tilePosition + glm::vec2(1, 1))) : m_watermap_data.at(XY(tilePosition + glm::vec2(1, 1))),
-    isC2Style ? m_heightmap_data.at(XY(tilePosition + glm::vec2(0, 1))) : m_watermap_data.at(XY(tilePosition + glm::vec2(0, 1)))
+    isC2Style ? getRawHeightAt(XY(tilePosition)) : getRawWaterAt(XY(tilePosition)),
+    isC2Style ? getRawHeightAt(XY(tilePosition + glm::vec2(1, 0))) : getRawWaterAt(XY(tilePosition + glm::vec2(1, 0))),
+    isC2Style ? getRawHeightAt(XY(tilePosition + glm::vec2(1, 1))) : getRawWaterAt(XY(tilePosition + glm::vec2(1, 1))),
+    isC2Style ? getRawHeightAt(XY(tilePosition + glm::vec2(0, 1))) : getRawWaterAt(XY(tilePosition + glm::vec2(0, 1)))
   };
   
   if (isQuadRotatedAt(XY(tilePosition))) {
@@ -339,16 +584,16 @@ float C2MapFile::getHeightAt(int xy)
   float scaled_height;
   auto isUnderwater = 0x80;
   
-  if (xy < 0 || xy >= m_heightmap_data.size()) {
+  if (xy < 0 || xy >= m_width * m_height) {
     std::cerr << "OOB height requested for heightmap! Returning -1" << std::endl;
     return -1.f;
   }
 
   if (m_type == CEMapType::C2) {
-    scaled_height = this->m_heightmap_data.at(xy) * this->getHeightmapScale();
+    scaled_height = this->getRawHeightAt(xy) * this->getHeightmapScale();
   } else {
-      auto c1WaterHeight = this->m_watermap_data.at(xy);
-      auto c1LandHeight = this->m_heightmap_data.at(xy);
+      auto c1WaterHeight = this->getRawWaterAt(xy);
+      auto c1LandHeight = this->getRawHeightAt(xy);
       uint8_t flags = this->getFlagsAt(xy);
       if (flags & isUnderwater) {
           // If water is here, use the water height
@@ -365,7 +610,7 @@ float C2MapFile::getHeightAt(int xy)
 
 float C2MapFile::getTerrainHeightAt(int xy)
 {
-  if (xy < 0 || xy >= m_heightmap_data.size()) {
+  if (xy < 0 || xy >= m_width * m_height) {
     std::cerr << "OOB terrain height requested! Returning -1" << std::endl;
     return -1.f;
   }
@@ -374,33 +619,27 @@ float C2MapFile::getTerrainHeightAt(int xy)
   
   if (m_type == CEMapType::C2) {
     // For C2, heightmap contains terrain height directly
-    scaled_height = this->m_heightmap_data.at(xy) * this->getHeightmapScale();
+    scaled_height = this->getRawHeightAt(xy) * this->getHeightmapScale();
   } else {
     // For C1, we need the actual ground height for depth calculations
     // m_watermap contains the ground level, m_heightmap contains surface level
     // For terrain height (ground), use watermap value directly
-    auto c1GroundHeight = this->m_watermap_data.at(xy);
+    auto c1GroundHeight = this->getRawWaterAt(xy);
     scaled_height = c1GroundHeight * this->getHeightmapScale();
   }
 
   return scaled_height;
 }
 
-void C2MapFile::setGroundLevelAt(int x, int y, float level, float slopeDegrees)
-{
-  int xy = (y * this->getWidth()) + x;
-
-  m_ground_levels[xy] = level;
-  m_ground_angles[xy] = slopeDegrees;
-}
-
 int C2MapFile::getObjectAt(int xy)
 {
-  if (xy <0 || xy >= this->m_object_index_data.size()) {
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  if (!page) {
     return 255;
   }
 
-  return int(this->m_object_index_data.at(xy));
+  return int(page->m_object_index_data.at(local));
 }
 
 float C2MapFile::getHeightmapScale()
@@ -420,11 +659,15 @@ bool C2MapFile::hasWaterAt(int xy)
 
     return false;
   } else {
-    uint8_t flags = this->getFlagsAt(xy);
+    int local;
+    CEMapPage* page = this->pageAt(xy, local);
+    if (!page) return false;
+
+    uint8_t flags = page->m_c1_flags_data.at(local);
     if (flags & 0x0080 || flags & 0x8000) return true;
 
-    uint8_t surfaceHeight = this->m_heightmap_data.at(xy);
-    uint8_t groundHeight = this->m_watermap_data.at(xy);
+    uint8_t surfaceHeight = page->m_heightmap_data.at(local);
+    uint8_t groundHeight = page->m_watermap_data.at(local);
     
     // Fix for false water detection in mountains:
     // When both heights max out (255), it's due to heightmap data limits, not water
@@ -446,8 +689,8 @@ bool C2MapFile::hasWaterAt(int xy)
     }
     
     // Even if height delta indicates water, check texture IDs for confirmation
-    int id = int(this->m_texturec1_A_index_data.at(xy));
-    int id_second = int(this->m_texturec1_B_index_data.at(xy));
+    int id = int(page->m_texturec1_A_index_data.at(local));
+    int id_second = int(page->m_texturec1_B_index_data.at(local));
     if (!id || !id_second) {
       // Texture ID 0 is always water
       return true;
@@ -477,8 +720,12 @@ bool C2MapFile::hasOriginalWaterAt(int xy)
   } else {
     if (flags & 0x0080) return true;
     
-    uint8_t surfaceHeight = this->m_heightmap_data.at(xy);
-    uint8_t groundHeight = this->m_watermap_data.at(xy);
+    int local;
+    CEMapPage* page = this->pageAt(xy, local);
+    if (!page) return false;
+
+    uint8_t surfaceHeight = page->m_heightmap_data.at(local);
+    uint8_t groundHeight = page->m_watermap_data.at(local);
     
     // Apply same mountain fix as hasWaterAt()
     if (surfaceHeight == 255 && groundHeight == 255) {
@@ -528,20 +775,22 @@ void C2MapFile::setWaterAt(int x, int y)
 
 void C2MapFile::setWaterAt(int x, int y, int water_height)
 {
-  int xy = (y * this->getWidth()) + x;
+  int local;
+  CEMapPage* page = this->pageAt(x, y, local);
+  if (!page) return;
 
   if (m_type == CEMapType::C2) {
-    this->m_flags_data.at(xy) |= 0x8000;
+    page->m_flags_data.writableAt(local) |= 0x8000;
   } else {
     // meh?
-    this->m_c1_flags_data[xy] |= 0x80;
+    page->m_c1_flags_data.writableAt(local) |= 0x80;
   }
 }
 
 int C2MapFile::getWaterAt(int xy)
 {
   if (m_type == CEMapType::C2) {
-    return this->m_watermap_data.at(xy);
+    return this->getRawWaterAt(xy);
   } else {
     // Use a different method for C1
     throw std::runtime_error("Water type unsupported by selected Carnivores engine.");
@@ -573,12 +822,12 @@ float C2MapFile::getLowestHeight(int x, int y, bool waterOnly)
       (std::min(y + 1, height - 1) * width) + std::min(x + 1, width - 1)
   };
 
-  uint8_t lowest = this->m_heightmap_data.at(quad_locations[0]);
+  uint8_t lowest = this->getRawHeightAt(quad_locations[0]);
 
   // We have to do this for water since tiles can have HALF water and half land.
   // For these, we want the water portion to be aligned with the neighboring water and not the land.
   for (int e=1; e < quad_locations.size(); e++) {
-    uint8_t h = this->m_heightmap_data.at(quad_locations[e]);
+    uint8_t h = this->getRawHeightAt(quad_locations[e]);
 
     if (waterOnly) {
       if (hasWaterAt(quad_locations[e]) && h < lowest) lowest = h;
@@ -592,7 +841,13 @@ float C2MapFile::getLowestHeight(int x, int y, bool waterOnly)
 
 float C2MapFile::getObjectHeightAt(int xy)
 {
-  float object_height = this->m_object_heightmap_data.at(xy);
+  int local;
+  CEMapPage* page = this->pageAt(xy, local);
+  if (!page) {
+    return 0.f;
+  }
+
+  float object_height = page->m_object_heightmap_data.at(local);
 
   float scaled_height = object_height * this->getHeightmapScale();
 
@@ -600,12 +855,25 @@ float C2MapFile::getObjectHeightAt(int xy)
 }
 
 float C2MapFile::getPlaceGroundHeight(int x, int y) {
-  return m_ground_levels.at(XY(glm::vec2(x, y)));
+  int local;
+  CEMapPage* page = this->pageAt(x, y, local);
+  if (!page) {
+    return 0.f;
+  }
+
+  this->ensureGroundAt(*page, local);
+  return page->m_ground_levels.at(local);
 }
 
 float C2MapFile::getGroundAngleAt(int x, int y) {
-  int xy = (y * this->getWidth()) + x;
-  return m_ground_angles.at(xy);
+  int local;
+  CEMapPage* page = this->pageAt(x, y, local);
+  if (!page) {
+    return 0.f;
+  }
+
+  this->ensureGroundAt(*page, local);
+  return page->m_ground_angles.at(local);
 }
 
 float C2MapFile::getInterpolatedGroundHeight(float world_x, float world_z) {
@@ -694,28 +962,6 @@ int C2MapFile::getObjectHeightForRadius(int x, int y, int R)
     return (int)hr;
 }
 
-void C2MapFile::fillWater(int x, int y, int source_x, int source_y)
-{
-  if (m_type == CEMapType::C1) {
-    int srcxy = (source_y * this->getWidth()) + source_x;
-    int h = this->m_heightmap_data.at(srcxy);
-    this->setWaterAt(x, y, h);
-  } else {
-    this->setWaterAt(x, y);
-    this->copyWaterMap(x, y, source_x, source_y);
-  }
-}
-
-void C2MapFile::copyWaterMap(int x, int y, int src_x, int src_y)
-{
-  int xy = (y * this->getWidth()) + x;
-  int srcxy = (src_y * this->getWidth()) + src_x;
-
-  if (m_type == CEMapType::C2) {
-    this->m_watermap_data.at(xy) = this->m_watermap_data.at(srcxy);
-  }
-}
-
 glm::vec2 C2MapFile::getXYAtWorldPosition(glm::vec2 pos)
 {
   glm::vec2 xy(floorf(pos.x / this->getTileLength()), floorf(pos.y / this->getTileLength()));
@@ -732,14 +978,33 @@ float C2MapFile::getAngleBetweenPoints(glm::vec3 a, glm::vec3 b)
 
 glm::vec3 C2MapFile::getRandomLanding()
 {
-  int num_landings = (int)m_landings.size();
-  glm::vec2 landing;
+  thread_local std::mt19937 rng(std::random_device{}());
+  return this->getRandomLanding(rng);
+}
+
+glm::vec3 C2MapFile::getRandomLanding(std::mt19937& rng)
+{
+  // Only landings on resident pages are candidates
+  int page_count = m_pages_x * m_pages_y;
+  int num_landings = 0;
+  for (int p = 0; p < page_count; p++) {
+    CEMapPage* page = m_pages[p].load(std::memory_order_acquire);
+    if (page) num_landings += (int)page->m_landings.size();
+  }
+
+  glm::vec2 landing = m_streamed ? m_start_tile : glm::vec2((int)getWidth() / 2, (int)getHeight() / 2);
 
   if (num_landings > 0) {
-    int r_landing = rand() % num_landings;
-    landing = m_landings.at(r_landing);
-  } else {
-    landing = glm::vec2((int)getWidth() / 2, (int)getHeight() / 2);
+    int r_landing = std::uniform_int_distribution<int>(0, num_landings - 1)(rng);
+    for (int p = 0; p < page_count; p++) {
+      CEMapPage* page = m_pages[p].load(std::memory_order_acquire);
+      if (!page) continue;
+      if (r_landing < (int)page->m_landings.size()) {
+        landing = page->m_landings.at(r_landing);
+        break;
+      }
+      r_landing -= (int)page->m_landings.size();
+    }
   }
 
   int xy = (landing.y * getWidth()) + landing.x;
@@ -755,8 +1020,12 @@ bool C2MapFile::hasDangerTileAt(std::shared_ptr<C2MapRscFile> rsc, glm::vec2 til
   // Read fog map and check for "lava" as best we can
   // We can kind of conclude that there's lava if there's a mortal
   // fog map at this location AND the tile height is < the mortal Y
-  int xy = (((int)tile.y >> 1) * (getWidth() >> 1)) + ((int)tile.x >> 1);
-  int fogIndex = m_fog_data.at(xy);
+  int zone;
+  CEMapPage* page = this->zoneAt((int)tile.x, (int)tile.y, zone);
+  if (!page) {
+    return false;
+  }
+  int fogIndex = page->m_fog_data.at(zone);
   
   // 0 = no fog
   if (fogIndex < 1) {
@@ -784,9 +1053,13 @@ bool C2MapFile::hasDangerTileAt(std::shared_ptr<C2MapRscFile> rsc, glm::vec2 til
 
 int C2MapFile::getFogIndexAt(int x, int y)
 {
-  // Fog data is at half resolution, so divide coordinates by 2
-  int xy = (((int)y >> 1) * (getWidth() >> 1)) + ((int)x >> 1);
-  int fogIndex = m_fog_data.at(xy);
+  // Fog data is at half resolution
+  int zone;
+  CEMapPage* page = this->zoneAt(x, y, zone);
+  if (!page) {
+    return -1;
+  }
+  int fogIndex = page->m_fog_data.at(zone);
   
   // Return 0-based index (-1 if no fog)
   return fogIndex > 0 ? fogIndex - 1 : -1;
@@ -797,10 +1070,13 @@ bool C2MapFile::hasFogAt(int x, int y)
   return getFogIndexAt(x, y) >= 0;
 }
 
-void C2MapFile::postProcess(std::weak_ptr<C2MapRscFile> rsc)
+/*
+ * Landings and, for C2, the water filling that closes gaps along shorelines. Works on a single
+ * page that may not be published yet, so it never looks past the page's edges
+ */
+void C2MapFile::postProcess(CEMapPage& page, std::shared_ptr<C2MapRscFile> rsc)
 {
-  std::shared_ptr<C2MapRscFile> m_rsc = rsc.lock();
-  if (!m_rsc) {
+  if (!rsc) {
     std::cerr << "Cannot aquire reference to RSC for postProcess! RSC no longer loaded." << std::endl;
 
     throw std::runtime_error("Lost reference to RSC file during map build!");
@@ -808,13 +1084,19 @@ void C2MapFile::postProcess(std::weak_ptr<C2MapRscFile> rsc)
 
   int w = (int)this->getWidth();
   int h = (int)this->getHeight();
+  int x0 = std::max(page.m_origin_x, 1), x1 = std::min(page.m_origin_x + page.m_size, w - 1);
+  int y0 = std::max(page.m_origin_y, 1), y1 = std::min(page.m_origin_y + page.m_size, h - 1);
+
+  auto hasOriginalWater = [&](int x, int y) {
+    return page.contains(x, y) && (page.m_flags_data.at(page.localIndex(x, y)) & 0x0080);
+  };
   
-  for (int y = 1; y < w-1; y++)
-    for (int x = 1; x < h-1; x++) {
-      int xy = (y * w) + (x);
+  for (int y = y0; y < y1; y++)
+    for (int x = x0; x < x1; x++) {
+      int xy = page.localIndex(x, y);
 
-      if (this->getObjectAt(xy) == 254) {
-        m_landings.push_back(glm::vec2(x, y));
+      if (page.m_object_index_data.at(xy) == 254) {
+        page.m_landings.push_back(glm::vec2(x, y));
       }
       
       if (m_type == CEMapType::C1) {
@@ -822,109 +1104,280 @@ void C2MapFile::postProcess(std::weak_ptr<C2MapRscFile> rsc)
       }
 
       // Process water filling to handle gaps
-      if (!this->hasOriginalWaterAt(xy)) {
-        if (this->hasOriginalWaterAt(x+1, y)) this->fillWater(x, y, x+1, y);
-        if (this->hasOriginalWaterAt(x, y+1)) this->fillWater(x, y, x, y+1);
-        if (this->hasOriginalWaterAt(x-1, y)) this->fillWater(x, y, x-1, y);
-        if (this->hasOriginalWaterAt(x, y-1)) this->fillWater(x, y, x, y-1);
-        if (this->hasOriginalWaterAt(x-1, y-1)) this->fillWater(x, y, x-1, y-1);
-        if (this->hasOriginalWaterAt(x+1, y-1)) this->fillWater(x, y, x+1, y-1);
-        if (this->hasOriginalWaterAt(x-1, y+1)) this->fillWater(x, y, x-1, y+1);
-        if (this->hasOriginalWaterAt(x+1, y+1)) this->fillWater(x, y, x+1, y+1);
-
-        if (this->hasDynamicWaterAt(xy)) {
-          if (this->m_heightmap_data.at(xy) == m_rsc->getWater(this->m_watermap_data.at(xy)).water_level) {
-            this->m_heightmap_data.at(xy) += 1;
+      if (!hasOriginalWater(x, y)) {
+        auto fillWater = [&](int source_x, int source_y) {
+          if (!hasOriginalWater(source_x, source_y)) return;
+          page.m_flags_data.writableAt(xy) |= 0x8000;
+          page.m_watermap_data.writableAt(xy) = page.m_watermap_data.at(page.localIndex(source_x, source_y));
+        };
+
+        fillWater(x+1, y);
+        fillWater(x, y+1);
+        fillWater(x-1, y);
+        fillWater(x, y-1);
+        fillWater(x-1, y-1);
+        fillWater(x+1, y-1);
+        fillWater(x-1, y+1);
+        fillWater(x+1, y+1);
+
+        if (page.m_flags_data.at(xy) & 0x8000) {
+          if (page.m_heightmap_data.at(xy) == rsc->getWater(page.m_watermap_data.at(xy)).water_level) {
+            page.m_heightmap_data.writableAt(xy) += 1;
           }
         }
       }
     }
 }
 
-void C2MapFile::load_c1(const std::string &file_name, std::weak_ptr<C2MapRscFile> rsc)
+/*
+ * postProcess, or its results from the map cache when they are there
+ */
+void C2MapFile::postProcessCached(CEMapPage& page, std::weak_ptr<C2MapRscFile> rsc, CEMapCache* cache)
 {
-  std::ifstream infile;
-  infile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+  // Water filling marks the tiles it fills in the flags layer
+  void* flags_data = (m_type == CEMapType::C2) ? (void*)page.m_flags_data.writableData() : (void*)page.m_c1_flags_data.writableData();
+  size_t flags_size = (m_type == CEMapType::C2) ? page.m_flags_data.byteSize() : page.m_c1_flags_data.byteSize();
+
+  // Check every layer first so a bad cache never leaves them half post-processed
+  if (cache && cache->isLoaded() &&
+      cache->contains(CEMapCache::Section::MAP_HEIGHTS, page.m_heightmap_data.byteSize()) &&
+      cache->contains(CEMapCache::Section::MAP_WATER, page.m_watermap_data.byteSize()) &&
+      cache->contains(CEMapCache::Section::MAP_FLAGS, flags_size) &&
+      cache->readVector(CEMapCache::Section::LANDINGS, page.m_landings)) {
+    cache->read(CEMapCache::Section::MAP_HEIGHTS, page.m_heightmap_data.writableData(), page.m_heightmap_data.byteSize());
+    cache->read(CEMapCache::Section::MAP_WATER, page.m_watermap_data.writableData(), page.m_watermap_data.byteSize());
+    cache->read(CEMapCache::Section::MAP_FLAGS, flags_data, flags_size);
+    return;
+  }
 
-  try {
-    infile.open(file_name.c_str(), std::ios::binary | std::ios::in);
-
-    infile.read(reinterpret_cast<char *>(this->m_heightmap_data.data()), 512*512);
-    infile.read(reinterpret_cast<char *>(this->m_texturec1_A_index_data.data()), 512*512);
-    infile.read(reinterpret_cast<char *>(this->m_texturec1_B_index_data.data()), 512*512);
-    infile.read(reinterpret_cast<char *>(this->m_object_index_data.data()), 512*512);
-    infile.read(reinterpret_cast<char *>(this->m_c1_flags_data.data()), 512*512);
-
-    // This is used in the original engine to calculate object "darkness" on a given tile - we don't really need it anymore
-    infile.read(reinterpret_cast<char *>(this->m_day_brightness_data.data()), 512*512);
-
-    infile.read(reinterpret_cast<char *>(this->m_watermap_data.data()), 512*512); // C1 has only 1 water - these are the heights of the underwater surface
-    infile.read(reinterpret_cast<char *>(this->m_object_heightmap_data.data()), 512*512);
-    infile.read(reinterpret_cast<char *>(this->m_fog_data.data()), 256*256);
-    infile.read(reinterpret_cast<char *>(this->m_soundfx_data.data()), 256*256);
-
-    infile.close();
-    this->postProcess(rsc);
-  } catch (const std::ios_base::failure& e) {
-    std::cerr << "I/O error: " << e.what() << std::endl;
-    throw;
-  } catch (const std::runtime_error& e) {
-      std::cerr << "Runtime error: " << e.what() << std::endl;
-    throw;
-  } catch (...) {
-      std::cerr << "An unknown error occurred." << std::endl;
-    
-    throw;
+  this->postProcess(page, rsc.lock());
+
+  if (cache) {
+    cache->write(CEMapCache::Section::MAP_HEIGHTS, page.m_heightmap_data.data(), page.m_heightmap_data.byteSize());
+    cache->write(CEMapCache::Section::MAP_WATER, page.m_watermap_data.data(), page.m_watermap_data.byteSize());
+    cache->write(CEMapCache::Section::MAP_FLAGS, flags_data, flags_size);
+    cache->writeVector(CEMapCache::Section::LANDINGS, page.m_landings);
   }
 }
 
-void C2MapFile::load(const std::string &file_name, std::weak_ptr<C2MapRscFile> rsc)
+bool C2MapFile::restoreGroundLayers(const CEMapCache& cache)
 {
-  std::ifstream infile;
-  infile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+  // Only single-page maps go through the map cache
+  CEMapPage* page = m_streamed ? nullptr : m_pages[0].load(std::memory_order_acquire);
+  if (!page) {
+    return false;
+  }
 
-  try {
-    infile.open(file_name.c_str(), std::ios::binary | std::ios::in);
+  std::lock_guard<std::mutex> lock(m_ground_mutex);
 
-    infile.read(reinterpret_cast<char *>(this->m_heightmap_data.data()), 1024*1024);
-    infile.read(reinterpret_cast<char *>(this->m_texture_A_index_data.data()), 1024*1024*2);
-    infile.read(reinterpret_cast<char *>(this->m_texture_B_index_data.data()), 1024*1024*2);
-    infile.read(reinterpret_cast<char *>(this->m_object_index_data.data()), 1024*1024);
-    infile.read(reinterpret_cast<char *>(this->m_flags_data.data()), 1024*1024*2);
+  bool restored = cache.read(CEMapCache::Section::GROUND_LEVELS, page->m_ground_levels.data(), page->m_ground_levels.size() * sizeof(float)) &&
+                  cache.read(CEMapCache::Section::GROUND_ANGLES, page->m_ground_angles.data(), page->m_ground_angles.size() * sizeof(float)) &&
+                  cache.read(CEMapCache::Section::WALKABLE_FLAGS, page->m_walkable_flags_data.data(), page->m_walkable_flags_data.size() * sizeof(uint16_t));
 
-    infile.read(reinterpret_cast<char *>(this->m_dawn_brightness_data.data()), 1024*1024);
-    infile.read(reinterpret_cast<char *>(this->m_day_brightness_data.data()), 1024*1024);
-    infile.read(reinterpret_cast<char *>(this->m_night_brightness_data.data()), 1024*1024);
+  // A partial restore leaves the regions to be rebuilt as they are used
+  int region_count = page->m_ground_regions_per_row * page->m_ground_regions_per_row;
+  for (int r = 0; r < region_count; r++) {
+    page->m_ground_region_ready[r].store(restored, std::memory_order_release);
+  }
 
-    infile.read(reinterpret_cast<char *>(this->m_watermap_data.data()), 1024*1024);
-    infile.read(reinterpret_cast<char *>(this->m_object_heightmap_data.data()), 1024*1024);
-    infile.read(reinterpret_cast<char *>(this->m_fog_data.data()), 512*512);
-    infile.read(reinterpret_cast<char *>(this->m_soundfx_data.data()), 512*512);
+  return restored;
+}
 
-    infile.close();
-    
-    this->postProcess(rsc);
-  } catch (const std::ios_base::failure& e) {
-    std::cerr << "I/O error: " << e.what() << std::endl;
-    throw;
-  } catch (const std::runtime_error& e) {
-      std::cerr << "Runtime error: " << e.what() << std::endl;
-    throw;
-  } catch (...) {
-      std::cerr << "An unknown error occurred." << std::endl;
-    
-    throw;
+void C2MapFile::storeGroundLayers(CEMapCache& cache)
+{
+  CEMapPage* page = m_streamed ? nullptr : m_pages[0].load(std::memory_order_acquire);
+  if (!page) {
+    return;
   }
+
+  for (int region_y = 0; region_y < page->m_ground_regions_per_row; region_y++) {
+    for (int region_x = 0; region_x < page->m_ground_regions_per_row; region_x++) {
+      this->ensureGroundAt(*page, (region_y * CEMapPage::GROUND_REGION * page->m_size) + (region_x * CEMapPage::GROUND_REGION));
+    }
+  }
+
+  cache.write(CEMapCache::Section::GROUND_LEVELS, page->m_ground_levels.data(), page->m_ground_levels.size() * sizeof(float));
+  cache.write(CEMapCache::Section::GROUND_ANGLES, page->m_ground_angles.data(), page->m_ground_angles.size() * sizeof(float));
+  cache.write(CEMapCache::Section::WALKABLE_FLAGS, page->m_walkable_flags_data.data(), page->m_walkable_flags_data.size() * sizeof(uint16_t));
 }
 
-uint16_t C2MapFile::getWalkableFlagsAt(glm::vec2 tile) {
-  int xy = (tile.y * getWidth()) + tile.x;
-  return m_walkable_flags_data.at(xy);
+/*
+ * Builds the region of the page holding local tile `local` unless that has happened already.
+ * AI worker threads land here concurrently, so building is serialised and the ready flag
+ * published last. The wait for the lock is unbounded, so the caller is counted as a builder
+ * before it and the page checked to be still resident: evicted pages aren't freed while any
+ * builder remains
+ */
+void C2MapFile::ensureGroundAt(CEMapPage& page, int local)
+{
+  if (local < 0 || local >= (int)page.m_ground_levels.size()) {
+    return;
+  }
+
+  int region_x = (local % page.m_size) / CEMapPage::GROUND_REGION;
+  int region_y = (local / page.m_size) / CEMapPage::GROUND_REGION;
+  std::atomic<bool>& ready = page.m_ground_region_ready[(region_y * page.m_ground_regions_per_row) + region_x];
+  if (ready.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  struct Builder {
+    std::atomic<int>& count;
+    ~Builder() { count.fetch_sub(1, std::memory_order_seq_cst); }
+  };
+  m_ground_builders.fetch_add(1, std::memory_order_seq_cst);
+  Builder builder = { m_ground_builders };
+
+  // Evicted before we were counted: nobody will read its ground again
+  if (m_pages[page.m_index].load(std::memory_order_seq_cst) != &page) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_ground_mutex);
+  if (!ready.load(std::memory_order_relaxed)) {
+    this->buildGroundRegion(page, region_x, region_y);
+    ready.store(true, std::memory_order_release);
+  }
+}
+
+glm::vec3 C2MapFile::getWorldVertex(int x, int y)
+{
+  float tile_size = this->getTileLength();
+
+  return glm::vec3((x * tile_size) + (tile_size / 2.f), this->getHeightAt((y * this->getWidth()) + x), (y * tile_size) + (tile_size / 2.f));
+}
+
+void C2MapFile::getQuadFaceNormals(int x, int y, glm::vec3& normal1, glm::vec3& normal2)
+{
+  int width = this->getWidth(), height = this->getHeight();
+
+  glm::vec3 vpositionLL = this->getWorldVertex(x, y);
+  glm::vec3 vpositionLR = this->getWorldVertex(std::min(x + 1, width - 1), y);
+  glm::vec3 vpositionUL = this->getWorldVertex(x, std::min(y + 1, height - 1));
+  glm::vec3 vpositionUR = this->getWorldVertex(std::min(x + 1, width - 1), std::min(y + 1, height - 1));
+
+  if (this->isQuadRotatedAt((y * width) + x)) {
+    normal1 = calculateFaceNormal(vpositionLL, vpositionUL, vpositionLR);
+    normal2 = calculateFaceNormal(vpositionLR, vpositionUL, vpositionUR);
+  } else {
+    normal1 = calculateFaceNormal(vpositionLL, vpositionUR, vpositionLR);
+    normal2 = calculateFaceNormal(vpositionLL, vpositionUL, vpositionUR);
+  }
 }
 
+/*
+ * Faces are summed in the order the terrain mesh used to accumulate them, so normals (and the
+ * slopes derived from them) come out the same whichever side asks first
+ */
+glm::vec3 C2MapFile::getVertexNormalAt(int x, int y)
+{
+  glm::vec3 normal(0.f), normal1, normal2;
+
+  if (x > 0 && y > 0) {
+    this->getQuadFaceNormals(x - 1, y - 1, normal1, normal2);
+    normal += normal2;
+  }
+  if (y > 0) {
+    this->getQuadFaceNormals(x, y - 1, normal1, normal2);
+    normal += normal1;
+  }
+  if (x > 0) {
+    this->getQuadFaceNormals(x - 1, y, normal1, normal2);
+    normal += normal1;
+  }
+  this->getQuadFaceNormals(x, y, normal1, normal2);
+  normal += normal1;
+
+  return glm::normalize(normal);
+}
+
+/*
+ * Ground level (mean of the corner heights), slope (from the averaged corner normals) and
+ * walkability for every tile in one region of a page. Neighbours are read across page edges
+ */
+void C2MapFile::buildGroundRegion(CEMapPage& page, int region_x, int region_y)
+{
+  int width = this->getWidth(), height = this->getHeight();
+  int x0 = page.m_origin_x + (region_x * CEMapPage::GROUND_REGION), y0 = page.m_origin_y + (region_y * CEMapPage::GROUND_REGION);
+  int x1 = std::min(x0 + CEMapPage::GROUND_REGION, page.m_origin_x + page.m_size);
+  int y1 = std::min(y0 + CEMapPage::GROUND_REGION, page.m_origin_y + page.m_size);
+
+  // Normals for the region's vertices plus the row and column shared with the next regions
+  int span_x = std::min(x1 + 1, width) - x0;
+  int span_y = std::min(y1 + 1, height) - y0;
+  std::vector<glm::vec3> normals(span_x * span_y);
+  for (int y = 0; y < span_y; y++) {
+    for (int x = 0; x < span_x; x++) {
+      normals[(y * span_x) + x] = this->getVertexNormalAt(x0 + x, y0 + y);
+    }
+  }
+
+  std::shared_ptr<C2MapRscFile> rsc = m_rsc.lock();
+
+  for (int y = y0; y < y1; y++) {
+    for (int x = x0; x < x1; x++) {
+      int xy = (y * width) + x;
+      int right = std::min(x + 1, width - 1), up = std::min(y + 1, height - 1);
+
+      float centerHeight = (this->getHeightAt(xy) + this->getHeightAt((y * width) + right) +
+                            this->getHeightAt((up * width) + x) + this->getHeightAt((up * width) + right)) / 4.0f;
+
+      int lx = x - x0, ly = y - y0;
+      glm::vec3 normalLL = normals[(ly * span_x) + lx];
+      glm::vec3 normalLR = (x + 1 < width) ? normals[(ly * span_x) + lx + 1] : normalLL;
+      glm::vec3 normalUL = (y + 1 < height) ? normals[((ly + 1) * span_x) + lx] : normalLL;
+      glm::vec3 normalUR = (y + 1 < height && x + 1 < width) ? normals[((ly + 1) * span_x) + lx + 1] : normalLL;
+      glm::vec3 avgNormal = glm::normalize(normalLL + normalLR + normalUL + normalUR);
+
+      float slopeAngle = glm::degrees(atan2(glm::length(glm::vec2(avgNormal.x, avgNormal.z)), avgNormal.y));
+
+      int local = page.localIndex(x, y);
+      page.m_ground_levels[local] = centerHeight;
+      page.m_ground_angles[local] = slopeAngle;
+
+      bool walkable = true;
+      if (this->hasWaterAt(x, y)) {
+        walkable = false;
+      } else if (rsc && this->hasDangerTileAt(rsc, glm::vec2(x, y))) {
+        walkable = false;
+      } else if (slopeAngle > 35.f) {
+        walkable = false;
+      }
+      page.m_walkable_flags_data[local] = walkable ? 0x0 : 0x1;
+    }
+  }
+}
+
+uint16_t C2MapFile::getWalkableFlagsAt(glm::vec2 tile) {
+  int local;
+  CEMapPage* page = this->pageAt((int)tile.x, (int)tile.y, local);
+  if (!page) {
+    // Nothing is walkable where the world is not loaded
+    return 0x1;
+  }
+
+  this->ensureGroundAt(*page, local);
+  return page->m_walkable_flags_data.at(local);
+}
 
 void C2MapFile::setWalkableFlagsAt(glm::vec2 tile, uint16_t flags) {
-  int xy = (tile.y * getWidth()) + tile.x;
-  m_walkable_flags_data[xy] = flags;
+  int local;
+  CEMapPage* page = this->pageAt((int)tile.x, (int)tile.y, local);
+  if (!page) {
+    return;
+  }
+
+  // Built first, so building the region later doesn't overwrite the new flags
+  this->ensureGroundAt(*page, local);
+  page->m_walkable_flags_data.at(local) = flags;
+
+  std::lock_guard<std::mutex> lock(m_walkability_mutex);
+  m_walkability_changes.push_back(glm::ivec2((int)tile.x, (int)tile.y));
 }
 
+std::vector<glm::ivec2> C2MapFile::takeWalkabilityChanges() {
+  std::lock_guard<std::mutex> lock(m_walkability_mutex);
+  std::vector<glm::ivec2> changes;
+  changes.swap(m_walkability_changes);
+  return changes;
+}
@@ -16,54 +16,89 @@
 
 #include <cstdint>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
 
 #include "g_shared.h"
 
 #include <glm/glm.hpp>
 
 class C2MapRscFile;
+class CEMapCache;
+class CEMapPage;
 struct _Water;
 
+/*
+ * The world is a grid of square pages (see CEMapPage). A classic .map file is one page covering the
+ * whole map and is always resident. A .world manifest describes a larger grid whose pages are
+ * loaded and evicted by CEWorldStreamer; tiles of pages that are not resident read as flat, dry,
+ * empty and unwalkable.
+ */
 class C2MapFile
 {
 private:
-  std::array<uint8_t, 1024 * 1024> m_heightmap_data = {};
-  std::array<uint8_t, 512 * 512> m_texturec1_A_index_data = {};
-  std::array<uint8_t, 512*512> m_texturec1_B_index_data = {};
-  std::array<uint16_t, 1024*1024> m_texture_A_index_data = {};
-  std::array<uint16_t, 1024*1024> m_texture_B_index_data = {};
-  std::array<uint8_t, 1024*1024> m_object_index_data = {};
-  std::array<uint16_t, 1024*1024> m_flags_data = {};
-  std::array<uint8_t, 512*512> m_c1_flags_data = {};
-  std::array<uint8_t, 1024*1024> m_dawn_brightness_data = {};
-  std::array<uint8_t, 1024*1024> m_day_brightness_data = {};
-  std::array<uint8_t, 1024*1024> m_night_brightness_data = {};
-  std::array<uint8_t, 1024*1024> m_watermap_data = {};
-  std::array<uint8_t, 1024*1024> m_object_heightmap_data = {};
-  std::array<uint8_t, 512*512> m_fog_data = {};
-  std::array<uint8_t, 512*512> m_soundfx_data = {};
-  std::vector<glm::vec2> m_landings;
-  
-  // Store computed ground level heights
-  std::array<float, 1024 * 1024> m_ground_levels = {};
-  std::array<float, 1024 * 1024> m_ground_angles = {};
-  std::array<uint16_t, 1024*1024> m_walkable_flags_data = {};
+  std::weak_ptr<C2MapRscFile> m_rsc;
+
+  int m_width = 0;
+  int m_height = 0;
+  int m_page_size = 0;  // tiles per page side, a power of two
+  int m_page_shift = 0;
+  int m_pages_x = 1;
+  int m_pages_y = 1;
+  bool m_streamed = false;
+  bool m_memory_mapped = true;
+  std::string m_page_directory;
+  glm::vec2 m_start_tile = glm::vec2(0.f);
+
+  // Read by any thread; only the main thread installs or evicts
+  std::unique_ptr<std::atomic<CEMapPage*>[]> m_pages;
+  std::vector<std::unique_ptr<CEMapPage>> m_page_storage;
+
+  // Evicted pages, kept for a grace period that outlasts any plain lookup still in flight
+  std::vector<std::pair<std::chrono::steady_clock::time_point, std::unique_ptr<CEMapPage>>> m_retired_pages;
+
+  // Serialises building ground regions and invalidating them around page changes
+  std::mutex m_ground_mutex;
+  // Threads waiting on or holding m_ground_mutex to build a region; no page is freed while nonzero
+  std::atomic<int> m_ground_builders{0};
+
+  // Tiles changed by setWalkableFlagsAt() since the last takeWalkabilityChanges()
+  std::vector<glm::ivec2> m_walkability_changes;
+  std::mutex m_walkability_mutex;
 
   constexpr static const int SIZE = 1024;
   constexpr static const int SIZE_C1 = 512;
   constexpr static const float HEIGHT_SCALE = 4.f; // Scaled down 16x for new world scale (was 64.f)
   constexpr static const float HEIGHT_SCALE_C1 = 2.f; // Scaled down 16x for new world scale (was 32.f)
   
-  void postProcess(std::weak_ptr<C2MapRscFile> rsc);
-  void fillWater(int x, int y, int src_x, int src_y);
-  void copyWaterMap(int x, int y, int src_x, int src_y);
+  void loadWorld(const std::string& file_name);
+  std::string getPageFileName(int page) const;
+
+  void postProcess(CEMapPage& page, std::shared_ptr<C2MapRscFile> rsc);
+  void postProcessCached(CEMapPage& page, std::weak_ptr<C2MapRscFile> rsc, CEMapCache* cache);
+
+  CEMapPage* pageAt(int xy, int& local) const;
+  CEMapPage* pageAt(int x, int y, int& local) const;
+  CEMapPage* zoneAt(int x, int y, int& local) const;
+  uint8_t getRawHeightAt(int xy) const;
+  uint8_t getRawWaterAt(int xy) const;
+
+  void ensureGroundAt(CEMapPage& page, int local);
+  void buildGroundRegion(CEMapPage& page, int region_x, int region_y);
+  void invalidateGroundAround(int page);
+  glm::vec3 getWorldVertex(int x, int y);
+  void getQuadFaceNormals(int x, int y, glm::vec3& normal1, glm::vec3& normal2);
   
   int XY(glm::vec2 tilePos);
 
 public:
   const CEMapType m_type;
 
-  C2MapFile(const CEMapType map_type, const std::string& map_file_name, std::weak_ptr<C2MapRscFile> rsc);
+  // map_file_name is a .map file or a .world manifest. memory_mapped maps page files instead of
+  // reading them; the layers are the same either way
+  C2MapFile(const CEMapType map_type, const std::string& map_file_name, std::weak_ptr<C2MapRscFile> rsc, std::shared_ptr<CEMapCache> cache = nullptr, bool memory_mapped = true);
   ~C2MapFile();
 
   int getWaterAt(int xy);
@@ -94,12 +129,17 @@ public:
   uint16_t getFlagsAt(int xy);
   uint16_t getFlagsAt(int x, int y);
   uint16_t getWalkableFlagsAt(glm::vec2 tile);
+  // Overrides the derived flags of a resident tile until its ground region is rebuilt
   void setWalkableFlagsAt(glm::vec2 tile, uint16_t flags);
+  // Tiles set since the last call, for whoever keeps a copy of the walkable flags
+  std::vector<glm::ivec2> takeWalkabilityChanges();
 
   glm::vec2 getXYAtWorldPosition(glm::vec2 pos);
   glm::vec3 getPositionAtCenterTile(glm::vec2 pos);
   glm::vec2 getWorldTilePosition(glm::vec3 pos);
   
+  // Thread-safe as long as each thread brings its own generator
+  glm::vec3 getRandomLanding(std::mt19937& rng);
   glm::vec3 getRandomLanding();
 
   float getAngleBetweenPoints(glm::vec3 a, glm::vec3 b);
@@ -124,11 +164,31 @@ public:
 
   void setWaterAt(int x, int y); // for C2
   void setWaterAt(int x, int y, int water_height);// c1
+
+  // Paging. Page numbers are row-major over the page grid
+  bool isStreamed() const { return m_streamed; }
+  int getPageSize() const { return m_page_size; }
+  int getPagesX() const { return m_pages_x; }
+  int getPagesY() const { return m_pages_y; }
+  int getPageAt(int x, int y) const;
+  bool isPageResident(int page) const;
+  glm::vec2 getStartTile() const { return m_start_tile; }
+
+  // Reads and post-processes a page without publishing it; safe on any thread
+  std::unique_ptr<CEMapPage> loadPage(int page);
+  // Main thread only. releaseRetiredPages() frees evicted pages after a grace period that plain
+  // lookups finish well within, and only while no ground region build (which may wait) is running
+  void installPage(std::unique_ptr<CEMapPage> page);
+  void evictPage(int page);
+  void releaseRetiredPages();
   
-  void setGroundLevelAt(int x, int y, float level, float angle);
+  // Smooth terrain normal at a vertex, from the faces of the quads around it
+  glm::vec3 getVertexNormalAt(int x, int y);
+
+  // Carry the derived ground layers through the map cache. Storing derives any region not built yet
+  bool restoreGroundLayers(const CEMapCache& cache);
+  void storeGroundLayers(CEMapCache& cache);
 
-  void load(const std::string& file_name, std::weak_ptr<C2MapRscFile> rsc);
-  void load_c1(const std::string& file_name, std::weak_ptr<C2MapRscFile> rsc);
 };
 
 #endif /* defined(__CE_Character_Lab__C2MapFile__) */
@@ -9,12 +9,14 @@
 #include "C2MapRscFile.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include "CETexture.h"
 #include "CEWorldModel.h"
 #include "C2Sky.h"
 #include "CEWaterEntity.h"
 #include "CEGeometry.h"
+#include "CELoadPipeline.h"
 #include "vertex.h"
 #include "transform.h"
 
@@ -31,9 +33,15 @@ auto make_unique(Args&&... args) -> std::unique_ptr<T>
   return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
 }
 
-C2MapRscFile::C2MapRscFile(const CEMapType type, const std::string& file_name, std::filesystem::path basePath) : m_type(type)
+C2MapRscFile::C2MapRscFile(const CEMapType type, const std::string& file_name, std::filesystem::path basePath, CELoadPipeline* pipeline) : m_type(type)
 {
-  this->load(file_name, basePath);
+  if (pipeline) {
+    this->load(file_name, basePath, pipeline);
+    return;
+  }
+  
+  CELoadPipeline serial(0);
+  this->load(file_name, basePath, &serial);
 }
 
 C2MapRscFile::~C2MapRscFile()
@@ -177,7 +185,7 @@ glm::vec4 C2MapRscFile::getFadeColor()
     }
 }
 
-void C2MapRscFile::load(const std::string &file_name, std::filesystem::path basePath)
+void C2MapRscFile::load(const std::string &file_name, std::filesystem::path basePath, CELoadPipeline* pipeline)
 {
   std::ifstream infile;
   infile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -191,12 +199,8 @@ void C2MapRscFile::load(const std::string &file_name, std::filesystem::path base
   try {
     infile.open(file_name.c_str(), std::ios::binary | std::ios::in);
 
-    int tile_padding = getAtlasTilePadding();
-    int tile_width = getAtlasTileWidth();
-
     int texture_count, model_count;
-    int SOURCE_SQUARE_SIZE = tile_width; // each texture in C2 is 128x128
-    int TEXTURE_SQUARE_SIZE = SOURCE_SQUARE_SIZE + (tile_padding * 2); // we add padding to each side to prevent bleeding and mipmap artifacts
+    int SOURCE_SQUARE_SIZE = getAtlasTileWidth(); // each texture in C2 is 128x128
     
     infile.read(reinterpret_cast<char *>(&texture_count), 4);
     infile.read(reinterpret_cast<char *>(&model_count), 4);
@@ -213,154 +217,39 @@ void C2MapRscFile::load(const std::string &file_name, std::filesystem::path base
     raw_texture_data.resize((size_t)SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE*texture_count);
     infile.read(reinterpret_cast<char *>(raw_texture_data.data()), (size_t)SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE*sizeof(uint16_t)*texture_count);
     
-    // Combine all the textures into a single texture for ease of opengl use.
-    // Add a buffer around images to mimic clamping with GL_LINEAR; see: https://stackoverflow.com/questions/19611745/opengl-black-lines-in-between-tiles
-    std::vector<uint16_t> combined_texture_data; // rgba5551
-    
-    int squared_texture_rows = static_cast<int>(sqrt(static_cast<float>(texture_count)) + .99f); // number of rows and columns needed to fit the data
-    
-    uint16_t pad_color;
-    std::vector<uint16_t> tx_filler((size_t)TEXTURE_SQUARE_SIZE*squared_texture_rows);
+    // The atlas is pure pixel shuffling; build it alongside the models and upload both once they're done
+    std::shared_future<void> textures = pipeline->async("rsc atlas", [this, raw_texture_data = std::move(raw_texture_data), texture_count]() {
+      this->buildTextures(raw_texture_data, texture_count);
+    });
     
-    for (int line = 0; line < (squared_texture_rows*SOURCE_SQUARE_SIZE); line++) { // Total vertical rows in image file (128 * number of images; current = pointer to vertical pixel location in file that represents the location of a new row of horizontal blocks)
-      
-      if (line % SOURCE_SQUARE_SIZE == 0) {
-        pad_color = _PadTypeColor::Red;
-        tx_filler.clear();
-        tx_filler.assign(((long long)TEXTURE_SQUARE_SIZE*squared_texture_rows*tile_padding), pad_color);
-        
-        for (int x=0; x < squared_texture_rows; x++) {
-          for (int p = 0; p < tile_padding; p++)
-            tx_filler.at((long long)x*TEXTURE_SQUARE_SIZE + p) = _PadTypeColor::Blue;
-
-          for (int p = 1; p <= tile_padding; p++)
-            tx_filler.at(((long long)x*TEXTURE_SQUARE_SIZE)+((long long)TEXTURE_SQUARE_SIZE-p)) = _PadTypeColor::Green;
-        }
-        combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
-      }
-      
-      for (int col = 0; col < squared_texture_rows; col++) { // Blocks (number of images; current = current block's image)
-        int lin_to_row = static_cast<int>(line/SOURCE_SQUARE_SIZE);
-        int tx_c = ((lin_to_row)*squared_texture_rows)+col;
-        int tex_start = line % SOURCE_SQUARE_SIZE;
-        
-        pad_color = _PadTypeColor::Blue;
-        for (int p = 0; p < tile_padding; p++)
-          combined_texture_data.insert(combined_texture_data.end(), pad_color);
-        
-        if (tx_c >= texture_count) {
-          std::vector<uint16_t> tx_filler(SOURCE_SQUARE_SIZE);
-          combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
-        } else {
-          std::vector<uint16_t>::const_iterator first = raw_texture_data.begin() + ((long long)tx_c*SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE) + ((long long)tex_start*SOURCE_SQUARE_SIZE); // Get start pos of a single line of pixels
-          std::vector<uint16_t>::const_iterator last = raw_texture_data.begin() + ((long long)tx_c*SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE) + ((long long)tex_start*SOURCE_SQUARE_SIZE) + SOURCE_SQUARE_SIZE; // Get end pos, which is the start + 128 pixels
-          combined_texture_data.insert(combined_texture_data.end(), first, last);
-        }
-        
-        pad_color = _PadTypeColor::Green;
-        for (int p = 0; p < tile_padding; p++)
-          combined_texture_data.insert(combined_texture_data.end(), pad_color);
+    try {
+      // Records are read in file order, then parsed in parallel
+      std::vector<std::string> model_records(model_count);
+      for (int m=0; m < model_count; m++) {
+        model_records[m] = CEWorldModel::readRecord(m_type, infile);
       }
       
-      if ((line+1) % SOURCE_SQUARE_SIZE == 0) {
-        pad_color = _PadTypeColor::Yellow;
-        tx_filler.clear();
-        tx_filler.assign((long long)TEXTURE_SQUARE_SIZE*squared_texture_rows*tile_padding, pad_color);
-        
-        for (int x=0; x < squared_texture_rows; x++) {
-          for (int p = 0; p < tile_padding; p++)
-            tx_filler.at((long long)x*TEXTURE_SQUARE_SIZE+p) = _PadTypeColor::Blue;
-
-          for (int p = 1; p <= tile_padding; p++)
-            tx_filler.at(((long long)x*TEXTURE_SQUARE_SIZE)+((long long)TEXTURE_SQUARE_SIZE-p)) = _PadTypeColor::Green;
-        }
-        
-        combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
-      }
+      this->m_models.resize(model_count);
+      pipeline->parallelFor("rsc models", model_count, [&](size_t m) {
+        std::istringstream record(model_records[m]);
+        record.exceptions(std::istringstream::failbit | std::istringstream::badbit);
+        this->m_models[m] = std::unique_ptr<CEWorldModel>(new CEWorldModel(m_type, record, true));
+      });
+    } catch (...) {
+      // The atlas job still refers to this object
+      textures.wait();
+      throw;
     }
+    pipeline->wait(textures);
     
-    int missing_bits = (squared_texture_rows*TEXTURE_SQUARE_SIZE*squared_texture_rows*TEXTURE_SQUARE_SIZE) - static_cast<int>(combined_texture_data.size());
-    
-    if (missing_bits > 0) {
-      std::vector<uint16_t> tx_filler(missing_bits);
-      combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
-    }
-
-      // TODO: we can use a frame buffer instead of this nastiness
-    std::vector<uint16_t> final_texture_data; // Now replace colors with correct entries
-    for (int i=0; i < tile_padding; i++) {
-      for (int row = 0; row < (TEXTURE_SQUARE_SIZE*squared_texture_rows); row++) {
-        for (int col = 0; col < (TEXTURE_SQUARE_SIZE*squared_texture_rows); col++) {
-          int id_x = col;
-          int id_y = row*TEXTURE_SQUARE_SIZE*squared_texture_rows;
-          uint16_t color;
-          
-          if (i >= 1) {
-            color = final_texture_data.at((long long)id_y+id_x);
-          } else {
-            color = combined_texture_data.at((long long)id_y+id_x);
-          }
-          
-          switch (color) {
-            case _AtlasPadType::Left:
-              color = final_texture_data.at((long long)id_y+((long long)id_x-1));
-              break;
-            case _AtlasPadType::Right:
-              if (i >= 1) {
-                color = final_texture_data.at((long long)id_y+((long long)id_x+1));
-              } else {
-                color = combined_texture_data.at((long long)id_y+((long long)id_x+1));
-              }
-              break;
-            case _AtlasPadType::Above:
-              color = final_texture_data.at((((long long)row-1)*TEXTURE_SQUARE_SIZE*squared_texture_rows)+id_x);
-              break;
-            case _AtlasPadType::Below:
-              if (i >= 1) {
-                color = final_texture_data.at((((long long)row+1)*TEXTURE_SQUARE_SIZE*squared_texture_rows)+id_x);
-              } else {
-                color = combined_texture_data.at((((long long)row+1)*TEXTURE_SQUARE_SIZE*squared_texture_rows)+id_x);
-              }
-              break;
-            default:
-              break;
-          }
-          if (i >= 1) {
-            final_texture_data.at((long long)id_y+id_x) = color;
-          } else {
-            final_texture_data.insert(final_texture_data.end(), color);
-          }
-        }
+    pipeline->run("rsc upload", [&]() {
+      for (auto& texture : this->m_textures) {
+        texture->upload();
       }
-    }
-    
-    std::unique_ptr<CETexture> cTexture = std::unique_ptr<CETexture>(new CETexture(final_texture_data, squared_texture_rows*TEXTURE_SQUARE_SIZE*squared_texture_rows*TEXTURE_SQUARE_SIZE, squared_texture_rows*TEXTURE_SQUARE_SIZE, squared_texture_rows*TEXTURE_SQUARE_SIZE));
-    //cTexture->saveToBMPFile("/tmp/atlas.bmp");
-
-    this->m_texture_atlas_width = squared_texture_rows;
-    this->m_texture_count = texture_count;
-    this->m_textures.push_back(std::move(cTexture));
-
-    for (int t=0; t < m_texture_count; t++) {
-      std::vector<uint16_t> texture_data;
-      std::vector<uint16_t>::const_iterator first = raw_texture_data.begin() + ((long long)t * SOURCE_SQUARE_SIZE * SOURCE_SQUARE_SIZE);
-      std::vector<uint16_t>::const_iterator last = first + (long long)SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE;
-      texture_data.insert(texture_data.end(), first, last);
-
-      std::unique_ptr<CETexture> c_texture = std::unique_ptr<CETexture>(new CETexture(texture_data, SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE, SOURCE_SQUARE_SIZE, SOURCE_SQUARE_SIZE));
-      //std::stringstream ss;
-      //ss << "/tmp/" << "map_texture_" << t << ".bmp";
-
-      //c_texture->saveToBMPFile(ss.str());
-      this->m_textures.push_back(std::move(c_texture));
-    }
-    
-    
-    // Load 3d models
-    for (int m=0; m < model_count; m++) {
-      std::unique_ptr<CEWorldModel> cModel = std::unique_ptr<CEWorldModel>(new CEWorldModel(m_type, infile));
-      this->m_models.push_back(std::move(cModel));
-    }
+      for (auto& model : this->m_models) {
+        model->upload();
+      }
+    });
     
     // Load sky bitmap and map overlay (dawn, day, night)
     if (m_type == CEMapType::C2) {
@@ -498,6 +387,158 @@ void C2MapRscFile::load(const std::string &file_name, std::filesystem::path base
   }
 }
 
+/*
+ * Builds the padded atlas and the individual textures without uploading them
+ */
+void C2MapRscFile::buildTextures(const std::vector<uint16_t>& raw_texture_data, int texture_count)
+{
+  int tile_padding = getAtlasTilePadding();
+  int SOURCE_SQUARE_SIZE = getAtlasTileWidth();
+  int TEXTURE_SQUARE_SIZE = SOURCE_SQUARE_SIZE + (tile_padding * 2); // we add padding to each side to prevent bleeding and mipmap artifacts
+
+  // Combine all the textures into a single texture for ease of opengl use.
+  // Add a buffer around images to mimic clamping with GL_LINEAR; see: https://stackoverflow.com/questions/19611745/opengl-black-lines-in-between-tiles
+  std::vector<uint16_t> combined_texture_data; // rgba5551
+  
+  int squared_texture_rows = static_cast<int>(sqrt(static_cast<float>(texture_count)) + .99f); // number of rows and columns needed to fit the data
+  
+  uint16_t pad_color;
+  std::vector<uint16_t> tx_filler((size_t)TEXTURE_SQUARE_SIZE*squared_texture_rows);
+  
+  for (int line = 0; line < (squared_texture_rows*SOURCE_SQUARE_SIZE); line++) { // Total vertical rows in image file (128 * number of images; current = pointer to vertical pixel location in file that represents the location of a new row of horizontal blocks)
+    
+    if (line % SOURCE_SQUARE_SIZE == 0) {
+      pad_color = _PadTypeColor::Red;
+      tx_filler.clear();
+      tx_filler.assign(((long long)TEXTURE_SQUARE_SIZE*squared_texture_rows*tile_padding), pad_color);
+      
+      for (int x=0; x < squared_texture_rows; x++) {
+        for (int p = 0; p < tile_padding; p++)
+          tx_filler.at((long long)x*TEXTURE_SQUARE_SIZE + p) = _PadTypeColor::Blue;
+
+        for (int p = 1; p <= tile_padding; p++)
+          tx_filler.at(((long long)x*TEXTURE_SQUARE_SIZE)+((long long)TEXTURE_SQUARE_SIZE-p)) = _PadTypeColor::Green;
+      }
+      combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
+    }
+    
+    for (int col = 0; col < squared_texture_rows; col++) { // Blocks (number of images; current = current block's image)
+      int lin_to_row = static_cast<int>(line/SOURCE_SQUARE_SIZE);
+      int tx_c = ((lin_to_row)*squared_texture_rows)+col;
+      int tex_start = line % SOURCE_SQUARE_SIZE;
+      
+      pad_color = _PadTypeColor::Blue;
+      for (int p = 0; p < tile_padding; p++)
+        combined_texture_data.insert(combined_texture_data.end(), pad_color);
+      
+      if (tx_c >= texture_count) {
+        std::vector<uint16_t> tx_filler(SOURCE_SQUARE_SIZE);
+        combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
+      } else {
+        std::vector<uint16_t>::const_iterator first = raw_texture_data.begin() + ((long long)tx_c*SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE) + ((long long)tex_start*SOURCE_SQUARE_SIZE); // Get start pos of a single line of pixels
+        std::vector<uint16_t>::const_iterator last = raw_texture_data.begin() + ((long long)tx_c*SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE) + ((long long)tex_start*SOURCE_SQUARE_SIZE) + SOURCE_SQUARE_SIZE; // Get end pos, which is the start + 128 pixels
+        combined_texture_data.insert(combined_texture_data.end(), first, last);
+      }
+      
+      pad_color = _PadTypeColor::Green;
+      for (int p = 0; p < tile_padding; p++)
+        combined_texture_data.insert(combined_texture_data.end(), pad_color);
+    }
+    
+    if ((line+1) % SOURCE_SQUARE_SIZE == 0) {
+      pad_color = _PadTypeColor::Yellow;
+      tx_filler.clear();
+      tx_filler.assign((long long)TEXTURE_SQUARE_SIZE*squared_texture_rows*tile_padding, pad_color);
+      
+      for (int x=0; x < squared_texture_rows; x++) {
+        for (int p = 0; p < tile_padding; p++)
+          tx_filler.at((long long)x*TEXTURE_SQUARE_SIZE+p) = _PadTypeColor::Blue;
+
+        for (int p = 1; p <= tile_padding; p++)
+          tx_filler.at(((long long)x*TEXTURE_SQUARE_SIZE)+((long long)TEXTURE_SQUARE_SIZE-p)) = _PadTypeColor::Green;
+      }
+      
+      combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
+    }
+  }
+  
+  int missing_bits = (squared_texture_rows*TEXTURE_SQUARE_SIZE*squared_texture_rows*TEXTURE_SQUARE_SIZE) - static_cast<int>(combined_texture_data.size());
+  
+  if (missing_bits > 0) {
+    std::vector<uint16_t> tx_filler(missing_bits);
+    combined_texture_data.insert(combined_texture_data.end(), tx_filler.begin(), tx_filler.end());
+  }
+
+    // TODO: we can use a frame buffer instead of this nastiness
+  std::vector<uint16_t> final_texture_data; // Now replace colors with correct entries
+  for (int i=0; i < tile_padding; i++) {
+    for (int row = 0; row < (TEXTURE_SQUARE_SIZE*squared_texture_rows); row++) {
+      for (int col = 0; col < (TEXTURE_SQUARE_SIZE*squared_texture_rows); col++) {
+        int id_x = col;
+        int id_y = row*TEXTURE_SQUARE_SIZE*squared_texture_rows;
+        uint16_t color;
+        
+        if (i >= 1) {
+          color = final_texture_data.at((long long)id_y+id_x);
+        } else {
+          color = combined_texture_data.at((long long)id_y+id_x);
+        }
+        
+        switch (color) {
+          case _AtlasPadType::Left:
+            color = final_texture_data.at((long long)id_y+((long long)id_x-1));
+            break;
+          case _AtlasPadType::Right:
+            if (i >= 1) {
+              color = final_texture_data.at((long long)id_y+((long long)id_x+1));
+            } else {
+              color = combined_texture_data.at((long long)id_y+((long long)id_x+1));
+            }
+            break;
+          case _AtlasPadType::Above:
+            color = final_texture_data.at((((long long)row-1)*TEXTURE_SQUARE_SIZE*squared_texture_rows)+id_x);
+            break;
+          case _AtlasPadType::Below:
+            if (i >= 1) {
+              color = final_texture_data.at((((long long)row+1)*TEXTURE_SQUARE_SIZE*squared_texture_rows)+id_x);
+            } else {
+              color = combined_texture_data.at((((long long)row+1)*TEXTURE_SQUARE_SIZE*squared_texture_rows)+id_x);
+            }
+            break;
+          default:
+            break;
+        }
+        if (i >= 1) {
+          final_texture_data.at((long long)id_y+id_x) = color;
+        } else {
+          final_texture_data.insert(final_texture_data.end(), color);
+        }
+      }
+    }
+  }
+  
+  std::unique_ptr<CETexture> cTexture = std::unique_ptr<CETexture>(new CETexture(final_texture_data, squared_texture_rows*TEXTURE_SQUARE_SIZE*squared_texture_rows*TEXTURE_SQUARE_SIZE, squared_texture_rows*TEXTURE_SQUARE_SIZE, squared_texture_rows*TEXTURE_SQUARE_SIZE, false, true));
+  //cTexture->saveToBMPFile("/tmp/atlas.bmp");
+
+  this->m_texture_atlas_width = squared_texture_rows;
+  this->m_texture_count = texture_count;
+  this->m_textures.push_back(std::move(cTexture));
+
+  for (int t=0; t < m_texture_count; t++) {
+    std::vector<uint16_t> texture_data;
+    std::vector<uint16_t>::const_iterator first = raw_texture_data.begin() + ((long long)t * SOURCE_SQUARE_SIZE * SOURCE_SQUARE_SIZE);
+    std::vector<uint16_t>::const_iterator last = first + (long long)SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE;
+    texture_data.insert(texture_data.end(), first, last);
+
+    std::unique_ptr<CETexture> c_texture = std::unique_ptr<CETexture>(new CETexture(texture_data, SOURCE_SQUARE_SIZE*SOURCE_SQUARE_SIZE, SOURCE_SQUARE_SIZE, SOURCE_SQUARE_SIZE, false, true));
+    //std::stringstream ss;
+    //ss << "/tmp/" << "map_texture_" << t << ".bmp";
+
+    //c_texture->saveToBMPFile(ss.str());
+    this->m_textures.push_back(std::move(c_texture));
+  }
+}
+
 void C2MapRscFile::generateTextureAtlas()
 {
     // Generate and bind the framebuffer
@@ -29,6 +29,7 @@ class CETexture;
 class CEWorldModel;
 class C2Sky;
 class CEAudioSource;
+class CELoadPipeline;
 
 struct CEWaterEntity;
 
@@ -89,13 +90,15 @@ private:
   std::vector<uint8_t> m_shadow_map;
 
   void generateTextureAtlas();
+  void buildTextures(const std::vector<uint16_t>& raw_texture_data, int texture_count);
   
-  void load(const std::string& file_name, std::filesystem::path basePath);
+  void load(const std::string& file_name, std::filesystem::path basePath, CELoadPipeline* pipeline);
   void load_c1(const std::string& file_name, std::filesystem::path basePath);
 public:
   std::vector< std::unique_ptr<CEWorldModel> > m_models;
 
-  C2MapRscFile(const CEMapType type, const std::string& file_name, std::filesystem::path basePath);
+  // Models and textures are parsed on the pipeline's workers; without one everything loads on this thread
+  C2MapRscFile(const CEMapType type, const std::string& file_name, std::filesystem::path basePath, CELoadPipeline* pipeline = nullptr);
   ~C2MapRscFile();
   
   int getTextureAtlasWidth();
@@ -10,7 +10,6 @@
 
 #include "CETexture.h"
 #include "transform.h"
-#include "camera.h"
 
 #include "tga.h"
 
@@ -431,26 +430,19 @@ void C2Sky::setRGBA(glm::vec4 color)
   this->m_cloud_shader->setVec4("sky_color", m_sky_rgba.r / 255.f, m_sky_rgba.g / 255.f, m_sky_rgba.b / 255.f, m_sky_rgba.a);
 }
 
-void C2Sky::Render(GLFWwindow* window, Camera& camera)
+void C2Sky::Render(GLFWwindow* window)
 {
   //this->updateClouds();
   int width, height;
   glfwGetFramebufferSize(window, &width, &height);
 
-  glm::mat4 view = camera.GetVM();
-  view[3][0] = 0.0f;
-  view[3][1] = 0.0f;
-  view[3][2] = 0.0f;
-
+  // The view (with translation stripped in the shader) and time come from the FrameConstants block
   glm::mat4 projection = glm::perspective(glm::radians(80.0f), (float)width / (float)height, 0.00625f, 6250.f); // Scaled down 16x
-  float elapsedTime = static_cast<float>(glfwGetTime());
 
   // Render the skybox
   glDepthFunc(GL_LEQUAL); // Change depth function so depth test passes when values are equal to depth buffer's content
   this->m_shader->use();
-  this->m_shader->setMat4("view", view);
   this->m_shader->setMat4("projection", projection);
-  this->m_shader->setFloat("time", elapsedTime); // Pass the elapsed time to the shader
 
 
   glBindVertexArray(this->m_vertex_array_object);
@@ -461,9 +453,7 @@ void C2Sky::Render(GLFWwindow* window, Camera& camera)
   glDrawArrays(GL_TRIANGLES, 6, 36);
 
   this->m_cloud_shader->use();
-  this->m_cloud_shader->setMat4("view", view);
   this->m_cloud_shader->setMat4("projection", projection);
-  this->m_cloud_shader->setFloat("time", elapsedTime); // Pass the elapsed time to the shader
 
   this->m_texture->use();
   
@@ -31,7 +31,6 @@ class CETexture;
 class ShaderProgram;
 class Tga;
 
-struct Camera;
 struct Transform;
 
 class C2Sky
@@ -74,7 +73,7 @@ public:
   ~C2Sky();
 
   void saveTextureAsBMP(const std::string& file_name );
-  void Render(GLFWwindow* window, Camera& camera);
+  void Render(GLFWwindow* window);
   void setRGBA(glm::vec4 color);
   void updateClouds();
   
@@ -44,11 +44,15 @@ CEAIGenericAmbientManager::CEAIGenericAmbientManager(
                                                      std::shared_ptr<CERemotePlayerController> playerController,
                                                      std::shared_ptr<C2MapFile> map,
                                                      std::shared_ptr<C2MapRscFile> rsc,
-                                                     std::shared_ptr<C2CarFile> car)
+                                                     std::shared_ptr<C2CarFile> car,
+                                                     std::shared_ptr<CEPathfindingService> pathService,
+                                                     std::shared_ptr<CEFlowFieldService> flowFields)
 : m_player_controller(playerController),
 m_map(map),
 m_rsc(rsc),
 m_car(car),
+m_path_service(pathService),
+m_flow_fields(flowFields),
 m_last_process_time(0),
 m_target_expire_time(0)
 {
@@ -59,12 +63,6 @@ m_target_expire_time(0)
   m_last_attack_target_position = glm::vec3(0.f);
   m_current_speed_multiplier = 1.0f;
   
-  m_path_finder = CEWalkableTerrainPathFinder();
-  m_path_finder.map = map;
-  m_path_finder.rsc = rsc;
-  
-  m_path_search_instance = std::make_unique<JPS::Searcher<CEWalkableTerrainPathFinder> >(m_path_finder);
-  
   std::string namedAI = jsonConfig.contains("name") ? jsonConfig["name"] : "unnamed";
   float walkSpeed = jsonConfig["character"]["walkSpeed"];
   float heightOffset = jsonConfig["character"].contains("heightOffset") ? (float)jsonConfig["character"]["heightOffset"] : 0.f;
@@ -76,6 +74,7 @@ m_target_expire_time(0)
   m_config.m_idle_odds = jsonConfig["character"].value("idleOdds", 0.3f);
   m_config.m_pf_range = jsonConfig["character"].value("roamRange", 128.f);
   m_config.m_walk_speed = walkSpeed;
+  m_roam_distance = m_config.m_pf_range;
   
   m_debug = jsonConfig.value("DEBUG", false);
   
@@ -300,144 +299,126 @@ void CEAIGenericAmbientManager::chooseNewTarget(glm::vec3 currentPosition, doubl
     return;
   }
   
+  // Only the first stretch of a long route comes back at once; plan the next from here
+  if (m_path_continues) {
+    if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Continuing route to " << m_path_continuation_goal.x << "," << m_path_continuation_goal.y << std::endl;
+    requestRoute({ m_path_continuation_goal }, m_path_purpose);
+    return;
+  }
+  
   const float tileSize = m_map->getTileLength();
-  glm::vec3 targetPosition;
-  bool foundSafeTile = false;
   
   // No planned waypoint available - pick a suitable direction instead
   if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Queue empty. Deciding on next route. Mood: " << m_mood << std::endl;
   
-  int tries = 0;
-  float dist = m_config.m_pf_range;
-  std::random_device rd;  // Random device for seeding
-  std::mt19937 gen(rd()); // Mersenne Twister generator
-  std::uniform_int_distribution<int> distrib(0, (int)directions.size() - 1);
-
-  while (tries < 12 && dist > 1) {
-    if (m_mood == CURIOUS) {
-      // Pick a random direction
-      glm::vec3 direction = directions[distrib(gen)];
-      targetPosition = currentPosition + direction * dist * tileSize;
-      targetPosition.y = currentPosition.y;
-      
-      bool found = SetCurrentTarget(targetPosition, currentTime);
-      if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Mood curious. Next rando spot selected? Found: " << found << std::endl;
-
-      if (found) return;
-
-      dist /= 2;
-    } else if (m_tracked_target.x > 0.f && m_tracked_target.y > 0.f) {
-      // Try to get "close enough" by moving a few tiles towards target
-      // Find a point in direction of target
-      // Note we do a one-way short distance JPS search to avoid resetting any in-flight
-      glm::vec2 worldPos = m_player_controller->getWorldPosition();
-      glm::vec2 direction;
-      
-      float factor = m_mood == ANGRY ? 1.0 : -1.0; // move towards OR away
-      if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Tracked target available. Attempting to move: " << factor << std::endl;
-      
-      if (factor > 0.0) {
-        direction = glm::normalize(m_tracked_target - worldPos);
-      } else {
-        direction = glm::normalize(worldPos - m_tracked_target);
-      }
-
-      // Try a fixed distance
-      glm::vec2 targetPos = worldPos + direction * (6.f);
-
-      // Run an inline search
-      // TODO: improve performance of this!
-      JPS::PathVector path = {};
-      bool found = JPS::findPath(path, m_path_finder, worldPos.x, worldPos.y, targetPos.x, targetPos.y, 1);
-       if (found) {
-         if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Found path to tracked target. Queuing: " << path.size() << std::endl;
-
-         for (auto p : path) {
-           m_path_waypoints.push_back(glm::vec2(p.x, p.y));
-         }
-         
-         // Use smooth transition when setting the first target from inline pathfinding
-         if (!m_path_waypoints.empty()) {
-           glm::vec2 nextWaypoint = m_path_waypoints.back();
-           glm::vec3 nextTarget = m_map->getPositionAtCenterTile(nextWaypoint);
-           initiateTargetTransition(nextTarget, currentTime);
-           m_target_expire_time = currentTime + 20.0;
-           m_path_waypoints.pop_back();
-         }
-       } else {
-         if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": FAILED to find tracked target path... Queue: " << m_path_waypoints.size() << std::endl;
-         
-         if (m_path_waypoints.empty()) {
-           if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Queue empty! No where to go. Run to landing." << std::endl;
-
-           glm::vec2 safePos = m_map->getRandomLanding();
-           glm::vec3 newTarget = glm::vec3(safePos.x * m_map->getTileLength(), 0, safePos.y * m_map->getTileLength());
-           
-           // Handle emergency landings - still use smooth transition but with shorter duration
-           initiateTargetTransition(newTarget, currentTime);
-           m_target_expire_time = currentTime + 1.0;
-         }
-       }
-
-      // Just try once
-      return;
+  if (m_mood == CURIOUS) {
+    std::uniform_int_distribution<int> distrib(0, (int)directions.size() - 1);
+    
+    // Pick a random direction. If there is no path, updateInflightPathsearch halves the range for the next try
+    glm::vec3 direction = directions[distrib(m_rng)];
+    glm::vec3 targetPosition = currentPosition + direction * m_roam_distance * tileSize;
+    targetPosition.y = currentPosition.y;
+    
+    bool queued = SetCurrentTarget(targetPosition, currentTime);
+    if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Mood curious. Next rando spot selected? Queued: " << queued << "; range: " << m_roam_distance << std::endl;
+  } else if (m_tracked_target.x > 0.f && m_tracked_target.y > 0.f) {
+    // Try to get "close enough" by moving a few tiles towards target
+    // Find a point in direction of target
+    glm::vec2 worldPos = m_player_controller->getWorldPosition();
+    glm::vec2 direction;
+    
+    float factor = m_mood == ANGRY ? 1.0 : -1.0; // move towards OR away
+    if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::chooseNewTarget" << ": Tracked target available. Attempting to move: " << factor << std::endl;
+    
+    if (factor > 0.0) {
+      direction = glm::normalize(m_tracked_target - worldPos);
+    } else {
+      direction = glm::normalize(worldPos - m_tracked_target);
     }
-
-    tries++;
+    
+    // Try a fixed distance
+    glm::vec2 targetPos = worldPos + direction * (6.f);
+    
+    // A short search, so it jumps ahead of any roaming searches
+    requestRoute({ glm::ivec2(targetPos) }, PathPurpose::TRACK);
   }
 }
 
 void CEAIGenericAmbientManager::updateInflightPathsearch(double currentTime)
 {
-  if (m_path_search_started_at < 0) return;
+  if (!m_path_ticket.ready()) return;
   
-  if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() invoked" << std::endl;
-
-  JPS::PathVector path = {};
-  auto res = m_path_search_instance->findPathStep(12);
-
-  if (res == JPS_FOUND_PATH) {
-    if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() JPS_FOUND_PATH" << std::endl;
-
-    // We found a path. Update planned route
-    res = m_path_search_instance->findPathFinish(path, 1);
-    if (res == JPS_FOUND_PATH) {
-      if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() JPS_FOUND_PATH received. Mood: " << m_mood << "; points: " << path.size() << std::endl;
-
-      // If I'm angry or afriad then clear eveything and focus on this
-      if (m_mood == ANGRY) {
-        m_path_waypoints.clear();
-      }
-
-      for (auto p : path) {
-        m_path_waypoints.push_back(glm::vec2(p.x, p.y));
-      }
-      
-      // Use smooth transition for inflight pathfinding results
-      if (!m_path_waypoints.empty()) {
-        glm::vec2 nextWaypoint = m_path_waypoints.back();
-        glm::vec3 nextTarget = m_map->getPositionAtCenterTile(nextWaypoint);
-        initiateTargetTransition(nextTarget, currentTime);
-        m_target_expire_time = currentTime + 20.0;
-        m_path_waypoints.pop_back();
-      }
-    } else {
-      // Some memory issue or something - invalidate target
-      if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() FAILED to find path or some error returned. Keeping existing planned route." << std::endl;
-    }
+  CEPathResult result = m_path_ticket.take();
   
-    m_path_search_started_at = -1.0;
-
-    return;
-  } else if (res == JPS_NEED_MORE_STEPS) {
-    // Keep trying
-    if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() JPS_NEED_MORE_STEPS. Deferring..." << std::endl;
-
+  if (result.status == CEPathStatus::FOUND) {
+    if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() JPS_FOUND_PATH received. Mood: " << m_mood << "; points: " << result.path.size() << std::endl;
+    
+    // If I'm angry or afriad then clear eveything and focus on this
+    if (m_mood == ANGRY) {
+      m_path_waypoints.clear();
+    }
+    
+    // Reversed, so the first step is popped first
+    m_path_waypoints.insert(m_path_waypoints.end(), result.path.rbegin(), result.path.rend());
+    m_path_continues = result.partial;
+    m_path_continuation_goal = result.goal;
+    
+    // Use smooth transition for inflight pathfinding results
+    if (!m_path_waypoints.empty()) {
+      glm::vec2 nextWaypoint = m_path_waypoints.back();
+      glm::vec3 nextTarget = m_map->getPositionAtCenterTile(nextWaypoint);
+      initiateTargetTransition(nextTarget, currentTime);
+      m_target_expire_time = currentTime + 20.0;
+      m_path_waypoints.pop_back();
+    }
+    
+    if (m_path_purpose == PathPurpose::ROAM) {
+      m_roam_distance = m_config.m_pf_range;
+    } else if (m_path_purpose == PathPurpose::ESCAPE) {
+      m_tracked_target = result.goal;
+    }
+    
     return;
   }
   
-  // Mark target expired so we pick a new one
-  if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() No path to target found? Keeping existing in case we find target" << std::endl;
+  if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - updateInflightPathsearch() FAILED to find path (status " << (int)result.status << "). Purpose: " << (int)m_path_purpose << std::endl;
+  
+  glm::vec2 target = m_map->getWorldTilePosition(m_current_target);
+  bool invalidTarget = (target.x == 0 && target.y == 0);
+  
+  switch (m_path_purpose) {
+    case PathPurpose::ROAM:
+      // Try closer next tick
+      m_roam_distance /= 2.f;
+      if (m_roam_distance <= 1.f) {
+        m_roam_distance = m_config.m_pf_range;
+        
+        if (invalidTarget) {
+          // Nowhere reachable from here at all
+          if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " cannot move; invalid target. Redeploying." << std::endl;
+          m_player_controller->StopMovement();
+          m_player_controller->setPosition(m_map->getRandomLanding(m_rng));
+        }
+      }
+      m_target_expire_time = currentTime;
+      break;
+    case PathPurpose::TRACK:
+      if (m_path_waypoints.empty()) {
+        if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << ":" << "CEAIGenericAmbientManager::updateInflightPathsearch" << ": Queue empty! No where to go. Run to landing." << std::endl;
+        
+        glm::vec2 safePos = m_map->getRandomLanding(m_rng);
+        glm::vec3 newTarget = glm::vec3(safePos.x * m_map->getTileLength(), 0, safePos.y * m_map->getTileLength());
+        
+        // Handle emergency landings - still use smooth transition but with shorter duration
+        initiateTargetTransition(newTarget, currentTime);
+        m_target_expire_time = currentTime + 1.0;
+      }
+      break;
+    case PathPurpose::ROUTE:
+    case PathPurpose::ESCAPE:
+      // Keep the existing planned route
+      break;
+  }
 }
 
 void CEAIGenericAmbientManager::Process(double currentTime) {
@@ -451,12 +432,12 @@ void CEAIGenericAmbientManager::Process(double currentTime) {
     // lock at final frame when non-looping animation finishes
     
     // Still update collision transform and upload state for rendering
-    updateCollisionTransform();
+    m_commands.push_back(AICommand::UPDATE_COLLISION);
     
     // Upload state to hardware at regular intervals for rendering
     const double minInterval = 1.0 / 30.0;
     if (currentTime - m_last_upload_time >= minInterval) {
-      m_player_controller->uploadStateToHardware();
+      m_commands.push_back(AICommand::UPLOAD_STATE);
       m_last_upload_time = currentTime;
     }
     
@@ -470,9 +451,26 @@ void CEAIGenericAmbientManager::Process(double currentTime) {
   // Update dynamic speed calculations
   updateDynamicSpeed(currentTime);
   
+  // Attacking within reach of the player's field: step along it, and drop any route still in flight
+  glm::ivec2 flowStep;
+  bool chasing = (m_mood == ANGRY && m_mood_decision == ATTACK && getFlowFieldStep(flowStep));
+  if (chasing && m_path_ticket.pending()) {
+    m_path_ticket = CEPathfindingService::Ticket();
+  }
+  
   // Update in-flight pathfinding first if needed
   updateInflightPathsearch(currentTime);
   
+  if (!chasing) {
+    m_flow_step = glm::ivec2(-1);
+  } else if (flowStep != m_flow_step) {
+    m_flow_step = flowStep;
+    m_path_waypoints.clear();
+    m_path_continues = false;
+    initiateTargetTransition(m_map->getPositionAtCenterTile(glm::vec2(flowStep)), currentTime);
+    m_target_expire_time = currentTime + 20.0;
+  }
+  
   // Check route following and target state
   glm::vec3 currentPosition = m_player_controller->getPosition();
   glm::vec3 currentForward = m_player_controller->getCamera()->GetForward();
@@ -480,7 +478,7 @@ void CEAIGenericAmbientManager::Process(double currentTime) {
   glm::vec2 target = m_map->getWorldTilePosition(m_current_target);
   
   bool lostTarget = (m_mood == ANGRY && currentTime - m_danger_last_spotted_at > DEFAULT_LOST_TARGET_GIVEUP_TIME);
-  bool angryAndNoRoute = (m_mood == ANGRY && m_path_waypoints.empty());
+  bool angryAndNoRoute = (m_mood == ANGRY && m_path_waypoints.empty() && !chasing);
   bool invalidTarget = (target.x == 0 && target.y == 0);
   bool expired = currentTime > m_target_expire_time;
   bool reachedTarget = glm::length(glm::vec2(currentPosition.x, currentPosition.z) - glm::vec2(m_current_target.x, m_current_target.z)) < (m_map->getTileLength() / 2.f);
@@ -489,7 +487,8 @@ void CEAIGenericAmbientManager::Process(double currentTime) {
     Reset(currentTime);
     target = m_map->getWorldTilePosition(m_current_target);
     invalidTarget = (target.x == 0 && target.y == 0);
-  } else if (reachedTarget || expired || invalidTarget) {
+  } else if ((reachedTarget || expired || invalidTarget) && !m_path_ticket.pending() && !chasing) {
+    // Choosing again while a search is in flight would supersede it before it could finish
     chooseNewTarget(currentPosition, currentTime);
     target = m_map->getWorldTilePosition(m_current_target);
     invalidTarget = (target.x == 0 && target.y == 0);
@@ -576,10 +575,13 @@ void CEAIGenericAmbientManager::Process(double currentTime) {
 
   if (!invalidTarget) {
     m_player_controller->MoveTo(m_current_target, deltaTime);
+  } else if (m_path_ticket.pending()) {
+    // Wait for the search rather than redeploying
+    m_player_controller->StopMovement();
   } else if (invalidTarget) {
     m_player_controller->StopMovement();
     if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " cannot move; invalid target. Redeploying." << std::endl;
-    m_player_controller->setPosition(m_map->getRandomLanding());
+    m_player_controller->setPosition(m_map->getRandomLanding(m_rng));
   }
   
   // Use interpolated target for smooth look-at direction
@@ -587,16 +589,58 @@ void CEAIGenericAmbientManager::Process(double currentTime) {
   
   const double minInterval = 1.0 / 30.0;
   if (currentTime - m_last_upload_time >= minInterval) {
-    m_player_controller->uploadStateToHardware();
+    m_commands.push_back(AICommand::UPLOAD_STATE);
     m_last_upload_time = currentTime;
   }
   
   // Update collision body transform if present
-  updateCollisionTransform();
+  m_commands.push_back(AICommand::UPDATE_COLLISION);
   
   m_last_process_time = currentTime;
 }
 
+void CEAIGenericAmbientManager::Think(const AIWorldSnapshot& world)
+{
+  m_commands.clear();
+  m_touched_local_player = false;
+  
+  Process(world.currentTime);
+  
+  if (m_isDead || !world.localPlayerAlive) {
+    return;
+  }
+  
+  // TODO: totally change this for multi-player?
+  // For now, it's only enabled if you spawn GenericAmbients, but we'd probably want to update it to track all "players" or entities.
+  if (IsDangerous()) {
+    auto contactDist = glm::distance(m_player_controller->getPosition(), world.localPlayerPosition);
+    if (contactDist < m_map->getTileLength()) {
+      // Killing the player spawns a body and plays audio, so the main thread handles it
+      m_touched_local_player = true;
+      return;
+    }
+  }
+  
+  if (NoticesPosition(world.localPlayerPosition)) {
+    ReportNotableEvent(world.localPlayerPosition, "PLAYER_SPOTTED", world.currentTime);
+  }
+}
+
+void CEAIGenericAmbientManager::ApplyCommands()
+{
+  for (AICommand command : m_commands) {
+    switch (command) {
+      case AICommand::UPLOAD_STATE:
+        m_player_controller->uploadStateToHardware();
+        break;
+      case AICommand::UPDATE_COLLISION:
+        updateCollisionTransform();
+        break;
+    }
+  }
+  m_commands.clear();
+}
+
 std::string CEAIGenericAmbientManager::chooseIdleAnimation() {
   if (m_config.IdleAnimNames.empty()) {
     throw std::runtime_error("Tried to chooseIdleAnimation but none are defined!");
@@ -665,13 +709,16 @@ void CEAIGenericAmbientManager::ReportNotableEvent(glm::vec3 position, std::stri
     m_mood = ANGRY;
     if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - ReportNotableEvent() - DECIDED: " << m_mood << std::endl;
     if (m_mood_decision == ATTACK) {
-      // Always set target on initial attack decision
-      SetCurrentTarget(position, currentTime);
+      // Always set target on initial attack decision; Process() follows the field instead if it reaches us
+      glm::ivec2 flowStep;
+      if (!getFlowFieldStep(flowStep)) {
+        SetCurrentTarget(position, currentTime);
+      }
       m_last_attack_target_position = position;
       m_last_attack_target_update = currentTime;
       if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: Initial attack target set" << std::endl;
     } else if (currentTime - m_last_safe_target_calculation > 12.0) {
-      SetCurrentTarget(findSafeTarget(position), currentTime);
+      requestSafeRoute(position, currentTime);
       m_last_safe_target_calculation = currentTime;
     }
   }
@@ -705,13 +752,16 @@ void CEAIGenericAmbientManager::ReportNotableEvent(glm::vec3 position, std::stri
     if (m_mood_decision == ATTACK) {
       // Only update attack target if player has moved significantly or enough time has passed
       if (shouldUpdateAttackTarget(position, currentTime)) {
-        SetCurrentTarget(position, currentTime);
+        glm::ivec2 flowStep;
+        if (!getFlowFieldStep(flowStep)) {
+          SetCurrentTarget(position, currentTime);
+        }
         m_last_attack_target_position = position;
         m_last_attack_target_update = currentTime;
         if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: Attack target updated due to significant player movement" << std::endl;
       }
     } else if (currentTime - m_last_safe_target_calculation > 3.0) {
-      SetCurrentTarget(findSafeTarget(position), currentTime);
+      requestSafeRoute(position, currentTime);
       m_last_safe_target_calculation = currentTime;
     }
   }
@@ -722,48 +772,67 @@ bool CEAIGenericAmbientManager::IsDangerous()
   return m_is_dangerous;
 }
 
-glm::vec3 CEAIGenericAmbientManager::findSafeTarget(glm::vec3 direction)
+void CEAIGenericAmbientManager::requestRoute(std::vector<glm::ivec2> goals, PathPurpose purpose)
+{
+  CEPathRequest request;
+  request.start = glm::ivec2(m_player_controller->getWorldPosition());
+  request.goals = std::move(goals);
+  
+  switch (purpose) {
+    case PathPurpose::ROAM:
+      request.priority = CEPathfindingService::PRIORITY_ROAM;
+      request.timeout = 5.0;
+      break;
+    case PathPurpose::TRACK:
+      request.priority = CEPathfindingService::PRIORITY_TRACK;
+      request.timeout = 0.5;
+      break;
+    case PathPurpose::ROUTE:
+    case PathPurpose::ESCAPE:
+      // Threat responses go stale quickly
+      request.priority = CEPathfindingService::PRIORITY_THREAT;
+      request.timeout = 0.5;
+      break;
+  }
+  
+  // Replacing the ticket cancels any search still in flight
+  m_path_ticket = m_path_service->submit(std::move(request));
+  m_path_purpose = purpose;
+  m_path_continues = false;
+}
+
+bool CEAIGenericAmbientManager::getFlowFieldStep(glm::ivec2& next) const
 {
-  if (m_debug) std::cout << glfwGetTime() << " " << m_config.AiName << " DEBUG: " << " [" << m_mood << "] findSafeTarget invoked." << std::endl;
+  if (!m_flow_fields) return false;
+  
+  std::shared_ptr<const CEFlowField> field = m_flow_fields->getField();
+  return field && field->getStep(glm::ivec2(m_player_controller->getWorldPosition()), next);
+}
 
-  int tries = 0;
+void CEAIGenericAmbientManager::requestSafeRoute(glm::vec3 threatPosition, double currentTime)
+{
+  if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " [" << m_mood << "] requestSafeRoute invoked." << std::endl;
+  
   glm::vec2 curPos = m_player_controller->getWorldPosition();
-  glm::vec3 pos = glm::vec3(0.f);
-  glm::vec2 check;
-
+  
   // Calculate the vector towards the provided position (direction)
-  glm::vec3 towards = glm::normalize(direction - m_player_controller->getPosition());
-
+  glm::vec3 towards = glm::normalize(threatPosition - m_player_controller->getPosition());
+  
   // Sort directions based on their dot product with the negative towards vector (opposite)
   std::vector<glm::vec3> sortedDirections = directions;
   std::sort(sortedDirections.begin(), sortedDirections.end(), [&](const glm::vec3& a, const glm::vec3& b) {
     return glm::dot(-towards, a) > glm::dot(-towards, b);
   });
-
+  
+  // The worker tries these in order and routes to the first one it can reach
+  std::vector<glm::ivec2> goals;
   for (const auto& dir : sortedDirections) {
-    check = curPos + (glm::vec2(dir.x, dir.z) * 32.f);
-    JPS::PathVector path = {};
-    bool found = JPS::findPath(path, m_path_finder, curPos.x, curPos.y, check.x, check.y, 1);
-    if (found && !path.empty()) {
-      if (m_debug) std::cout << glfwGetTime() << " " << m_config.AiName << " DEBUG: " << " [" << m_mood << "] findSafeTarget found safe target" << std::endl;
-
-      pos.x = path.back().x * m_map->getTileLength();
-      pos.y = 0.f;
-      pos.z = path.back().y * m_map->getTileLength();
-      
-      if (m_debug) std::cout << glfwGetTime() << " " << m_config.AiName << " DEBUG: " << " [" << m_mood << "] findSafeTarget SAFE: " << pos.x << ", " << pos.y << ", " << pos.z << std::endl;
-
-      return pos;
-    }
-    tries++;
+    goals.push_back(glm::ivec2(curPos + (glm::vec2(dir.x, dir.z) * 32.f)));
   }
-
-  if (m_debug) std::cout << glfwGetTime() << " " << m_config.AiName << " DEBUG: " << " [" << m_mood << "] findSafeTarget. No target found." << std::endl;
-
-  return m_map->getPositionAtCenterTile(m_player_controller->getWorldPosition());
+  
+  requestRoute(std::move(goals), PathPurpose::ESCAPE);
 }
 
-
 bool CEAIGenericAmbientManager::SetCurrentTarget(glm::vec3 targetPosition, double currentTime) {
   if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " [" << m_mood << "] SetCurrentTarget invoked." << std::endl;
   float tileSize = m_map->getTileLength();
@@ -778,51 +847,23 @@ bool CEAIGenericAmbientManager::SetCurrentTarget(glm::vec3 targetPosition, doubl
     if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << " - CEAIGenericAmbientManager::SetCurrentTarget: current tracked target differs from new" << std::endl;
   }
   
-  auto worldPos = m_player_controller->getWorldPosition();
-
-  JPS::PathVector path = {};
-  // WARNING: init will abort any active search
-  if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << "- SetCurrentTarget() - Aborting any inflight search to find new target" << std::endl;
-  auto res = m_path_search_instance->findPathInit(JPS::Pos(worldPos.x, worldPos.y), JPS::Pos(tileCoords.x, tileCoords.y));
-  
-  bool found = false;
-  if (res == JPS_FOUND_PATH) {
-    // Greedy algo already found a path
-    res = m_path_search_instance->findPathFinish(path, 1);
-    if (res == JPS_FOUND_PATH) {
-      if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << "- SetCurrentTarget(): GREEDY Found path to target. Updating with waypoints: " << path.size() << std::endl;
-
-      for (auto p : path) {
-        m_path_waypoints.push_back(glm::vec2(p.x, p.y));
-      }
-
-      // Use smooth transition for SetCurrentTarget pathfinding results
-      if (!m_path_waypoints.empty()) {
-        glm::vec2 nextWaypoint = m_path_waypoints.back();
-        glm::vec3 nextTarget = m_map->getPositionAtCenterTile(nextWaypoint);
-        initiateTargetTransition(nextTarget, currentTime);
-        m_target_expire_time = currentTime + 20.0;
-        m_path_waypoints.pop_back();
-      }
-      found = true;
-    }
-    m_path_search_started_at = -1.0;
-  } else if (res == JPS_NEED_MORE_STEPS) {
-    // Otherwise, defer to future frames
-    if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << "- SetCurrentTarget(): JPS_NEED_MORE_STEPS. Deferring to furture frames" << std::endl;
-    m_path_search_started_at = currentTime;
-    found = true;
-  }
+  // WARNING: this supersedes any active search
+  if (m_debug) std::cout << currentTime << " " << m_config.AiName << " DEBUG: " << "- SetCurrentTarget() - Replacing any inflight search to find new target" << std::endl;
+  requestRoute({ glm::ivec2(tileCoords) }, m_mood == ANGRY ? PathPurpose::ROUTE : PathPurpose::ROAM);
   
   m_tracked_target = tileCoords;
   
-  return found;
+  return true;
 }
 
 bool CEAIGenericAmbientManager::NoticesLocalPlayer(std::shared_ptr<CELocalPlayerController> localPlayer) {
+  return NoticesPosition(localPlayer->getPosition());
+}
+
+bool CEAIGenericAmbientManager::NoticesPosition(glm::vec3 position) {
   if (m_view_range <= 0.f) return false;
 
-  float dist = glm::distance(localPlayer->getPosition(), m_player_controller->getPosition());
+  float dist = glm::distance(position, m_player_controller->getPosition());
   if (dist < m_view_range * m_map->getTileLength()) return true;
   
   return false;
@@ -926,6 +967,7 @@ void CEAIGenericAmbientManager::createCollisionBody(CEPhysicsWorld* physicsWorld
   auto baseBvhShape = geo->getMeshShape();
   btVector3 scale(0.0625f, 0.0625f, 0.0625f);
   btScaledBvhTriangleMeshShape* scaledShape = new btScaledBvhTriangleMeshShape(baseBvhShape, scale);
+  auto lock = physicsWorld->lockWorld();
   btRigidBody* instanceBody = physicsWorld->createStaticBody(scaledShape, pos);
   instanceBody->setUserPointer(this);
   
@@ -940,16 +982,19 @@ void CEAIGenericAmbientManager::createCollisionBody(CEPhysicsWorld* physicsWorld
   physicsWorld->registerCollisionObject(instanceBody, info);
   
   m_collisionBody = instanceBody;
+  m_physicsWorld = physicsWorld;
 }
 
 void CEAIGenericAmbientManager::removeCollisionBody(CEPhysicsWorld* physicsWorld)
 {
     if (m_collisionBody && physicsWorld) {
+        auto lock = physicsWorld->lockWorld();
         physicsWorld->getDynamicsWorld()->removeRigidBody(m_collisionBody);
-        // Unregister from physics world object info map
-        physicsWorld->registerCollisionObject(m_collisionBody, {}); // Empty info removes entry
+        // Give up its object info slot
+        physicsWorld->unregisterCollisionObject(m_collisionBody);
         delete m_collisionBody;
         m_collisionBody = nullptr;
+        m_physicsWorld = nullptr;
     }
     
     if (m_collisionShape) {
@@ -987,6 +1032,7 @@ void CEAIGenericAmbientManager::updateCollisionTransform()
     transform.setRotation(rotation);
     
     // Apply transform to collision body
+    auto lock = m_physicsWorld->lockWorld();
     m_collisionBody->getMotionState()->setWorldTransform(transform);
     m_collisionBody->setWorldTransform(transform);
 }
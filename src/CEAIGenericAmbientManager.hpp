@@ -1,18 +1,19 @@
 #pragma once
 
 #include <memory>
+#include <random>
 #include <vector>
 #include <unordered_map>
 #include <string>
 
-#include "CEWalkableTerrainPathFinder.hpp"
+#include "CEPathfindingService.h"
+#include "CEFlowFieldService.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtx/hash.hpp>
 
 #include <nlohmann/json.hpp>
-#include "jps.hpp"
 
 class CERemotePlayerController;
 class CELocalPlayerController;
@@ -50,6 +51,14 @@ enum AIAttackDecision {
   ATTACK
 };
 
+// Read-only view of the world for one AI tick. Think() runs on worker threads, so it reads the
+// local player from here; C2MapFile and C2MapRscFile are immutable once loaded and shared as-is
+struct AIWorldSnapshot {
+  double currentTime;
+  glm::vec3 localPlayerPosition;
+  bool localPlayerAlive;
+};
+
 class CEAIGenericAmbientManager {
   const float DEFAULT_VIEW_RANGE = 60.f;
   const float DEFAULT_MIN_ATTACK = 0.3f;
@@ -76,14 +85,31 @@ class CEAIGenericAmbientManager {
   
   AIGenericAmbientManagerConfig m_config;
   
-  CEWalkableTerrainPathFinder m_path_finder;
-  std::unique_ptr< JPS::Searcher<CEWalkableTerrainPathFinder> > m_path_search_instance;
+  // Searches run on the service's workers; we hold at most one in flight and poll it each tick
+  enum class PathPurpose {
+    ROAM,   // curious wandering; on failure try closer
+    ROUTE,  // to an attack target; on failure keep the current route
+    TRACK,  // a few tiles towards/away from the tracked target; on failure run to a landing
+    ESCAPE  // first reachable safe spot away from a threat
+  };
+  std::shared_ptr<CEPathfindingService> m_path_service;
+  CEPathfindingService::Ticket m_path_ticket;
+  PathPurpose m_path_purpose = PathPurpose::ROAM;
+  // The last route stopped short of its goal (hierarchical search); planned on once walked
+  bool m_path_continues = false;
+  glm::ivec2 m_path_continuation_goal = glm::ivec2(0);
+  // Attackers close to the player step along its shared field instead of searching; null without one
+  std::shared_ptr<CEFlowFieldService> m_flow_fields;
+  // Tile the field last sent us to, -1 when not following it
+  glm::ivec2 m_flow_step = glm::ivec2(-1);
+  float m_roam_distance;
+  // Roaming directions and redeploy landings. Ours alone, since Think runs on job system workers
+  std::mt19937 m_rng{std::random_device{}()};
   
   double m_last_process_time;
   double m_target_expire_time;
   double m_last_upload_time = 0;
   double m_last_idle_time = 0;
-  double m_path_search_started_at = -1.0;
   
   float m_view_range = DEFAULT_VIEW_RANGE;
   
@@ -128,11 +154,21 @@ class CEAIGenericAmbientManager {
   
   // Collision detection for projectile hits
   btRigidBody* m_collisionBody = nullptr;
+  CEPhysicsWorld* m_physicsWorld = nullptr; // world m_collisionBody is in
   btTriangleMesh* m_collisionMesh = nullptr;
   btBvhTriangleMeshShape* m_collisionShape = nullptr;
   
+  // Next waypoint at the back
   std::vector<glm::vec2> m_path_waypoints = {};
   
+  // Side effects Think() may not perform off the main thread (GPU instance data, Bullet), in order
+  enum class AICommand {
+    UPLOAD_STATE,
+    UPDATE_COLLISION
+  };
+  std::vector<AICommand> m_commands;
+  bool m_touched_local_player = false;
+  
   void chooseNewTarget(glm::vec3 currentPosition, double currentTime);
   glm::vec2 popNextTarget(double currentTime);
   void initiateTargetTransition(glm::vec3 newTarget, double currentTime, bool forceImmediate = false);
@@ -147,19 +183,32 @@ class CEAIGenericAmbientManager {
   void updateInflightPathsearch(double currentTime);
   float CalculateAttackChance(float distance, float maxDist, float minAttackChance, float maxAttackChance);
   
-  glm::vec3 findSafeTarget(glm::vec3 direction);
+  void requestRoute(std::vector<glm::ivec2> goals, PathPurpose purpose);
+  // Next tile from here along the player's flow field; false when the field doesn't cover us
+  bool getFlowFieldStep(glm::ivec2& next) const;
+  void requestSafeRoute(glm::vec3 threatPosition, double currentTime);
   
   // Collision helper methods
   void createCollisionBody(CEPhysicsWorld* physicsWorld);
   void removeCollisionBody(CEPhysicsWorld* physicsWorld);
+  
+  void Process(double currentTime);
 
 public:
-  CEAIGenericAmbientManager(json jsonConfig, std::shared_ptr<CERemotePlayerController> playerController, std::shared_ptr<C2MapFile> map, std::shared_ptr<C2MapRscFile> rsc, std::shared_ptr<C2CarFile> car);
-  void Process(double currentTime);
+  CEAIGenericAmbientManager(json jsonConfig, std::shared_ptr<CERemotePlayerController> playerController, std::shared_ptr<C2MapFile> map, std::shared_ptr<C2MapRscFile> rsc, std::shared_ptr<C2CarFile> car, std::shared_ptr<CEPathfindingService> pathService, std::shared_ptr<CEFlowFieldService> flowFields = nullptr);
+  // Worker-thread tick: Process() plus the sensing checks against the snapshot. Touches only this AI
+  // and its controller; anything shared is queued for ApplyCommands()
+  void Think(const AIWorldSnapshot& world);
+  // Main thread, after every Think() of the frame has finished
+  void ApplyCommands();
+  // Set by Think() when a dangerous AI reached the local player this frame
+  bool TouchedLocalPlayer() const { return m_touched_local_player; }
+  // Queues a path search to position; true once one is queued (or already heading there)
   bool SetCurrentTarget(glm::vec3 position, double currentTime);
   void Reset(double currentTime);
   void ReportNotableEvent(glm::vec3 position, std::string eventType, double currentTime);
   bool NoticesLocalPlayer(std::shared_ptr<CELocalPlayerController> localPlayer);
+  bool NoticesPosition(glm::vec3 position);
   bool NoticesPlayerFromSensory(double currentTime);
   bool IsDangerous();
   std::shared_ptr<CERemotePlayerController> GetPlayerController();
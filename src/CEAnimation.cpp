@@ -1,27 +1,106 @@
 #include "CEAnimation.h"
 
+#include <utility>
+#include <iostream>
+#include <cmath>
+
 CEAnimation::CEAnimation(const std::string& ani_name, int kps, int total_frames, int total_time_ms)
     : m_name(ani_name), m_kps(kps), m_number_of_frames(total_frames), m_total_time(total_time_ms) {
 }
 
 CEAnimation::~CEAnimation() {
+  if (m_gpu_frame_texture) glDeleteTextures(1, &m_gpu_frame_texture);
+  if (m_gpu_vertex_map_texture) glDeleteTextures(1, &m_gpu_vertex_map_texture);
+  if (m_gpu_frame_buffer) glDeleteBuffers(1, &m_gpu_frame_buffer);
+  if (m_gpu_vertex_map_buffer) glDeleteBuffers(1, &m_gpu_vertex_map_buffer);
 }
 
 void CEAnimation::setAnimationData(std::vector<short int> raw_animation_data, int vcount, std::vector<TFace> faces, std::vector<TPoint3d> original_vertices) {
-    m_animation_data.assign(raw_animation_data.begin(), raw_animation_data.end());
+    m_animation_data = std::move(raw_animation_data);
   // Sadly we need to keep this around since we need it to rebuild the faces after updating mesh with animation data.
-  m_faces = faces;
-  m_original_vertices = original_vertices;
+  m_faces = std::move(faces);
+  m_original_vertices = std::move(original_vertices);
+}
+
+const std::vector<short int>& CEAnimation::GetAnimationData() const {
+    return m_animation_data;
+}
+
+const std::vector<TFace>& CEAnimation::GetFaces() const {
+    return m_faces;
 }
 
-std::shared_ptr<const std::vector<short int>> CEAnimation::GetAnimationData() const {
-    return std::make_shared<const std::vector<short int>>(m_animation_data);
+const std::vector<TPoint3d>& CEAnimation::GetOriginalVertices() const {
+    return m_original_vertices;
 }
 
-std::shared_ptr<const std::vector<TFace>> CEAnimation::GetFaces() const {
-    return std::make_shared<const std::vector<TFace>>(m_faces);
+bool CEAnimation::frameAt(double elapsed, bool loop, int& frame_a, int& frame_b, float& blend) const {
+  if (m_number_of_frames <= 0 || m_kps <= 0) {
+    return false;
+  }
+  
+  if (!loop && (elapsed * 1000.0) >= m_total_time) {
+    return false;
+  }
+  
+  // Wrap the elapsed time around the total animation time
+  double time_per_frame = 1.0 / double(m_kps);
+  double total_time = m_number_of_frames * time_per_frame;
+  double exact_frame = fmod(elapsed, total_time) / time_per_frame;
+  
+  frame_a = static_cast<int>(exact_frame) % m_number_of_frames;
+  frame_b = (frame_a + 1) % m_number_of_frames;
+  blend = static_cast<float>(exact_frame - static_cast<int>(exact_frame));
+  return true;
 }
 
-std::shared_ptr<const std::vector<TPoint3d>> CEAnimation::GetOriginalVertices() const {
-    return std::make_shared<const std::vector<TPoint3d>>(m_original_vertices);
+/*
+ * Bake the raw keyframes (frames * vertices * xyz shorts, same layout as the .CAR file) into an
+ * R16I buffer texture, plus an R32I map from each face corner (gl_VertexID) to its source vertex.
+ * Only attempted once; the result is cached either way.
+ */
+bool CEAnimation::bakeGPUFrames() {
+  if (m_gpu_baked) {
+    return m_gpu_frame_texture != 0;
+  }
+  m_gpu_baked = true;
+  
+  size_t frame_values = size_t(m_number_of_frames) * m_original_vertices.size() * 3;
+  if (frame_values == 0 || m_faces.empty() || m_animation_data.size() < frame_values) {
+    return false;
+  }
+  
+  GLint max_texels = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+  if (frame_values > size_t(max_texels) || m_faces.size() * 3 > size_t(max_texels)) {
+    std::cout << "Animation '" << m_name << "' is too large for a buffer texture, using CPU animation" << std::endl;
+    return false;
+  }
+  
+  std::vector<GLint> vertex_map;
+  vertex_map.reserve(m_faces.size() * 3);
+  for (const auto& face : m_faces) {
+    vertex_map.push_back(face.v1);
+    vertex_map.push_back(face.v2);
+    vertex_map.push_back(face.v3);
+  }
+  
+  glGenBuffers(1, &m_gpu_frame_buffer);
+  glBindBuffer(GL_TEXTURE_BUFFER, m_gpu_frame_buffer);
+  glBufferData(GL_TEXTURE_BUFFER, frame_values * sizeof(short int), m_animation_data.data(), GL_STATIC_DRAW);
+  glGenTextures(1, &m_gpu_frame_texture);
+  glBindTexture(GL_TEXTURE_BUFFER, m_gpu_frame_texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R16I, m_gpu_frame_buffer);
+  
+  glGenBuffers(1, &m_gpu_vertex_map_buffer);
+  glBindBuffer(GL_TEXTURE_BUFFER, m_gpu_vertex_map_buffer);
+  glBufferData(GL_TEXTURE_BUFFER, vertex_map.size() * sizeof(GLint), vertex_map.data(), GL_STATIC_DRAW);
+  glGenTextures(1, &m_gpu_vertex_map_texture);
+  glBindTexture(GL_TEXTURE_BUFFER, m_gpu_vertex_map_texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, m_gpu_vertex_map_buffer);
+  
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  
+  return true;
 }
@@ -18,6 +18,12 @@
 
 class CEAnimation {
 private:
+  // Keyframes and face-corner -> vertex map as buffer textures, for sampling in the vertex shader
+  GLuint m_gpu_frame_buffer = 0;
+  GLuint m_gpu_frame_texture = 0;
+  GLuint m_gpu_vertex_map_buffer = 0;
+  GLuint m_gpu_vertex_map_texture = 0;
+  bool m_gpu_baked = false;
 
 public:
 	std::string m_name;
@@ -31,9 +37,18 @@ public:
   ~CEAnimation();
 
   void setAnimationData(std::vector<short int> raw_animation_data, int vcount, std::vector<TFace> faces, std::vector<TPoint3d> original_vertices);
-  std::shared_ptr<const std::vector<short int>> GetAnimationData() const;
-  std::shared_ptr<const std::vector<TFace>> GetFaces() const;
-  std::shared_ptr<const std::vector<TPoint3d>> GetOriginalVertices() const;
+  // Views into the animation's own storage; sampled every animation tick, so never copy
+  const std::vector<short int>& GetAnimationData() const;
+  const std::vector<TFace>& GetFaces() const;
+  const std::vector<TPoint3d>& GetOriginalVertices() const;
+  
+  // Keyframe pair and blend factor `elapsed` seconds in. False once a non-looping animation has ended
+  bool frameAt(double elapsed, bool loop, int& frame_a, int& frame_b, float& blend) const;
+  
+  // Uploads the keyframes once on first use (GL thread only). False if this animation can't be sampled on the GPU
+  bool bakeGPUFrames();
+  GLuint getGPUFrameTexture() const { return m_gpu_frame_texture; }
+  GLuint getGPUVertexMapTexture() const { return m_gpu_vertex_map_texture; }
 };
 
 #endif /* defined(__CE_Character_Lab__CEAnimation__) */
@@ -2,22 +2,28 @@
 //  CEBulletHeightfield.cpp
 //  CE Character Lab
 //
-//  Bullet Physics custom terrain triangle mesh system with exact subdivision matching
+//  Bullet Physics terrain sections read straight from the map's height grid
 //
 
 #include "CEBulletHeightfield.h"
 #include "C2MapFile.h"
 #include "CETerrainPartition.h"
+#include "CETerrainCollisionShape.h"
 
 // Bullet Physics includes
 #include <btBulletDynamicsCommon.h>
-#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
-#include <BulletCollision/CollisionShapes/btTriangleMesh.h>
 
 #include <iostream>
 #include <algorithm>
-#include <cmath>
-#include <limits>
+
+CEBulletHeightfield::TerrainSection::~TerrainSection()
+{
+    if (terrainBody) {
+        delete terrainBody->getMotionState();
+        delete terrainBody;
+    }
+    if (terrainShape) delete terrainShape;
+}
 
 CEBulletHeightfield::CEBulletHeightfield(C2MapFile* mapFile)
     : m_mapFile(mapFile)
@@ -31,8 +37,13 @@ CEBulletHeightfield::CEBulletHeightfield(C2MapFile* mapFile)
     m_mapHeight = m_mapFile->getHeight();
     
     
-    // Build single terrain triangle mesh
-    buildTerrainMesh();
+    // One section per page that is already loaded; a streamed world adds the rest as they arrive
+    int pageCount = m_mapFile->getPagesX() * m_mapFile->getPagesY();
+    for (int page = 0; page < pageCount; page++) {
+        if (m_mapFile->isPageResident(page)) {
+            m_sections[page] = buildSection(page);
+        }
+    }
     
 }
 
@@ -41,119 +52,117 @@ CEBulletHeightfield::~CEBulletHeightfield()
     // Cleanup is automatic via unique_ptr
 }
 
-void CEBulletHeightfield::buildTerrainMesh()
+std::unique_ptr<CEBulletHeightfield::TerrainSection> CEBulletHeightfield::buildSection(int page)
 {
-    if (!m_mapFile) return;
-    
-    m_terrainMesh = std::make_unique<TerrainMesh>();
-    
-    // Calculate world bounds for entire map
-    m_terrainMesh->worldMin = glm::vec3(0, -1000.0f, 0);
-    m_terrainMesh->worldMax = glm::vec3(m_mapWidth * m_tileSize, 1000.0f, m_mapHeight * m_tileSize);
-    
-    // Create triangle mesh using EXACT same logic as TerrainRenderer::loadIntoHardwareMemory()
-    m_terrainMesh->triangleMesh = new btTriangleMesh();
-    m_terrainMesh->minHeight = std::numeric_limits<float>::max();
-    m_terrainMesh->maxHeight = std::numeric_limits<float>::lowest();
-    
-    int triangleCount = 0;
-    
-    
-    // Generate triangles for each tile quad (EXACT same loops as TerrainRenderer lines 934-1010)
-    for (int y = 0; y < m_mapHeight - 1; y++) {
-        for (int x = 0; x < m_mapWidth - 1; x++) {
-            int base_index = (y * m_mapWidth) + x;
-            
-            // Use EXACT same logic as TerrainRenderer::calcWorldVertex()
-            // LL (Lower Left): tile at (x, y)
-            float h1 = m_mapFile->getHeightAt((y * m_mapWidth) + x);
-            float worldX1 = (x * m_tileSize) + (m_tileSize / 2.0f);
-            float worldZ1 = (y * m_tileSize) + (m_tileSize / 2.0f);
-            btVector3 vpositionLL(worldX1, h1, worldZ1);
-            
-            // LR (Lower Right): tile at (x+1, y)
-            float h2 = m_mapFile->getHeightAt((y * m_mapWidth) + (x + 1));
-            float worldX2 = ((x + 1) * m_tileSize) + (m_tileSize / 2.0f);
-            btVector3 vpositionLR(worldX2, h2, worldZ1);
-            
-            // UL (Upper Left): tile at (x, y+1)  
-            float h3 = m_mapFile->getHeightAt(((y + 1) * m_mapWidth) + x);
-            float worldZ2 = ((y + 1) * m_tileSize) + (m_tileSize / 2.0f);
-            btVector3 vpositionUL(worldX1, h3, worldZ2);
-            
-            // UR (Upper Right): tile at (x+1, y+1)
-            float h4 = m_mapFile->getHeightAt(((y + 1) * m_mapWidth) + (x + 1));
-            btVector3 vpositionUR(worldX2, h4, worldZ2);
-            
-            // Update height bounds
-            m_terrainMesh->minHeight = std::min({m_terrainMesh->minHeight, h1, h2, h3, h4});
-            m_terrainMesh->maxHeight = std::max({m_terrainMesh->maxHeight, h1, h2, h3, h4});
-            
-            // Use EXACT same triangle subdivision logic as TerrainRenderer (lines 949-1002)
-            bool quad_reverse = m_mapFile->isQuadRotatedAt(base_index);
-            
-            if (quad_reverse) {
-                // Triangle 1: lower_left → upper_left → lower_right
-                m_terrainMesh->triangleMesh->addTriangle(vpositionLL, vpositionUL, vpositionLR);
-                // Triangle 2: lower_right → upper_left → upper_right  
-                m_terrainMesh->triangleMesh->addTriangle(vpositionLR, vpositionUL, vpositionUR);
-            } else {
-                // Triangle 1: lower_left → upper_right → lower_right
-                m_terrainMesh->triangleMesh->addTriangle(vpositionLL, vpositionUR, vpositionLR);
-                // Triangle 2: lower_left → upper_left → upper_right
-                m_terrainMesh->triangleMesh->addTriangle(vpositionLL, vpositionUL, vpositionUR);
-            }
-            
-            
-            triangleCount += 2;
-        }
-    }
-    
-    // Store triangle count
-    m_terrainMesh->triangleCount = triangleCount;
-    
-    // Update world bounds with actual height range
-    m_terrainMesh->worldMin.y = m_terrainMesh->minHeight;
-    m_terrainMesh->worldMax.y = m_terrainMesh->maxHeight;
-    
-    // Create BVH triangle mesh shape from our custom triangle mesh
-    // Bullet's BVH will handle spatial partitioning and culling internally
-    m_terrainMesh->terrainShape = new btBvhTriangleMeshShape(m_terrainMesh->triangleMesh, true);
-    
-    // Create static rigid body for the triangle mesh
+    auto section = std::make_unique<TerrainSection>();
+    
+    // Quads whose lower-left tile lies in the page; the last row and column read into the next page
+    int pageSize = m_mapFile->getPageSize();
+    int x0 = (page % m_mapFile->getPagesX()) * pageSize;
+    int y0 = (page / m_mapFile->getPagesX()) * pageSize;
+    int x1 = std::min(x0 + pageSize, m_mapWidth - 1);
+    int y1 = std::min(y0 + pageSize, m_mapHeight - 1);
+    
+    // The shape generates the same triangles as TerrainRenderer::loadIntoHardwareMemory() on demand,
+    // straight from the height grid, so there is no triangle copy or BVH to build
+    section->terrainShape = new CETerrainCollisionShape(m_mapFile, x0, y0, x1, y1);
+    section->triangleCount = section->terrainShape->getTriangleCount();
+    section->minHeight = section->terrainShape->getLocalAabbMin().y();
+    section->maxHeight = section->terrainShape->getLocalAabbMax().y();
+    
+    // World bounds of the section with its actual height range
+    section->worldMin = glm::vec3(x0 * m_tileSize, section->minHeight, y0 * m_tileSize);
+    section->worldMax = glm::vec3((x1 + 1) * m_tileSize, section->maxHeight, (y1 + 1) * m_tileSize);
+    
+    // Create static rigid body for the section
     btTransform transform;
     transform.setIdentity();
     transform.setOrigin(btVector3(0, 0, 0));
     
     btDefaultMotionState* motionState = new btDefaultMotionState(transform);
-    btRigidBody::btRigidBodyConstructionInfo rbInfo(0.0f, motionState, m_terrainMesh->terrainShape, btVector3(0, 0, 0));
+    btRigidBody::btRigidBodyConstructionInfo rbInfo(0.0f, motionState, section->terrainShape, btVector3(0, 0, 0));
     
-    m_terrainMesh->terrainBody = new btRigidBody(rbInfo);
-    m_terrainMesh->terrainBody->setRestitution(0.1f);
-    m_terrainMesh->terrainBody->setFriction(0.8f);
+    section->terrainBody = new btRigidBody(rbInfo);
+    section->terrainBody->setRestitution(0.1f);
+    section->terrainBody->setFriction(0.8f);
     
     // Set user pointer for identification
-    m_terrainMesh->terrainBody->setUserPointer(m_terrainMesh.get());
+    section->terrainBody->setUserPointer(section.get());
     
+    return section;
 }
 
 void CEBulletHeightfield::addToWorld(btDiscreteDynamicsWorld* world)
 {
-    if (!world || !m_terrainMesh || !m_terrainMesh->terrainBody) return;
+    if (!world) return;
     
-    world->addRigidBody(m_terrainMesh->terrainBody, TERRAIN_COLLISION_GROUP, TERRAIN_COLLISION_MASK);
+    for (auto& section : m_sections) {
+        world->addRigidBody(section.second->terrainBody, TERRAIN_COLLISION_GROUP, TERRAIN_COLLISION_MASK);
+    }
     
 }
 
 void CEBulletHeightfield::removeFromWorld(btDiscreteDynamicsWorld* world)
 {
-    if (!world || !m_terrainMesh || !m_terrainMesh->terrainBody) return;
+    if (!world) return;
+    
+    for (auto& section : m_sections) {
+        world->removeRigidBody(section.second->terrainBody);
+    }
+    
+}
+
+void CEBulletHeightfield::addSection(btDiscreteDynamicsWorld* world, int page)
+{
+    if (!world || !m_mapFile) return;
+    
+    this->removeSection(world, page);
     
-    world->removeRigidBody(m_terrainMesh->terrainBody);
+    auto section = buildSection(page);
+    world->addRigidBody(section->terrainBody, TERRAIN_COLLISION_GROUP, TERRAIN_COLLISION_MASK);
+    m_sections[page] = std::move(section);
+}
+
+void CEBulletHeightfield::removeSection(btDiscreteDynamicsWorld* world, int page)
+{
+    auto it = m_sections.find(page);
+    if (!world || it == m_sections.end()) return;
+    
+    world->removeRigidBody(it->second->terrainBody);
+    m_sections.erase(it);
+}
+
+std::vector<int> CEBulletHeightfield::getSectionsReading(int page) const
+{
+    std::vector<int> sections;
+    int pagesX = m_mapFile->getPagesX();
+    int px = page % pagesX;
+    int py = page / pagesX;
+    
+    for (int dy = -1; dy <= 0; dy++) {
+        for (int dx = -1; dx <= 0; dx++) {
+            if (px + dx < 0 || py + dy < 0) continue;
+            int reader = page + (dy * pagesX) + dx;
+            if (reader == page || m_sections.count(reader)) {
+                sections.push_back(reader);
+            }
+        }
+    }
     
+    return sections;
 }
 
 int CEBulletHeightfield::getTriangleCount() const
 {
-    return m_terrainMesh ? m_terrainMesh->triangleCount : 0;
-}
\ No newline at end of file
+    int triangleCount = 0;
+    for (const auto& section : m_sections) {
+        triangleCount += section.second->triangleCount;
+    }
+    return triangleCount;
+}
+
+const CEBulletHeightfield::TerrainSection* CEBulletHeightfield::getSection(int page) const
+{
+    auto it = m_sections.find(page);
+    return it != m_sections.end() ? it->second.get() : nullptr;
+}
@@ -2,7 +2,7 @@
 //  CEBulletHeightfield.h
 //  CE Character Lab
 //
-//  Bullet Physics custom terrain triangle mesh system with exact subdivision matching
+//  Bullet Physics terrain sections read straight from the map's height grid
 //
 
 #ifndef __CE_Character_Lab__CEBulletHeightfield__
@@ -10,37 +10,34 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <map>
 #include <memory>
 
 // Forward declarations
 class C2MapFile;
 class CETerrainPartition;
+class CETerrainCollisionShape;
 class btDiscreteDynamicsWorld;
-class btBvhTriangleMeshShape;
-class btTriangleMesh;
 class btRigidBody;
 class btVector3;
 
 class CEBulletHeightfield
 {
 public:
-    // Simplified single terrain mesh structure
-    struct TerrainMesh {
-        btTriangleMesh* triangleMesh;
-        btBvhTriangleMeshShape* terrainShape;
+    // Terrain over the quads of one map page (a classic .map is a single page). The shape keeps
+    // no triangles of its own, only per-region height bounds
+    struct TerrainSection {
+        CETerrainCollisionShape* terrainShape;
         btRigidBody* terrainBody;
         
         glm::vec3 worldMin, worldMax;
         float minHeight, maxHeight;
         int triangleCount;
         
-        TerrainMesh() : triangleMesh(nullptr), terrainShape(nullptr), terrainBody(nullptr), triangleCount(0) {}
+        TerrainSection() : terrainShape(nullptr), terrainBody(nullptr), triangleCount(0) {}
         
-        ~TerrainMesh() {
-            if (triangleMesh) delete triangleMesh;
-            if (terrainShape) delete terrainShape;
-            // terrainBody is managed by physics world
-        }
+        // Must already be out of the physics world
+        ~TerrainSection();
     };
 
 private:
@@ -48,21 +45,29 @@ private:
     float m_tileSize;
     int m_mapWidth, m_mapHeight;
     
-    std::unique_ptr<TerrainMesh> m_terrainMesh;
+    // One section per resident page, keyed by page number
+    std::map<int, std::unique_ptr<TerrainSection>> m_sections;
     
-    void buildTerrainMesh();
+    std::unique_ptr<TerrainSection> buildSection(int page);
     
 public:
     CEBulletHeightfield(C2MapFile* mapFile);
     ~CEBulletHeightfield();
     
-    // Add/remove terrain mesh from physics world
+    // Add/remove every section from physics world
     void addToWorld(btDiscreteDynamicsWorld* world);
     void removeFromWorld(btDiscreteDynamicsWorld* world);
     
-    // Debug info
+    // Streamed worlds: (re)build one page's section and add it, or take it out and free it
+    void addSection(btDiscreteDynamicsWorld* world, int page);
+    void removeSection(btDiscreteDynamicsWorld* world, int page);
+    // Sections whose edge quads read heights from the page (the page itself and those left of and below it)
+    std::vector<int> getSectionsReading(int page) const;
+    
+    // Debug info; triangles are generated on demand, never stored
     int getTriangleCount() const;
-    const TerrainMesh* getTerrainMesh() const { return m_terrainMesh.get(); }
+    const TerrainSection* getSection(int page) const;
+    const std::map<int, std::unique_ptr<TerrainSection>>& getSections() const { return m_sections; }
     
     // Collision groups for terrain (matching CEPhysicsWorld::CollisionGroups)
     static const short TERRAIN_COLLISION_GROUP = 1 << 1;  // TERRAIN_GROUP (bit 1)
@@ -6,7 +6,6 @@
 //
 
 #include "CEBulletProjectileManager.h"
-#include "CEBulletProjectile.h"
 #include "CEPhysicsWorld.h"
 #include "CEParticleSystem.h"
 #include "C2MapFile.h"
@@ -28,18 +27,18 @@
 extern void addImpactEvent(const glm::vec3& location, const std::string& surfaceType, float distance, float damage, const std::string& impactType);
 extern void addImpactEvent(const glm::vec3& location, const std::string& surfaceType, float distance, float damage, const std::string& impactType, const std::string& objectName, int objectIndex, int instanceIndex);
 extern void addImpactEvent(const glm::vec3& location, const glm::vec3& surfaceNormal, const std::string& surfaceType, float distance, float damage, const std::string& impactType);
-extern void addFaceIntersectionEvent(const glm::vec3& location, const std::string& surfaceType, float distance, const glm::vec3& normal, const glm::vec3& direction, int tileX, int tileZ, int faceIndex, const std::string& objectName, int objectIndex, int instanceIndex);
 extern void addDebugSphere(const glm::vec3& position, float radius, const glm::vec3& color, const std::string& label);
 
 using libAF2::Sound;
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-CEBulletProjectileManager::CEBulletProjectileManager(C2MapFile* map, C2MapRscFile* mapRsc, LocalAudioManager* audioManager)
+CEBulletProjectileManager::CEBulletProjectileManager(C2MapFile* map, C2MapRscFile* mapRsc, LocalAudioManager* audioManager, std::unique_ptr<CEPhysicsWorld::StaticShapes> staticShapes,
+                                                     const CEPhysicsWorld::SimulationSettings& simulationSettings)
     : m_map(map), m_mapRsc(mapRsc), m_audioManager(audioManager)
 {
     // Initialize physics world with terrain, objects, and water
-    m_physicsWorld.reset(new CEPhysicsWorld(map, mapRsc));
+    m_physicsWorld.reset(new CEPhysicsWorld(map, mapRsc, std::move(staticShapes), simulationSettings));
     
     // Initialize particle system for impact effects
     m_particleSystem.reset(new CEParticleSystem(2000)); // Max 2000 particles for intense effects
@@ -52,13 +51,6 @@ CEBulletProjectileManager::CEBulletProjectileManager(C2MapFile* map, C2MapRscFil
 
 CEBulletProjectileManager::~CEBulletProjectileManager()
 {
-    // Clean up all active projectiles
-    for (auto& projectile : m_activeProjectiles) {
-        if (projectile && projectile->getRigidBody()) {
-            m_physicsWorld->removeRigidBody(projectile->getRigidBody());
-        }
-    }
-    m_activeProjectiles.clear();
 }
 
 void CEBulletProjectileManager::loadImpactSoundConfig()
@@ -113,27 +105,15 @@ void CEBulletProjectileManager::loadImpactSoundConfig()
 void CEBulletProjectileManager::spawnProjectile(const glm::vec3& origin, const glm::vec3& direction, 
                                                float muzzleVelocity, float damage, const std::string& type)
 {
-    // Spawning ballistic projectile
-    
     // Calculate initial velocity vector
     glm::vec3 velocity = glm::normalize(direction) * muzzleVelocity;
     
-    // Create new bullet projectile
-    std::unique_ptr<CEBulletProjectile> projectile(new CEBulletProjectile(
-        m_physicsWorld->getDynamicsWorld(),
-        origin,
-        velocity,
-        damage
-    ));
-    
-    m_activeProjectiles.push_back(std::move(projectile));
-    
-    // Active projectiles count available via getActiveProjectileCount()
+    m_projectiles.spawn(origin, velocity, damage);
 }
 
 void CEBulletProjectileManager::update(double currentTime, double deltaTime)
 {
-    // Step the physics simulation
+    // Step the physics simulation (player and AI collision; projectiles don't live in it)
     m_physicsWorld->stepSimulation(static_cast<float>(deltaTime));
     
     // Update particle system
@@ -141,55 +121,38 @@ void CEBulletProjectileManager::update(double currentTime, double deltaTime)
         m_particleSystem->update(static_cast<float>(deltaTime));
     }
     
-    // Update all projectiles and check for impacts
-    for (auto it = m_activeProjectiles.begin(); it != m_activeProjectiles.end();) {
-        auto& projectile = *it;
-        
-        // Update projectile and check for impact
-        bool impacted = projectile->update(currentTime, m_physicsWorld.get());
-        
-        if (impacted) {
-            handleImpact(*projectile, currentTime);
-        }
-        
-        // Process face intersections for effects (even if not impacted yet)
-        processFaceIntersections(*projectile);
-        
-        // Remove projectiles that should be destroyed
-        if (projectile->shouldDestroy(currentTime)) {
-            // Remove from physics world first
-            if (projectile->getRigidBody()) {
-                m_physicsWorld->removeRigidBody(projectile->getRigidBody());
-            }
-            
-            // Debug: Log projectile cleanup
-            static int cleanupCount = 0;
-            cleanupCount++;
-            if (cleanupCount <= 5) {
-                std::cout << "🗑️ Cleanup projectile " << cleanupCount << " - active count: " 
-                          << m_activeProjectiles.size() << " -> " << (m_activeProjectiles.size() - 1) << std::endl;
-            }
-            
-            it = m_activeProjectiles.erase(it);
-        } else {
-            ++it;
-        }
+    // Advance all projectiles along their arcs and handle whatever they hit
+    m_impacts.clear();
+    m_projectiles.step(static_cast<float>(deltaTime), m_physicsWorld.get(), m_impacts);
+    for (const auto& impact : m_impacts) {
+        handleImpact(impact, currentTime);
     }
 }
 
-void CEBulletProjectileManager::handleImpact(const CEBulletProjectile& projectile, double currentTime)
+void CEBulletProjectileManager::handleImpact(const CEProjectilePool::Impact& impact, double currentTime)
 {
-    if (!projectile.hasImpacted()) return;
+    const glm::vec3& hitPoint = impact.point;
+    const std::string& surfaceType = impact.surfaceType;
+    float distance = impact.distance;
+    float damage = impact.damage;
     
-    const glm::vec3& hitPoint = projectile.getImpactPoint();
-    const std::string& surfaceType = projectile.getImpactSurfaceType();
-    float distance = projectile.getImpactDistance();
-    float damage = projectile.getDamage();
+    // Visual feedback at the impact
+    glm::vec3 impactColor = glm::vec3(1.0f, 0.5f, 0.0f);
+    if (surfaceType == "terrain") {
+        impactColor = glm::vec3(0.0f, 1.0f, 0.5f);
+    } else if (surfaceType == "water") {
+        impactColor = glm::vec3(0.0f, 0.8f, 1.0f);
+    } else if (surfaceType == "object") {
+        impactColor = glm::vec3(1.0f, 0.0f, 0.5f);
+    } else if (surfaceType == "ai_character") {
+        impactColor = glm::vec3(1.0f, 0.0f, 0.0f); // Red for AI character hits
+    }
+    addDebugSphere(hitPoint, 2.0f, impactColor, "impact");
     
     // Log impact to GUI with proper surface normal for orientation
-    glm::vec3 impactNormal = projectile.getImpactNormal();
+    glm::vec3 impactNormal = impact.normal;
     
-    if (surfaceType == "object" && !projectile.getImpactObjectName().empty()) {
+    if (surfaceType == "object" && !impact.hit.objectInfo.objectName.empty()) {
         // Use the surface normal version for proper orientation, even for objects
         addImpactEvent(hitPoint, impactNormal, surfaceType, distance, damage, "Bullet Impact");
     } else {
@@ -202,8 +165,8 @@ void CEBulletProjectileManager::handleImpact(const CEBulletProjectile& projectil
     
     // Check for AI character hits
     if (surfaceType == "ai_character") {
-        // Get the hit body from the projectile's raycast result
-        btRigidBody* hitBody = projectile.getHitBody();
+        // Get the hit body from the projectile's trace
+        btRigidBody* hitBody = impact.hit.hitBody;
         if (hitBody && hitBody->getUserPointer()) {
             CEAIGenericAmbientManager* aiManager = static_cast<CEAIGenericAmbientManager*>(hitBody->getUserPointer());
             if (aiManager && !aiManager->isDead()) {
@@ -218,8 +181,6 @@ void CEBulletProjectileManager::handleImpact(const CEBulletProjectile& projectil
     if (m_particleSystem) {
         std::cout << "🎆 Emitting particles for " << surfaceType << " impact at [" 
                   << hitPoint.x << ", " << hitPoint.y << ", " << hitPoint.z << "]" << std::endl;
-        glm::vec3 impactNormal = projectile.getImpactNormal();
-        
         if (surfaceType == "terrain" || surfaceType == "ground") {
             // Ground impact: much more dramatic dirt and dust
             std::cout << "   Emitting 60 ground impact + 40 dust particles" << std::endl;
@@ -227,7 +188,7 @@ void CEBulletProjectileManager::handleImpact(const CEBulletProjectile& projectil
             m_particleSystem->emitDustCloud(hitPoint, 40);
         } else if (surfaceType == "object") {
             // Object impact: explosive debris and sparks
-            glm::vec3 impactDirection = glm::normalize(projectile.getVelocity());
+            glm::vec3 impactDirection = glm::normalize(impact.velocity);
             m_particleSystem->emitDebris(hitPoint, impactDirection, 35);
             m_particleSystem->emitGroundImpact(hitPoint, impactNormal, 25); // Heavy dust
             m_particleSystem->emitDustCloud(hitPoint, 20); // Extra smoke
@@ -236,12 +197,12 @@ void CEBulletProjectileManager::handleImpact(const CEBulletProjectile& projectil
           m_particleSystem->emitDustCloud(hitPoint, 80); // Major water spray
           m_particleSystem->emitGroundImpact(hitPoint, impactNormal, 40); // Heavy splash particles
         } else if (surfaceType == "ai_character") {
-          glm::vec3 impactDirection = glm::normalize(projectile.getVelocity());
+          glm::vec3 impactDirection = glm::normalize(impact.velocity);
           m_particleSystem->emitDustCloud(hitPoint, 30);
           m_particleSystem->emitBloodSplash(hitPoint, impactNormal, 120);
         } else {
             // Default impact: heavy debris
-            glm::vec3 impactDirection = glm::normalize(projectile.getVelocity());
+            glm::vec3 impactDirection = glm::normalize(impact.velocity);
             m_particleSystem->emitGroundImpact(hitPoint, impactNormal, 40);
             m_particleSystem->emitDebris(hitPoint, impactDirection, 25);
         }
@@ -305,68 +266,3 @@ void CEBulletProjectileManager::renderParticles(Camera* camera)
         }
     }
 }
-
-void CEBulletProjectileManager::processFaceIntersections(CEBulletProjectile& projectile)
-{
-    const auto& intersections = projectile.getFaceIntersections();
-    
-    if (intersections.empty()) return;
-    
-    std::cout << "🔥 Processing " << intersections.size() << " face intersections for effects" << std::endl;
-    
-    for (const auto& intersection : intersections) {
-        // Create effect markers at each face intersection point
-        // This shows where the bullet passed through surfaces, even if it ended up below terrain
-        
-        // Choose effect color based on surface type
-        glm::vec3 effectColor;
-        std::string effectLabel;
-        
-        if (intersection.surfaceType == "terrain") {
-            effectColor = glm::vec3(1.0f, 0.8f, 0.0f); // Orange for terrain hits
-            effectLabel = "terrain_face_hit";
-        } else if (intersection.surfaceType == "object") {
-            effectColor = glm::vec3(1.0f, 0.0f, 1.0f); // Magenta for object hits
-            effectLabel = "object_face_hit";
-        } else if (intersection.surfaceType == "water") {
-            effectColor = glm::vec3(0.0f, 0.8f, 1.0f); // Cyan for water hits
-            effectLabel = "water_face_hit";
-        } else {
-            effectColor = glm::vec3(0.5f, 0.5f, 0.5f); // Gray for unknown
-            effectLabel = "unknown_face_hit";
-        }
-        
-        // Add face intersection event to UI with all detailed information
-        addFaceIntersectionEvent(
-            intersection.position,
-            intersection.surfaceType,
-            intersection.distance,
-            intersection.normal,
-            intersection.incomingDirection,
-            intersection.tileX,
-            intersection.tileZ,
-            intersection.faceIndex,
-            intersection.objectName,
-            intersection.objectIndex,
-            intersection.instanceIndex
-        );
-        
-        std::cout << "  💥 " << intersection.surfaceType << " face hit at [" 
-                  << intersection.position.x << ", " << intersection.position.y << ", " << intersection.position.z << "]";
-        
-        if (intersection.surfaceType == "terrain") {
-            std::cout << " tile[" << intersection.tileX << "," << intersection.tileZ << "]";
-        } else if (intersection.surfaceType == "object") {
-            std::cout << " object: " << intersection.objectName;
-        }
-        
-        std::cout << " normal: [" << intersection.normal.x << ", " << intersection.normal.y << ", " << intersection.normal.z << "]" << std::endl;
-        
-        // TODO: Add particle effects, decals, ricochet calculations based on normals
-        // TODO: Add surface-specific impact sounds
-        // TODO: Add damage calculations for objects
-    }
-    
-    // Clear processed intersections to prevent reprocessing
-    projectile.clearFaceIntersections();
-}
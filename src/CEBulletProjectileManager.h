@@ -13,8 +13,9 @@
 #include <glm/glm.hpp>
 #include <string>
 
-class CEBulletProjectile;
-class CEPhysicsWorld;
+#include "CEPhysicsWorld.h"
+#include "CEProjectilePool.h"
+
 class C2MapFile;
 class C2MapRscFile;
 class LocalAudioManager;
@@ -25,7 +26,8 @@ class CEBulletProjectileManager
 {
 private:
     std::unique_ptr<CEPhysicsWorld> m_physicsWorld;
-    std::vector<std::unique_ptr<CEBulletProjectile>> m_activeProjectiles;
+    CEProjectilePool m_projectiles;
+    std::vector<CEProjectilePool::Impact> m_impacts; // reused every update
     C2MapFile* m_map;
     C2MapRscFile* m_mapRsc;
     LocalAudioManager* m_audioManager;
@@ -37,15 +39,14 @@ private:
     std::vector<std::string> m_waterSoundPaths;
     
     // Impact handling
-    void handleImpact(const CEBulletProjectile& projectile, double currentTime);
+    void handleImpact(const CEProjectilePool::Impact& impact, double currentTime);
     void playImpactAudio(const glm::vec3& position, const std::string& surfaceType);
     void loadImpactSoundConfig();
     
-    // Face intersection processing
-    void processFaceIntersections(CEBulletProjectile& projectile);
-    
 public:
-    CEBulletProjectileManager(C2MapFile* map, C2MapRscFile* mapRsc, LocalAudioManager* audioManager);
+    // staticShapes: collision shapes prebuilt with CEPhysicsWorld::buildStaticShapes(), if any
+    CEBulletProjectileManager(C2MapFile* map, C2MapRscFile* mapRsc, LocalAudioManager* audioManager, std::unique_ptr<CEPhysicsWorld::StaticShapes> staticShapes = nullptr,
+                              const CEPhysicsWorld::SimulationSettings& simulationSettings = CEPhysicsWorld::SimulationSettings());
     ~CEBulletProjectileManager();
     
     // Spawn a new realistic ballistic projectile
@@ -59,7 +60,7 @@ public:
     void renderParticles(Camera* camera);
     
     // Get count of active projectiles
-    size_t getActiveProjectileCount() const { return m_activeProjectiles.size(); }
+    size_t getActiveProjectileCount() const { return m_projectiles.size(); }
     
     // Get physics world for other systems
     CEPhysicsWorld* getPhysicsWorld() const { return m_physicsWorld.get(); }
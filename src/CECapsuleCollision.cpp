@@ -12,11 +12,13 @@
 CECapsuleCollision::CECapsuleCollision(btDiscreteDynamicsWorld* dynamicsWorld, 
                                        float radius, 
                                        float height, 
-                                       const glm::vec3& initialPosition)
+                                       const glm::vec3& initialPosition,
+                                       std::recursive_mutex* worldMutex)
     : m_dynamicsWorld(dynamicsWorld)
     , m_capsuleShape(nullptr)
     , m_capsuleBody(nullptr)
     , m_motionState(nullptr)
+    , m_worldMutex(worldMutex)
     , m_position(initialPosition)
     , m_radius(radius)
     , m_height(height)
@@ -43,6 +45,8 @@ void CECapsuleCollision::createCapsuleBody()
 {
     if (!m_dynamicsWorld || !m_enabled) return;
     
+    auto lock = lockWorld();
+    
     // Clean up existing body if any
     destroyCapsuleBody();
     
@@ -106,6 +110,7 @@ void CECapsuleCollision::destroyCapsuleBody()
     }
     
     // Normal cleanup during runtime
+    auto lock = lockWorld();
     if (m_dynamicsWorld && m_capsuleBody) {
         try {
             // Check if the body is actually in the world before trying to remove it
@@ -169,6 +174,7 @@ void CECapsuleCollision::updatePosition(const glm::vec3& position)
     transform.setIdentity();
     transform.setOrigin(glmToBtVector3(position));
     
+    auto lock = lockWorld();
     m_capsuleBody->setWorldTransform(transform);
     m_capsuleBody->getMotionState()->setWorldTransform(transform);
     m_capsuleBody->activate(true);
@@ -200,6 +206,7 @@ bool CECapsuleCollision::checkMovement(const glm::vec3& from, const glm::vec3& t
     sweepCallback.m_collisionFilterGroup = PLAYER_COLLISION_GROUP;
     sweepCallback.m_collisionFilterMask = PLAYER_COLLISION_MASK;
     
+    auto lock = lockWorld();
     m_dynamicsWorld->convexSweepTest(&testShape, fromTransform, toTransform, sweepCallback);
     
     // Return true if no collision (movement is allowed)
@@ -232,6 +239,7 @@ bool CECapsuleCollision::checkMovementWithNormal(const glm::vec3& from, const gl
     sweepCallback.m_collisionFilterGroup = PLAYER_COLLISION_GROUP;
     sweepCallback.m_collisionFilterMask = PLAYER_COLLISION_MASK;
     
+    auto lock = lockWorld();
     m_dynamicsWorld->convexSweepTest(&testShape, fromTransform, toTransform, sweepCallback);
     
     // If collision detected, store the normal
@@ -291,6 +299,7 @@ bool CECapsuleCollision::hasContacts() const
     }
     
     // Check collision manifolds to see if we have any contacts
+    auto lock = lockWorld();
     int numManifolds = m_dynamicsWorld->getDispatcher()->getNumManifolds();
     for (int i = 0; i < numManifolds; i++) {
         btPersistentManifold* contactManifold = m_dynamicsWorld->getDispatcher()->getManifoldByIndexInternal(i);
@@ -319,4 +328,9 @@ glm::vec3 CECapsuleCollision::btVector3ToGlm(const btVector3& vec) const
 btVector3 CECapsuleCollision::glmToBtVector3(const glm::vec3& vec) const
 {
     return btVector3(vec.x, vec.y, vec.z);
-}
\ No newline at end of file
+}
+
+std::unique_lock<std::recursive_mutex> CECapsuleCollision::lockWorld() const
+{
+    return m_worldMutex ? std::unique_lock<std::recursive_mutex>(*m_worldMutex) : std::unique_lock<std::recursive_mutex>();
+}
@@ -11,6 +11,7 @@
 
 #include "ICapsuleCollision.h"
 #include <memory>
+#include <mutex>
 
 // Forward declarations for Bullet Physics
 class btCapsuleShape;
@@ -30,6 +31,7 @@ private:
     btRigidBody* m_capsuleBody;
     btDefaultMotionState* m_motionState;
     btDiscreteDynamicsWorld* m_dynamicsWorld; // Not owned
+    std::recursive_mutex* m_worldMutex; // Not owned; held around every use of the world, if given
     
     // Collision filtering constants
     static const short PLAYER_COLLISION_GROUP = 1 << 4;  // PLAYER_GROUP (bit 4)
@@ -48,6 +50,7 @@ private:
     void destroyCapsuleBody();
     glm::vec3 btVector3ToGlm(const class btVector3& vec) const;
     class btVector3 glmToBtVector3(const glm::vec3& vec) const;
+    std::unique_lock<std::recursive_mutex> lockWorld() const;
     
 public:
     /**
@@ -56,11 +59,13 @@ public:
      * @param radius Initial capsule radius
      * @param height Initial capsule height (cylindrical part)
      * @param initialPosition Starting position
+     * @param worldMutex Lock of a world that is stepped on another thread (CEPhysicsWorld::getWorldMutex)
      */
     CECapsuleCollision(btDiscreteDynamicsWorld* dynamicsWorld, 
                        float radius = 3.5f, 
                        float height = 18.0f, 
-                       const glm::vec3& initialPosition = glm::vec3(0.0f));
+                       const glm::vec3& initialPosition = glm::vec3(0.0f),
+                       std::recursive_mutex* worldMutex = nullptr);
     
     /**
      * Destructor - cleans up Bullet Physics objects
@@ -0,0 +1,268 @@
+//
+//  CECharacterBatch.cpp
+//  CE Character Lab
+//
+//  One immutable, GPU-animated mesh per .CAR shared by every character spawned from it, drawn in a single instanced call
+//
+
+#include "CECharacterBatch.h"
+
+#include "C2CarFile.h"
+#include "CEAnimation.h"
+#include "CEGeometry.h"
+#include "IndexedMeshLoader.h"
+#include "shader_program.h"
+#include "vertex.h"
+
+#include "camera.h"
+#include "transform.h"
+
+#include <iostream>
+
+std::map<const C2CarFile*, std::weak_ptr<CECharacterBatch>> CECharacterBatch::s_batches;
+
+CECharacterBatch::CECharacterBatch(std::shared_ptr<C2CarFile> car, C2MapFile* map, C2MapRscFile* rsc)
+: m_car(car)
+{
+  std::shared_ptr<CEAnimation> base = car->getFirstAnimation().lock();
+  if (!base) {
+    return;
+  }
+  
+  // Every animation in a .CAR shares the base mesh, so one copy of it serves every character
+  std::unique_ptr<IndexedMeshLoader> loader = std::make_unique<IndexedMeshLoader>(base->GetOriginalVertices(), base->GetFaces());
+  this->m_geometry = std::make_unique<CEGeometry>(loader->getVertices(), loader->getIndices(), car->getGeometry()->getTexture().lock(), "dinosaur");
+  this->m_geometry->ConfigureShaderUniforms(map, rsc);
+  
+  if (!this->m_geometry->IsGPUAnimationEnabled() || !this->bakeAnimations()) {
+    return;
+  }
+  
+  ShaderProgram* shader = this->m_geometry->getShader();
+  shader->use();
+  shader->setBool("gpuAnimation", true);
+  shader->setBool("instancedAnimation", true);
+  shader->setInt("animationVertexCount", (int)base->GetOriginalVertices().size());
+  
+  this->m_gpu_animated = true;
+}
+
+CECharacterBatch::~CECharacterBatch()
+{
+  if (m_upload) m_upload->cancel();
+  if (m_frame_texture) glDeleteTextures(1, &m_frame_texture);
+  if (m_vertex_map_texture) glDeleteTextures(1, &m_vertex_map_texture);
+  if (m_frame_buffer) glDeleteBuffers(1, &m_frame_buffer);
+  if (m_vertex_map_buffer) glDeleteBuffers(1, &m_vertex_map_buffer);
+  
+  auto it = s_batches.find(m_car.get());
+  if (it != s_batches.end() && it->second.expired()) {
+    s_batches.erase(it);
+  }
+}
+
+std::shared_ptr<CECharacterBatch> CECharacterBatch::forCar(const std::shared_ptr<C2CarFile>& car, C2MapFile* map, C2MapRscFile* rsc)
+{
+  std::shared_ptr<CECharacterBatch> batch = s_batches[car.get()].lock();
+  if (!batch) {
+    batch = std::make_shared<CECharacterBatch>(car, map, rsc);
+    s_batches[car.get()] = batch;
+  }
+  
+  return batch;
+}
+
+void CECharacterBatch::RenderAll(Transform& base_transform, Camera& camera)
+{
+  for (auto& entry : s_batches) {
+    if (std::shared_ptr<CECharacterBatch> batch = entry.second.lock()) {
+      batch->render(base_transform, camera);
+    }
+  }
+}
+
+/*
+ * Same layout as CEAnimation::bakeGPUFrames, but with all of the car's animations in one
+ * buffer texture so instances playing different animations can share a draw call
+ */
+bool CECharacterBatch::bakeAnimations()
+{
+  std::shared_ptr<CEAnimation> base = m_car->getFirstAnimation().lock();
+  const size_t vertex_count = base->GetOriginalVertices().size();
+  const size_t frame_size = vertex_count * 3;
+  
+  auto frames_storage = std::make_shared<std::vector<short int>>();
+  std::vector<short int>& frames = *frames_storage;
+  int next_frame = 0;
+  for (const auto& entry : m_car->getAnimations()) {
+    const std::shared_ptr<CEAnimation>& ani = entry.second;
+    if (!ani || ani->GetOriginalVertices().size() != vertex_count) {
+      continue;
+    }
+    
+    const std::vector<short int>& data = ani->GetAnimationData();
+    if (ani->m_number_of_frames <= 0 || data.size() < frame_size * ani->m_number_of_frames) {
+      continue;
+    }
+    
+    m_first_frame[ani.get()] = next_frame;
+    frames.insert(frames.end(), data.begin(), data.begin() + frame_size * ani->m_number_of_frames);
+    next_frame += ani->m_number_of_frames;
+  }
+  
+  const std::vector<TFace>& faces = base->GetFaces();
+  GLint max_texels = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+  if (frames.empty() || frames.size() > size_t(max_texels) || faces.size() * 3 > size_t(max_texels)) {
+    std::cout << "Character keyframes do not fit a buffer texture, characters will not be batched" << std::endl;
+    m_first_frame.clear();
+    return false;
+  }
+  
+  auto vertex_map_storage = std::make_shared<std::vector<GLint>>();
+  std::vector<GLint>& vertex_map = *vertex_map_storage;
+  vertex_map.reserve(faces.size() * 3);
+  for (const auto& face : faces) {
+    vertex_map.push_back(face.v1);
+    vertex_map.push_back(face.v2);
+    vertex_map.push_back(face.v3);
+  }
+  
+  // A buffer texture follows its buffer's storage, so the keyframes can arrive later through the
+  // upload queue. Spawning a new kind of character then doesn't stall the frame
+  glGenBuffers(1, &m_frame_buffer);
+  glBindBuffer(GL_TEXTURE_BUFFER, m_frame_buffer);
+  glGenTextures(1, &m_frame_texture);
+  glBindTexture(GL_TEXTURE_BUFFER, m_frame_texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R16I, m_frame_buffer);
+  
+  glGenBuffers(1, &m_vertex_map_buffer);
+  glBindBuffer(GL_TEXTURE_BUFFER, m_vertex_map_buffer);
+  glGenTextures(1, &m_vertex_map_texture);
+  glBindTexture(GL_TEXTURE_BUFFER, m_vertex_map_texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, m_vertex_map_buffer);
+  
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  
+  CEUploadQueue& queue = CEUploadQueue::getInstance();
+  m_upload = queue.createTicket();
+  queue.uploadBuffer(m_upload, m_frame_buffer, frames.data(), frames.size() * sizeof(short int), GL_STATIC_DRAW, frames_storage);
+  queue.uploadBuffer(m_upload, m_vertex_map_buffer, vertex_map.data(), vertex_map.size() * sizeof(GLint), GL_STATIC_DRAW, vertex_map_storage);
+  
+  std::cout << "Baked " << m_first_frame.size() << " animations (" << next_frame << " frames) for instanced characters" << std::endl;
+  return true;
+}
+
+int CECharacterBatch::addInstance()
+{
+  int slot;
+  if (!m_free_slots.empty()) {
+    slot = m_free_slots.back();
+    m_free_slots.pop_back();
+  } else {
+    slot = (int)m_instances.size();
+    m_instances.emplace_back();
+  }
+  
+  m_instances[slot] = _Instance();
+  m_instances[slot].used = true;
+  return slot;
+}
+
+void CECharacterBatch::removeInstance(int slot)
+{
+  if (slot < 0 || slot >= (int)m_instances.size() || !m_instances[slot].used) {
+    return;
+  }
+  
+  m_instances[slot].used = false;
+  m_free_slots.push_back(slot);
+}
+
+void CECharacterBatch::setInstanceTransform(int slot, const glm::mat4& model)
+{
+  m_instances[slot].model = model;
+}
+
+bool CECharacterBatch::setInstanceAnimation(int slot, const std::shared_ptr<CEAnimation>& animation, double elapsed, bool loop, bool noInterpolation)
+{
+  if (!animation) {
+    return false;
+  }
+  
+  auto first = m_first_frame.find(animation.get());
+  if (first == m_first_frame.end()) {
+    return false;
+  }
+  
+  int frame_a, frame_b;
+  float blend;
+  if (!animation->frameAt(elapsed, loop, frame_a, frame_b, blend)) {
+    return false;
+  }
+  
+  if (noInterpolation) {
+    frame_b = frame_a;
+    blend = 0.f;
+  }
+  
+  _Instance& instance = m_instances[slot];
+  instance.frame = frame_a;
+  instance.animation = glm::vec3(first->second + frame_a, first->second + frame_b, blend);
+  return true;
+}
+
+bool CECharacterBatch::setInstanceFrame(int slot, const std::shared_ptr<CEAnimation>& animation, int frame)
+{
+  if (!animation || frame < 0 || frame >= animation->m_number_of_frames) {
+    return false;
+  }
+  
+  auto first = m_first_frame.find(animation.get());
+  if (first == m_first_frame.end()) {
+    return false;
+  }
+  
+  _Instance& instance = m_instances[slot];
+  instance.frame = frame;
+  instance.animation = glm::vec3(first->second + frame, first->second + frame, 0.f);
+  return true;
+}
+
+int CECharacterBatch::getInstanceFrame(int slot) const
+{
+  return m_instances[slot].frame;
+}
+
+void CECharacterBatch::render(Transform& base_transform, Camera& camera)
+{
+  if (!m_gpu_animated || !m_upload->isReady()) {
+    return;
+  }
+  
+  m_models.clear();
+  m_animations.clear();
+  for (const auto& instance : m_instances) {
+    if (instance.used) {
+      m_models.push_back(instance.model);
+      m_animations.push_back(instance.animation);
+    }
+  }
+  
+  if (m_models.empty()) {
+    return;
+  }
+  
+  m_geometry->Update(base_transform, camera);
+  m_geometry->UpdateInstances(m_models);
+  m_geometry->UpdateInstanceAnimations(m_animations);
+  
+  glActiveTexture(GL_TEXTURE0 + CEGeometry::ANIMATION_FRAMES_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, m_frame_texture);
+  glActiveTexture(GL_TEXTURE0 + CEGeometry::ANIMATION_VERTEX_MAP_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, m_vertex_map_texture);
+  glActiveTexture(GL_TEXTURE0);
+  
+  m_geometry->DrawInstances();
+}
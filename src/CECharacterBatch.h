@@ -0,0 +1,83 @@
+//
+//  CECharacterBatch.h
+//  CE Character Lab
+//
+//  One immutable, GPU-animated mesh per .CAR shared by every character spawned from it, drawn in a single instanced call
+//
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "CEUploadQueue.h"
+
+class C2CarFile;
+class C2MapFile;
+class C2MapRscFile;
+class CEAnimation;
+class CEGeometry;
+
+struct Camera;
+struct Transform;
+
+class CECharacterBatch
+{
+private:
+  struct _Instance {
+    glm::mat4 model = glm::mat4(1.f);
+    glm::vec3 animation = glm::vec3(0.f); // frameA, frameB (atlas frames), blend
+    int frame = 0;                        // frameA within its own animation
+    bool used = false;
+  };
+
+  std::shared_ptr<C2CarFile> m_car;
+  std::unique_ptr<CEGeometry> m_geometry;
+
+  // Keyframes of every animation in the car, back to back, and the face corner -> vertex map
+  GLuint m_frame_buffer = 0;
+  GLuint m_frame_texture = 0;
+  GLuint m_vertex_map_buffer = 0;
+  GLuint m_vertex_map_texture = 0;
+  std::shared_ptr<CEUploadQueue::Ticket> m_upload;
+  std::unordered_map<const CEAnimation*, int> m_first_frame;
+  bool m_gpu_animated = false;
+
+  std::vector<_Instance> m_instances;
+  std::vector<int> m_free_slots;
+
+  // Upload scratch, reused every frame
+  std::vector<glm::mat4> m_models;
+  std::vector<glm::vec3> m_animations;
+
+  static std::map<const C2CarFile*, std::weak_ptr<CECharacterBatch>> s_batches;
+
+  bool bakeAnimations();
+
+public:
+  CECharacterBatch(std::shared_ptr<C2CarFile> car, C2MapFile* map, C2MapRscFile* rsc);
+  ~CECharacterBatch();
+
+  // The batch for this car, created on first use. Callers fall back to their own geometry if !isGPUAnimated()
+  static std::shared_ptr<CECharacterBatch> forCar(const std::shared_ptr<C2CarFile>& car, C2MapFile* map, C2MapRscFile* rsc);
+  // Draws every live batch, one instanced call each
+  static void RenderAll(Transform& base_transform, Camera& camera);
+
+  bool isGPUAnimated() const { return m_gpu_animated; }
+
+  int addInstance();
+  void removeInstance(int slot);
+
+  void setInstanceTransform(int slot, const glm::mat4& model);
+  // Samples CEAnimation::frameAt into the instance; false once a non-looping animation has ended
+  bool setInstanceAnimation(int slot, const std::shared_ptr<CEAnimation>& animation, double elapsed, bool loop, bool noInterpolation);
+  bool setInstanceFrame(int slot, const std::shared_ptr<CEAnimation>& animation, int frame);
+  int getInstanceFrame(int slot) const;
+
+  void render(Transform& base_transform, Camera& camera);
+};
@@ -0,0 +1,380 @@
+//
+//  CEClusterGraph.cpp
+//  CE Character Lab
+//
+//  Abstract graph over square clusters of the walkable grid, for hierarchical (HPA*) path planning
+//
+
+#include "CEClusterGraph.h"
+
+#include "CEWalkabilityGrid.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <utility>
+
+// Costs in tenths of a tile
+static const int STRAIGHT_COST = 10;
+static const int DIAGONAL_COST = 14;
+
+// Runs at least this long get an entrance at each end rather than one in the middle
+static const int SPLIT_ENTRANCE_LENGTH = 6;
+
+static const glm::ivec2 STEPS[8] = {
+  glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1),
+  glm::ivec2(1, 1), glm::ivec2(-1, 1), glm::ivec2(1, -1), glm::ivec2(-1, -1)
+};
+
+// Octile distance, never more than the real cost
+static inline int estimate(glm::ivec2 a, glm::ivec2 b)
+{
+  int dx = std::abs(a.x - b.x), dy = std::abs(a.y - b.y);
+  return (STRAIGHT_COST * std::max(dx, dy)) + ((DIAGONAL_COST - STRAIGHT_COST) * std::min(dx, dy));
+}
+
+CEClusterGraph::CEClusterGraph(const CEWalkabilityGrid& grid)
+: m_width(grid.getWidth()),
+m_height(grid.getHeight()),
+m_clusters_x((m_width + CLUSTER_SIZE - 1) / CLUSTER_SIZE),
+m_clusters_y((m_height + CLUSTER_SIZE - 1) / CLUSTER_SIZE),
+m_cluster_nodes((size_t)m_clusters_x * m_clusters_y)
+{
+  for (int border = 0; border < m_clusters_x * m_clusters_y * 2; border++) {
+    this->buildBorder(grid, border);
+  }
+  for (int cluster = 0; cluster < m_clusters_x * m_clusters_y; cluster++) {
+    this->connectCluster(grid, cluster);
+  }
+}
+
+int CEClusterGraph::clusterAt(glm::ivec2 tile) const
+{
+  return ((tile.y / CLUSTER_SIZE) * m_clusters_x) + (tile.x / CLUSTER_SIZE);
+}
+
+void CEClusterGraph::getClusterBounds(int cluster, glm::ivec2& low, glm::ivec2& high) const
+{
+  low = glm::ivec2(cluster % m_clusters_x, cluster / m_clusters_x) * CLUSTER_SIZE;
+  high = glm::min(low + CLUSTER_SIZE, glm::ivec2(m_width, m_height));
+}
+
+int CEClusterGraph::addNode(glm::ivec2 tile, int cluster, int border)
+{
+  int id;
+  if (!m_free_nodes.empty()) {
+    id = m_free_nodes.back();
+    m_free_nodes.pop_back();
+  } else {
+    id = (int)m_nodes.size();
+    m_nodes.emplace_back();
+  }
+
+  _Node& node = m_nodes[id];
+  node.tile = tile;
+  node.cluster = cluster;
+  node.border = border;
+  node.edges.clear();
+  m_cluster_nodes[cluster].push_back(id);
+  return id;
+}
+
+int CEClusterGraph::getNeighbour(int border) const
+{
+  int cluster = border / 2;
+  if (border & 1) {
+    return (cluster / m_clusters_x + 1 < m_clusters_y) ? cluster + m_clusters_x : -1;
+  }
+  return (cluster % m_clusters_x + 1 < m_clusters_x) ? cluster + 1 : -1;
+}
+
+void CEClusterGraph::buildBorder(const CEWalkabilityGrid& grid, int border)
+{
+  int cluster = border / 2, neighbour = this->getNeighbour(border);
+  if (neighbour < 0) return;
+
+  bool towards_y = border & 1;
+  glm::ivec2 low, high;
+  this->getClusterBounds(cluster, low, high);
+
+  // Walk the last line of the cluster; across is the tile on the other side
+  glm::ivec2 along = towards_y ? glm::ivec2(1, 0) : glm::ivec2(0, 1);
+  glm::ivec2 across = towards_y ? glm::ivec2(0, 1) : glm::ivec2(1, 0);
+  glm::ivec2 first = towards_y ? glm::ivec2(low.x, high.y - 1) : glm::ivec2(high.x - 1, low.y);
+  int length = towards_y ? high.x - low.x : high.y - low.y;
+
+  auto addEntrance = [&](int i) {
+    glm::ivec2 inside = first + (along * i);
+    int a = this->addNode(inside, cluster, border);
+    int b = this->addNode(inside + across, neighbour, border);
+    m_nodes[a].edges.push_back({ b, STRAIGHT_COST });
+    m_nodes[b].edges.push_back({ a, STRAIGHT_COST });
+  };
+
+  int run_start = -1;
+  for (int i = 0; i <= length; i++) {
+    glm::ivec2 inside = first + (along * i);
+    bool open = i < length && grid(inside.x, inside.y) && grid(inside.x + across.x, inside.y + across.y);
+    if (open && run_start < 0) {
+      run_start = i;
+    } else if (!open && run_start >= 0) {
+      int run_end = i - 1;
+      if (run_end - run_start + 1 >= SPLIT_ENTRANCE_LENGTH) {
+        addEntrance(run_start);
+        addEntrance(run_end);
+      } else {
+        addEntrance((run_start + run_end) / 2);
+      }
+      run_start = -1;
+    }
+  }
+}
+
+void CEClusterGraph::removeBorder(int border)
+{
+  for (int c : { border / 2, this->getNeighbour(border) }) {
+    if (c < 0) continue;
+
+    std::vector<int>& nodes = m_cluster_nodes[c];
+    for (int id : nodes) {
+      if (m_nodes[id].border == border) {
+        m_nodes[id].border = -1;
+        m_nodes[id].edges.clear();
+        m_free_nodes.push_back(id);
+      }
+    }
+    nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](int id) { return m_nodes[id].border < 0; }), nodes.end());
+  }
+}
+
+/*
+ * Replaces the edges between the cluster's own nodes. The step across each entrance, to the node
+ * on the other side of the same border, is kept; edges to slots freed and reused since go too
+ */
+void CEClusterGraph::connectCluster(const CEWalkabilityGrid& grid, int cluster)
+{
+  const std::vector<int>& nodes = m_cluster_nodes[cluster];
+  for (int id : nodes) {
+    std::vector<_Edge>& edges = m_nodes[id].edges;
+    int border = m_nodes[id].border;
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const _Edge& e) {
+      return m_nodes[e.to].cluster == cluster || m_nodes[e.to].border != border;
+    }), edges.end());
+  }
+
+  glm::ivec2 low, high;
+  this->getClusterBounds(cluster, low, high);
+  int box_width = high.x - low.x;
+
+  // Moves are symmetric, so each flood gives the costs both ways to the nodes after it
+  std::vector<int> costs;
+  for (size_t i = 0; i + 1 < nodes.size(); i++) {
+    flood(grid, low, high, m_nodes[nodes[i]].tile, costs);
+    for (size_t j = i + 1; j < nodes.size(); j++) {
+      glm::ivec2 tile = m_nodes[nodes[j]].tile - low;
+      int cost = costs[(tile.y * box_width) + tile.x];
+      if (cost >= 0) {
+        m_nodes[nodes[i]].edges.push_back({ nodes[j], cost });
+        m_nodes[nodes[j]].edges.push_back({ nodes[i], cost });
+      }
+    }
+  }
+}
+
+void CEClusterGraph::rebuild(const CEWalkabilityGrid& grid, int x0, int y0, int x1, int y1)
+{
+  x0 = std::max(0, x0) / CLUSTER_SIZE;
+  y0 = std::max(0, y0) / CLUSTER_SIZE;
+  x1 = std::min(m_width - 1, x1) / CLUSTER_SIZE;
+  y1 = std::min(m_height - 1, y1) / CLUSTER_SIZE;
+
+  // Every border of the clusters, including those their left and lower neighbours own
+  std::vector<int> borders, clusters;
+  for (int cy = y0; cy <= y1; cy++) {
+    for (int cx = x0; cx <= x1; cx++) {
+      int cluster = (cy * m_clusters_x) + cx;
+      borders.push_back(cluster * 2);
+      borders.push_back((cluster * 2) + 1);
+      if (cx > 0) borders.push_back((cluster - 1) * 2);
+      if (cy > 0) borders.push_back(((cluster - m_clusters_x) * 2) + 1);
+    }
+  }
+  std::sort(borders.begin(), borders.end());
+  borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+
+  for (int border : borders) {
+    this->removeBorder(border);
+    this->buildBorder(grid, border);
+
+    // Both sides lost nodes their inner edges pointed at
+    clusters.push_back(border / 2);
+    if (this->getNeighbour(border) >= 0) clusters.push_back(this->getNeighbour(border));
+  }
+  std::sort(clusters.begin(), clusters.end());
+  clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+
+  for (int cluster : clusters) {
+    this->connectCluster(grid, cluster);
+  }
+}
+
+void CEClusterGraph::flood(const CEWalkabilityGrid& grid, glm::ivec2 low, glm::ivec2 high, glm::ivec2 from, std::vector<int>& costs)
+{
+  int box_width = high.x - low.x;
+  costs.assign((size_t)box_width * (high.y - low.y), -1);
+
+  typedef std::pair<int, int> Entry; // cost, tile index in the box
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  glm::ivec2 start = from - low;
+  costs[(start.y * box_width) + start.x] = 0;
+  open.push(Entry(0, (start.y * box_width) + start.x));
+
+  while (!open.empty()) {
+    Entry entry = open.top();
+    open.pop();
+    if (entry.first > costs[entry.second]) continue;
+
+    glm::ivec2 tile = low + glm::ivec2(entry.second % box_width, entry.second / box_width);
+    for (int i = 0; i < 8; i++) {
+      glm::ivec2 next = tile + STEPS[i];
+      if (next.x < low.x || next.y < low.y || next.x >= high.x || next.y >= high.y) continue;
+      if (!grid.canStep(tile.x, tile.y, STEPS[i].x, STEPS[i].y)) continue;
+
+      int index = ((next.y - low.y) * box_width) + (next.x - low.x);
+      int cost = entry.first + ((i < 4) ? STRAIGHT_COST : DIAGONAL_COST);
+      if (costs[index] < 0 || cost < costs[index]) {
+        costs[index] = cost;
+        open.push(Entry(cost, index));
+      }
+    }
+  }
+}
+
+bool CEClusterGraph::refine(const CEWalkabilityGrid& grid, int cluster, glm::ivec2 from, glm::ivec2 to, std::vector<glm::vec2>& path) const
+{
+  glm::ivec2 low, high;
+  this->getClusterBounds(cluster, low, high);
+  int box_width = high.x - low.x;
+
+  // Costs from the far end, so following them down from `from` walks the shortest path in order
+  std::vector<int> costs;
+  flood(grid, low, high, to, costs);
+  auto costAt = [&](glm::ivec2 tile) { return costs[((tile.y - low.y) * box_width) + (tile.x - low.x)]; };
+  if (costAt(from) < 0) return false;
+
+  glm::ivec2 tile = from;
+  while (tile != to) {
+    int cost = costAt(tile);
+    for (int i = 0; i < 8; i++) {
+      glm::ivec2 next = tile + STEPS[i];
+      if (next.x < low.x || next.y < low.y || next.x >= high.x || next.y >= high.y) continue;
+      if (!grid.canStep(tile.x, tile.y, STEPS[i].x, STEPS[i].y)) continue;
+
+      int next_cost = costAt(next);
+      if (next_cost >= 0 && next_cost + ((i < 4) ? STRAIGHT_COST : DIAGONAL_COST) == cost) {
+        tile = next;
+        break;
+      }
+    }
+    path.push_back(glm::vec2(tile));
+  }
+  return true;
+}
+
+/*
+ * A* over the nodes, with start and goal joined to the nodes of their clusters for this search.
+ * The work is bounded by the size of the graph and REFINED_SEGMENTS floods of one cluster, however
+ * far apart the two are
+ */
+bool CEClusterGraph::findPath(const CEWalkabilityGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::vec2>& path, bool& partial) const
+{
+  path.clear();
+  partial = false;
+  if (!grid(start.x, start.y) || !grid(goal.x, goal.y)) return false;
+  if (start == goal) return true;
+
+  const int start_id = (int)m_nodes.size(), goal_id = start_id + 1;
+  int start_cluster = this->clusterAt(start), goal_cluster = this->clusterAt(goal);
+  auto tileOf = [&](int id) { return (id == start_id) ? start : (id == goal_id) ? goal : m_nodes[id].tile; };
+  auto clusterOf = [&](int id) { return (id == start_id) ? start_cluster : (id == goal_id) ? goal_cluster : m_nodes[id].cluster; };
+
+  glm::ivec2 low, high;
+  std::vector<int> costs;
+  auto costTo = [&](glm::ivec2 tile) { return costs[((tile.y - low.y) * (high.x - low.x)) + (tile.x - low.x)]; };
+
+  std::vector<_Edge> start_edges;
+  this->getClusterBounds(start_cluster, low, high);
+  flood(grid, low, high, start, costs);
+  for (int id : m_cluster_nodes[start_cluster]) {
+    if (costTo(m_nodes[id].tile) >= 0) start_edges.push_back({ id, costTo(m_nodes[id].tile) });
+  }
+  if (start_cluster == goal_cluster && costTo(goal) >= 0) {
+    start_edges.push_back({ goal_id, costTo(goal) });
+  }
+
+  // A flood from the goal gives the costs into it, as moves are symmetric
+  std::vector<int> to_goal(m_nodes.size(), -1);
+  this->getClusterBounds(goal_cluster, low, high);
+  flood(grid, low, high, goal, costs);
+  for (int id : m_cluster_nodes[goal_cluster]) {
+    to_goal[id] = costTo(m_nodes[id].tile);
+  }
+
+  std::vector<int> g(m_nodes.size() + 2, INT_MAX), parent(m_nodes.size() + 2, -1);
+  typedef std::pair<int, int> Entry; // estimated total, node
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  g[start_id] = 0;
+  open.push(Entry(estimate(start, goal), start_id));
+
+  auto relax = [&](int from, int to, int cost) {
+    if (g[from] + cost < g[to]) {
+      g[to] = g[from] + cost;
+      parent[to] = from;
+      open.push(Entry(g[to] + estimate(tileOf(to), goal), to));
+    }
+  };
+
+  while (!open.empty()) {
+    Entry entry = open.top();
+    open.pop();
+    int id = entry.second;
+    if (id == goal_id) break;
+    if (entry.first > g[id] + estimate(tileOf(id), goal)) continue;
+
+    const std::vector<_Edge>& edges = (id == start_id) ? start_edges : m_nodes[id].edges;
+    for (const _Edge& edge : edges) {
+      relax(id, edge.to, edge.cost);
+    }
+    if (id != start_id && to_goal[id] >= 0) {
+      relax(id, goal_id, to_goal[id]);
+    }
+  }
+  if (g[goal_id] == INT_MAX) return false;
+
+  std::vector<int> route;
+  for (int id = goal_id; id >= 0; id = parent[id]) {
+    route.push_back(id);
+  }
+  std::reverse(route.begin(), route.end());
+
+  // Entrances are one straight step apart; each stretch inside a cluster is refined on its own
+  int refined = 0;
+  for (size_t i = 0; i + 1 < route.size(); i++) {
+    glm::ivec2 from = tileOf(route[i]), to = tileOf(route[i + 1]);
+    if (from == to) continue;
+
+    if (clusterOf(route[i]) != clusterOf(route[i + 1])) {
+      path.push_back(glm::vec2(to));
+      continue;
+    }
+    if (refined == REFINED_SEGMENTS) {
+      partial = true;
+      break;
+    }
+    if (!this->refine(grid, clusterOf(route[i]), from, to, path)) return false;
+    refined++;
+  }
+  return true;
+}
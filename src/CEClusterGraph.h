@@ -0,0 +1,81 @@
+//
+//  CEClusterGraph.h
+//  CE Character Lab
+//
+//  Abstract graph over square clusters of the walkable grid, for hierarchical (HPA*) path planning
+//
+
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class CEWalkabilityGrid;
+
+/*
+ * Wherever a run of tiles can be crossed from one cluster to the next there is an entrance: a node
+ * on each side, joined by one straight step. Inside a cluster every pair of its nodes is joined by
+ * the cost of the shortest path that stays in the cluster, so the graph connects exactly what the
+ * grid connects. A long search runs over the nodes, and only the first few clusters of the route
+ * are turned back into tiles; the rest is planned again from where that leaves off.
+ */
+class CEClusterGraph
+{
+public:
+  // Same as CETerrainPartition's partitions
+  constexpr static const int CLUSTER_SIZE = 32;
+  // Cluster crossings turned into tiles per findPath()
+  constexpr static const int REFINED_SEGMENTS = 2;
+
+private:
+  struct _Edge {
+    int to;
+    int cost;
+  };
+
+  struct _Node {
+    glm::ivec2 tile;
+    int cluster;
+    // Entrance the node is one side of; -1 for a free slot
+    int border;
+    std::vector<_Edge> edges;
+  };
+
+  int m_width;
+  int m_height;
+  int m_clusters_x;
+  int m_clusters_y;
+  // Slots are reused, so node numbers outside a rebuilt area stay valid
+  std::vector<_Node> m_nodes;
+  std::vector<int> m_free_nodes;
+  std::vector<std::vector<int>> m_cluster_nodes;
+
+  int clusterAt(glm::ivec2 tile) const;
+  // Tiles [low, high)
+  void getClusterBounds(int cluster, glm::ivec2& low, glm::ivec2& high) const;
+
+  // Borders are numbered cluster * 2 + 0 for the one towards +x, + 1 for the one towards +y.
+  // The cluster across the border, -1 at the edge of the map
+  int getNeighbour(int border) const;
+  void buildBorder(const CEWalkabilityGrid& grid, int border);
+  void removeBorder(int border);
+  void connectCluster(const CEWalkabilityGrid& grid, int cluster);
+  int addNode(glm::ivec2 tile, int cluster, int border);
+
+  // Dijkstra from `from` without leaving [low, high); costs are per tile of the box, -1 unreached
+  static void flood(const CEWalkabilityGrid& grid, glm::ivec2 low, glm::ivec2 high, glm::ivec2 from, std::vector<int>& costs);
+  // Appends the tiles after from, up to and including to, staying in the cluster
+  bool refine(const CEWalkabilityGrid& grid, int cluster, glm::ivec2 from, glm::ivec2 to, std::vector<glm::vec2>& path) const;
+
+public:
+  explicit CEClusterGraph(const CEWalkabilityGrid& grid);
+
+  // Rebuilds the entrances and costs of every cluster holding a tile of [x0, x1] x [y0, y1]
+  // (inclusive), after the grid has been refreshed there
+  void rebuild(const CEWalkabilityGrid& grid, int x0, int y0, int x1, int y1);
+
+  // Tile path from start in JPS order, without the start. False if goal can't be reached. partial
+  // is set when the path stops short of goal after REFINED_SEGMENTS clusters
+  bool findPath(const CEWalkabilityGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::vec2>& path, bool& partial) const;
+};
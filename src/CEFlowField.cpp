@@ -0,0 +1,78 @@
+//
+//  CEFlowField.cpp
+//  CE Character Lab
+//
+//  Distance-to-target field over a window of the walkable grid, for many AI converging on one target
+//
+
+#include "CEFlowField.h"
+
+#include "CEWalkabilityGrid.h"
+
+#include <functional>
+#include <queue>
+#include <utility>
+
+// Costs in tenths of a tile, as CEClusterGraph counts them
+static const int STRAIGHT_COST = 10;
+static const int DIAGONAL_COST = 14;
+
+// Straight first; each step followed by its opposite
+static const glm::ivec2 STEPS[8] = {
+  glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1),
+  glm::ivec2(1, 1), glm::ivec2(-1, -1), glm::ivec2(-1, 1), glm::ivec2(1, -1)
+};
+
+CEFlowField::CEFlowField(const CEWalkabilityGrid& grid, glm::ivec2 target)
+: m_target(target),
+m_origin(target - glm::ivec2(WINDOW_SIZE / 2)),
+m_steps(WINDOW_SIZE * WINDOW_SIZE, NO_STEP)
+{
+  if (!grid(target.x, target.y)) {
+    return;
+  }
+
+  std::vector<int> costs(WINDOW_SIZE * WINDOW_SIZE, -1);
+  typedef std::pair<int, int> Entry; // cost, window index
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  int start = this->indexOf(target);
+  costs[start] = 0;
+  open.push(Entry(0, start));
+
+  while (!open.empty()) {
+    Entry entry = open.top();
+    open.pop();
+    if (entry.first > costs[entry.second]) continue;
+
+    glm::ivec2 tile = m_origin + glm::ivec2(entry.second % WINDOW_SIZE, entry.second / WINDOW_SIZE);
+    for (int i = 0; i < 8; i++) {
+      // Moves are symmetric, so the way on from `next` is the opposite step back onto this tile
+      glm::ivec2 next = tile + STEPS[i];
+      int index = this->indexOf(next);
+      if (index < 0 || !grid.canStep(tile.x, tile.y, STEPS[i].x, STEPS[i].y)) continue;
+
+      int cost = entry.first + ((i < 4) ? STRAIGHT_COST : DIAGONAL_COST);
+      if (costs[index] < 0 || cost < costs[index]) {
+        costs[index] = cost;
+        m_steps[index] = (uint8_t)(i ^ 1);
+        open.push(Entry(cost, index));
+      }
+    }
+  }
+}
+
+int CEFlowField::indexOf(glm::ivec2 tile) const
+{
+  glm::ivec2 local = tile - m_origin;
+  if (local.x < 0 || local.y < 0 || local.x >= WINDOW_SIZE || local.y >= WINDOW_SIZE) return -1;
+  return (local.y * WINDOW_SIZE) + local.x;
+}
+
+bool CEFlowField::getStep(glm::ivec2 tile, glm::ivec2& next) const
+{
+  int index = this->indexOf(tile);
+  if (index < 0 || m_steps[index] == NO_STEP) return false;
+
+  next = tile + STEPS[m_steps[index]];
+  return true;
+}
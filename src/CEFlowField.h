@@ -0,0 +1,46 @@
+//
+//  CEFlowField.h
+//  CE Character Lab
+//
+//  Distance-to-target field over a window of the walkable grid, for many AI converging on one target
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class CEWalkabilityGrid;
+
+/*
+ * Dijkstra from the target over the WINDOW_SIZE square of tiles around it, moving as JPS does.
+ * Every reached tile also stores its step towards the target, so an agent anywhere in the window
+ * reads its next tile in one lookup instead of searching. Immutable once built.
+ */
+class CEFlowField
+{
+public:
+  constexpr static const int WINDOW_SIZE = 128;
+
+private:
+  glm::ivec2 m_target;
+  glm::ivec2 m_origin;
+  // Per window tile: index into the 8 steps, NO_STEP at the target and where unreached
+  std::vector<uint8_t> m_steps;
+
+  constexpr static const uint8_t NO_STEP = 0xff;
+
+  // -1 outside the window
+  int indexOf(glm::ivec2 tile) const;
+
+public:
+  CEFlowField(const CEWalkabilityGrid& grid, glm::ivec2 target);
+
+  glm::ivec2 getTarget() const { return m_target; }
+
+  // The tile to move to from `tile` to close in on the target. False outside the window, where
+  // the target can't be reached within it, and on the target itself
+  bool getStep(glm::ivec2 tile, glm::ivec2& next) const;
+};
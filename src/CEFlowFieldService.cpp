@@ -0,0 +1,85 @@
+//
+//  CEFlowFieldService.cpp
+//  CE Character Lab
+//
+//  Keeps a flow field towards the chased target up to date on a thread of its own
+//
+
+#include "CEFlowFieldService.h"
+
+#include "CEWalkabilityGrid.h"
+
+CEFlowFieldService::CEFlowFieldService(std::shared_ptr<CEWalkabilityGrid> walkability)
+: m_walkability(walkability)
+{
+  m_worker = std::thread(&CEFlowFieldService::workerLoop, this);
+}
+
+CEFlowFieldService::~CEFlowFieldService()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_rebuild_ready.notify_all();
+  m_worker.join();
+}
+
+void CEFlowFieldService::setTarget(glm::ivec2 tile)
+{
+  uint64_t generation = m_walkability->getGeneration();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_has_target && tile == m_target && generation == m_generation) {
+      return;
+    }
+    m_target = tile;
+    m_has_target = true;
+    m_rebuild = true;
+    m_generation = generation;
+  }
+  m_rebuild_ready.notify_one();
+}
+
+void CEFlowFieldService::clearTarget()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_has_target = false;
+  m_rebuild = false;
+  m_field.reset();
+}
+
+std::shared_ptr<const CEFlowField> CEFlowFieldService::getField() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_field;
+}
+
+/*
+ * A target that moves several tiles, or a grid that changes several times, while a field is being
+ * built gets one field for how things ended up
+ */
+void CEFlowFieldService::workerLoop()
+{
+  while (true) {
+    glm::ivec2 target;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_rebuild_ready.wait(lock, [&] { return m_stopping || m_rebuild; });
+      if (m_stopping) {
+        return;
+      }
+      target = m_target;
+      m_rebuild = false;
+    }
+
+    auto field = std::make_shared<const CEFlowField>(*m_walkability, target);
+
+    // A field built over a grid that has changed since is still better than none, and its
+    // replacement follows straight after. One towards a tile the target has left is not
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_has_target && field->getTarget() == m_target) {
+      m_field = field;
+    }
+  }
+}
@@ -0,0 +1,59 @@
+//
+//  CEFlowFieldService.h
+//  CE Character Lab
+//
+//  Keeps a flow field towards the chased target up to date on a thread of its own
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <glm/glm.hpp>
+
+#include "CEFlowField.h"
+
+class CEWalkabilityGrid;
+
+/*
+ * Every AI chasing the target shares one field, so the chase costs one Dijkstra over the window
+ * each time the target enters another tile rather than one search per chaser. The field is also
+ * rebuilt when the walkability grid changes under it (tile edits and page loads, once the
+ * pathfinding service has refreshed the grid). Chasers keep reading the last field while the
+ * next one is built.
+ */
+class CEFlowFieldService
+{
+private:
+  std::shared_ptr<CEWalkabilityGrid> m_walkability;
+
+  std::thread m_worker;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_rebuild_ready;
+  // Guarded by m_mutex
+  std::shared_ptr<const CEFlowField> m_field;
+  glm::ivec2 m_target = glm::ivec2(-1);
+  bool m_has_target = false;
+  bool m_rebuild = false;
+  // Grid generation the newest field asked for reads
+  uint64_t m_generation = 0;
+  bool m_stopping = false;
+
+  void workerLoop();
+
+public:
+  explicit CEFlowFieldService(std::shared_ptr<CEWalkabilityGrid> walkability);
+  ~CEFlowFieldService();
+
+  // Main thread, every frame; cheap unless the target entered another tile or the grid changed
+  void setTarget(glm::ivec2 tile);
+  // No target: the field is dropped and chasers fall back to their own searches
+  void clearTarget();
+
+  // Thread-safe. Null while there is no target or its first field is being built
+  std::shared_ptr<const CEFlowField> getField() const;
+};
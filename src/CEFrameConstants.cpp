@@ -0,0 +1,45 @@
+//
+//  CEFrameConstants.cpp
+//  CE Character Lab
+//
+//  std140 uniform buffer with the per-frame camera, time and fog values shared by the world shaders
+//
+
+#include "CEFrameConstants.h"
+
+#include "shader_program.h"
+#include "camera.h"
+
+CEFrameConstants::CEFrameConstants()
+{
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(_Block), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+CEFrameConstants::~CEFrameConstants()
+{
+  glDeleteBuffers(1, &m_buffer);
+}
+
+void CEFrameConstants::setFog(const glm::vec4& fog_color, float view_distance)
+{
+  m_block.fog_color = fog_color;
+  m_block.view_distance = view_distance;
+}
+
+void CEFrameConstants::update(const Camera& camera, float time)
+{
+  m_block.view = camera.GetVM();
+  m_block.projection = camera.GetProjection();
+  m_block.projection_view = m_block.projection * m_block.view;
+  m_block.camera_position = camera.GetPosition();
+  m_block.time = time;
+
+  glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(_Block), &m_block);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferBase(GL_UNIFORM_BUFFER, ShaderProgram::FRAME_CONSTANTS_BINDING, m_buffer);
+}
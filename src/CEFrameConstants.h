@@ -0,0 +1,42 @@
+//
+//  CEFrameConstants.h
+//  CE Character Lab
+//
+//  std140 uniform buffer with the per-frame camera, time and fog values shared by the world shaders
+//
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+struct Camera;
+
+class CEFrameConstants
+{
+private:
+  // Mirrors the FrameConstants block in the shaders; member order and padding follow std140
+  struct _Block {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 projection_view;
+    glm::vec3 camera_position;
+    float time;
+    glm::vec4 fog_color;
+    float view_distance;
+    float _padding[3];
+  };
+  static_assert(sizeof(_Block) == 240, "FrameConstants must match the std140 layout");
+
+  GLuint m_buffer = 0;
+  _Block m_block = {};
+
+public:
+  CEFrameConstants();
+  ~CEFrameConstants();
+
+  void setFog(const glm::vec4& fog_color, float view_distance);
+
+  // Upload this frame's values and bind the buffer to ShaderProgram::FRAME_CONSTANTS_BINDING
+  void update(const Camera& camera, float time);
+};
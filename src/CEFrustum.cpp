@@ -0,0 +1,70 @@
+//
+//  CEFrustum.cpp
+//  CE Character Lab
+//
+//  View frustum extracted from a view-projection matrix, used for visibility culling
+//
+
+#include "CEFrustum.h"
+
+CEFrustum::CEFrustum()
+{
+  m_planes.fill(glm::vec4(0.f));
+}
+
+CEFrustum::CEFrustum(const glm::mat4& view_projection)
+{
+  update(view_projection);
+}
+
+// Gribb/Hartmann plane extraction. GLM is column-major so rows are read as m[col][row]
+void CEFrustum::update(const glm::mat4& m)
+{
+  glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+  glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+  glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+  glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+  m_planes[0] = row3 + row0; // left
+  m_planes[1] = row3 - row0; // right
+  m_planes[2] = row3 + row1; // bottom
+  m_planes[3] = row3 - row1; // top
+  m_planes[4] = row3 + row2; // near
+  m_planes[5] = row3 - row2; // far
+
+  for (auto& plane : m_planes) {
+    float length = glm::length(glm::vec3(plane));
+    if (length > 0.f) {
+      plane /= length;
+    }
+  }
+}
+
+bool CEFrustum::intersectsAABB(const glm::vec3& min, const glm::vec3& max) const
+{
+  for (const auto& plane : m_planes) {
+    // The corner furthest along the plane normal; if it is behind, the whole box is
+    glm::vec3 positive(
+                       plane.x >= 0.f ? max.x : min.x,
+                       plane.y >= 0.f ? max.y : min.y,
+                       plane.z >= 0.f ? max.z : min.z
+                       );
+
+    if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.f) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool CEFrustum::intersectsSphere(const glm::vec3& center, float radius) const
+{
+  for (const auto& plane : m_planes) {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,29 @@
+//
+//  CEFrustum.h
+//  CE Character Lab
+//
+//  View frustum extracted from a view-projection matrix, used for visibility culling
+//
+
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+class CEFrustum
+{
+private:
+  // Left, right, bottom, top, near, far. xyz = normal (pointing inward), w = distance
+  std::array<glm::vec4, 6> m_planes;
+
+public:
+  CEFrustum();
+  explicit CEFrustum(const glm::mat4& view_projection);
+
+  void update(const glm::mat4& view_projection);
+
+  // Conservative tests: may report visible for volumes that are just outside a corner
+  bool intersectsAABB(const glm::vec3& min, const glm::vec3& max) const;
+  bool intersectsSphere(const glm::vec3& center, float radius) const;
+};
@@ -13,6 +13,7 @@
 
 #include <nlohmann/json.hpp>
 #include <filesystem>
+#include <chrono>
 
 #include "IndexedMeshLoader.h"
 
@@ -23,17 +24,42 @@
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-CEGeometry::CEGeometry(std::vector < Vertex > vertices, std::vector < uint32_t > indices, std::shared_ptr<CETexture> texture, std::string shaderName)
-: m_vertices(vertices), m_indices(indices), m_texture(texture)
+#if CE_ANIMATION_TIMING
+std::atomic<uint64_t> CEGeometry::s_animation_sample_ns(0);
+std::atomic<uint64_t> CEGeometry::s_animation_samples(0);
+#endif
+
+static bool gpuAnimationFromConfig(const json& data)
+{
+  if (data.contains("video") && data["video"].is_object()) {
+    if (data["video"].contains("gpuAnimation") && data["video"]["gpuAnimation"].is_boolean()) {
+      return data["video"]["gpuAnimation"];
+    }
+  }
+  return true;
+}
+
+CEGeometry::CEGeometry(std::vector < Vertex > vertices, std::vector < uint32_t > indices, std::shared_ptr<CETexture> texture, std::string shaderName, bool deferUpload)
+: m_shader_name(shaderName), m_vertices(vertices), m_indices(indices), m_texture(texture)
 {
-  this->loadObjectIntoMemoryBuffer(shaderName);
   m_current_frame = 0;
   m_has_physics = false;
+  if (!deferUpload) {
+    this->upload();
+  }
 }
 
 CEGeometry::~CEGeometry()
 {
+  if (!this->m_uploaded) {
+    return;
+  }
+  this->m_upload->cancel();
   glDeleteBuffers(NUM_BUFFERS, m_vertexArrayBuffers);
+  glDeleteBuffers(1, &this->m_instanced_vab);
+  if (this->m_instanced_animation_vab) {
+    glDeleteBuffers(1, &this->m_instanced_animation_vab);
+  }
   glDeleteVertexArrays(1, &this->m_vertexArrayObject);
 }
 
@@ -47,6 +73,24 @@ void CEGeometry::saveTextureAsBMP(const std::string &file_name)
   this->m_texture->saveToBMPFile(file_name);
 }
 
+void CEGeometry::upload()
+{
+  if (this->m_uploaded) return;
+
+  // Shared textures (CAR skins reused by batches) may already be resident
+  if (this->m_texture) {
+    this->m_texture->upload();
+  }
+  this->loadObjectIntoMemoryBuffer(this->m_shader_name);
+  this->m_uploaded = true;
+}
+
+bool CEGeometry::isResident() const
+{
+  if (!this->m_upload || !this->m_upload->isReady()) return false;
+  return !this->m_texture || this->m_texture->isResident();
+}
+
 void CEGeometry::loadObjectIntoMemoryBuffer(std::string shaderName)
 {
   std::ifstream f("config.json");
@@ -58,15 +102,24 @@ void CEGeometry::loadObjectIntoMemoryBuffer(std::string shaderName)
   this->m_shader = std::unique_ptr<ShaderProgram>(new ShaderProgram((shaderPath / (shaderName + ".vs")).string(), (shaderPath / (shaderName + ".fs")).string()));
   this->m_shader->use();
   this->m_shader->setBool("enable_transparency", true);
+  this->m_mvp_uniform = this->m_shader->getUniformLocation("MVP");
+  this->m_model_uniform = this->m_shader->getUniformLocation("model");
+  this->cacheAnimationUniforms(gpuAnimationFromConfig(data));
   
   glGenVertexArrays(1, &this->m_vertexArrayObject);
   glBindVertexArray(this->m_vertexArrayObject);
   
   glGenBuffers(NUM_BUFFERS, this->m_vertexArrayBuffers);
   
-  glBindBuffer(GL_ARRAY_BUFFER, this->m_vertexArrayBuffers[VERTEX_VB]);
-  glBufferData(GL_ARRAY_BUFFER, (int)this->m_vertices.size()*sizeof(Vertex), this->m_vertices.data(), GL_STREAM_DRAW);
+  // The VAO only records which buffers to read, so the data itself can arrive later through the
+  // upload queue. m_vertices and m_indices are never reallocated, and CPU animation writes into
+  // m_vertices in place, so the queue reads whatever is current when it gets there
+  CEUploadQueue& queue = CEUploadQueue::getInstance();
+  this->m_upload = queue.createTicket();
+  queue.uploadBuffer(this->m_upload, this->m_vertexArrayBuffers[VERTEX_VB], this->m_vertices.data(), this->m_vertices.size()*sizeof(Vertex), GL_STREAM_DRAW);
+  queue.uploadBuffer(this->m_upload, this->m_vertexArrayBuffers[INDEX_VB], this->m_indices.data(), this->m_indices.size()*sizeof(unsigned int), GL_DYNAMIC_DRAW);
   
+  glBindBuffer(GL_ARRAY_BUFFER, this->m_vertexArrayBuffers[VERTEX_VB]);
   glEnableVertexAttribArray(0); // position
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
   glEnableVertexAttribArray(1); // uv
@@ -77,7 +130,6 @@ void CEGeometry::loadObjectIntoMemoryBuffer(std::string shaderName)
   glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(glm::vec3)+sizeof(glm::vec2)+sizeof(glm::vec3)));
   
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->m_vertexArrayBuffers[INDEX_VB]);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, (int)this->m_indices.size()*sizeof(unsigned int), this->m_indices.data(), GL_DYNAMIC_DRAW);
   
   // instanced vab
   this->m_num_instances = 0;
@@ -195,7 +247,6 @@ bool CEGeometry::SetAnimation(std::weak_ptr<CEAnimation> animation, double atTim
   }
   
   double animationStartTime = startAt;
-  int totalFrames = ani->m_number_of_frames;
   
   // Calculate the elapsed time since the animation started
   double elapsedTime = atTime - animationStartTime;
@@ -216,50 +267,121 @@ bool CEGeometry::SetAnimation(std::weak_ptr<CEAnimation> animation, double atTim
     return false;
   }
   
-  // Calculate the total time for the animation cycle
-  double totalTime = totalFrames * timePerFrame;
-  
-  if (!loop && (elapsedTime * 1000.0) >= ani->m_total_time) {
+  int currentFrame = 0;
+  int nextFrame = 0;
+  float k2 = 0.f; // Interpolation factor
+  if (!ani->frameAt(elapsedTime, loop, currentFrame, nextFrame, k2)) {
     return false;
   }
-
-  // Wrap the elapsed time around the total animation time
-  double currentTime = fmod(elapsedTime, totalTime);
-  
-  // Determine the frame index and interpolation factor
-  double exactFrameIndex = currentTime / timePerFrame;
-  int currentFrame = static_cast<int>(exactFrameIndex) % totalFrames;
-  int nextFrame = (currentFrame + 1) % totalFrames;
+  if (noInterpolation) {
+    k2 = 0.f;
+  }
   
   m_current_frame = currentFrame;
   
-  auto aniData = *ani->GetAnimationData();
-  auto origVData = ani->GetOriginalVertices();
+#if CE_ANIMATION_TIMING
+  auto sampleStart = std::chrono::steady_clock::now();
+#endif
+  
+  // Sample straight from the animation's storage; nothing here may allocate
+  const std::vector<short int>& aniData = ani->GetAnimationData();
+  const std::vector<TFace>& faces = ani->GetFaces();
   assert(aniData.size() % 3 == 0);
-  size_t numVertices = origVData->size();
+  size_t numVertices = ani->GetOriginalVertices().size();
   
-  auto faces = *ani->GetFaces();
-  if (noInterpolation) {
-    // Use discrete frames without interpolation (for weapons)
-    applyAnimFaceOrdered_NoInterp(m_vertices, faces, aniData.data(), static_cast<int>(numVertices), currentFrame);
+  if (this->m_gpu_animation_enabled && ani->bakeGPUFrames()) {
+    // The vertex shader samples both keyframes; only the frame pair and blend factor change
+    this->m_gpu_animation = ani;
+    this->m_shader->use();
+    this->m_shader->setBool(this->m_gpu_animation_uniform, true);
+    this->m_shader->setInt(this->m_animation_vertex_count_uniform, static_cast<int>(numVertices));
+    this->m_shader->setInt(this->m_animation_frame_a_uniform, currentFrame);
+    this->m_shader->setInt(this->m_animation_frame_b_uniform, noInterpolation ? currentFrame : nextFrame);
+    this->m_shader->setFloat(this->m_animation_blend_uniform, k2);
   } else {
-    float k2 = static_cast<float>(exactFrameIndex - currentFrame); // Interpolation factor
-    applyAnimFaceOrdered(m_vertices, faces, aniData.data(), static_cast<int>(numVertices), currentFrame, nextFrame, k2);
+    if (this->m_gpu_animation) {
+      this->m_gpu_animation.reset();
+      this->m_shader->use();
+      this->m_shader->setBool(this->m_gpu_animation_uniform, false);
+    }
+    
+    if (noInterpolation) {
+      // Use discrete frames without interpolation (for weapons)
+      applyAnimFaceOrdered_NoInterp(m_vertices, faces, aniData.data(), static_cast<int>(numVertices), currentFrame);
+    } else {
+      applyAnimFaceOrdered(m_vertices, faces, aniData.data(), static_cast<int>(numVertices), currentFrame, nextFrame, k2);
+    }
+    
+    // Until the queued upload has run it still reads m_vertices, so there is nothing to map yet
+    if (this->m_upload->isReady()) {
+      glBindBuffer(GL_ARRAY_BUFFER, this->m_vertexArrayBuffers[VERTEX_VB]);
+      auto sizeBytes = static_cast<GLsizei>(m_vertices.size() * sizeof(Vertex));
+      void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeBytes,
+          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      std::memcpy(ptr, m_vertices.data(), sizeBytes);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
   }
   
-  glBindBuffer(GL_ARRAY_BUFFER, this->m_vertexArrayBuffers[VERTEX_VB]);
-  auto sizeBytes = static_cast<GLsizei>(m_vertices.size() * sizeof(Vertex));
-  void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeBytes,
-      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
-  std::memcpy(ptr, m_vertices.data(), sizeBytes);
-  glUnmapBuffer(GL_ARRAY_BUFFER);
+#if CE_ANIMATION_TIMING
+  auto sampleNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sampleStart).count();
+  s_animation_sample_ns += (uint64_t)sampleNs;
+  s_animation_samples++;
+#endif
   
   return true;
 }
 
+#if CE_ANIMATION_TIMING
+/*
+ * Per-character animation cost (sampling + vertex upload) since the last call, for the performance monitor
+ */
+CEGeometry::AnimationTiming CEGeometry::TakeAnimationTiming()
+{
+  AnimationTiming timing;
+  timing.total_ns = s_animation_sample_ns.exchange(0);
+  timing.samples = s_animation_samples.exchange(0);
+  return timing;
+}
+#endif
+
+/*
+ * Resolve the GPU animation uniforms of the current shader. Shaders without them (ui) keep the CPU path
+ */
+void CEGeometry::cacheAnimationUniforms(bool gpu_animation)
+{
+  this->m_gpu_animation.reset();
+  this->m_gpu_animation_uniform = this->m_shader->getUniformLocation("gpuAnimation");
+  this->m_animation_vertex_count_uniform = this->m_shader->getUniformLocation("animationVertexCount");
+  this->m_animation_frame_a_uniform = this->m_shader->getUniformLocation("animationFrameA");
+  this->m_animation_frame_b_uniform = this->m_shader->getUniformLocation("animationFrameB");
+  this->m_animation_blend_uniform = this->m_shader->getUniformLocation("animationBlend");
+  
+  this->m_gpu_animation_enabled = gpu_animation && this->m_gpu_animation_uniform >= 0;
+  if (this->m_gpu_animation_enabled) {
+    this->m_shader->setInt("animationFrames", ANIMATION_FRAMES_UNIT);
+    this->m_shader->setInt("animationVertexMap", ANIMATION_VERTEX_MAP_UNIT);
+    this->m_shader->setBool(this->m_gpu_animation_uniform, false);
+  }
+}
+
+void CEGeometry::bindGPUAnimation()
+{
+  if (!this->m_gpu_animation) return;
+  
+  glActiveTexture(GL_TEXTURE0 + ANIMATION_FRAMES_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, this->m_gpu_animation->getGPUFrameTexture());
+  glActiveTexture(GL_TEXTURE0 + ANIMATION_VERTEX_MAP_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, this->m_gpu_animation->getGPUVertexMapTexture());
+  glActiveTexture(GL_TEXTURE0);
+}
+
 void CEGeometry::DrawNaked()
 {
+  if (!this->isResident()) return;
+  
   m_texture->use();
+  this->bindGPUAnimation();
   glBindVertexArray(this->m_vertexArrayObject);
   
   glDrawElementsBaseVertex(GL_TRIANGLES, (int)this->m_indices.size(), GL_UNSIGNED_INT, 0, 0);
@@ -289,11 +411,10 @@ void CEGeometry::ConfigureShaderUniforms(C2MapFile* map, C2MapRscFile* rsc)
   g = std::min(g * brightnessFactor, 1.0f);
   b = std::min(b * brightnessFactor, 1.0f);
   
-  auto dist = (map->getTileLength() * (map->getWidth() / 8.f));
   auto dColor = glm::vec4(r, g, b, a);
   
+  // The fog distance itself comes from the FrameConstants block
   m_shader->use();
-  m_shader->setFloat("view_distance", dist);
   m_shader->setVec4("distanceColor", dColor);
   m_shader->setFloat("terrainWidth", map->getWidth());
   m_shader->setFloat("terrainHeight", map->getHeight());
@@ -303,21 +424,22 @@ void CEGeometry::ConfigureShaderUniforms(C2MapFile* map, C2MapRscFile* rsc)
 void CEGeometry::Update(Transform &transform, Camera &camera)
 {
   this->m_shader->use();
-  double t = glfwGetTime();
-  glm::mat4 MVP = transform.GetStaticModelVP(camera);
   glm::mat4 model = transform.GetStaticModel();
   
-  this->m_shader->setMat4("MVP", MVP);
-  this->m_shader->setMat4("model", model);
-  this->m_shader->setMat4("view", camera.GetVM());
-  this->m_shader->setMat4("projection", camera.GetProjection());
-  this->m_shader->setFloat("time", (float)t);
+  // View, projection and time come from the FrameConstants block
+  if (this->m_mvp_uniform >= 0) {
+    this->m_shader->setMat4(this->m_mvp_uniform, transform.GetStaticModelVP(camera));
+  }
+  this->m_shader->setMat4(this->m_model_uniform, model);
 }
 
 void CEGeometry::DrawInstances()
 {
+  if (this->m_num_instances == 0 || !this->isResident()) return;
+  
   this->m_shader->use();
   this->m_texture->use();
+  this->bindGPUAnimation();
   glBindVertexArray(this->m_vertexArrayObject);
   
   glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (int)this->m_indices.size(), GL_UNSIGNED_INT, 0, this->m_num_instances, 0);
@@ -327,12 +449,15 @@ void CEGeometry::DrawInstances()
 
 void CEGeometry::DrawInstancesWithShader(ShaderProgram* externalShader)
 {
+  if (this->m_num_instances == 0 || !this->isResident()) return;
+  
   if (externalShader) {
     externalShader->use();
   } else {
     this->m_shader->use();
   }
   this->m_texture->use();
+  this->bindGPUAnimation();
   glBindVertexArray(this->m_vertexArrayObject);
   
   glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (int)this->m_indices.size(), GL_UNSIGNED_INT, 0, this->m_num_instances, 0);
@@ -340,13 +465,30 @@ void CEGeometry::DrawInstancesWithShader(ShaderProgram* externalShader)
   glBindVertexArray(0);
 }
 
-void CEGeometry::UpdateInstances(std::vector<glm::mat4> transforms)
+void CEGeometry::UpdateInstances(const std::vector<glm::mat4>& transforms)
 {
   this->m_num_instances = (int)transforms.size();
   glBindBuffer(GL_ARRAY_BUFFER, this->m_instanced_vab);
   glBufferData(GL_ARRAY_BUFFER, this->m_num_instances*sizeof(glm::mat4), transforms.data(), GL_DYNAMIC_DRAW);
 }
 
+void CEGeometry::UpdateInstanceAnimations(const std::vector<glm::vec3>& animations)
+{
+  if (!this->m_instanced_animation_vab) {
+    // Only shared character meshes need the extra stream, so it is added on first use
+    glGenBuffers(1, &this->m_instanced_animation_vab);
+    glBindVertexArray(this->m_vertexArrayObject);
+    glBindBuffer(GL_ARRAY_BUFFER, this->m_instanced_animation_vab);
+    glEnableVertexAttribArray(8);
+    glVertexAttribPointer(8, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glVertexAttribDivisor(8, 1);
+    glBindVertexArray(0);
+  }
+  
+  glBindBuffer(GL_ARRAY_BUFFER, this->m_instanced_animation_vab);
+  glBufferData(GL_ARRAY_BUFFER, animations.size()*sizeof(glm::vec3), animations.data(), GL_DYNAMIC_DRAW);
+}
+
 const std::vector<Vertex>& CEGeometry::GetVertices() const {
   return m_vertices;
 }
@@ -371,6 +513,9 @@ void CEGeometry::setShader(std::string shaderName)
   this->m_shader = std::unique_ptr<ShaderProgram>(new ShaderProgram((shaderPath / (shaderName + ".vs")).string(), (shaderPath / (shaderName + ".fs")).string()));
   this->m_shader->use();
   this->m_shader->setBool("enable_transparency", true);
+  this->m_mvp_uniform = this->m_shader->getUniformLocation("MVP");
+  this->m_model_uniform = this->m_shader->getUniformLocation("model");
+  this->cacheAnimationUniforms(gpuAnimationFromConfig(data));
 }
 
 void CEGeometry::EnablePhysics()
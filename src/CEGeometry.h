@@ -15,7 +15,9 @@
 #include <cstdint>
 #include <fstream>
 #include <string>
+#include <atomic>
 #include "g_shared.h"
+#include "CEUploadQueue.h"
 
 // Forward declarations
 class btTriangleIndexVertexArray;
@@ -45,30 +47,71 @@ private:
     NUM_BUFFERS=2
   };
 
-  GLuint m_instanced_vab;
-  GLuint m_num_instances;
+  GLuint m_instanced_vab = 0;
+  GLuint m_instanced_animation_vab = 0;
+  GLuint m_num_instances = 0;
 
-  GLuint m_vertexArrayObject;
-  GLuint m_vertexArrayBuffers[NUM_BUFFERS];
+  GLuint m_vertexArrayObject = 0;
+  GLuint m_vertexArrayBuffers[NUM_BUFFERS] = {};
+  std::string m_shader_name;
+  bool m_uploaded = false;
+  std::shared_ptr<CEUploadQueue::Ticket> m_upload; // vertex and index data
 
   std::vector < Vertex > m_vertices;
   std::vector < unsigned int > m_indices;
   std::unique_ptr<ShaderProgram> m_shader;
+  GLint m_mvp_uniform = -1;
+  GLint m_model_uniform = -1;
+  
+  // GPU vertex animation: frames are sampled in the vertex shader from the animation's baked
+  // buffer textures. Only used when enabled in config and the shader supports it
+  bool m_gpu_animation_enabled = false;
+  std::shared_ptr<CEAnimation> m_gpu_animation;
+  GLint m_gpu_animation_uniform = -1;
+  GLint m_animation_vertex_count_uniform = -1;
+  GLint m_animation_frame_a_uniform = -1;
+  GLint m_animation_frame_b_uniform = -1;
+  GLint m_animation_blend_uniform = -1;
   
   // Note: memory managed by Bullet directly
   btTriangleIndexVertexArray* m_bullet_tiv = nullptr;
   btBvhTriangleMeshShape* m_gimpact = nullptr;
 
   std::shared_ptr<CETexture> m_texture;
+  
+#if CE_ANIMATION_TIMING
+  static std::atomic<uint64_t> s_animation_sample_ns;
+  static std::atomic<uint64_t> s_animation_samples;
+#endif
+  
   void applyAnimFaceOrdered(std::vector<Vertex>& m_vertices,
                             const std::vector<TFace>& faces,
                             const short* aniData,
                             int numVerts, int frameA, int frameB, float t);
+  void cacheAnimationUniforms(bool gpu_animation);
+  void bindGPUAnimation();
 public:
-  CEGeometry(std::vector < Vertex > vertices, std::vector < unsigned int > indices, std::shared_ptr<CETexture> texture, std::string shaderName);
+  static const GLint ANIMATION_FRAMES_UNIT = 6;
+  static const GLint ANIMATION_VERTEX_MAP_UNIT = 7;
+  
+#if CE_ANIMATION_TIMING
+  // CPU cost of SetAnimation, for the performance monitor; tools/animation_bench.cpp times it offline
+  struct AnimationTiming {
+    uint64_t total_ns = 0;
+    uint64_t samples = 0;
+  };
+#endif
+  
+  // deferUpload: build on the CPU only and leave the texture, shader and buffers to upload()
+  CEGeometry(std::vector < Vertex > vertices, std::vector < unsigned int > indices, std::shared_ptr<CETexture> texture, std::string shaderName, bool deferUpload = false);
   ~CEGeometry();
   
   void loadObjectIntoMemoryBuffer(std::string shaderName);
+  // GL thread only; does nothing once uploaded
+  void upload();
+  bool isUploaded() const { return m_uploaded; }
+  // Buffers and texture have reached the GPU; nothing draws until they have
+  bool isResident() const;
   
   std::weak_ptr<CETexture> getTexture();
 
@@ -76,6 +119,9 @@ public:
   void Update(Transform& transform, Camera& camera);
   bool SetAnimation(std::weak_ptr<CEAnimation> animation, double atTime, double startAt, double lastUpdateAt, bool deferUpdate, bool maxFPS, bool notVisible, float playbackSpeed, bool loop, bool noInterpolation = false);
   bool SetAnimation(std::weak_ptr<CEAnimation> animation, int atFrame);
+#if CE_ANIMATION_TIMING
+  static AnimationTiming TakeAnimationTiming();
+#endif
   void Draw();
   void DrawNaked();
   
@@ -88,10 +134,13 @@ public:
   
   const int GetCurrentFrame() const;
 
-  void UpdateInstances(std::vector<glm::mat4> transforms);
+  void UpdateInstances(const std::vector<glm::mat4>& transforms);
+  // Per-instance (frameA, frameB, blend) for GPU animation of a shared mesh; see CECharacterBatch
+  void UpdateInstanceAnimations(const std::vector<glm::vec3>& animations);
   void DrawInstances();
   void DrawInstancesWithShader(ShaderProgram* externalShader);
   
+  bool IsGPUAnimationEnabled() const { return m_gpu_animation_enabled; }
   ShaderProgram* getShader() { return m_shader.get(); }
   void setShader(std::string shaderName);
   
@@ -0,0 +1,109 @@
+//
+//  CEJobSystem.cpp
+//  CE Character Lab
+//
+//  Fixed pool of worker threads for fork/join parallel loops over per-frame work
+//
+
+#include "CEJobSystem.h"
+
+CEJobSystem::CEJobSystem(unsigned int worker_count)
+{
+  for (unsigned int i = 0; i < worker_count; i++) {
+    m_workers.emplace_back(&CEJobSystem::workerLoop, this);
+  }
+}
+
+CEJobSystem::~CEJobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_work_ready.notify_all();
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void CEJobSystem::runJobs()
+{
+  size_t i;
+  while ((i = m_next_index.fetch_add(1)) < m_job_count) {
+    try {
+      (*m_job)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error) {
+        m_error = std::current_exception();
+      }
+    }
+  }
+}
+
+void CEJobSystem::workerLoop()
+{
+  uint64_t seen_generation = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_work_ready.wait(lock, [&] { return m_stopping || m_generation != seen_generation; });
+      if (m_stopping) {
+        return;
+      }
+      seen_generation = m_generation;
+    }
+
+    runJobs();
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (--m_busy_workers == 0) {
+        m_work_done.notify_one();
+      }
+    }
+  }
+}
+
+void CEJobSystem::parallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+  if (count == 0) {
+    return;
+  }
+
+  if (m_workers.empty() || count == 1) {
+    for (size_t i = 0; i < count; i++) {
+      job(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_job = &job;
+    m_job_count = count;
+    m_next_index = 0;
+    m_busy_workers = m_workers.size();
+    m_error = nullptr;
+    m_generation++;
+  }
+  m_work_ready.notify_all();
+
+  // The calling thread works too rather than idling until the workers finish
+  runJobs();
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_work_done.wait(lock, [&] { return m_busy_workers == 0; });
+    m_job = nullptr;
+    error = m_error;
+    m_error = nullptr;
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
@@ -0,0 +1,54 @@
+//
+//  CEJobSystem.h
+//  CE Character Lab
+//
+//  Fixed pool of worker threads for fork/join parallel loops over per-frame work
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CEJobSystem
+{
+private:
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_work_ready;
+  std::condition_variable m_work_done;
+
+  // Current parallelFor; workers pull indices until m_job_count is reached
+  const std::function<void(size_t)>* m_job = nullptr;
+  size_t m_job_count = 0;
+  std::atomic<size_t> m_next_index{0};
+  size_t m_busy_workers = 0;
+  uint64_t m_generation = 0;
+  bool m_stopping = false;
+  std::exception_ptr m_error;
+
+  void workerLoop();
+  void runJobs();
+
+public:
+  // 0 workers runs every job on the calling thread
+  explicit CEJobSystem(unsigned int worker_count);
+  ~CEJobSystem();
+
+  CEJobSystem(const CEJobSystem&) = delete;
+  CEJobSystem& operator=(const CEJobSystem&) = delete;
+
+  // Runs job(i) for every i in [0, count) on the workers and the calling thread, and returns once all
+  // have finished. The first exception thrown by a job is rethrown here
+  void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+  unsigned int getWorkerCount() const { return (unsigned int)m_workers.size(); }
+};
@@ -0,0 +1,148 @@
+//
+//  CEJumpPointTable.cpp
+//  CE Character Lab
+//
+//  JPS+ jump distances for every tile of a single-page map, in all 8 directions
+//
+
+#include "CEJumpPointTable.h"
+
+#include "CEMapCache.h"
+#include "CEWalkabilityGrid.h"
+
+#include <algorithm>
+
+// One more tile along the same run, away from zero
+static inline int16_t extend(int16_t next)
+{
+  return (next > 0) ? next + 1 : next - 1;
+}
+
+CEJumpPointTable::CEJumpPointTable(int width, int height)
+: m_width(width),
+m_height(height),
+m_distances((size_t)width * height * 8, 0)
+{
+}
+
+/*
+ * The rules are jps.hpp's jumpX/jumpY, run backwards along each line: a tile is a jump point if a
+ * side tile opens up after it (forced neighbour), a wall if the next tile is blocked, and
+ * otherwise one more than the next tile
+ */
+void CEJumpPointTable::fillRows(const CEWalkabilityGrid& grid, int y0, int y1)
+{
+  y0 = std::max(0, y0);
+  y1 = std::min(m_height - 1, y1);
+
+  for (int y = y0; y <= y1; y++) {
+    for (int dx = -1; dx <= 1; dx += 2) {
+      int dir = direction(dx, 0);
+      for (int x = (dx > 0) ? m_width - 1 : 0; x >= 0 && x < m_width; x -= dx) {
+        int16_t& d = this->at(x, y, dir);
+        if (!grid(x, y)) {
+          d = 0;
+        } else if ((grid(x + dx, y + 1) && !grid(x, y + 1)) || (grid(x + dx, y - 1) && !grid(x, y - 1))) {
+          d = 1;
+        } else if (!grid(x + dx, y)) {
+          d = -1;
+        } else {
+          d = extend(this->at(x + dx, y, dir));
+        }
+      }
+    }
+  }
+}
+
+void CEJumpPointTable::fillColumns(const CEWalkabilityGrid& grid, int x0, int x1)
+{
+  x0 = std::max(0, x0);
+  x1 = std::min(m_width - 1, x1);
+
+  for (int x = x0; x <= x1; x++) {
+    for (int dy = -1; dy <= 1; dy += 2) {
+      int dir = direction(0, dy);
+      for (int y = (dy > 0) ? m_height - 1 : 0; y >= 0 && y < m_height; y -= dy) {
+        int16_t& d = this->at(x, y, dir);
+        if (!grid(x, y)) {
+          d = 0;
+        } else if ((grid(x + 1, y + dy) && !grid(x + 1, y)) || (grid(x - 1, y + dy) && !grid(x - 1, y))) {
+          d = 1;
+        } else if (!grid(x, y + dy)) {
+          d = -1;
+        } else {
+          d = extend(this->at(x, y + dy, dir));
+        }
+      }
+    }
+  }
+}
+
+/*
+ * jps.hpp's jumpD stops on a forced neighbour or when either straight jump out of the tile finds
+ * a jump point, and moves on while the diagonal step is open. Needs the straight distances
+ */
+void CEJumpPointTable::fillDiagonal(const CEWalkabilityGrid& grid, int dx, int dy, int x_limit, int y_limit)
+{
+  int dir = direction(dx, dy), dir_x = direction(dx, 0), dir_y = direction(0, dy);
+  int x_start = (dx > 0) ? std::min(m_width - 1, x_limit) : std::max(0, x_limit);
+  int y_start = (dy > 0) ? std::min(m_height - 1, y_limit) : std::max(0, y_limit);
+
+  for (int y = y_start; y >= 0 && y < m_height; y -= dy) {
+    for (int x = x_start; x >= 0 && x < m_width; x -= dx) {
+      int16_t& d = this->at(x, y, dir);
+      if (!grid(x, y)) {
+        d = 0;
+        continue;
+      }
+
+      if ((grid(x - dx, y + dy) && !grid(x - dx, y)) || (grid(x + dx, y - dy) && !grid(x, y - dy))) {
+        d = 1;
+        continue;
+      }
+
+      bool gdx = grid(x + dx, y), gdy = grid(x, y + dy);
+      if ((gdx && this->at(x + dx, y, dir_x) > 0) || (gdy && this->at(x, y + dy, dir_y) > 0)) {
+        d = 1;
+      } else if ((gdx || gdy) && grid(x + dx, y + dy)) {
+        d = extend(this->at(x + dx, y + dy, dir));
+      } else {
+        d = -1;
+      }
+    }
+  }
+}
+
+void CEJumpPointTable::build(const CEWalkabilityGrid& grid)
+{
+  this->fillRows(grid, 0, m_height - 1);
+  this->fillColumns(grid, 0, m_width - 1);
+  for (int dy = -1; dy <= 1; dy += 2) {
+    for (int dx = -1; dx <= 1; dx += 2) {
+      this->fillDiagonal(grid, dx, dy, (dx > 0) ? m_width - 1 : 0, (dy > 0) ? m_height - 1 : 0);
+    }
+  }
+}
+
+void CEJumpPointTable::patch(const CEWalkabilityGrid& grid, int x0, int y0, int x1, int y1)
+{
+  // A distance reads the tile before it (forced neighbours) and everything after it, up to the
+  // line next to it; so tiles more than one past the far side of the rectangle keep theirs
+  this->fillRows(grid, y0 - 1, y1 + 1);
+  this->fillColumns(grid, x0 - 1, x1 + 1);
+  for (int dy = -1; dy <= 1; dy += 2) {
+    for (int dx = -1; dx <= 1; dx += 2) {
+      this->fillDiagonal(grid, dx, dy, (dx > 0) ? x1 + 1 : x0 - 1, (dy > 0) ? y1 + 1 : y0 - 1);
+    }
+  }
+}
+
+bool CEJumpPointTable::restore(const CEMapCache& cache)
+{
+  return cache.read(CEMapCache::Section::JUMP_DISTANCES, m_distances.data(), m_distances.size() * sizeof(int16_t));
+}
+
+void CEJumpPointTable::store(CEMapCache& cache) const
+{
+  cache.write(CEMapCache::Section::JUMP_DISTANCES, m_distances.data(), m_distances.size() * sizeof(int16_t));
+}
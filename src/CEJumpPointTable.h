@@ -0,0 +1,67 @@
+//
+//  CEJumpPointTable.h
+//  CE Character Lab
+//
+//  JPS+ jump distances for every tile of a single-page map, in all 8 directions
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CEMapCache;
+class CEWalkabilityGrid;
+
+/*
+ * For each walkable tile and direction, where a JPS jump from that tile ends when the goal isn't
+ * in the way: d > 0 stops at the jump point d - 1 tiles on, d < 0 runs into a wall after passing
+ * -d - 1 tiles, 0 is a blocked tile. Only the goal decides anything at search time. Derived from a
+ * CEWalkabilityGrid, so the danger tiles and slopes folded into the walkable flags count as walls.
+ */
+class CEJumpPointTable
+{
+private:
+  int m_width;
+  int m_height;
+  // [(y * width + x) * 8 + direction]
+  std::vector<int16_t> m_distances;
+
+  inline int16_t& at(int x, int y, int direction) { return m_distances[((((size_t)y * m_width) + x) * 8) + direction]; }
+
+  // Straight directions along rows [y0, y1] and columns [x0, x1]
+  void fillRows(const CEWalkabilityGrid& grid, int y0, int y1);
+  void fillColumns(const CEWalkabilityGrid& grid, int x0, int x1);
+  // One diagonal direction, from the tiles at x_limit, y_limit back against it to the map edges
+  void fillDiagonal(const CEWalkabilityGrid& grid, int dx, int dy, int x_limit, int y_limit);
+
+public:
+  // Distances are 16 bit, so neither side may be longer than this
+  constexpr static const int MAX_SIZE = 32766;
+
+  CEJumpPointTable(int width, int height);
+
+  // 0, 1 along x; 2, 3 along y; 4 to 7 diagonal
+  static inline int direction(int dx, int dy)
+  {
+    if (!dy) return (dx < 0) ? 1 : 0;
+    if (!dx) return (dy < 0) ? 3 : 2;
+    return 4 + (dx < 0) + ((dy < 0) << 1);
+  }
+
+  inline int16_t getDistance(unsigned x, unsigned y, int direction) const
+  {
+    return m_distances[((((size_t)y * m_width) + x) * 8) + direction];
+  }
+
+  void build(const CEWalkabilityGrid& grid);
+  // Recomputes every distance that can depend on tiles [x0, x1] x [y0, y1] (inclusive), after the
+  // grid has been refreshed there. Straight lines through the rectangle and the diagonal quadrants
+  // leading into it
+  void patch(const CEWalkabilityGrid& grid, int x0, int y0, int x1, int y1);
+
+  // Carried through the map cache; restore() fails if the cache holds no table of this size
+  bool restore(const CEMapCache& cache);
+  void store(CEMapCache& cache) const;
+};
@@ -0,0 +1,248 @@
+//
+//  CELoadPipeline.cpp
+//  CE Character Lab
+//
+//  Worker pool for startup loading: CPU work runs on workers, GL/AL uploads on the main thread
+//
+
+#include "CELoadPipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <memory>
+
+CELoadPipeline::CELoadPipeline(unsigned int worker_count)
+: m_start(std::chrono::steady_clock::now())
+{
+  for (unsigned int i = 0; i < worker_count; i++) {
+    m_workers.emplace_back(&CELoadPipeline::workerLoop, this);
+  }
+}
+
+CELoadPipeline::~CELoadPipeline()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_work_ready.notify_all();
+
+  // Workers finish the queue before they stop, so no future is left unfulfilled
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void CELoadPipeline::workerLoop()
+{
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_work_ready.wait(lock, [&] { return m_stopping || !m_jobs.empty(); });
+      if (m_jobs.empty()) {
+        return;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    job();
+  }
+}
+
+void CELoadPipeline::timed(const std::string& stage, const std::function<void()>& job)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  // Record the stage even if the job throws
+  struct _Record {
+    CELoadPipeline* pipeline;
+    const std::string& stage;
+    std::chrono::steady_clock::time_point start;
+
+    ~_Record()
+    {
+      auto end = std::chrono::steady_clock::now();
+      double start_ms = std::chrono::duration<double, std::milli>(start - pipeline->m_start).count();
+      double end_ms = std::chrono::duration<double, std::milli>(end - pipeline->m_start).count();
+
+      std::lock_guard<std::mutex> lock(pipeline->m_timing_mutex);
+      _StageTiming& timing = pipeline->m_timings[stage];
+      timing.start_ms = timing.start_ms < 0.0 ? start_ms : std::min(timing.start_ms, start_ms);
+      timing.end_ms = std::max(timing.end_ms, end_ms);
+      timing.busy_ms += end_ms - start_ms;
+      timing.jobs++;
+    }
+  } record{ this, stage, start };
+
+  job();
+}
+
+std::shared_future<void> CELoadPipeline::async(const std::string& stage, std::function<void()> job)
+{
+  auto promise = std::make_shared<std::promise<void>>();
+  std::shared_future<void> future = promise->get_future().share();
+
+  auto task = [this, stage, job = std::move(job), promise]() {
+    try {
+      this->timed(stage, job);
+      promise->set_value();
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  };
+
+  if (m_workers.empty()) {
+    task();
+    return future;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(task));
+  }
+  m_work_ready.notify_one();
+  return future;
+}
+
+/*
+ * Helpers are queued like any other job, but the caller claims indices too and only waits for
+ * indices, never for helpers. A helper that starts after the loop is done finds nothing left and
+ * returns, so a parallelFor inside an async() job can't deadlock on a busy pool.
+ */
+void CELoadPipeline::parallelFor(const std::string& stage, size_t count, const std::function<void(size_t)>& job)
+{
+  if (count == 0) {
+    return;
+  }
+
+  struct _Loop {
+    const std::function<void(size_t)>* job;
+    size_t count;
+    std::atomic<size_t> next{0};
+    size_t done = 0;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+  };
+  auto loop = std::make_shared<_Loop>();
+  loop->job = &job;
+  loop->count = count;
+
+  auto work = [this, stage, loop]() {
+    size_t i;
+    while ((i = loop->next.fetch_add(1)) < loop->count) {
+      std::exception_ptr error;
+      try {
+        this->timed(stage, [&] { (*loop->job)(i); });
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(loop->mutex);
+      if (error && !loop->error) {
+        loop->error = error;
+      }
+      if (++loop->done == loop->count) {
+        loop->finished.notify_all();
+      }
+    }
+  };
+
+  size_t helpers = std::min(m_workers.size(), count - 1);
+  if (helpers > 0) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (size_t h = 0; h < helpers; h++) {
+        m_jobs.push_back(work);
+      }
+    }
+    m_work_ready.notify_all();
+  }
+
+  work();
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&] { return loop->done == loop->count; });
+    error = std::move(loop->error);
+    loop->error = nullptr;
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void CELoadPipeline::upload(const std::string& stage, std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_upload_mutex);
+    m_uploads.emplace_back(stage, std::move(job));
+  }
+  m_upload_ready.notify_one();
+}
+
+bool CELoadPipeline::runOneUpload(std::chrono::milliseconds timeout)
+{
+  std::pair<std::string, std::function<void()>> upload;
+  {
+    std::unique_lock<std::mutex> lock(m_upload_mutex);
+    if (!m_upload_ready.wait_for(lock, timeout, [&] { return !m_uploads.empty(); })) {
+      return false;
+    }
+    upload = std::move(m_uploads.front());
+    m_uploads.pop_front();
+  }
+
+  this->timed(upload.first, upload.second);
+  return true;
+}
+
+void CELoadPipeline::runUploads()
+{
+  while (this->runOneUpload(std::chrono::milliseconds(0))) {
+  }
+}
+
+void CELoadPipeline::wait(const std::shared_future<void>& job)
+{
+  // Short timeout: the job finishing doesn't signal the upload queue
+  while (job.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    this->runOneUpload(std::chrono::milliseconds(2));
+  }
+
+  this->runUploads();
+  job.get();
+}
+
+void CELoadPipeline::run(const std::string& stage, const std::function<void()>& job)
+{
+  this->timed(stage, job);
+}
+
+void CELoadPipeline::report()
+{
+  std::vector<std::pair<std::string, _StageTiming>> stages;
+  {
+    std::lock_guard<std::mutex> lock(m_timing_mutex);
+    stages.assign(m_timings.begin(), m_timings.end());
+  }
+  std::sort(stages.begin(), stages.end(), [](const auto& a, const auto& b) { return a.second.start_ms < b.second.start_ms; });
+
+  double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+  std::cout << "Startup: " << total_ms << "ms on " << m_workers.size() << " loader threads + main" << std::endl;
+
+  char line[160];
+  for (const auto& stage : stages) {
+    const _StageTiming& timing = stage.second;
+    std::snprintf(line, sizeof(line), "  %-20s %8.1fms .. %8.1fms  wall %8.1fms  busy %8.1fms  (%d jobs)",
+                  stage.first.c_str(), timing.start_ms, timing.end_ms, timing.end_ms - timing.start_ms, timing.busy_ms, timing.jobs);
+    std::cout << line << std::endl;
+  }
+}
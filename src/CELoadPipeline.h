@@ -0,0 +1,86 @@
+//
+//  CELoadPipeline.h
+//  CE Character Lab
+//
+//  Worker pool for startup loading: CPU work runs on workers, GL/AL uploads on the main thread
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * Every job belongs to a named stage; report() prints how long each stage took from its first job
+ * starting to its last one finishing, and how much thread time it used. Anything that touches GL or
+ * AL is queued with upload() and only runs on the main thread, inside wait() or runUploads().
+ * With 0 workers async() runs the job straight away and nothing overlaps.
+ */
+class CELoadPipeline
+{
+private:
+  struct _StageTiming {
+    double start_ms = -1.0; // since the pipeline was created
+    double end_ms = 0.0;
+    double busy_ms = 0.0;   // summed over threads
+    int jobs = 0;
+  };
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_work_ready;
+  std::deque<std::function<void()>> m_jobs;
+  bool m_stopping = false;
+
+  std::mutex m_upload_mutex;
+  std::condition_variable m_upload_ready;
+  std::deque<std::pair<std::string, std::function<void()>>> m_uploads;
+
+  std::mutex m_timing_mutex;
+  std::map<std::string, _StageTiming> m_timings;
+  std::chrono::steady_clock::time_point m_start;
+
+  void workerLoop();
+  void timed(const std::string& stage, const std::function<void()>& job);
+  bool runOneUpload(std::chrono::milliseconds timeout);
+
+public:
+  explicit CELoadPipeline(unsigned int worker_count);
+  ~CELoadPipeline();
+
+  CELoadPipeline(const CELoadPipeline&) = delete;
+  CELoadPipeline& operator=(const CELoadPipeline&) = delete;
+
+  // Runs job on a worker. The future rethrows anything the job threw
+  std::shared_future<void> async(const std::string& stage, std::function<void()> job);
+
+  // Runs job(i) for every i in [0, count) on the workers and the calling thread, and returns once all
+  // have finished. Safe to call from inside an async() job. The first exception is rethrown here
+  void parallelFor(const std::string& stage, size_t count, const std::function<void(size_t)>& job);
+
+  // Queues GL/AL work for the main thread
+  void upload(const std::string& stage, std::function<void()> job);
+
+  // Main thread only: runs queued uploads until the job has finished, then whatever uploads are
+  // left, then rethrows the job's exception
+  void wait(const std::shared_future<void>& job);
+  // Main thread only: runs every queued upload
+  void runUploads();
+
+  // Times job on the calling thread
+  void run(const std::string& stage, const std::function<void()>& job);
+
+  void report();
+
+  unsigned int getWorkerCount() const { return (unsigned int)m_workers.size(); }
+};
@@ -0,0 +1,214 @@
+//
+//  CEMapCache.cpp
+//  CE Character Lab
+//
+//  Versioned binary cache of the data derived from a .map/.rsc pair at load time
+//
+
+#include "CEMapCache.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+static const char CACHE_MAGIC[4] = { 'C', 'E', 'M', 'C' };
+
+// Sections start on 8-byte boundaries within the file
+static size_t alignSection(size_t size)
+{
+  return (size + 7) & ~size_t(7);
+}
+
+CEMapCache::CEMapCache(const std::string& map_file_name, const std::string& rsc_file_name, const std::string& cache_file_name, bool rebuild)
+: m_cache_file_name(cache_file_name)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  m_key = hashFile(map_file_name, 0xcbf29ce484222325ull);
+  m_key = hashFile(rsc_file_name, m_key);
+
+  if (rebuild) {
+    std::cout << "Map cache: rebuild requested; ignoring " << m_cache_file_name << std::endl;
+    return;
+  }
+
+  m_loaded = this->load();
+
+  auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (m_loaded) {
+    std::cout << "Map cache: loaded " << m_cache_file_name << " (" << m_sections.size() << " sections) in " << elapsed << "ms" << std::endl;
+  } else {
+    std::cout << "Map cache: no valid cache at " << m_cache_file_name << "; it will be built on this start" << std::endl;
+  }
+}
+
+/*
+ * FNV-1a over 64-bit words (tail bytes one at a time). Only needs to notice that a file changed
+ */
+uint64_t CEMapCache::hashFile(const std::string& file_name, uint64_t seed)
+{
+  const uint64_t prime = 0x100000001b3ull;
+  uint64_t hash = seed;
+
+  std::ifstream infile(file_name, std::ios::binary | std::ios::in);
+  if (!infile.is_open()) {
+    return hash;
+  }
+
+  std::vector<char> buffer(1 << 20);
+  while (infile) {
+    infile.read(buffer.data(), buffer.size());
+    size_t count = (size_t)infile.gcount();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, buffer.data() + i, 8);
+      hash = (hash ^ word) * prime;
+    }
+    for (; i < count; i++) {
+      hash = (hash ^ (uint8_t)buffer[i]) * prime;
+    }
+  }
+
+  return hash;
+}
+
+bool CEMapCache::load()
+{
+  std::ifstream infile(m_cache_file_name, std::ios::binary | std::ios::in | std::ios::ate);
+  if (!infile.is_open()) {
+    return false;
+  }
+
+  // One read for the whole file
+  size_t file_size = (size_t)infile.tellg();
+  if (file_size < sizeof(_Header)) {
+    return false;
+  }
+  m_file_data.resize(file_size);
+  infile.seekg(0);
+  if (!infile.read(reinterpret_cast<char*>(m_file_data.data()), file_size)) {
+    m_file_data.clear();
+    return false;
+  }
+
+  _Header header;
+  std::memcpy(&header, m_file_data.data(), sizeof(_Header));
+  if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != VERSION || header.key != m_key) {
+    m_file_data.clear();
+    return false;
+  }
+
+  size_t offset = sizeof(_Header);
+  for (uint32_t s = 0; s < header.section_count; s++) {
+    if (offset + sizeof(_SectionHeader) > file_size) break;
+
+    _SectionHeader section;
+    std::memcpy(&section, m_file_data.data() + offset, sizeof(_SectionHeader));
+    offset += sizeof(_SectionHeader);
+
+    if (section.size > file_size - offset) break;
+
+    m_sections[(Section)section.tag] = std::make_pair(offset, (size_t)section.size);
+    offset += alignSection((size_t)section.size);
+  }
+
+  // A truncated file is treated as no cache at all
+  if (m_sections.size() != header.section_count) {
+    m_sections.clear();
+    m_file_data.clear();
+    return false;
+  }
+
+  return true;
+}
+
+const uint8_t* CEMapCache::find(Section section, size_t& size) const
+{
+  auto it = m_sections.find(section);
+  if (it == m_sections.end()) {
+    return nullptr;
+  }
+
+  size = it->second.second;
+  return m_file_data.data() + it->second.first;
+}
+
+bool CEMapCache::contains(Section section, size_t size) const
+{
+  size_t section_size = 0;
+  return find(section, section_size) && section_size == size;
+}
+
+bool CEMapCache::read(Section section, void* dest, size_t size) const
+{
+  size_t section_size = 0;
+  const uint8_t* data = find(section, section_size);
+  if (!data || section_size != size) {
+    return false;
+  }
+
+  std::memcpy(dest, data, size);
+  return true;
+}
+
+void CEMapCache::write(Section section, const void* src, size_t size)
+{
+  if (m_loaded) return;
+
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+  std::lock_guard<std::mutex> lock(m_pending_mutex);
+  m_pending[section].assign(bytes, bytes + size);
+}
+
+void CEMapCache::save()
+{
+  std::lock_guard<std::mutex> lock(m_pending_mutex);
+  if (m_loaded || m_pending.empty()) return;
+
+  fs::path cache_path(m_cache_file_name);
+  fs::path temp_path = cache_path;
+  temp_path += ".tmp";
+
+  try {
+    if (cache_path.has_parent_path()) {
+      fs::create_directories(cache_path.parent_path());
+    }
+
+    std::ofstream out(temp_path, std::ios::binary | std::ios::out | std::ios::trunc);
+    out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+    _Header header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+    header.key = m_key;
+    header.section_count = (uint32_t)m_pending.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const char padding[8] = {};
+    for (const auto& pending : m_pending) {
+      _SectionHeader section = {};
+      section.tag = (uint32_t)pending.first;
+      section.size = pending.second.size();
+      out.write(reinterpret_cast<const char*>(&section), sizeof(section));
+      out.write(reinterpret_cast<const char*>(pending.second.data()), pending.second.size());
+      out.write(padding, alignSection(pending.second.size()) - pending.second.size());
+    }
+    out.close();
+
+    // Replace atomically so an interrupted save never leaves a half-written cache behind
+    fs::rename(temp_path, cache_path);
+    std::cout << "Map cache: saved " << m_pending.size() << " sections to " << m_cache_file_name << std::endl;
+  } catch (const std::exception& e) {
+    // The cache is an optimisation; a failed save only costs the next start its speed-up
+    std::cerr << "Map cache: could not save " << m_cache_file_name << ": " << e.what() << std::endl;
+    std::error_code ignored;
+    fs::remove(temp_path, ignored);
+  }
+
+  m_pending.clear();
+}
@@ -0,0 +1,142 @@
+//
+//  CEMapCache.h
+//  CE Character Lab
+//
+//  Versioned binary cache of the data derived from a .map/.rsc pair at load time
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/*
+ * One file per map, keyed by a hash of the .map and .rsc contents. Producers call write() with what
+ * they derived while the cache is cold; save() then stores it all. On the next start the whole file
+ * is read back in one go and the same producers call read() instead of recomputing.
+ */
+class CEMapCache
+{
+public:
+  // Bump whenever a cached product, or the code deriving it, changes
+  constexpr static const uint32_t VERSION = 3;
+
+  enum class Section : uint32_t {
+    MAP_HEIGHTS = 1,      // heightmap after C2MapFile::postProcess
+    MAP_WATER,            // water map after gap filling
+    LANDINGS,
+    GROUND_LEVELS,
+    GROUND_ANGLES,
+    WALKABLE_FLAGS,
+    TERRAIN_NORMALS,
+    TERRAIN_CHUNK_BOUNDS, // min/max pairs per TerrainRenderer chunk
+    OBJECT_PLACEMENTS,
+    WATER_ENTITIES,       // RSC waters including those registered while building C1 water
+    WATER_MESH_SIZES,     // vertex count, index count per water
+    WATER_VERTICES,
+    WATER_INDICES,
+    FOG_ZONES,
+    MAP_FLAGS,            // C2MapFile flags, with the water filled in by postProcess marked
+    JUMP_DISTANCES        // CEJumpPointTable entries
+  };
+
+  struct ObjectPlacement {
+    int32_t model;
+    int32_t rotation; // quarter turns
+    glm::vec3 position;
+  };
+
+  struct FogZone {
+    int32_t fog_id;
+    glm::vec2 center;
+    glm::vec2 size;
+  };
+
+private:
+  struct _Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t section_count;
+    uint32_t reserved;
+  };
+
+  struct _SectionHeader {
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t size;
+  };
+
+  std::string m_cache_file_name;
+  uint64_t m_key = 0;
+  bool m_loaded = false;
+
+  // Whole cache file when loaded; sections point into it
+  std::vector<uint8_t> m_file_data;
+  std::map<Section, std::pair<size_t, size_t>> m_sections; // offset, size
+
+  // Products collected this run for save(); loader jobs write concurrently
+  std::map<Section, std::vector<uint8_t>> m_pending;
+  std::mutex m_pending_mutex;
+
+  static uint64_t hashFile(const std::string& file_name, uint64_t seed);
+  bool load();
+  const uint8_t* find(Section section, size_t& size) const;
+
+public:
+  // rebuild ignores any existing cache file; it is replaced on save()
+  CEMapCache(const std::string& map_file_name, const std::string& rsc_file_name, const std::string& cache_file_name, bool rebuild);
+
+  // True when a valid cache for these exact files was read; writes are ignored from then on
+  bool isLoaded() const { return m_loaded; }
+
+  // True if the section is there and exactly size bytes
+  bool contains(Section section, size_t size) const;
+
+  // Copies a section into dest; false if it is missing or not exactly size bytes
+  bool read(Section section, void* dest, size_t size) const;
+  void write(Section section, const void* src, size_t size);
+
+  template <typename T>
+  bool readVector(Section section, std::vector<T>& out) const
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "cached types must be trivially copyable");
+
+    size_t size = 0;
+    const uint8_t* data = find(section, size);
+    if (!data || (size % sizeof(T)) != 0) return false;
+
+    if constexpr (std::is_default_constructible<T>::value) {
+      out.resize(size / sizeof(T));
+      std::memcpy(out.data(), data, size);
+    } else {
+      // e.g. Vertex; copy each one through aligned storage
+      out.clear();
+      out.reserve(size / sizeof(T));
+      for (size_t offset = 0; offset < size; offset += sizeof(T)) {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type item;
+        std::memcpy(&item, data + offset, sizeof(T));
+        out.push_back(*reinterpret_cast<T*>(&item));
+      }
+    }
+    return true;
+  }
+
+  template <typename T>
+  void writeVector(Section section, const std::vector<T>& in)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "cached types must be trivially copyable");
+    write(section, in.data(), in.size() * sizeof(T));
+  }
+
+  // Stores everything passed to write(). Does nothing if the cache was loaded
+  void save();
+};
@@ -0,0 +1,110 @@
+//
+//  CEMapPage.cpp
+//  CE Character Lab
+//
+//  One square page of map layers. A classic .map file is a world of a single page
+//
+
+#include "CEMapPage.h"
+#include "CEMappedFile.h"
+
+#include <cstring>
+
+CEMapPage::CEMapPage(int index, int origin_x, int origin_y, int size)
+: m_index(index), m_origin_x(origin_x), m_origin_y(origin_y), m_size(size)
+{
+}
+
+CEMapPage::~CEMapPage()
+{
+}
+
+size_t CEMapPage::fileSize(CEMapType type, int size)
+{
+  size_t tiles = (size_t)size * size;
+  size_t zones = tiles / 4;
+
+  if (type == CEMapType::C2) {
+    // 8-bit heights, objects, 3 brightness, water, object heights; 16-bit textures A/B and flags
+    return (tiles * 13) + (zones * 2);
+  }
+  return (tiles * 8) + (zones * 2);
+}
+
+void CEMapPage::load(CEMapType type, const std::string& file_name, bool memory_mapped)
+{
+  m_file = std::make_unique<CEMappedFile>(file_name, memory_mapped);
+  if (m_file->size() < fileSize(type, m_size)) {
+    throw std::runtime_error("Map file is truncated: " + file_name);
+  }
+
+  this->assignLayers(type, m_file->data());
+}
+
+void CEMapPage::loadBlank(CEMapType type)
+{
+  size_t tiles = (size_t)m_size * m_size;
+
+  m_blank.assign(fileSize(type, m_size), 0);
+  this->assignLayers(type, m_blank.data());
+
+  // 255 is "no object"
+  std::memset(const_cast<uint8_t*>(m_object_index_data.data()), 255, tiles);
+}
+
+void CEMapPage::assignLayers(CEMapType type, const uint8_t* data)
+{
+  const size_t tiles = (size_t)m_size * m_size;
+  const size_t zones = tiles / 4;
+  const uint8_t* layer = data;
+
+  if (type == CEMapType::C2) {
+    layer = m_heightmap_data.assign(layer, tiles);
+    layer = m_texture_A_index_data.assign(layer, tiles);
+    layer = m_texture_B_index_data.assign(layer, tiles);
+    layer = m_object_index_data.assign(layer, tiles);
+    layer = m_flags_data.assign(layer, tiles);
+
+    layer = m_dawn_brightness_data.assign(layer, tiles);
+    layer = m_day_brightness_data.assign(layer, tiles);
+    layer = m_night_brightness_data.assign(layer, tiles);
+
+    layer = m_watermap_data.assign(layer, tiles);
+    layer = m_object_heightmap_data.assign(layer, tiles);
+    layer = m_fog_data.assign(layer, zones);
+    layer = m_soundfx_data.assign(layer, zones);
+
+    m_flags_data.makeWritable();
+  } else {
+    layer = m_heightmap_data.assign(layer, tiles);
+    layer = m_texturec1_A_index_data.assign(layer, tiles);
+    layer = m_texturec1_B_index_data.assign(layer, tiles);
+    layer = m_object_index_data.assign(layer, tiles);
+    layer = m_c1_flags_data.assign(layer, tiles);
+
+    // This is used in the original engine to calculate object "darkness" on a given tile - we don't really need it anymore
+    layer = m_day_brightness_data.assign(layer, tiles);
+
+    layer = m_watermap_data.assign(layer, tiles); // C1 has only 1 water - these are the heights of the underwater surface
+    layer = m_object_heightmap_data.assign(layer, tiles);
+    layer = m_fog_data.assign(layer, zones);
+    layer = m_soundfx_data.assign(layer, zones);
+
+    m_c1_flags_data.makeWritable();
+  }
+
+  m_heightmap_data.makeWritable();
+  m_watermap_data.makeWritable();
+
+  // Heap storage for the derived layers; C2MapFile fills regions in as they are asked for
+  m_ground_levels.assign(tiles, 0.f);
+  m_ground_angles.assign(tiles, 0.f);
+  m_walkable_flags_data.assign(tiles, 0);
+
+  m_ground_regions_per_row = (m_size + GROUND_REGION - 1) / GROUND_REGION;
+  int region_count = m_ground_regions_per_row * m_ground_regions_per_row;
+  m_ground_region_ready = std::make_unique<std::atomic<bool>[]>(region_count);
+  for (int r = 0; r < region_count; r++) {
+    m_ground_region_ready[r].store(false, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,125 @@
+//
+//  CEMapPage.h
+//  CE Character Lab
+//
+//  One square page of map layers. A classic .map file is a world of a single page
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "g_shared.h"
+
+class CEMappedFile;
+
+/*
+ * Page files use the .map layout of their map type at m_size x m_size tiles (fog and ambient
+ * sound at half resolution). C2MapFile owns the pages and derives everything else from them.
+ */
+class CEMapPage
+{
+public:
+  // One layer of the page file. Layers point straight into the mapped file; the ones the engine
+  // edits after loading (heights, water, flags) are copied out first with makeWritable()
+  template <typename T>
+  class Layer
+  {
+  private:
+    const T* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<T> m_owned;
+
+  public:
+    // Views count items at bytes; returns where the next layer starts
+    const uint8_t* assign(const uint8_t* bytes, size_t count)
+    {
+      m_data = reinterpret_cast<const T*>(bytes);
+      m_size = count;
+      m_owned.clear();
+      return bytes + (count * sizeof(T));
+    }
+
+    void makeWritable()
+    {
+      m_owned.assign(m_data, m_data + m_size);
+      m_data = m_owned.data();
+    }
+
+    size_t size() const { return m_size; }
+    size_t byteSize() const { return m_size * sizeof(T); }
+    const T* data() const { return m_data; }
+    T* writableData() { return m_owned.empty() ? nullptr : m_owned.data(); }
+
+    const T& at(size_t i) const
+    {
+      if (i >= m_size) throw std::out_of_range("map layer index out of range");
+      return m_data[i];
+    }
+
+    T& writableAt(size_t i) { return m_owned.at(i); }
+  };
+
+  // Ground levels, slopes and walkability are derived per GROUND_REGION x GROUND_REGION block
+  constexpr static const int GROUND_REGION = 32;
+
+  const int m_index;    // row-major page number
+  const int m_origin_x; // first tile of the page in world tiles
+  const int m_origin_y;
+  const int m_size;     // tiles per side
+
+  Layer<uint8_t> m_heightmap_data;
+  Layer<uint8_t> m_texturec1_A_index_data;
+  Layer<uint8_t> m_texturec1_B_index_data;
+  Layer<uint16_t> m_texture_A_index_data;
+  Layer<uint16_t> m_texture_B_index_data;
+  Layer<uint8_t> m_object_index_data;
+  Layer<uint16_t> m_flags_data;
+  Layer<uint8_t> m_c1_flags_data;
+  Layer<uint8_t> m_dawn_brightness_data;
+  Layer<uint8_t> m_day_brightness_data;
+  Layer<uint8_t> m_night_brightness_data;
+  Layer<uint8_t> m_watermap_data;
+  Layer<uint8_t> m_object_heightmap_data;
+  Layer<uint8_t> m_fog_data;
+  Layer<uint8_t> m_soundfx_data;
+  std::vector<glm::vec2> m_landings; // world tiles
+
+  std::vector<float> m_ground_levels;
+  std::vector<float> m_ground_angles;
+  std::vector<uint16_t> m_walkable_flags_data;
+  std::unique_ptr<std::atomic<bool>[]> m_ground_region_ready;
+  int m_ground_regions_per_row = 0;
+
+private:
+  // Backs every layer above except the writable ones
+  std::unique_ptr<CEMappedFile> m_file;
+  // Stands in for the file of a page that has none
+  std::vector<uint8_t> m_blank;
+
+  void assignLayers(CEMapType type, const uint8_t* data);
+
+public:
+  CEMapPage(int index, int origin_x, int origin_y, int size);
+  ~CEMapPage();
+
+  // Bytes in a page file of this type and size
+  static size_t fileSize(CEMapType type, int size);
+
+  // Throws std::runtime_error if the file is missing or too short
+  void load(CEMapType type, const std::string& file_name, bool memory_mapped);
+  // Flat, dry and empty; for pages a world leaves out
+  void loadBlank(CEMapType type);
+
+  int localIndex(int x, int y) const { return ((y - m_origin_y) * m_size) + (x - m_origin_x); }
+  int localZoneIndex(int x, int y) const { return (((y - m_origin_y) >> 1) * (m_size >> 1)) + ((x - m_origin_x) >> 1); }
+  bool contains(int x, int y) const { return x >= m_origin_x && y >= m_origin_y && x < m_origin_x + m_size && y < m_origin_y + m_size; }
+};
@@ -0,0 +1,140 @@
+//
+//  CEMappedFile.cpp
+//  CE Character Lab
+//
+//  Read-only view of a whole file, memory-mapped where the platform allows it
+//
+
+#include "CEMappedFile.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CEMappedFile::CEMappedFile(const std::string& file_name, bool memory_mapped)
+{
+  if (memory_mapped && this->map(file_name)) {
+    m_mapped = true;
+    return;
+  }
+
+  if (memory_mapped) {
+    std::cerr << "Could not memory-map " << file_name << "; reading it instead" << std::endl;
+  }
+  this->read(file_name);
+}
+
+CEMappedFile::~CEMappedFile()
+{
+  this->unmap();
+}
+
+void CEMappedFile::read(const std::string& file_name)
+{
+  std::ifstream infile(file_name, std::ios::binary | std::ios::in | std::ios::ate);
+  if (!infile.is_open()) {
+    throw std::runtime_error("Could not open " + file_name);
+  }
+
+  m_buffer.resize((size_t)infile.tellg());
+  infile.seekg(0);
+  if (!infile.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size())) {
+    throw std::runtime_error("Could not read " + file_name);
+  }
+
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+}
+
+#ifdef _WIN32
+
+bool CEMappedFile::map(const std::string& file_name)
+{
+  HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  m_file_handle = file;
+  m_mapping_handle = mapping;
+  m_data = static_cast<const uint8_t*>(view);
+  m_size = (size_t)file_size.QuadPart;
+  return true;
+}
+
+void CEMappedFile::unmap()
+{
+  if (!m_mapped) return;
+
+  UnmapViewOfFile(m_data);
+  CloseHandle((HANDLE)m_mapping_handle);
+  CloseHandle((HANDLE)m_file_handle);
+  m_mapped = false;
+}
+
+#else
+
+bool CEMappedFile::map(const std::string& file_name)
+{
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file
+  close(fd);
+  if (view == MAP_FAILED) {
+    return false;
+  }
+
+  m_data = static_cast<const uint8_t*>(view);
+  m_size = (size_t)st.st_size;
+  return true;
+}
+
+void CEMappedFile::unmap()
+{
+  if (!m_mapped) return;
+
+  munmap(const_cast<uint8_t*>(m_data), m_size);
+  m_mapped = false;
+}
+
+#endif
@@ -0,0 +1,49 @@
+//
+//  CEMappedFile.h
+//  CE Character Lab
+//
+//  Read-only view of a whole file, memory-mapped where the platform allows it
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Maps the file read-only so callers can point straight into it instead of copying. With mapping
+ * off (or if it fails) the file is read into memory in one go; data() behaves the same either way.
+ */
+class CEMappedFile
+{
+private:
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+  bool m_mapped = false;
+
+  // Fallback storage when the file is read rather than mapped
+  std::vector<uint8_t> m_buffer;
+
+#ifdef _WIN32
+  void* m_file_handle = nullptr;
+  void* m_mapping_handle = nullptr;
+#endif
+
+  bool map(const std::string& file_name);
+  void read(const std::string& file_name);
+  void unmap();
+
+public:
+  // Throws std::runtime_error if the file cannot be opened or read
+  CEMappedFile(const std::string& file_name, bool memory_mapped);
+  ~CEMappedFile();
+
+  CEMappedFile(const CEMappedFile&) = delete;
+  CEMappedFile& operator=(const CEMappedFile&) = delete;
+
+  const uint8_t* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool isMapped() const { return m_mapped; }
+};
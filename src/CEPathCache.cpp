@@ -0,0 +1,131 @@
+//
+//  CEPathCache.cpp
+//  CE Character Lab
+//
+//  Recently found paths, handed out again to searches between the same places
+//
+
+#include "CEPathCache.h"
+
+#include <iterator>
+
+uint64_t CEPathCache::squareKey(glm::ivec2 tile)
+{
+  return ((uint64_t)(uint32_t)(tile.x / QUANTUM) << 32) | (uint32_t)(tile.y / QUANTUM);
+}
+
+void CEPathCache::erase(std::list<_Entry>::iterator entry)
+{
+  auto range = m_by_goal.equal_range(entry->goal_square);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == entry) {
+      m_by_goal.erase(it);
+      break;
+    }
+  }
+  m_entries.erase(entry);
+}
+
+uint64_t CEPathCache::getGeneration() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_generation;
+}
+
+/*
+ * Any path to the goal's square that passes through start will do; the rest of it from there is
+ * as good as a fresh search would find
+ */
+bool CEPathCache::find(glm::ivec2 start, glm::ivec2 goal, glm::ivec2& found_goal, std::vector<glm::vec2>& path)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto range = m_by_goal.equal_range(squareKey(goal));
+  for (auto it = range.first; it != range.second; ++it) {
+    const _Entry& entry = *it->second;
+    if (start.x < entry.low.x || start.y < entry.low.y || start.x > entry.high.x || start.y > entry.high.y) continue;
+
+    for (size_t i = 0; i < entry.tiles.size(); i++) {
+      if (entry.tiles[i] != start) continue;
+
+      found_goal = entry.goal;
+      path.clear();
+      path.reserve(entry.tiles.size() - i - 1);
+      for (size_t j = i + 1; j < entry.tiles.size(); j++) {
+        path.push_back(glm::vec2(entry.tiles[j]));
+      }
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      m_stats.hits++;
+      return true;
+    }
+  }
+
+  m_stats.misses++;
+  return false;
+}
+
+void CEPathCache::store(glm::ivec2 start, glm::ivec2 goal, const std::vector<glm::vec2>& path, uint64_t generation)
+{
+  _Entry entry;
+  entry.start_square = squareKey(start);
+  entry.goal_square = squareKey(goal);
+  entry.goal = goal;
+  entry.tiles.reserve(path.size() + 1);
+  entry.tiles.push_back(start);
+  entry.low = entry.high = start;
+  for (const glm::vec2& point : path) {
+    glm::ivec2 tile = glm::ivec2(point);
+    entry.tiles.push_back(tile);
+    entry.low = glm::min(entry.low, tile);
+    entry.high = glm::max(entry.high, tile);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (generation != m_generation) {
+    return;
+  }
+
+  // The newer path replaces any between the same squares
+  auto range = m_by_goal.equal_range(entry.goal_square);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->start_square == entry.start_square) {
+      this->erase(it->second);
+      break;
+    }
+  }
+
+  if (m_entries.size() >= CAPACITY) {
+    this->erase(std::prev(m_entries.end()));
+  }
+
+  m_entries.push_front(std::move(entry));
+  m_by_goal.emplace(m_entries.front().goal_square, m_entries.begin());
+}
+
+void CEPathCache::invalidate(int x0, int y0, int x1, int y1)
+{
+  // A diagonal step can't cut past a blocked tile, so paths beside the area may be broken too
+  x0--; y0--; x1++; y1++;
+  
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_generation++;
+
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    auto next = std::next(it);
+    if (it->high.x >= x0 && it->high.y >= y0 && it->low.x <= x1 && it->low.y <= y1) {
+      for (const glm::ivec2& tile : it->tiles) {
+        if (tile.x >= x0 && tile.y >= y0 && tile.x <= x1 && tile.y <= y1) {
+          this->erase(it);
+          break;
+        }
+      }
+    }
+    it = next;
+  }
+}
+
+CEPathCache::Stats CEPathCache::getStats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
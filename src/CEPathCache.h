@@ -0,0 +1,73 @@
+//
+//  CEPathCache.h
+//  CE Character Lab
+//
+//  Recently found paths, handed out again to searches between the same places
+//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/*
+ * Entries are keyed by the QUANTUM square their start and goal fall in, so one path answers every
+ * request from anywhere along it to a goal within a few tiles of the one it was found for. The
+ * least recently used entry goes first once CAPACITY is reached. Thread-safe.
+ */
+class CEPathCache
+{
+public:
+  constexpr static const int QUANTUM = 4;
+  constexpr static const size_t CAPACITY = 512;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+private:
+  struct _Entry {
+    // The key: squares of the start and goal the path was found for
+    uint64_t start_square;
+    uint64_t goal_square;
+    glm::ivec2 goal;
+    // Start tile first, then every tile to goal
+    std::vector<glm::ivec2> tiles;
+    // Bounds of tiles
+    glm::ivec2 low;
+    glm::ivec2 high;
+  };
+
+  mutable std::mutex m_mutex;
+  // Most recently used first
+  std::list<_Entry> m_entries;
+  // By goal square, for lookups from any start
+  std::unordered_multimap<uint64_t, std::list<_Entry>::iterator> m_by_goal;
+  // Bumped by invalidate(), so paths searched over the old tiles aren't stored after it
+  uint64_t m_generation = 0;
+  Stats m_stats;
+
+  static uint64_t squareKey(glm::ivec2 tile);
+  void erase(std::list<_Entry>::iterator entry);
+
+public:
+  // Taken before searching, and handed back to store()
+  uint64_t getGeneration() const;
+
+  // Path from start to a goal in goal's square, without the start, as a search returns it
+  bool find(glm::ivec2 start, glm::ivec2 goal, glm::ivec2& found_goal, std::vector<glm::vec2>& path);
+  // A complete path from start, without the start; dropped if tiles changed since generation
+  void store(glm::ivec2 start, glm::ivec2 goal, const std::vector<glm::vec2>& path, uint64_t generation);
+
+  // Drops every path through or beside tiles [x0, x1] x [y0, y1] (inclusive). Paths elsewhere stay
+  // valid, if not always the shortest any more
+  void invalidate(int x0, int y0, int x1, int y1);
+
+  Stats getStats() const;
+};
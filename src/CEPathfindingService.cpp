@@ -0,0 +1,341 @@
+//
+//  CEPathfindingService.cpp
+//  CE Character Lab
+//
+//  Runs JPS searches over the walkable terrain on worker threads, so long searches never stall a frame
+//
+
+#include "CEPathfindingService.h"
+
+#include "C2MapFile.h"
+#include "CEMapCache.h"
+
+#include <algorithm>
+#include <iostream>
+
+// Searches check their deadline and cancellation between batches of this many JPS steps
+static const int SEARCH_STEP_BATCH = 256;
+
+// Goals further than this many tiles along either axis are searched hierarchically
+static const int HIERARCHICAL_DISTANCE = 2 * CEClusterGraph::CLUSTER_SIZE;
+
+CEPathfindingService::Ticket& CEPathfindingService::Ticket::operator=(Ticket&& other)
+{
+  if (this != &other) {
+    this->cancel();
+    m_result = std::move(other.m_result);
+    m_cancelled = std::move(other.m_cancelled);
+  }
+  return *this;
+}
+
+CEPathfindingService::Ticket::~Ticket()
+{
+  this->cancel();
+}
+
+bool CEPathfindingService::Ticket::ready() const
+{
+  return m_result.valid() && m_result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+CEPathResult CEPathfindingService::Ticket::take()
+{
+  CEPathResult result = m_result.get();
+  m_cancelled.reset();
+  return result;
+}
+
+void CEPathfindingService::Ticket::cancel()
+{
+  if (m_cancelled) {
+    *m_cancelled = true;
+    m_cancelled.reset();
+  }
+  m_result = std::future<CEPathResult>();
+}
+
+bool CEPathfindingService::_JobOrder::operator()(const std::unique_ptr<_Job>& a, const std::unique_ptr<_Job>& b) const
+{
+  // priority_queue pops the "largest": highest priority, then earliest deadline, then oldest
+  if (a->request.priority != b->request.priority) return a->request.priority < b->request.priority;
+  if (a->deadline != b->deadline) return a->deadline > b->deadline;
+  return a->sequence > b->sequence;
+}
+
+CEPathfindingService::CEPathfindingService(std::shared_ptr<C2MapFile> map, unsigned int worker_count, std::shared_ptr<CEMapCache> cache)
+: m_map(map)
+{
+  m_grid.walkability = std::make_shared<CEWalkabilityGrid>(map);
+  
+  // A streamed world changes a page at a time, far too often to keep a table of it
+  int width = map->getWidth(), height = map->getHeight();
+  if (!map->isStreamed() && width <= CEJumpPointTable::MAX_SIZE && height <= CEJumpPointTable::MAX_SIZE) {
+    auto table = std::make_shared<CEJumpPointTable>(width, height);
+    if (!cache || !table->restore(*cache)) {
+      table->build(*m_grid.walkability);
+      if (cache) {
+        table->store(*cache);
+      }
+    }
+    m_jump_points = table;
+  }
+  
+  m_clusters = std::make_shared<CEClusterGraph>(*m_grid.walkability);
+  
+  for (unsigned int i = 0; i < std::max(1u, worker_count); i++) {
+    m_workers.emplace_back(&CEPathfindingService::workerLoop, this);
+  }
+}
+
+CEPathfindingService::~CEPathfindingService()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_work_ready.notify_all();
+  
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+  
+  // Anyone still waiting gets an answer rather than a broken promise
+  while (!m_queue.empty()) {
+    CEPathResult result;
+    result.status = CEPathStatus::CANCELLED;
+    const_cast<std::unique_ptr<_Job>&>(m_queue.top())->result.set_value(result);
+    m_queue.pop();
+  }
+}
+
+CEPathfindingService::Ticket CEPathfindingService::submit(CEPathRequest request)
+{
+  auto job = std::make_unique<_Job>();
+  job->deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(request.timeout));
+  job->request = std::move(request);
+  job->cancelled = std::make_shared<std::atomic<bool>>(false);
+  
+  Ticket ticket;
+  ticket.m_result = job->result.get_future();
+  ticket.m_cancelled = job->cancelled;
+  
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job->sequence = m_next_sequence++;
+    m_queue.push(std::move(job));
+  }
+  m_work_ready.notify_one();
+  
+  return ticket;
+}
+
+void CEPathfindingService::workerLoop()
+{
+  // The searcher keeps a reference to its grid, so this copy is where the job's table goes
+  CEWalkableTerrainPathFinder grid = m_grid;
+  JPS::Searcher<CEWalkableTerrainPathFinder> searcher(grid);
+  std::shared_ptr<const CEClusterGraph> clusters;
+  uint64_t cache_generation = 0;
+  
+  while (true) {
+    std::unique_ptr<_Job> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_work_ready.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+      if (m_stopping) {
+        return;
+      }
+      // top() is const; the job is popped straight after, so moving out of it is safe
+      job = std::move(const_cast<std::unique_ptr<_Job>&>(m_queue.top()));
+      m_queue.pop();
+    }
+    
+    this->refreshWalkability();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      grid.jump_points = m_jump_points;
+      clusters = m_clusters;
+      cache_generation = m_path_cache.getGeneration();
+    }
+    job->result.set_value(runJob(*job, searcher, *clusters, cache_generation));
+  }
+}
+
+void CEPathfindingService::onPageLoaded(int page)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_dirty_pages.push_back(page);
+}
+
+void CEPathfindingService::onPageEvicted(int page)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_dirty_pages.push_back(page);
+}
+
+/*
+ * Reading the flags derives any ground regions not built yet, which is too slow for the main
+ * thread's page callbacks. One worker rereads while the others keep searching
+ */
+void CEPathfindingService::refreshWalkability()
+{
+  std::unique_lock<std::mutex> refresh_lock(m_refresh_mutex, std::try_to_lock);
+  if (!refresh_lock.owns_lock()) {
+    return;
+  }
+  
+  std::vector<int> pages;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pages.swap(m_dirty_pages);
+  }
+  
+  std::sort(pages.begin(), pages.end());
+  pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+  for (int page : pages) {
+    m_grid.walkability->refreshPage(page);
+  }
+  
+  std::vector<glm::ivec2> tiles = m_map->takeWalkabilityChanges();
+  if (pages.empty() && tiles.empty()) {
+    return;
+  }
+  
+  glm::ivec2 low(0), high(-1);
+  if (!tiles.empty()) {
+    low = high = tiles[0];
+  }
+  for (const glm::ivec2& tile : tiles) {
+    m_grid.walkability->refresh(tile.x, tile.y, tile.x + 1, tile.y + 1);
+    low = glm::min(low, tile);
+    high = glm::max(high, tile);
+  }
+  
+  // Searches still running keep the tables they started with; one patch covers the whole batch
+  std::shared_ptr<const CEJumpPointTable> table;
+  std::shared_ptr<const CEClusterGraph> clusters;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    table = m_jump_points;
+    clusters = m_clusters;
+  }
+  
+  if (table && !tiles.empty()) {
+    auto patched = std::make_shared<CEJumpPointTable>(*table);
+    patched->patch(*m_grid.walkability, low.x, low.y, high.x, high.y);
+    table = patched;
+  }
+  
+  auto rebuilt = std::make_shared<CEClusterGraph>(*clusters);
+  for (int page : pages) {
+    int x0, y0, x1, y1;
+    m_grid.walkability->getPageExtent(page, x0, y0, x1, y1);
+    rebuilt->rebuild(*m_grid.walkability, x0, y0, x1 - 1, y1 - 1);
+  }
+  if (!tiles.empty()) {
+    rebuilt->rebuild(*m_grid.walkability, low.x, low.y, high.x, high.y);
+  }
+  
+  // Under the same lock, so no job pairs the new tables with the old cache or the other way round
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_jump_points = table;
+  m_clusters = rebuilt;
+  for (int page : pages) {
+    int x0, y0, x1, y1;
+    m_grid.walkability->getPageExtent(page, x0, y0, x1, y1);
+    m_path_cache.invalidate(x0, y0, x1 - 1, y1 - 1);
+  }
+  if (!tiles.empty()) {
+    m_path_cache.invalidate(low.x, low.y, high.x, high.y);
+  }
+}
+
+CEPathResult CEPathfindingService::runJob(_Job& job, JPS::Searcher<CEWalkableTerrainPathFinder>& searcher, const CEClusterGraph& clusters, uint64_t cache_generation)
+{
+  CEPathResult result;
+  
+  // Waiting in the queue may have been enough to make it stale
+  if (*job.cancelled) {
+    result.status = CEPathStatus::CANCELLED;
+    return result;
+  }
+  if (std::chrono::steady_clock::now() > job.deadline) {
+    result.status = CEPathStatus::EXPIRED;
+    return result;
+  }
+  
+  const JPS::Position start = JPS::Pos(job.request.start.x, job.request.start.y);
+  
+  for (const glm::ivec2& goal : job.request.goals) {
+    // Roaming keeps going between the same landings and shores; no search at all if one was found
+    // from here, or from a tile further back along the same path
+    if (m_path_cache.find(job.request.start, goal, result.goal, result.path)) {
+      result.status = CEPathStatus::FOUND;
+      return result;
+    }
+    
+    // Far goals cost the same bounded search however far they are, and only the first stretch is
+    // walked out in tiles
+    glm::ivec2 offset = glm::abs(goal - job.request.start);
+    if (std::max(offset.x, offset.y) > HIERARCHICAL_DISTANCE) {
+      if (*job.cancelled) {
+        result.status = CEPathStatus::CANCELLED;
+        return result;
+      }
+      if (clusters.findPath(*m_grid.walkability, job.request.start, goal, result.path, result.partial)) {
+        result.status = CEPathStatus::FOUND;
+        result.goal = goal;
+        if (!result.partial) {
+          m_path_cache.store(job.request.start, goal, result.path, cache_generation);
+        }
+        return result;
+      }
+      result.path.clear();
+      result.partial = false;
+      continue;
+    }
+    
+    JPS_Result res = searcher.findPathInit(start, JPS::Pos(goal.x, goal.y));
+    
+    while (res == JPS_NEED_MORE_STEPS) {
+      if (*job.cancelled) {
+        result.status = CEPathStatus::CANCELLED;
+        return result;
+      }
+      if (std::chrono::steady_clock::now() > job.deadline) {
+        result.status = CEPathStatus::EXPIRED;
+        return result;
+      }
+      res = searcher.findPathStep(SEARCH_STEP_BATCH);
+    }
+    
+    if (res == JPS_EMPTY_PATH) {
+      result.status = CEPathStatus::FOUND;
+      result.goal = goal;
+      return result;
+    }
+    
+    if (res == JPS_FOUND_PATH) {
+      JPS::PathVector path;
+      if (searcher.findPathFinish(path, 1) == JPS_FOUND_PATH) {
+        result.status = CEPathStatus::FOUND;
+        result.goal = goal;
+        result.path.reserve(path.size());
+        for (const auto& p : path) {
+          result.path.push_back(glm::vec2(p.x, p.y));
+        }
+        m_path_cache.store(job.request.start, goal, result.path, cache_generation);
+        return result;
+      }
+    }
+    
+    if (res == JPS_OUT_OF_MEMORY) {
+      std::cerr << "Pathfinding ran out of memory; freeing searcher" << std::endl;
+      searcher.freeMemory();
+    }
+  }
+  
+  result.status = CEPathStatus::NO_PATH;
+  return result;
+}
@@ -0,0 +1,145 @@
+//
+//  CEPathfindingService.h
+//  CE Character Lab
+//
+//  Runs JPS searches over the walkable terrain on worker threads, so long searches never stall a frame
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CEClusterGraph.h"
+#include "CEPathCache.h"
+#include "CEWalkableTerrainPathFinder.hpp"
+#include "IWorldPageListener.h"
+#include "jps.hpp"
+
+class C2MapFile;
+class CEMapCache;
+
+enum class CEPathStatus {
+  FOUND,
+  NO_PATH,
+  // Not finished before its deadline
+  EXPIRED,
+  // Superseded by the requester, or the service shut down
+  CANCELLED
+};
+
+struct CEPathRequest {
+  glm::ivec2 start = glm::ivec2(0);
+  // Tried in order; the first reachable goal wins
+  std::vector<glm::ivec2> goals;
+  int priority = 0;
+  // Seconds from submission
+  double timeout = 1.0;
+};
+
+struct CEPathResult {
+  CEPathStatus status = CEPathStatus::NO_PATH;
+  glm::ivec2 goal = glm::ivec2(0);
+  // Tile waypoints in JPS order (start to goal)
+  std::vector<glm::vec2> path;
+  // A hierarchical search refined only the first clusters of the route; plan again from the end
+  // of path to carry on towards goal
+  bool partial = false;
+};
+
+class CEPathfindingService : public IWorldPageListener
+{
+public:
+  // Higher runs first
+  static const int PRIORITY_ROAM = 0;
+  static const int PRIORITY_TRACK = 1;
+  static const int PRIORITY_THREAT = 2;
+
+  // Handle to a submitted request. Dropping or cancelling it lets the worker skip or abandon the search
+  class Ticket
+  {
+    friend class CEPathfindingService;
+
+    std::future<CEPathResult> m_result;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+
+  public:
+    Ticket() = default;
+    Ticket(Ticket&&) = default;
+    Ticket& operator=(Ticket&& other);
+    ~Ticket();
+
+    bool pending() const { return m_result.valid(); }
+    bool ready() const;
+    // Only once ready(); the ticket is empty afterwards
+    CEPathResult take();
+    void cancel();
+  };
+
+private:
+  struct _Job {
+    CEPathRequest request;
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t sequence;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    std::promise<CEPathResult> result;
+  };
+
+  struct _JobOrder {
+    bool operator()(const std::unique_ptr<_Job>& a, const std::unique_ptr<_Job>& b) const;
+  };
+
+  std::shared_ptr<C2MapFile> m_map;
+
+  // Bits shared by every worker; each worker owns its own JPS searcher
+  CEWalkableTerrainPathFinder m_grid;
+  // Single-page maps only. Replaced, never modified, when tiles change; guarded by m_mutex and
+  // taken by each job as it starts
+  std::shared_ptr<const CEJumpPointTable> m_jump_points;
+  // For goals too far for a flat search; replaced the same way when tiles or pages change
+  std::shared_ptr<const CEClusterGraph> m_clusters;
+  // Complete paths found so far; invalidated together with the tables being replaced
+  CEPathCache m_path_cache;
+
+  // Pages whose walkability changed, guarded by m_mutex; the next worker to take a job rereads them
+  std::vector<int> m_dirty_pages;
+  std::mutex m_refresh_mutex;
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_work_ready;
+  std::priority_queue<std::unique_ptr<_Job>, std::vector<std::unique_ptr<_Job>>, _JobOrder> m_queue;
+  uint64_t m_next_sequence = 0;
+  bool m_stopping = false;
+
+  void workerLoop();
+  void refreshWalkability();
+  CEPathResult runJob(_Job& job, JPS::Searcher<CEWalkableTerrainPathFinder>& searcher, const CEClusterGraph& clusters, uint64_t cache_generation);
+
+public:
+  // The jump point table of a single-page map is read from cache, or built and written to it
+  CEPathfindingService(std::shared_ptr<C2MapFile> map, unsigned int worker_count, std::shared_ptr<CEMapCache> cache = nullptr);
+  ~CEPathfindingService();
+
+  // Thread-safe; called from AI worker threads
+  Ticket submit(CEPathRequest request);
+
+  // The grid every search runs over, for other planners to share
+  std::shared_ptr<CEWalkabilityGrid> getWalkability() const { return m_grid.walkability; }
+  // Thread-safe; counts every goal looked up in the path cache since the start
+  CEPathCache::Stats getCacheStats() const { return m_path_cache.getStats(); }
+
+  // IWorldPageListener
+  void onPageLoaded(int page) override;
+  void onPageEvicted(int page) override;
+};
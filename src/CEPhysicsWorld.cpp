@@ -12,6 +12,7 @@
 #include "CEGeometry.h"
 #include "CEBulletHeightfield.h"
 #include "CEBulletDebugDraw.h"
+#include "CELoadPipeline.h"
 #include "transform.h"
 #include "vertex.h"
 
@@ -20,47 +21,156 @@
 #include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
 #include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
 #include <BulletCollision/CollisionShapes/btTriangleMesh.h>
+#if BT_THREADSAFE
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#endif
 
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <GLFW/glfw3.h>
 
-CEPhysicsWorld::CEPhysicsWorld(C2MapFile* mapFile, C2MapRscFile* mapRsc)
+#if BT_THREADSAFE
+// Bullet's task scheduler is global, so every world shares the one made on first use
+static btITaskScheduler* sharedTaskScheduler()
+{
+    static btITaskScheduler* scheduler = []() {
+        btITaskScheduler* created = btCreateDefaultTaskScheduler();
+        if (created) {
+            btSetTaskScheduler(created);
+        }
+        return created;
+    }();
+    return scheduler;
+}
+#endif
+
+CEPhysicsWorld::StaticShapes::StaticShapes()
+{
+}
+
+CEPhysicsWorld::StaticShapes::~StaticShapes()
+{
+    for (auto* shape : modelShapes) {
+        delete shape;
+    }
+}
+
+std::unique_ptr<CEPhysicsWorld::StaticShapes> CEPhysicsWorld::buildStaticShapes(C2MapFile* mapFile, C2MapRscFile* mapRsc, CELoadPipeline* pipeline)
+{
+    auto shapes = std::make_unique<StaticShapes>();
+    
+    if (mapFile) {
+        // Create single terrain triangle mesh with exact subdivision matching
+        shapes->heightfield = std::make_unique<CEBulletHeightfield>(mapFile);
+    }
+    
+    if (!mapRsc) return shapes;
+    
+    int objectCount = mapRsc->getWorldModelCount();
+    
+    // Indexed by model; models without collision keep a null entry
+    shapes->modelShapes.assign(objectCount, nullptr);
+    
+    auto buildModelShape = [&](size_t i) {
+        CEWorldModel* model = mapRsc->getWorldModel((int)i);
+        if (!model) return;
+        
+        // Skip objects with no valid dimensions
+        if (model->getObjectInfo()->Radius <= 0) {
+            return;
+        }
+        
+        // Create triangle mesh from geometry (shared by all instances)
+        btTriangleIndexVertexArray* tiv = model->getGeometry()->getPhysicalMesh();
+        if (!tiv || tiv->getNumSubParts() < 1) {
+            return;
+        }
+        
+        // Create base BVH triangle mesh shape (shared by all instances)
+        btBvhTriangleMeshShape* baseBvhShape = new btBvhTriangleMeshShape(tiv, true);
+        baseBvhShape->setMargin(0.01f);
+        shapes->modelShapes[i] = baseBvhShape;
+    };
+    
+    if (pipeline) {
+        pipeline->parallelFor("physics models", objectCount, buildModelShape);
+    } else {
+        for (int i = 0; i < objectCount; i++) {
+            buildModelShape(i);
+        }
+    }
+    
+    return shapes;
+}
+
+CEPhysicsWorld::CEPhysicsWorld(C2MapFile* mapFile, C2MapRscFile* mapRsc, std::unique_ptr<StaticShapes> shapes,
+                               const SimulationSettings& settings)
     : m_collisionConfig(nullptr)
     , m_dispatcher(nullptr)
     , m_broadphase(nullptr)
     , m_solver(nullptr)
+    , m_solverPool(nullptr)
     , m_dynamicsWorld(nullptr)
-    , m_terrainMesh(nullptr)
-    , m_terrainShape(nullptr)
-    , m_terrainBody(nullptr)
+    , m_pendingTime(0.0f)
+    , m_stopStepping(false)
+    , m_maxObjectRadius(0.0f)
+    , m_objectCellsX(0)
+    , m_objectCellsY(0)
+    , m_objectCellSize(1.0f)
+    , m_activationRadius(128.0f)
+    , m_activationFrame(0)
+    , m_tracePass(0)
     , m_mapFile(mapFile)
+    , m_mapRsc(mapRsc)
 {
     // Initialize Bullet Physics world
-    m_collisionConfig = new btDefaultCollisionConfiguration();
-    m_dispatcher = new btCollisionDispatcher(m_collisionConfig);
-    m_broadphase = new btDbvtBroadphase();
-    m_solver = new btSequentialImpulseConstraintSolver();
-    
-    m_dynamicsWorld = new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_collisionConfig);
+    createDynamicsWorld(settings);
     // Use much stronger gravity for snappy FPS player movement feel
     // Bullets can have separate physics properties if needed
     float gameGravity = -115.3f; // Realistic Earth gravity (9.8 m/s² scaled to 1 unit = 8.5cm)
     m_dynamicsWorld->setGravity(btVector3(0, gameGravity, 0));
     
+    m_traceObject = std::make_unique<btCollisionObject>();
+    
     // Initialize debug drawer for physics visualization
     m_debugDrawer = std::make_unique<CEBulletDebugDraw>();
     m_dynamicsWorld->setDebugDrawer(m_debugDrawer.get());
     
+    if (!shapes) {
+        shapes = buildStaticShapes(mapFile, mapRsc);
+    }
+    
+    if (mapFile) {
+        m_activationRadius = mapFile->getTileLength() * 8.0f;
+    }
+    
     // Setup collision geometry (terrain and world objects optimized for performance)
-    // setupTerrain(mapFile);  // DISABLED: Too expensive, using height checks instead
-    setupHeightfieldTerrain(mapFile);  // NEW: Bullet Physics heightfield terrain
-    setupWorldObjects(mapRsc);  // RE-ENABLED: Optimized AABB-based hierarchical collision
+    setupHeightfieldTerrain(std::move(shapes->heightfield));  // NEW: Bullet Physics heightfield terrain
+    setupWorldObjects(mapRsc, std::move(shapes->modelShapes));  // RE-ENABLED: Optimized AABB-based hierarchical collision
     setupWaterPlanes(mapFile);  // RE-ENABLED: For water collision detection
     
+    if (settings.steppingThread) {
+        m_stepThread = std::thread(&CEPhysicsWorld::runStepThread, this);
+    }
 }
 
 CEPhysicsWorld::~CEPhysicsWorld()
 {
+    if (m_stepThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_stepMutex);
+            m_stopStepping = true;
+        }
+        m_stepCondition.notify_one();
+        m_stepThread.join();
+    }
+    
     // Remove heightfield terrain from world before cleanup
     if (m_heightfieldTerrain) {
         m_heightfieldTerrain->removeFromWorld(m_dynamicsWorld);
@@ -79,7 +189,7 @@ CEPhysicsWorld::~CEPhysicsWorld()
     }
     
     // Clean up collision shapes
-    for (auto* shape : m_objectShapes) {
+    for (auto* shape : m_scaledShapes) {
         delete shape;
     }
     for (auto* baseShape : m_baseBvhShapes) {
@@ -92,141 +202,151 @@ CEPhysicsWorld::~CEPhysicsWorld()
         delete shape;
     }
     
-    if (m_terrainShape) delete m_terrainShape;
-    if (m_terrainMesh) delete m_terrainMesh;
-    
     // Clean up Bullet world
     delete m_dynamicsWorld;
     delete m_solver;
+    delete m_solverPool;
     delete m_broadphase;
     delete m_dispatcher;
     delete m_collisionConfig;
 }
 
-void CEPhysicsWorld::setupHeightfieldTerrain(C2MapFile* mapFile)
+/*
+ * The multithreaded world runs narrowphase and island solving as tasks on Bullet's scheduler. It
+ * only exists when Bullet is built with BT_THREADSAFE; otherwise the sequential world is used.
+ */
+void CEPhysicsWorld::createDynamicsWorld(const SimulationSettings& settings)
 {
-    if (!mapFile) return;
+    m_collisionConfig = new btDefaultCollisionConfiguration();
+    m_broadphase = new btDbvtBroadphase();
     
+#if BT_THREADSAFE
+    btITaskScheduler* scheduler = settings.multithreaded ? sharedTaskScheduler() : nullptr;
+    if (scheduler) {
+        int threads = settings.workerThreads > 0 ? settings.workerThreads : (int)std::thread::hardware_concurrency() - 1;
+        scheduler->setNumThreads(std::clamp(threads, 1, scheduler->getMaxNumThreads()));
+        
+        m_dispatcher = new btCollisionDispatcherMt(m_collisionConfig);
+        m_solverPool = new btConstraintSolverPoolMt(scheduler->getNumThreads());
+        m_solver = new btSequentialImpulseConstraintSolverMt();
+        m_dynamicsWorld = new btDiscreteDynamicsWorldMt(m_dispatcher, m_broadphase, m_solverPool, m_solver, m_collisionConfig);
+        
+        std::cout << "CEPhysicsWorld: Multithreaded world on " << scheduler->getName() << " with "
+                  << scheduler->getNumThreads() << " threads" << std::endl;
+        return;
+    }
+#endif
+    if (settings.multithreaded) {
+        std::cerr << "CEPhysicsWorld: Bullet has no task scheduler in this build, using the single-threaded world" << std::endl;
+    }
+    
+    m_dispatcher = new btCollisionDispatcher(m_collisionConfig);
+    m_solver = new btSequentialImpulseConstraintSolver();
+    m_dynamicsWorld = new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_collisionConfig);
+}
+
+void CEPhysicsWorld::setupHeightfieldTerrain(std::unique_ptr<CEBulletHeightfield> heightfield)
+{
+    if (!heightfield) return;
     
-    // Create single terrain triangle mesh with exact subdivision matching
-    m_heightfieldTerrain = std::make_unique<CEBulletHeightfield>(mapFile);
+    m_heightfieldTerrain = std::move(heightfield);
     
     // Add terrain mesh to physics world
     m_heightfieldTerrain->addToWorld(m_dynamicsWorld);
     
-    // Register terrain body in object info map for proper collision detection
-    const auto* terrainMesh = m_heightfieldTerrain->getTerrainMesh();
-    if (terrainMesh && terrainMesh->terrainBody) {
+    // Register terrain bodies for proper collision detection
+    for (const auto& section : m_heightfieldTerrain->getSections()) {
         CollisionObjectInfo terrainInfo;
         terrainInfo.type = CollisionObjectType::HEIGHTFIELD_TERRAIN;
-        terrainInfo.objectName = "TerrainTriangleMesh";
-        m_objectInfoMap[terrainMesh->terrainBody] = terrainInfo;
+        terrainInfo.objectName = "TerrainHeightfield";
+        registerCollisionObject(section.second->terrainBody, terrainInfo);
     }
     
     int totalTriangles = m_heightfieldTerrain->getTriangleCount();
 }
 
-void CEPhysicsWorld::setupTerrain(C2MapFile* mapFile)
+/*
+ * (Re)build one page's terrain section; the old body, if any, gives up its info slot
+ */
+void CEPhysicsWorld::addTerrainSection(int page)
 {
-    if (!mapFile) return;
-    
-    m_terrainMesh = new btTriangleMesh();
-    
-    float tileLength = mapFile->getTileLength();
-    int width = mapFile->getWidth();
-    int height = mapFile->getHeight();
-    
-    
-    // Create triangle mesh from heightfield
-    for (int y = 0; y < height - 1; y++) {
-        for (int x = 0; x < width - 1; x++) {
-            // Get height values for the four corners of this tile
-            float h1 = mapFile->getPlaceGroundHeight(x, y);
-            float h2 = mapFile->getPlaceGroundHeight(x + 1, y);
-            float h3 = mapFile->getPlaceGroundHeight(x, y + 1);
-            float h4 = mapFile->getPlaceGroundHeight(x + 1, y + 1);
-            
-            // Convert to world coordinates
-            float worldX1 = x * tileLength;
-            float worldZ1 = y * tileLength;
-            float worldX2 = (x + 1) * tileLength;
-            float worldZ2 = (y + 1) * tileLength;
-            
-            // Create two triangles for each tile
-            // Triangle 1: (x,y), (x+1,y), (x,y+1)
-            m_terrainMesh->addTriangle(
-                btVector3(worldX1, h1, worldZ1),
-                btVector3(worldX2, h2, worldZ1),
-                btVector3(worldX1, h3, worldZ2)
-            );
-            
-            // Triangle 2: (x+1,y), (x+1,y+1), (x,y+1)
-            m_terrainMesh->addTriangle(
-                btVector3(worldX2, h2, worldZ1),
-                btVector3(worldX2, h4, worldZ2),
-                btVector3(worldX1, h3, worldZ2)
-            );
-        }
+    const auto* oldSection = m_heightfieldTerrain->getSection(page);
+    if (oldSection) {
+        unregisterCollisionObject(oldSection->terrainBody);
     }
     
-    // Create collision shape from mesh
-    m_terrainShape = new btBvhTriangleMeshShape(m_terrainMesh, true);
+    m_heightfieldTerrain->addSection(m_dynamicsWorld, page);
     
-    // Create rigid body for terrain (static)
-    m_terrainBody = createStaticBody(m_terrainShape, glm::vec3(0, 0, 0));
-    
-    // Store terrain object info
     CollisionObjectInfo terrainInfo;
-    terrainInfo.type = CollisionObjectType::TERRAIN;
-    terrainInfo.objectName = "Terrain";
-    m_objectInfoMap[m_terrainBody] = terrainInfo;
-    
+    terrainInfo.type = CollisionObjectType::HEIGHTFIELD_TERRAIN;
+    terrainInfo.objectName = "TerrainHeightfield";
+    registerCollisionObject(m_heightfieldTerrain->getSection(page)->terrainBody, terrainInfo);
 }
 
-void CEPhysicsWorld::setupWorldObjects(C2MapRscFile* mapRsc)
+void CEPhysicsWorld::setupWorldObjects(C2MapRscFile* mapRsc, std::vector<btBvhTriangleMeshShape*> modelShapes)
 {
     if (!mapRsc) return;
     
-    int objectCount = mapRsc->getWorldModelCount();
-    
-    // Performance: Maximum collision range
-    float tileLength = m_mapFile->getTileLength();
-    float maxCollisionRange = 300.0f; // Reasonable range for bullet collision detection
-    float maxCollisionRangeSq = maxCollisionRange * maxCollisionRange;
-    
-    for (int i = 0; i < objectCount; i++) {
-        CEWorldModel* model = mapRsc->getWorldModel(i);
-        if (!model) continue;
+    // Base shapes are freed with the world from here on
+    m_baseBvhShapes = std::move(modelShapes);
+    
+    // Every instance is drawn at the same scale, so one scaled shape per model serves them all
+    btVector3 scale(0.0625f, 0.0625f, 0.0625f);
+    btTransform identity;
+    identity.setIdentity();
+    m_scaledShapes.assign(m_baseBvhShapes.size(), nullptr);
+    m_modelRadius.assign(m_baseBvhShapes.size(), 0.0f);
+    for (size_t i = 0; i < m_baseBvhShapes.size(); i++) {
+        if (!m_baseBvhShapes[i]) continue;
         
-        // Get object dimensions
-        auto objectInfo = model->getObjectInfo();
-        float radius = objectInfo->Radius;
-        
-        // Skip objects with no valid dimensions
-        if (radius <= 0) {
-            continue;
-        }
+        m_scaledShapes[i] = new btScaledBvhTriangleMeshShape(m_baseBvhShapes[i], scale);
         
-        // Create triangle mesh from geometry (shared by all instances)
-        btTriangleIndexVertexArray* tiv = model->getGeometry()->getPhysicalMesh();
-        if (!tiv || tiv->getNumSubParts() < 1) {
-            continue;
+        // Bounds any rotation of the instance about its origin
+        btVector3 aabbMin, aabbMax;
+        m_scaledShapes[i]->getAabb(identity, aabbMin, aabbMax);
+        m_modelRadius[i] = std::max(aabbMin.length(), aabbMax.length());
+        m_maxObjectRadius = std::max(m_maxObjectRadius, m_modelRadius[i]);
+    }
+    
+    m_objectCellSize = m_mapFile->getTileLength() * OBJECT_CELL_TILES;
+    m_objectCellsX = std::max(1, (m_mapFile->getWidth() + OBJECT_CELL_TILES - 1) / OBJECT_CELL_TILES);
+    m_objectCellsY = std::max(1, (m_mapFile->getHeight() + OBJECT_CELL_TILES - 1) / OBJECT_CELL_TILES);
+    m_objectCells.assign(m_objectCellsX * m_objectCellsY, {});
+    
+    if (!m_mapFile->isStreamed()) {
+        addObjectInstances(mapRsc, -1, nullptr);
+    } else {
+        // Streamed worlds keep instances per page so eviction can free them
+        int pageCount = m_mapFile->getPagesX() * m_mapFile->getPagesY();
+        for (int page = 0; page < pageCount; page++) {
+            if (m_mapFile->isPageResident(page)) {
+                addObjectInstances(mapRsc, page, &m_pageObjects[page]);
+            }
         }
-        
-        // Create base BVH triangle mesh shape (shared by all instances)
-        btBvhTriangleMeshShape* baseBvhShape = new btBvhTriangleMeshShape(tiv, true);
-        baseBvhShape->setMargin(0.01f);
+    }
+    
+    std::cout << "Physics: " << getObjectInstanceCount() << " world object instances, activated within "
+              << m_activationRadius << " units of the player, AI and projectiles" << std::endl;
+}
 
-        // Store base shape and mesh for cleanup
-        m_baseBvhShapes.push_back(baseBvhShape);
+/*
+ * Grid entries for the instances placed by one page (page -1: every instance). No bodies are made
+ * here; updateObjectActivation() creates them as activators come near
+ */
+void CEPhysicsWorld::addObjectInstances(C2MapRscFile* mapRsc, int page, std::vector<int>* instances)
+{
+    int objectCount = std::min(mapRsc->getWorldModelCount(), (int)m_scaledShapes.size());
+    
+    for (int i = 0; i < objectCount; i++) {
+        CEWorldModel* model = mapRsc->getWorldModel(i);
+        if (!model || !m_scaledShapes[i]) continue;
         
-        // Create instances using btScaledBvhTriangleMeshShape
         const auto& transforms = model->getTransforms();
-        int instanceIndex = 0;
-        int culledInstances = 0;
-        
         
-        for (const auto& transform : transforms) {
+        for (size_t instanceIndex = 0; instanceIndex < transforms.size(); instanceIndex++) {
+            if (page >= 0 && model->getInstanceGroup(instanceIndex) != page) continue;
+            
+            const Transform& transform = transforms[instanceIndex];
             glm::vec3 position = *const_cast<Transform&>(transform).GetPos();
             glm::vec3 rotation = *const_cast<Transform&>(transform).GetRot(); // Extract rotation!
 
@@ -242,39 +362,164 @@ void CEPhysicsWorld::setupWorldObjects(C2MapRscFile* mapRsc)
                 objectPosition = position;
             }
             
-            // Create scaled instance of the base BVH shape
-            // Use the scaling that matches visual rendering
-            btVector3 scale(0.0625f, 0.0625f, 0.0625f);
-            btScaledBvhTriangleMeshShape* scaledShape = new btScaledBvhTriangleMeshShape(baseBvhShape, scale);
-            
-            // Create rigid body for this instance WITH ROTATION to match visual rendering
-            btRigidBody* instanceBody = createStaticBody(scaledShape, objectPosition, rotation);
-            
-            // Set collision filtering
-            short objectGroup = OBJECT_GROUP;
-            short objectMask = -1; // Collide with everything
-            m_dynamicsWorld->removeRigidBody(instanceBody);
-            m_dynamicsWorld->addRigidBody(instanceBody, objectGroup, objectMask);
+            int id;
+            if (!m_freeObjectInstances.empty()) {
+                id = m_freeObjectInstances.back();
+                m_freeObjectInstances.pop_back();
+            } else {
+                id = (int)m_objectInstances.size();
+                m_objectInstances.emplace_back();
+            }
             
-            // Store for cleanup
-            m_objectShapes.push_back(scaledShape);
-            m_objectBodies.push_back(instanceBody);
+            int cellX = std::clamp((int)std::floor(objectPosition.x / m_objectCellSize), 0, m_objectCellsX - 1);
+            int cellY = std::clamp((int)std::floor(objectPosition.z / m_objectCellSize), 0, m_objectCellsY - 1);
             
-            // Store object info
-            CollisionObjectInfo instanceInfo;
-            instanceInfo.type = CollisionObjectType::WORLD_OBJECT;
-            instanceInfo.objectIndex = i;
-            instanceInfo.instanceIndex = instanceIndex;
-            instanceInfo.objectName = "ScaledBVH_" + std::to_string(i) + "_Instance_" + std::to_string(instanceIndex);
-            instanceInfo.worldModel = model;
-            instanceInfo.instanceTransform = objectPosition;
-            m_objectInfoMap[instanceBody] = instanceInfo;
+            _ObjectInstance& instance = m_objectInstances[id];
+            instance = _ObjectInstance();
+            instance.position = objectPosition;
+            instance.rotation = rotation;
+            instance.model = i;
+            instance.instance = (int)instanceIndex;
+            instance.cell = (cellY * m_objectCellsX) + cellX;
+            m_objectCells[instance.cell].push_back(id);
             
-            instanceIndex++;
+            if (instances) {
+                instances->push_back(id);
+            }
         }
-        
+    }
+}
+
+void CEPhysicsWorld::removeObjectInstance(int id)
+{
+    _ObjectInstance& instance = m_objectInstances[id];
+    if (instance.body) {
+        deactivateObject(id);
+    }
+    
+    auto& cell = m_objectCells[instance.cell];
+    auto it = std::find(cell.begin(), cell.end(), id);
+    if (it != cell.end()) {
+        *it = cell.back();
+        cell.pop_back();
+    }
+    
+    instance = _ObjectInstance();
+    m_freeObjectInstances.push_back(id);
+}
+
+// Instance transform WITH ROTATION to match visual rendering
+static btTransform objectTransform(const glm::vec3& position, const glm::vec3& rotation)
+{
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(btVector3(position.x, position.y, position.z));
+    btQuaternion quat;
+    quat.setEulerZYX(rotation.z, rotation.y, rotation.x); // Bullet uses Z,Y,X order
+    transform.setRotation(quat);
+    return transform;
+}
+
+/*
+ * Static body for one instance. Static bodies never move, so they go without a motion state
+ */
+void CEPhysicsWorld::activateObject(int id)
+{
+    _ObjectInstance& instance = m_objectInstances[id];
+    
+    btRigidBody::btRigidBodyConstructionInfo rbInfo(0, nullptr, m_scaledShapes[instance.model], btVector3(0, 0, 0));
+    rbInfo.m_startWorldTransform = objectTransform(instance.position, instance.rotation);
+    instance.body = new btRigidBody(rbInfo);
+    instance.body->setUserIndex(-2 - id);
+    
+    // Collide with everything
+    m_dynamicsWorld->addRigidBody(instance.body, OBJECT_GROUP, -1);
+    
+    instance.activeSlot = (int)m_activeObjects.size();
+    m_activeObjects.push_back(id);
+}
+
+void CEPhysicsWorld::deactivateObject(int id)
+{
+    _ObjectInstance& instance = m_objectInstances[id];
+    
+    m_dynamicsWorld->removeRigidBody(instance.body);
+    delete instance.body;
+    instance.body = nullptr;
+    
+    int moved = m_activeObjects.back();
+    m_activeObjects[instance.activeSlot] = moved;
+    m_objectInstances[moved].activeSlot = instance.activeSlot;
+    m_activeObjects.pop_back();
+    instance.activeSlot = -1;
+}
+
+void CEPhysicsWorld::addActivator(const glm::vec3& position)
+{
+    addActivator(position, position, m_activationRadius);
+}
+
+void CEPhysicsWorld::addActivator(const glm::vec3& from, const glm::vec3& to, float radius)
+{
+    m_activators.push_back(_Activator{ glm::vec2(from.x, from.z), glm::vec2(to.x, to.z), radius });
+}
+
+/*
+ * Instances come in within an activator's radius and stay until every activator is more than
+ * ACTIVATION_HYSTERESIS times its radius away, so bodies aren't rebuilt every frame at the
+ * boundary. Distances are measured in the ground plane to the instance's bounding circle.
+ */
+void CEPhysicsWorld::updateObjectActivation()
+{
+    auto lock = lockWorld();
+    
+    if (m_objectCells.empty()) {
+        m_activators.clear();
+        return;
     }
     
+    m_activationFrame++;
+    
+    for (const _Activator& activator : m_activators) {
+        float keep = activator.radius * ACTIVATION_HYSTERESIS;
+        float reach = keep + m_maxObjectRadius;
+        glm::vec2 low = glm::min(activator.from, activator.to) - reach;
+        glm::vec2 high = glm::max(activator.from, activator.to) + reach;
+        int cellX0 = std::clamp((int)std::floor(low.x / m_objectCellSize), 0, m_objectCellsX - 1);
+        int cellX1 = std::clamp((int)std::floor(high.x / m_objectCellSize), 0, m_objectCellsX - 1);
+        int cellY0 = std::clamp((int)std::floor(low.y / m_objectCellSize), 0, m_objectCellsY - 1);
+        int cellY1 = std::clamp((int)std::floor(high.y / m_objectCellSize), 0, m_objectCellsY - 1);
+        
+        glm::vec2 segment = activator.to - activator.from;
+        float lengthSq = glm::dot(segment, segment);
+        
+        for (int cellY = cellY0; cellY <= cellY1; cellY++) {
+            for (int cellX = cellX0; cellX <= cellX1; cellX++) {
+                for (int id : m_objectCells[(cellY * m_objectCellsX) + cellX]) {
+                    _ObjectInstance& instance = m_objectInstances[id];
+                    glm::vec2 point(instance.position.x, instance.position.z);
+                    float t = lengthSq > 0.0f ? glm::clamp(glm::dot(point - activator.from, segment) / lengthSq, 0.0f, 1.0f) : 0.0f;
+                    float distance = glm::distance(point, activator.from + (segment * t)) - m_modelRadius[instance.model];
+                    if (distance > keep) continue;
+                    
+                    instance.keptFrame = m_activationFrame;
+                    if (!instance.body && distance <= activator.radius) {
+                        activateObject(id);
+                    }
+                }
+            }
+        }
+    }
+    m_activators.clear();
+    
+    // Whatever no activator kept this pass leaves the world; swap-removal only moves entries
+    // that were already checked
+    for (size_t i = m_activeObjects.size(); i-- > 0;) {
+        int id = m_activeObjects[i];
+        if (m_objectInstances[id].keptFrame != m_activationFrame) {
+            deactivateObject(id);
+        }
+    }
 }
 
 void CEPhysicsWorld::setupWaterPlanes(C2MapFile* mapFile)
@@ -314,7 +559,7 @@ void CEPhysicsWorld::setupWaterPlanes(C2MapFile* mapFile)
     CollisionObjectInfo waterInfo;
     waterInfo.type = CollisionObjectType::WATER_PLANE;
     waterInfo.objectName = "Water Plane";
-    m_objectInfoMap[waterBody] = waterInfo;
+    registerCollisionObject(waterBody, waterInfo);
     
     // Store for cleanup
     m_waterShapes.push_back(waterShape);
@@ -324,6 +569,8 @@ void CEPhysicsWorld::setupWaterPlanes(C2MapFile* mapFile)
 
 btRigidBody* CEPhysicsWorld::createStaticBody(btCollisionShape* shape, const glm::vec3& position)
 {
+    auto lock = lockWorld();
+    
     btTransform transform;
     transform.setIdentity();
     transform.setOrigin(btVector3(position.x, position.y, position.z));
@@ -341,6 +588,8 @@ btRigidBody* CEPhysicsWorld::createStaticBody(btCollisionShape* shape, const glm
 
 btRigidBody* CEPhysicsWorld::createStaticBody(btCollisionShape* shape, const glm::vec3& position, const glm::vec3& rotation)
 {
+    auto lock = lockWorld();
+    
     btTransform transform;
     transform.setIdentity();
     transform.setOrigin(btVector3(position.x, position.y, position.z));
@@ -362,45 +611,72 @@ btRigidBody* CEPhysicsWorld::createStaticBody(btCollisionShape* shape, const glm
     return body;
 }
 
-btRigidBody* CEPhysicsWorld::createProjectile(const glm::vec3& position, const glm::vec3& velocity, float mass)
+void CEPhysicsWorld::stepSimulation(float deltaTime)
 {
-    // Create small sphere for bullet
-    btSphereShape* bulletShape = new btSphereShape(0.005f); // 5mm radius
-    
-    btTransform transform;
-    transform.setIdentity();
-    transform.setOrigin(btVector3(position.x, position.y, position.z));
-    
-    btVector3 localInertia;
-    bulletShape->calculateLocalInertia(mass, localInertia);
+    if (!m_dynamicsWorld) return;
     
-    btDefaultMotionState* motionState = new btDefaultMotionState(transform);
-    btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, motionState, bulletShape, localInertia);
-    btRigidBody* body = new btRigidBody(rbInfo);
-    
-    // Set initial velocity
-    body->setLinearVelocity(btVector3(velocity.x, velocity.y, velocity.z));
+    updateObjectActivation();
     
-    // Add to world
-    m_dynamicsWorld->addRigidBody(body);
+    if (m_stepThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> stepLock(m_stepMutex);
+            m_pendingTime += deltaTime;
+        }
+        m_stepCondition.notify_one();
+        return;
+    }
     
-    return body;
+    // Bullet keeps the time left over below a fixed step and interpolates motion states by it
+    auto lock = lockWorld();
+    m_dynamicsWorld->stepSimulation(deltaTime, MAX_SUBSTEPS, FIXED_TIMESTEP);
 }
 
-void CEPhysicsWorld::stepSimulation(float deltaTime)
+/*
+ * Takes whatever time the render thread has handed over and steps it, giving the world back
+ * between fixed steps so a query never waits longer than one step
+ */
+void CEPhysicsWorld::runStepThread()
 {
-    if (m_dynamicsWorld) {
-        // Optimized physics for scaled world (64 units/tile vs 256)
-        // 240Hz provides excellent collision detection at reasonable performance cost
-        float fixedTimeStep = 1.0f / 60.0f; // 60-240 Hz physics for scaled world
-        int maxSubSteps = 4; // Reasonable substeps for good performance
+    for (;;) {
+        float pending;
+        {
+            std::unique_lock<std::mutex> stepLock(m_stepMutex);
+            m_stepCondition.wait(stepLock, [this]() { return m_pendingTime > 0.0f || m_stopStepping; });
+            if (m_stopStepping) return;
+            pending = m_pendingTime;
+            m_pendingTime = 0.0f;
+        }
         
-        m_dynamicsWorld->stepSimulation(deltaTime, maxSubSteps, fixedTimeStep);
+        // Same cap as MAX_SUBSTEPS on the render thread: a long stall isn't caught up on
+        pending = std::min(pending, FIXED_TIMESTEP * MAX_SUBSTEPS);
+        while (pending > 0.0f) {
+            float slice = std::min(pending, FIXED_TIMESTEP);
+            auto lock = lockWorld();
+            m_dynamicsWorld->stepSimulation(slice, MAX_SUBSTEPS, FIXED_TIMESTEP);
+            pending -= slice;
+        }
+    }
+}
+
+glm::mat4 CEPhysicsWorld::getInterpolatedTransform(btRigidBody* body)
+{
+    auto lock = lockWorld();
+    
+    // Bullet writes moving bodies' motion states interpolated between the last two fixed steps
+    btTransform transform = body->getWorldTransform();
+    if (!body->isStaticOrKinematicObject() && body->getMotionState()) {
+        body->getMotionState()->getWorldTransform(transform);
     }
+    
+    btScalar matrix[16];
+    transform.getOpenGLMatrix(matrix);
+    return glm::make_mat4(matrix);
 }
 
 CEPhysicsWorld::RaycastResult CEPhysicsWorld::raycast(const glm::vec3& from, const glm::vec3& to)
 {
+    auto lock = lockWorld();
+    
     RaycastResult result;
     
     // Validate ray
@@ -437,15 +713,255 @@ CEPhysicsWorld::RaycastResult CEPhysicsWorld::raycast(const glm::vec3& from, con
         result.distance = glm::distance(from, result.hitPoint);
         
         // Look up object information
-        auto it = m_objectInfoMap.find(result.hitBody);
-        if (it != m_objectInfoMap.end()) {
-            result.objectInfo = it->second;
+        result.objectInfo = getObjectInfo(rayCallback.m_collisionObject);
+    }
+    
+    return result;
+}
+
+/*
+ * Visits the cells of a unit grid crossed by the segment (u0, v0)-(u1, v1) in order, with the
+ * segment parameters at which it enters and leaves each; visit returns true to stop
+ */
+template <typename Visit>
+static void walkGrid(float u0, float v0, float u1, float v1, Visit visit)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    int cellX = (int)std::floor(u0);
+    int cellY = (int)std::floor(v0);
+    float du = u1 - u0;
+    float dv = v1 - v0;
+    int stepX = du > 0.0f ? 1 : -1;
+    int stepY = dv > 0.0f ? 1 : -1;
+    float deltaX = du != 0.0f ? 1.0f / std::abs(du) : inf;
+    float deltaY = dv != 0.0f ? 1.0f / std::abs(dv) : inf;
+    float nextX = du > 0.0f ? (cellX + 1 - u0) * deltaX : (du < 0.0f ? (u0 - cellX) * deltaX : inf);
+    float nextY = dv > 0.0f ? (cellY + 1 - v0) * deltaY : (dv < 0.0f ? (v0 - cellY) * deltaY : inf);
+    
+    int cells = std::abs((int)std::floor(u1) - cellX) + std::abs((int)std::floor(v1) - cellY) + 1;
+    float t = 0.0f;
+    for (int i = 0; i < cells; i++) {
+        float exit = std::min({ nextX, nextY, 1.0f });
+        if (visit(cellX, cellY, t, exit)) return;
+        
+        if (nextX < nextY) {
+            cellX += stepX;
+            t = nextX;
+            nextX += deltaX;
         } else {
-            result.objectInfo.type = CollisionObjectType::TERRAIN;
-            result.objectInfo.objectName = "Unknown";
+            cellY += stepY;
+            t = nextY;
+            nextY += deltaY;
         }
     }
+}
+
+// Two-sided segment/triangle test (Moller-Trumbore); t is the parameter along origin + dir
+static bool intersectSegmentTriangle(const glm::vec3& origin, const glm::vec3& dir, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t)
+{
+    glm::vec3 edge1 = b - a;
+    glm::vec3 edge2 = c - a;
+    glm::vec3 p = glm::cross(dir, edge2);
+    float det = glm::dot(edge1, p);
+    if (std::abs(det) < 1e-12f) return false;
+    
+    float invDet = 1.0f / det;
+    glm::vec3 s = origin - a;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+    
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = glm::dot(dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    
+    t = glm::dot(edge2, q) * invDet;
+    return t >= 0.0f && t <= 1.0f;
+}
+
+/*
+ * Quads are visited in the order the segment crosses them, so the first one it hits holds the
+ * nearest hit. A quad's triangles (same vertices and diagonal as CETerrainCollisionShape) are only
+ * tested when the segment's height over the quad overlaps the quad's height range
+ */
+bool CEPhysicsWorld::traceTerrain(const glm::vec3& from, const glm::vec3& to, float& fraction, glm::vec3& normal) const
+{
+    if (!m_mapFile) return false;
+    
+    const float tile = m_mapFile->getTileLength();
+    const float half = tile / 2.0f;
+    const int width = m_mapFile->getWidth();
+    const int height = m_mapFile->getHeight();
+    const glm::vec3 dir = to - from;
+    bool hit = false;
+    
+    // In quad units quad q spans the tile centres q and q + 1
+    walkGrid((from.x - half) / tile, (from.z - half) / tile, (to.x - half) / tile, (to.z - half) / tile,
+             [&](int x, int y, float enter, float exit) {
+        if (x < 0 || y < 0 || x >= width - 1 || y >= height - 1) return false;
+        if (m_mapFile->isStreamed()) {
+            int pageSize = m_mapFile->getPageSize();
+            if (!m_mapFile->isPageResident(((y / pageSize) * m_mapFile->getPagesX()) + (x / pageSize))) return false;
+        }
+        
+        float hLL = m_mapFile->getHeightAt((y * width) + x);
+        float hLR = m_mapFile->getHeightAt((y * width) + x + 1);
+        float hUL = m_mapFile->getHeightAt(((y + 1) * width) + x);
+        float hUR = m_mapFile->getHeightAt(((y + 1) * width) + x + 1);
+        
+        const float margin = 0.01f;
+        float yEnter = from.y + (dir.y * enter);
+        float yExit = from.y + (dir.y * exit);
+        if (std::min(yEnter, yExit) - margin > std::max({ hLL, hLR, hUL, hUR }) ||
+            std::max(yEnter, yExit) + margin < std::min({ hLL, hLR, hUL, hUR })) {
+            return false;
+        }
+        
+        float worldX1 = (x * tile) + half;
+        float worldZ1 = (y * tile) + half;
+        glm::vec3 vpositionLL(worldX1, hLL, worldZ1);
+        glm::vec3 vpositionLR(worldX1 + tile, hLR, worldZ1);
+        glm::vec3 vpositionUL(worldX1, hUL, worldZ1 + tile);
+        glm::vec3 vpositionUR(worldX1 + tile, hUR, worldZ1 + tile);
+        
+        glm::vec3 triangles[2][3];
+        if (m_mapFile->isQuadRotatedAt((y * width) + x)) {
+            triangles[0][0] = vpositionLL; triangles[0][1] = vpositionUL; triangles[0][2] = vpositionLR;
+            triangles[1][0] = vpositionLR; triangles[1][1] = vpositionUL; triangles[1][2] = vpositionUR;
+        } else {
+            triangles[0][0] = vpositionLL; triangles[0][1] = vpositionUR; triangles[0][2] = vpositionLR;
+            triangles[1][0] = vpositionLL; triangles[1][1] = vpositionUL; triangles[1][2] = vpositionUR;
+        }
+        
+        for (const auto& triangle : triangles) {
+            float t;
+            if (intersectSegmentTriangle(from, dir, triangle[0], triangle[1], triangle[2], t) && (!hit || t < fraction)) {
+                hit = true;
+                fraction = t;
+                normal = glm::normalize(glm::cross(triangle[1] - triangle[0], triangle[2] - triangle[0]));
+            }
+        }
+        return hit;
+    });
+    
+    // Face the side the segment came from
+    if (hit && glm::dot(normal, dir) > 0.0f) {
+        normal = -normal;
+    }
+    return hit;
+}
+
+CEPhysicsWorld::RaycastResult CEPhysicsWorld::traceSegment(const glm::vec3& from, const glm::vec3& to)
+{
+    auto lock = lockWorld();
     
+    RaycastResult result;
+    
+    glm::vec3 dir = to - from;
+    if (glm::length(dir) < 0.001f) {
+        return result;
+    }
+    
+    float terrainFraction = 1.0f;
+    glm::vec3 terrainNormal(0.0f, 1.0f, 0.0f);
+    bool terrainHit = traceTerrain(from, to, terrainFraction, terrainNormal);
+    
+    // Objects and AI only count when nearer than the terrain
+    btVector3 btFrom(from.x, from.y, from.z);
+    btVector3 btTo(to.x, to.y, to.z);
+    btTransform fromTransform;
+    fromTransform.setIdentity();
+    fromTransform.setOrigin(btFrom);
+    btTransform toTransform;
+    toTransform.setIdentity();
+    toTransform.setOrigin(btTo);
+    btCollisionWorld::ClosestRayResultCallback callback(btFrom, btTo);
+    callback.m_closestHitFraction = terrainFraction;
+    
+    int hitInstance = -1;
+    btRigidBody* hitCharacter = nullptr;
+    
+    if (!m_objectCells.empty()) {
+        // Neighbouring cells too, for instances whose bounds reach over a cell border
+        m_tracePass++;
+        int reach = (int)std::ceil(m_maxObjectRadius / m_objectCellSize);
+        float dirLengthSq = glm::dot(dir, dir);
+        
+        walkGrid(from.x / m_objectCellSize, from.z / m_objectCellSize, to.x / m_objectCellSize, to.z / m_objectCellSize,
+                 [&](int cellX, int cellY, float enter, float /*exit*/) {
+            if (enter > callback.m_closestHitFraction) return true;
+            
+            for (int y = std::max(0, cellY - reach); y <= std::min(m_objectCellsY - 1, cellY + reach); y++) {
+                for (int x = std::max(0, cellX - reach); x <= std::min(m_objectCellsX - 1, cellX + reach); x++) {
+                    for (int id : m_objectCells[(y * m_objectCellsX) + x]) {
+                        _ObjectInstance& instance = m_objectInstances[id];
+                        if (instance.tracedPass == m_tracePass) continue;
+                        instance.tracedPass = m_tracePass;
+                        
+                        // Bounding sphere first
+                        float t = glm::clamp(glm::dot(instance.position - from, dir) / dirLengthSq, 0.0f, 1.0f);
+                        glm::vec3 offset = from + (dir * t) - instance.position;
+                        float radius = m_modelRadius[instance.model];
+                        if (glm::dot(offset, offset) > radius * radius) continue;
+                        
+                        btCollisionShape* shape = m_scaledShapes[instance.model];
+                        btTransform transform = objectTransform(instance.position, instance.rotation);
+                        m_traceObject->setCollisionShape(shape);
+                        m_traceObject->setWorldTransform(transform);
+                        
+                        float before = callback.m_closestHitFraction;
+                        btCollisionWorld::rayTestSingle(fromTransform, toTransform, m_traceObject.get(), shape, transform, callback);
+                        if (callback.m_closestHitFraction < before) {
+                            hitInstance = id;
+                        }
+                    }
+                }
+            }
+            return false;
+        });
+    }
+    
+    glm::vec3 segmentMin = glm::min(from, to);
+    glm::vec3 segmentMax = glm::max(from, to);
+    for (btRigidBody* body : m_characterBodies) {
+        btVector3 aabbMin, aabbMax;
+        body->getCollisionShape()->getAabb(body->getWorldTransform(), aabbMin, aabbMax);
+        if (segmentMax.x < aabbMin.x() || segmentMin.x > aabbMax.x() ||
+            segmentMax.y < aabbMin.y() || segmentMin.y > aabbMax.y() ||
+            segmentMax.z < aabbMin.z() || segmentMin.z > aabbMax.z()) {
+            continue;
+        }
+        
+        float before = callback.m_closestHitFraction;
+        btCollisionWorld::rayTestSingle(fromTransform, toTransform, body, body->getCollisionShape(), body->getWorldTransform(), callback);
+        if (callback.m_closestHitFraction < before) {
+            hitCharacter = body;
+            hitInstance = -1;
+        }
+    }
+    
+    if (hitCharacter || hitInstance >= 0) {
+        result.hasHit = true;
+        result.hitPoint = from + (dir * callback.m_closestHitFraction);
+        btVector3 normal = callback.m_hitNormalWorld.normalized();
+        result.hitNormal = glm::vec3(normal.getX(), normal.getY(), normal.getZ());
+        if (hitCharacter) {
+            result.hitBody = hitCharacter;
+            result.objectInfo = getObjectInfo(hitCharacter);
+        } else {
+            result.hitBody = m_objectInstances[hitInstance].body;
+            result.objectInfo = getInstanceInfo(hitInstance);
+        }
+    } else if (terrainHit) {
+        result.hasHit = true;
+        result.hitPoint = from + (dir * terrainFraction);
+        result.hitNormal = terrainNormal;
+        result.objectInfo.type = CollisionObjectType::HEIGHTFIELD_TERRAIN;
+        result.objectInfo.objectName = "TerrainHeightfield";
+    }
+    
+    if (result.hasHit) {
+        result.distance = glm::distance(from, result.hitPoint);
+    }
     return result;
 }
 
@@ -469,6 +985,8 @@ void CEPhysicsWorld::updateHeightfieldForPosition(const glm::vec3& position)
 
 void CEPhysicsWorld::removeRigidBody(btRigidBody* body)
 {
+    auto lock = lockWorld();
+    
     if (body && m_dynamicsWorld) {
         m_dynamicsWorld->removeRigidBody(body);
         
@@ -503,6 +1021,8 @@ void CEPhysicsWorld::renderPhysicsDebug(const glm::mat4& viewProjectionMatrix, c
 {
     if (!m_debugDrawer || !m_dynamicsWorld) return;
     
+    auto lock = lockWorld();
+    
     // Set view-projection matrix and camera position for proper 3D rendering and culling
     m_debugDrawer->setViewProjectionMatrix(viewProjectionMatrix);
     m_debugDrawer->setCameraPosition(cameraPosition);
@@ -525,12 +1045,11 @@ void CEPhysicsWorld::renderPhysicsDebug(const glm::mat4& viewProjectionMatrix, c
         glm::vec3 objectPos(objOrigin.getX(), objOrigin.getY(), objOrigin.getZ());
         
         // Check if this is a terrain partition
-        auto it = m_objectInfoMap.find(static_cast<btRigidBody*>(obj));
-        bool isTerrain = (it != m_objectInfoMap.end() && it->second.type == CollisionObjectType::HEIGHTFIELD_TERRAIN);
+        bool isTerrain = getObjectInfo(obj).type == CollisionObjectType::HEIGHTFIELD_TERRAIN;
         
         if (isTerrain) {
             // For terrain: check if camera is within reasonable range for debug rendering
-            const auto* terrainMesh = m_heightfieldTerrain->getTerrainMesh();
+            const auto* terrainMesh = static_cast<const CEBulletHeightfield::TerrainSection*>(obj->getUserPointer());
             if (terrainMesh) {
                 // Check if camera is within terrain bounds (inside or above the map)
                 bool cameraInsideTerrainBounds = (
@@ -560,9 +1079,14 @@ void CEPhysicsWorld::renderPhysicsDebug(const glm::mat4& viewProjectionMatrix, c
             }
         }
         
-        // Draw this collision object  
+        // Draw this collision object, moving bodies where they are between fixed steps
+        btTransform drawTransform = obj->getWorldTransform();
+        btRigidBody* body = btRigidBody::upcast(obj);
+        if (body && !body->isStaticOrKinematicObject() && body->getMotionState()) {
+            body->getMotionState()->getWorldTransform(drawTransform);
+        }
         btVector3 color = isTerrain ? btVector3(0.0f, 1.0f, 0.0f) : btVector3(1.0f, 1.0f, 0.0f); // Green for terrain, yellow for objects
-        m_dynamicsWorld->debugDrawObject(obj->getWorldTransform(), obj->getCollisionShape(), color);
+        m_dynamicsWorld->debugDrawObject(drawTransform, obj->getCollisionShape(), color);
         drawnObjects++;
     }
     
@@ -571,9 +1095,116 @@ void CEPhysicsWorld::renderPhysicsDebug(const glm::mat4& viewProjectionMatrix, c
     m_debugDrawer->endFrame();
 }
 
+/*
+ * Runs after the terrain renderer has placed the page's object instances
+ */
+void CEPhysicsWorld::onPageLoaded(int page)
+{
+    auto lock = lockWorld();
+    
+    // Edge quads of the sections left of and below the page read its heights, so rebuild them too
+    if (m_heightfieldTerrain) {
+        for (int section : m_heightfieldTerrain->getSectionsReading(page)) {
+            addTerrainSection(section);
+        }
+    }
+    
+    if (m_mapRsc && !m_pageObjects.count(page)) {
+        addObjectInstances(m_mapRsc, page, &m_pageObjects[page]);
+    }
+}
+
+void CEPhysicsWorld::onPageEvicted(int page)
+{
+    auto lock = lockWorld();
+    
+    if (m_heightfieldTerrain) {
+        const auto* section = m_heightfieldTerrain->getSection(page);
+        if (section) {
+            unregisterCollisionObject(section->terrainBody);
+            m_heightfieldTerrain->removeSection(m_dynamicsWorld, page);
+        }
+    }
+    
+    auto it = m_pageObjects.find(page);
+    if (it == m_pageObjects.end()) return;
+    
+    for (int id : it->second) {
+        removeObjectInstance(id);
+    }
+    m_pageObjects.erase(it);
+}
+
 void CEPhysicsWorld::registerCollisionObject(btRigidBody* body, const CollisionObjectInfo& info)
 {
-    if (body) {
-        m_objectInfoMap[body] = info;
+    auto lock = lockWorld();
+    
+    if (!body) return;
+    
+    int slot = body->getUserIndex();
+    if (slot < 0 || slot >= (int)m_objectInfos.size()) {
+        if (!m_freeObjectInfos.empty()) {
+            slot = m_freeObjectInfos.back();
+            m_freeObjectInfos.pop_back();
+        } else {
+            slot = (int)m_objectInfos.size();
+            m_objectInfos.emplace_back();
+        }
+        body->setUserIndex(slot);
+    }
+    m_objectInfos[slot] = info;
+    
+    if (info.type == CollisionObjectType::AI_CHARACTER &&
+        std::find(m_characterBodies.begin(), m_characterBodies.end(), body) == m_characterBodies.end()) {
+        m_characterBodies.push_back(body);
+    }
+}
+
+void CEPhysicsWorld::unregisterCollisionObject(btRigidBody* body)
+{
+    auto lock = lockWorld();
+    
+    if (!body) return;
+    
+    int slot = body->getUserIndex();
+    if (slot >= 0 && slot < (int)m_objectInfos.size()) {
+        m_objectInfos[slot] = CollisionObjectInfo();
+        m_freeObjectInfos.push_back(slot);
+    }
+    body->setUserIndex(-1);
+    
+    m_characterBodies.erase(std::remove(m_characterBodies.begin(), m_characterBodies.end(), body), m_characterBodies.end());
+}
+
+CEPhysicsWorld::CollisionObjectInfo CEPhysicsWorld::getObjectInfo(const btCollisionObject* object) const
+{
+    CollisionObjectInfo info;
+    info.type = CollisionObjectType::TERRAIN;
+    info.objectName = "Unknown";
+    if (!object) return info;
+    
+    int index = object->getUserIndex();
+    if (index >= 0 && index < (int)m_objectInfos.size()) {
+        return m_objectInfos[index];
     }
+    
+    int id = -2 - index;
+    if (id >= 0 && id < (int)m_objectInstances.size() && m_objectInstances[id].model >= 0) {
+        return getInstanceInfo(id);
+    }
+    return info;
+}
+
+CEPhysicsWorld::CollisionObjectInfo CEPhysicsWorld::getInstanceInfo(int id) const
+{
+    const _ObjectInstance& instance = m_objectInstances[id];
+    
+    CollisionObjectInfo info;
+    info.type = CollisionObjectType::WORLD_OBJECT;
+    info.objectIndex = instance.model;
+    info.instanceIndex = instance.instance;
+    info.objectName = "ScaledBVH_" + std::to_string(instance.model) + "_Instance_" + std::to_string(instance.instance);
+    info.worldModel = m_mapRsc ? m_mapRsc->getWorldModel(instance.model) : nullptr;
+    info.instanceTransform = instance.position;
+    return info;
 }
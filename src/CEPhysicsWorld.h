@@ -12,17 +12,24 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <glm/glm.hpp>
 
+#include "IWorldPageListener.h"
+
 // Forward declarations for Bullet Physics
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 class btDbvtBroadphase;
-class btSequentialImpulseConstraintSolver;
+class btConstraintSolver;
+class btConstraintSolverPoolMt;
 class btDiscreteDynamicsWorld;
 class btTriangleMesh;
 class btBvhTriangleMeshShape;
 class btRigidBody;
+class btCollisionObject;
 class btCollisionShape;
 
 // Forward declarations for debug rendering
@@ -33,8 +40,9 @@ class C2MapFile;
 class C2MapRscFile;
 class CEWorldModel;
 class CEBulletHeightfield;
+class CELoadPipeline;
 
-class CEPhysicsWorld
+class CEPhysicsWorld : public IWorldPageListener
 {
 public:
     // Collision object identification
@@ -68,6 +76,25 @@ public:
         glm::vec3 aabbCenter = glm::vec3(0); // AABB center offset from transform
     };
     
+    // Collision shapes that depend only on the map and models, so they can be built before the
+    // world exists and on a loader thread
+    struct StaticShapes {
+        std::unique_ptr<CEBulletHeightfield> heightfield;
+        std::vector<btBvhTriangleMeshShape*> modelShapes; // by model index; null if the model has no collision
+        
+        StaticShapes();
+        ~StaticShapes(); // frees whatever the world didn't take
+    };
+    
+    // Fixed when the world is built
+    struct SimulationSettings {
+        bool multithreaded;  // Bullet's parallel world and solver pool; needs a BT_THREADSAFE build
+        int workerThreads;   // task scheduler threads; 0 leaves one core for the render thread
+        bool steppingThread; // step on a thread of its own instead of inside stepSimulation()
+        
+        SimulationSettings() : multithreaded(false), workerThreads(0), steppingThread(false) {}
+    };
+    
     struct RaycastResult {
         bool hasHit = false;
         glm::vec3 hitPoint;
@@ -82,13 +109,18 @@ private:
     btDefaultCollisionConfiguration* m_collisionConfig;
     btCollisionDispatcher* m_dispatcher;
     btDbvtBroadphase* m_broadphase;
-    btSequentialImpulseConstraintSolver* m_solver;
+    btConstraintSolver* m_solver;
+    btConstraintSolverPoolMt* m_solverPool; // multithreaded worlds only
     btDiscreteDynamicsWorld* m_dynamicsWorld;
     
-    // Terrain collision (legacy - being replaced by heightfield)
-    btTriangleMesh* m_terrainMesh;
-    btBvhTriangleMeshShape* m_terrainShape;
-    btRigidBody* m_terrainBody;
+    // Held while the world is stepped or touched. With a stepping thread the render thread locks
+    // it around its queries and changes, and the thread locks it one fixed step at a time
+    std::recursive_mutex m_worldMutex;
+    std::thread m_stepThread;
+    std::mutex m_stepMutex;
+    std::condition_variable m_stepCondition;
+    float m_pendingTime; // handed over by stepSimulation(), guarded by m_stepMutex
+    bool m_stopStepping;
     
     // Heightfield terrain system
     std::unique_ptr<CEBulletHeightfield> m_heightfieldTerrain;
@@ -98,43 +130,114 @@ private:
     
     // World objects collision
     std::vector<btTriangleMesh*> m_objectMeshes;
-    std::vector<btBvhTriangleMeshShape*> m_baseBvhShapes; // Base BVH shapes for scaling/instancing
-    std::vector<btCollisionShape*> m_objectShapes; // Scaled instances and other shapes
-    std::vector<btRigidBody*> m_objectBodies;
+    std::vector<btBvhTriangleMeshShape*> m_baseBvhShapes; // Base BVH shapes for scaling/instancing, by model index
+    std::vector<btCollisionShape*> m_scaledShapes; // One scaled shape per model, shared by all its instances
+    std::vector<float> m_modelRadius; // Bounding radius of each scaled shape about its origin
+    float m_maxObjectRadius;
+    
+    // Every world object instance is kept here, bucketed in a grid by position; it only has a body
+    // in the dynamics world while an activator is near it
+    struct _ObjectInstance {
+        glm::vec3 position;
+        glm::vec3 rotation;
+        int model = -1; // -1 while the slot is free
+        int instance = -1;
+        int cell = -1;
+        btRigidBody* body = nullptr; // only while active
+        int activeSlot = -1; // index in m_activeObjects
+        int keptFrame = -1; // last activation pass that wanted it in the world
+        int tracedPass = -1; // last traceSegment() that tested it
+    };
+    std::vector<_ObjectInstance> m_objectInstances;
+    std::vector<int> m_freeObjectInstances;
+    constexpr static const int OBJECT_CELL_TILES = 16;
+    std::vector<std::vector<int>> m_objectCells;
+    int m_objectCellsX, m_objectCellsY;
+    float m_objectCellSize;
+    std::vector<int> m_activeObjects;
+    
+    // Objects within radius of the XZ segment from-to are activated; a point when from == to
+    struct _Activator {
+        glm::vec2 from, to;
+        float radius;
+    };
+    std::vector<_Activator> m_activators;
+    float m_activationRadius;
+    int m_activationFrame;
+    
+    // Streamed worlds: object instances placed by each resident page, freed when it is evicted
+    std::map<int, std::vector<int>> m_pageObjects;
     
     // Water planes collision
     std::vector<btCollisionShape*> m_waterShapes;
     std::vector<btRigidBody*> m_waterBodies;
     
-    // Object identification mapping
-    std::map<btRigidBody*, CollisionObjectInfo> m_objectInfoMap;
+    // traceSegment(): a scratch object for testing instances that have no body, and the AI bodies
+    std::unique_ptr<btCollisionObject> m_traceObject;
+    std::vector<btRigidBody*> m_characterBodies;
+    int m_tracePass;
+    
+    // Info of registered bodies, indexed by the body's user index. Object instance bodies carry
+    // -2 - instance instead and their info is derived from the instance
+    std::vector<CollisionObjectInfo> m_objectInfos;
+    std::vector<int> m_freeObjectInfos;
     
     // Keep references to map files for calculations
     C2MapFile* m_mapFile;
     
     // Helper methods
-    void setupTerrain(C2MapFile* mapFile);
-    void setupHeightfieldTerrain(C2MapFile* mapFile);
-    void setupWorldObjects(C2MapRscFile* mapRsc);
+    void setupHeightfieldTerrain(std::unique_ptr<CEBulletHeightfield> heightfield);
+    void setupWorldObjects(C2MapRscFile* mapRsc, std::vector<btBvhTriangleMeshShape*> modelShapes);
     void setupWaterPlanes(C2MapFile* mapFile);
+    void addObjectInstances(C2MapRscFile* mapRsc, int page, std::vector<int>* instances);
+    void removeObjectInstance(int id);
+    void activateObject(int id);
+    void deactivateObject(int id);
+    CollisionObjectInfo getInstanceInfo(int id) const;
+    bool traceTerrain(const glm::vec3& from, const glm::vec3& to, float& fraction, glm::vec3& normal) const;
+    void addTerrainSection(int page);
+    void createDynamicsWorld(const SimulationSettings& settings);
+    void runStepThread();
+    
+    C2MapRscFile* m_mapRsc;
     
 public:
-    CEPhysicsWorld(C2MapFile* mapFile, C2MapRscFile* mapRsc);
+    // Without prebuilt shapes they are built here
+    CEPhysicsWorld(C2MapFile* mapFile, C2MapRscFile* mapRsc, std::unique_ptr<StaticShapes> shapes = nullptr,
+                   const SimulationSettings& settings = SimulationSettings());
     ~CEPhysicsWorld();
+    
+    // Terrain sections and model BVHs; the model BVHs are built in parallel when a pipeline is given
+    static std::unique_ptr<StaticShapes> buildStaticShapes(C2MapFile* mapFile, C2MapRscFile* mapRsc, CELoadPipeline* pipeline = nullptr);
 
   btRigidBody* createStaticBody(btCollisionShape* shape, const glm::vec3& position);
   btRigidBody* createStaticBody(btCollisionShape* shape, const glm::vec3& position, const glm::vec3& rotation);
     
-    // Core physics operations
+    // Core physics operations. Runs object activation, then advances the world in FIXED_TIMESTEP
+    // steps, at most MAX_SUBSTEPS of them; with a stepping thread the steps are handed to it and
+    // this returns at once
     void stepSimulation(float deltaTime);
     btDiscreteDynamicsWorld* getDynamicsWorld() { return m_dynamicsWorld; }
     
-    // Projectile creation
-    btRigidBody* createProjectile(const glm::vec3& position, const glm::vec3& velocity, float mass = 0.008f);
+    // Anything using getDynamicsWorld() directly must hold this while it does
+    std::recursive_mutex& getWorldMutex() { return m_worldMutex; }
+    std::unique_lock<std::recursive_mutex> lockWorld() { return std::unique_lock<std::recursive_mutex>(m_worldMutex); }
+    
+    // A moving body's transform for rendering, interpolated between its last two fixed steps.
+    // Static and kinematic bodies just return their world transform
+    glm::mat4 getInterpolatedTransform(btRigidBody* body);
+    
+    constexpr static const float FIXED_TIMESTEP = 1.0f / 60.0f;
+    constexpr static const int MAX_SUBSTEPS = 4;
     
     // Raycasting for immediate hit detection
     RaycastResult raycast(const glm::vec3& from, const glm::vec3& to);
     
+    // Projectile hit test from-to without the broadphase: a DDA over the height grid's quads, then
+    // narrow-phase tests against the world objects in the grid cells it crosses (active or not)
+    // and the AI bodies whose bounds it overlaps. Water is not tested
+    RaycastResult traceSegment(const glm::vec3& from, const glm::vec3& to);
+    
     // Check if a specific rigid body has any contacts
     bool hasContacts(btRigidBody* body);
     
@@ -159,11 +262,31 @@ public:
     void enablePhysicsDebugRendering(bool enable);
     void renderPhysicsDebug(const glm::mat4& viewProjectionMatrix, const glm::vec3& cameraPosition);
     
-    // Object registration for raycast identification
+    // Object registration for raycast identification; the info slot is kept in the body's user index
     void registerCollisionObject(btRigidBody* body, const CollisionObjectInfo& info);
+    void unregisterCollisionObject(btRigidBody* body);
+    // Type TERRAIN named "Unknown" for bodies that were never registered
+    CollisionObjectInfo getObjectInfo(const btCollisionObject* object) const;
+    
+    // World object bodies near activators are in the dynamics world; the rest wait in the grid.
+    // Activators are collected every frame and consumed by updateObjectActivation(), which
+    // stepSimulation() runs first. A segment covers something's travel over the step
+    void addActivator(const glm::vec3& position);
+    void addActivator(const glm::vec3& from, const glm::vec3& to, float radius);
+    void updateObjectActivation();
+    // Player and AI activators' radius; bodies leave again beyond ACTIVATION_HYSTERESIS times it
+    void setObjectActivationRadius(float radius) { m_activationRadius = radius; }
+    size_t getActiveObjectCount() const { return m_activeObjects.size(); }
+    size_t getObjectInstanceCount() const { return m_objectInstances.size() - m_freeObjectInstances.size(); }
+    
+    constexpr static const float ACTIVATION_HYSTERESIS = 1.5f;
     
     // Cleanup
     void removeRigidBody(btRigidBody* body);
+    
+    // IWorldPageListener
+    void onPageLoaded(int page) override;
+    void onPageEvicted(int page) override;
 };
 
 #endif /* defined(__CE_Character_Lab__CEPhysicsWorld__) */
@@ -0,0 +1,101 @@
+//
+//  CEProjectilePool.cpp
+//  CE Character Lab
+//
+//  Analytic ballistic projectiles kept in pooled structure-of-arrays storage
+//
+
+#include "CEProjectilePool.h"
+
+CEProjectilePool::CEProjectilePool(size_t capacity, float maxLifetime)
+    : m_gravity(0.0f, -15.0f, 0.0f)
+    , m_maxLifetime(maxLifetime)
+{
+    m_position.reserve(capacity);
+    m_velocity.reserve(capacity);
+    m_spawnPosition.reserve(capacity);
+    m_age.reserve(capacity);
+    m_damage.reserve(capacity);
+}
+
+void CEProjectilePool::spawn(const glm::vec3& position, const glm::vec3& velocity, float damage)
+{
+    m_position.push_back(position);
+    m_velocity.push_back(velocity);
+    m_spawnPosition.push_back(position);
+    m_age.push_back(0.0f);
+    m_damage.push_back(damage);
+}
+
+void CEProjectilePool::remove(size_t index)
+{
+    size_t last = m_position.size() - 1;
+    m_position[index] = m_position[last];
+    m_velocity[index] = m_velocity[last];
+    m_spawnPosition[index] = m_spawnPosition[last];
+    m_age[index] = m_age[last];
+    m_damage[index] = m_damage[last];
+
+    m_position.pop_back();
+    m_velocity.pop_back();
+    m_spawnPosition.pop_back();
+    m_age.pop_back();
+    m_damage.pop_back();
+}
+
+void CEProjectilePool::step(float deltaTime, CEPhysicsWorld* physics, std::vector<Impact>& impacts)
+{
+    if (!physics || deltaTime <= 0.0f) return;
+
+    for (size_t i = 0; i < m_position.size();) {
+        const glm::vec3 position = m_position[i];
+        const glm::vec3 next = position + (m_velocity[i] * deltaTime) + (0.5f * m_gravity * deltaTime * deltaTime);
+
+        auto hit = physics->traceSegment(position, next);
+        if (hit.hasHit) {
+            Impact impact;
+            impact.point = hit.hitPoint;
+            impact.normal = hit.hitNormal;
+            impact.distance = glm::distance(hit.hitPoint, m_spawnPosition[i]);
+            impact.damage = m_damage[i];
+
+            // Velocity where it hit along the arc
+            float stepFraction = glm::distance(position, hit.hitPoint) / glm::max(glm::distance(position, next), 1e-6f);
+            impact.velocity = m_velocity[i] + (m_gravity * (deltaTime * stepFraction));
+
+            switch (hit.objectInfo.type) {
+                case CEPhysicsWorld::CollisionObjectType::TERRAIN:
+                case CEPhysicsWorld::CollisionObjectType::HEIGHTFIELD_TERRAIN:
+                    impact.surfaceType = "terrain";
+                    break;
+                case CEPhysicsWorld::CollisionObjectType::WORLD_OBJECT:
+                    impact.surfaceType = "object";
+                    break;
+                case CEPhysicsWorld::CollisionObjectType::WATER_PLANE:
+                    impact.surfaceType = "water";
+                    break;
+                case CEPhysicsWorld::CollisionObjectType::AI_CHARACTER:
+                    impact.surfaceType = "ai_character";
+                    break;
+                default:
+                    impact.surfaceType = "unknown";
+                    break;
+            }
+
+            impact.hit = std::move(hit);
+            impacts.push_back(std::move(impact));
+            remove(i);
+            continue;
+        }
+
+        m_age[i] += deltaTime;
+        if (m_age[i] > m_maxLifetime) {
+            remove(i);
+            continue;
+        }
+
+        m_position[i] = next;
+        m_velocity[i] += m_gravity * deltaTime;
+        i++;
+    }
+}
@@ -0,0 +1,62 @@
+//
+//  CEProjectilePool.h
+//  CE Character Lab
+//
+//  Analytic ballistic projectiles kept in pooled structure-of-arrays storage
+//
+
+#ifndef __CE_Character_Lab__CEProjectilePool__
+#define __CE_Character_Lab__CEProjectilePool__
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+#include "CEPhysicsWorld.h"
+
+/*
+ * Projectiles follow the closed-form arc p + v t + g t^2 / 2 over each step, and the step's chord is
+ * tested with CEPhysicsWorld::traceSegment(); none of them is a Bullet body. Live projectiles are
+ * packed at the front of the arrays and a finished one is replaced by the last, so once the arrays
+ * have grown to the peak count, firing and removal don't allocate.
+ */
+class CEProjectilePool
+{
+public:
+    struct Impact {
+        glm::vec3 point;
+        glm::vec3 normal;
+        glm::vec3 velocity;      // when it hit
+        std::string surfaceType; // "terrain", "object", "water", "ai_character" or "unknown"
+        float distance;          // from the spawn point
+        float damage;
+        CEPhysicsWorld::RaycastResult hit;
+    };
+
+private:
+    std::vector<glm::vec3> m_position;
+    std::vector<glm::vec3> m_velocity;
+    std::vector<glm::vec3> m_spawnPosition;
+    std::vector<float> m_age;
+    std::vector<float> m_damage;
+
+    glm::vec3 m_gravity;
+    float m_maxLifetime;
+
+    void remove(size_t index);
+
+public:
+    CEProjectilePool(size_t capacity = 256, float maxLifetime = 10.0f);
+
+    void spawn(const glm::vec3& position, const glm::vec3& velocity, float damage);
+
+    // Advances every projectile by deltaTime; those that hit something are removed and their impacts
+    // appended, those older than the lifetime are dropped
+    void step(float deltaTime, CEPhysicsWorld* physics, std::vector<Impact>& impacts);
+
+    size_t size() const { return m_position.size(); }
+    const glm::vec3& getPosition(size_t index) const { return m_position[index]; }
+    const glm::vec3& getVelocity(size_t index) const { return m_velocity[index]; }
+};
+
+#endif /* defined(__CE_Character_Lab__CEProjectilePool__) */
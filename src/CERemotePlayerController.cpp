@@ -57,19 +57,28 @@ CERemotePlayerController::CERemotePlayerController(std::shared_ptr<LocalAudioMan
     }
   }
   
-  std::unique_ptr<IndexedMeshLoader> m_loader = std::make_unique<IndexedMeshLoader>(*initialAni->GetOriginalVertices(), *initialAni->GetFaces());
-  
-  // Note we create a copy of geometry from the FIRST animation
-  // Note we get a lock on the texture, thus there's a dependency here on
-  // the original geometry.
-  m_geo = std::make_unique<CEGeometry>(m_loader->getVertices(), m_loader->getIndices(), carFile->getGeometry()->getTexture().lock(), "dinosaur");
-  
   Transform transform(glm::vec3(0.f), glm::vec3(0, glm::radians(180.f), 0), glm::vec3(0.0625f)); // Scaled down 16x
-  std::vector<glm::mat4> model = { transform.GetStaticModel() };
   
-  // Only ever ONE instance!
-  m_geo->UpdateInstances(model);
-  m_geo->ConfigureShaderUniforms(m_map.get(), m_rsc.get());
+  m_batch = CECharacterBatch::forCar(carFile, m_map.get(), m_rsc.get());
+  if (m_batch->isGPUAnimated()) {
+    m_batch_slot = m_batch->addInstance();
+    m_batch->setInstanceTransform(m_batch_slot, transform.GetStaticModel());
+  } else {
+    m_batch.reset();
+    
+    std::unique_ptr<IndexedMeshLoader> m_loader = std::make_unique<IndexedMeshLoader>(initialAni->GetOriginalVertices(), initialAni->GetFaces());
+    
+    // Note we create a copy of geometry from the FIRST animation
+    // Note we get a lock on the texture, thus there's a dependency here on
+    // the original geometry.
+    m_geo = std::make_unique<CEGeometry>(m_loader->getVertices(), m_loader->getIndices(), carFile->getGeometry()->getTexture().lock(), "dinosaur");
+    
+    std::vector<glm::mat4> model = { transform.GetStaticModel() };
+    
+    // Only ever ONE instance!
+    m_geo->UpdateInstances(model);
+    m_geo->ConfigureShaderUniforms(m_map.get(), m_rsc.get());
+  }
   
   // Configure sensory capabilities for AI (limited view, no god mode)
   setSensoryCapabilities(60.0f, 80.0f, 20.0f, false);
@@ -81,6 +90,13 @@ CERemotePlayerController::CERemotePlayerController(std::shared_ptr<LocalAudioMan
   m_camera.SetLookAt(initialFacingDirection);
 }
 
+CERemotePlayerController::~CERemotePlayerController()
+{
+  if (m_batch) {
+    m_batch->removeInstance(m_batch_slot);
+  }
+}
+
 glm::vec3 CERemotePlayerController::getPosition() const
 {
   return this->m_camera.GetPosition();
@@ -117,6 +133,7 @@ bool CERemotePlayerController::isAnimPlaying(double currentTime) {
   if (m_is_looping_anim) return true;
   
   auto ani = m_car->getAnimationByName(m_current_animation).lock();
+  if (!ani) return false;
   
   return ((currentTime - m_animation_started_at) * 1000.0) < ani->m_total_time;
 }
@@ -151,17 +168,27 @@ void CERemotePlayerController::updateWithObserver(double currentTime, Transform
   float pitchSmoothingRate = m_pitchSmoothingSpeed * deltaTime;
   m_currentPitchAngle += pitchDifference * pitchSmoothingRate;
   
-  m_geo->Update(baseTransform, observerCamera);
-  
-  // Calculate dynamic animation speed based on current movement speed and animation type
-  float animationPlaybackSpeed = calculateAnimationPlaybackSpeed();
-  
   bool didUpdate = false;
-  didUpdate = m_geo->SetAnimation(anim, currentTime, m_animation_started_at, m_animation_last_update_at, deferUpdate, maxFPS, notVisible, animationPlaybackSpeed, m_is_looping_anim, m_shouldLockAtEnd);
+  int currentFrame = 0;
+  if (m_batch) {
+    // Shared mesh: only this instance's frame pair and blend factor change, so there is nothing to throttle
+    if (!(deferUpdate && notVisible)) {
+      didUpdate = m_batch->setInstanceAnimation(m_batch_slot, anim.lock(), currentTime - m_animation_started_at, m_is_looping_anim, m_shouldLockAtEnd);
+    }
+    currentFrame = m_batch->getInstanceFrame(m_batch_slot);
+  } else {
+    m_geo->Update(baseTransform, observerCamera);
+    
+    // Calculate dynamic animation speed based on current movement speed and animation type
+    float animationPlaybackSpeed = calculateAnimationPlaybackSpeed();
+    
+    didUpdate = m_geo->SetAnimation(anim, currentTime, m_animation_started_at, m_animation_last_update_at, deferUpdate, maxFPS, notVisible, animationPlaybackSpeed, m_is_looping_anim, m_shouldLockAtEnd);
+    currentFrame = m_geo->GetCurrentFrame();
+  }
 
   if (didUpdate) {
     auto audioSrc = m_car->getSoundForAnimation(m_current_animation);
-    if (audioSrc != nullptr && m_geo->GetCurrentFrame() == 0 && !audioSrc->isPlaying()) {
+    if (audioSrc != nullptr && currentFrame == 0 && !audioSrc->isPlaying()) {
       audioSrc->setPosition(m_camera.GetPosition());
       audioSrc->setLooped(false);
       audioSrc->setMaxDistance(16*60); // Scaled down 16x (was 256*60)
@@ -177,7 +204,9 @@ void CERemotePlayerController::updateWithObserver(double currentTime, Transform
 
 void CERemotePlayerController::Render()
 {
-  m_geo->DrawInstances();
+  if (m_geo) {
+    m_geo->DrawInstances();
+  }
 }
 
 void CERemotePlayerController::StopMovement()
@@ -210,7 +239,11 @@ void CERemotePlayerController::lockAtFinalFrame(Transform& transform, Camera& ca
   auto anim = m_car->getAnimationByName(m_current_animation).lock();
   if (anim) {
     int finalFrame = anim->m_number_of_frames - 1; // Get last frame (0-indexed)
-    m_geo->SetAnimation(anim, finalFrame); // Set to specific frame
+    if (m_batch) {
+      m_batch->setInstanceFrame(m_batch_slot, anim, finalFrame);
+    } else {
+      m_geo->SetAnimation(anim, finalFrame); // Set to specific frame
+    }
   }
   freezeAnimation(); // Now freeze to prevent any further updates
 }
@@ -251,8 +284,12 @@ void CERemotePlayerController::uploadStateToHardware()
   Transform transform(position, rotation, glm::vec3(0.0625f)); // Scaled down 16x
   
   // Update instance data
-  std::vector<glm::mat4> model = { transform.GetStaticModel() };
-  m_geo->UpdateInstances(model);
+  if (m_batch) {
+    m_batch->setInstanceTransform(m_batch_slot, transform.GetStaticModel());
+  } else {
+    std::vector<glm::mat4> model = { transform.GetStaticModel() };
+    m_geo->UpdateInstances(model);
+  }
 }
 
 
@@ -15,6 +15,7 @@
 #include "CEBasePlayerController.hpp"
 
 #include "CEGeometry.h"
+#include "CECharacterBatch.h"
 
 class C2MapFile;
 class C2CarFile;
@@ -40,7 +41,11 @@ private:
   // Shared reference to CAR. Defines audio, texture, animations, etc
   std::shared_ptr<C2CarFile> m_car;
   
-  // We need a unique copy of geometry for local avatar animations
+  // Characters of the same CAR share one mesh and draw together; this is our instance in it
+  std::shared_ptr<CECharacterBatch> m_batch;
+  int m_batch_slot = -1;
+  
+  // Fallback when the batch can't animate on the GPU: a unique copy of geometry for local avatar animations
   std::unique_ptr<CEGeometry> m_geo;
   
   std::string m_current_animation;
@@ -110,6 +115,7 @@ private:
 public:
   void uploadStateToHardware();
   CERemotePlayerController(std::shared_ptr<LocalAudioManager> audioManager, std::shared_ptr<C2CarFile> carFile, std::shared_ptr<C2MapFile> map, std::shared_ptr<C2MapRscFile> rsc, std::string initialAnimationName);
+  ~CERemotePlayerController();
 
   // CEBasePlayerController interface implementation
   glm::vec3 getPosition() const override;
@@ -153,5 +159,6 @@ public:
   void holdCurrentFrame(); // Stop animation progression but keep current frame
   bool hasAnimationFinished(double currentTime); // Check if current non-looping animation has finished
   
+  // Only draws characters that are not batched; batched ones are drawn by CECharacterBatch::RenderAll
   void Render();
 };
@@ -461,6 +461,11 @@ void CEShadowManager::renderShadowCaster(CEWorldModel* model, const Transform& t
         return;
     }
     
+    // Still waiting on the upload queue
+    if (!geom->isResident()) {
+        return;
+    }
+    
     // Set model matrix 
     glm::mat4 modelMatrix = transform.GetStaticModel();
     m_shadow_shader->setMat4("model", modelMatrix);
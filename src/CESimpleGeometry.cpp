@@ -12,21 +12,29 @@
 #include "vertex.h"
 #include "camera.h"
 #include "transform.h"
+#include "C2MapRscFile.h"
 
 #include <nlohmann/json.hpp>
 #include <filesystem>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-CESimpleGeometry::CESimpleGeometry(std::vector < Vertex > vertices, std::unique_ptr<CETexture> texture)
+CESimpleGeometry::CESimpleGeometry(std::vector < Vertex > vertices, std::unique_ptr<CETexture> texture, bool deferUpload)
 : m_vertices(vertices), m_texture(std::move(texture))
 {
-  this->loadObjectIntoMemoryBuffer();
+  if (!deferUpload) {
+    this->upload();
+  }
 }
 
 CESimpleGeometry::~CESimpleGeometry()
 {
+  if (!this->m_uploaded) {
+    return;
+  }
+  this->m_upload->cancel();
   glDeleteBuffers(1, &this->m_instanced_vab);
   glDeleteBuffers(1, &this->m_vertex_array_buffer);
   glDeleteVertexArrays(1, &this->m_vertex_array_object);
@@ -37,6 +45,23 @@ ShaderProgram* CESimpleGeometry::getShader()
   return this->m_shader.get();
 }
 
+void CESimpleGeometry::upload()
+{
+  if (this->m_uploaded) return;
+
+  if (this->m_texture) {
+    this->m_texture->upload();
+  }
+  this->loadObjectIntoMemoryBuffer();
+  this->m_uploaded = true;
+}
+
+bool CESimpleGeometry::isResident() const
+{
+  if (!this->m_upload || !this->m_upload->isReady()) return false;
+  return !this->m_texture || this->m_texture->isResident();
+}
+
 void CESimpleGeometry::loadObjectIntoMemoryBuffer()
 {
   std::ifstream f("config.json");
@@ -48,8 +73,9 @@ void CESimpleGeometry::loadObjectIntoMemoryBuffer()
   this->m_shader = std::unique_ptr<ShaderProgram>(new ShaderProgram((shaderPath / "simple_geo.vs").string(), (shaderPath / "simple_geo.fs").string()));
   
   glGenBuffers(1, &this->m_vertex_array_buffer);
-  glBindBuffer(GL_ARRAY_BUFFER, this->m_vertex_array_buffer);
-  glBufferData(GL_ARRAY_BUFFER, int(this->m_vertices.size() * sizeof(Vertex)), this->m_vertices.data(), GL_STATIC_DRAW);
+  CEUploadQueue& queue = CEUploadQueue::getInstance();
+  this->m_upload = queue.createTicket();
+  queue.uploadBuffer(this->m_upload, this->m_vertex_array_buffer, this->m_vertices.data(), this->m_vertices.size() * sizeof(Vertex), GL_STATIC_DRAW);
   
   glGenVertexArrays(1, &this->m_vertex_array_object);
   glBindVertexArray(this->m_vertex_array_object);
@@ -88,6 +114,8 @@ void CESimpleGeometry::loadObjectIntoMemoryBuffer()
 
 void CESimpleGeometry::Draw()
 {
+  if (!this->isResident()) return;
+  
   this->m_shader->use();
   this->m_texture->use();
   glBindVertexArray(this->m_vertex_array_object);
@@ -101,6 +129,8 @@ void CESimpleGeometry::Draw()
 // https://www.reddit.com/r/opengl/comments/55m1zg/help_with_figuring_out_gldrawelementsinstanced/
 void CESimpleGeometry::DrawInstances()
 {
+  if (this->m_num_instances == 0 || !this->isResident()) return;
+  
   this->m_shader->use();
   this->m_texture->use();
   glBindVertexArray(this->m_vertex_array_object);
@@ -110,17 +140,29 @@ void CESimpleGeometry::DrawInstances()
   glBindVertexArray(0);
 }
 
-void CESimpleGeometry::UpdateInstances(std::vector<glm::mat4> transforms)
+void CESimpleGeometry::UpdateInstances(const std::vector<glm::mat4>& transforms)
 {
   this->m_num_instances = (int)transforms.size();
   glBindBuffer(GL_ARRAY_BUFFER, this->m_instanced_vab);
-  glBufferData(GL_ARRAY_BUFFER, this->m_num_instances*sizeof(glm::mat4), transforms.data(), GL_STATIC_DRAW);
+  glBufferData(GL_ARRAY_BUFFER, this->m_num_instances*sizeof(glm::mat4), transforms.data(), GL_DYNAMIC_DRAW);
 }
 
-void CESimpleGeometry::Update(Camera &camera)
+/*
+ * Fog and colour setup for world object billboards, matching CEGeometry::ConfigureShaderUniforms
+ */
+void CESimpleGeometry::ConfigureShaderUniforms(C2MapRscFile* rsc)
 {
-  this->m_shader->use();
-  this->m_shader->setMat4("projection_view", camera.GetViewProjection());
+  auto color = rsc->getFadeColor();
+  float brightnessFactor = 1.2f;
+  float r = std::min(color.r / 255.0f * brightnessFactor, 1.0f);
+  float g = std::min(color.g / 255.0f * brightnessFactor, 1.0f);
+  float b = std::min(color.b / 255.0f * brightnessFactor, 1.0f);
+  
+  m_shader->use();
+  m_shader->setBool("enableFog", true);
+  m_shader->setVec4("distanceColor", glm::vec4(r, g, b, color.a));
+  m_shader->setBool("enable_transparency", true);
+  m_shader->setBool("swapRedBlue", true); // C2 bitmaps are stored BGR
 }
 
 void CESimpleGeometry::Update(Transform& transform, Camera& camera)
@@ -17,36 +17,45 @@
 #include <cstdint>
 #include <fstream>
 
+#include "CEUploadQueue.h"
+
 class Vertex;
 class CETexture;
 class ShaderProgram;
+class C2MapRscFile;
 
 struct Camera;
 struct Transform;
 
 class CESimpleGeometry {
 private:
-  GLuint m_vertex_array_object;
-  GLuint m_vertex_array_buffer;
+  GLuint m_vertex_array_object = 0;
+  GLuint m_vertex_array_buffer = 0;
 
-  GLuint m_instanced_vab;
-  GLuint m_num_instances;
+  GLuint m_instanced_vab = 0;
+  GLuint m_num_instances = 0;
+  bool m_uploaded = false;
+  std::shared_ptr<CEUploadQueue::Ticket> m_upload;
 
   std::vector<Vertex> m_vertices;
   std::unique_ptr<CETexture> m_texture;
   
   std::unique_ptr<ShaderProgram> m_shader;
 public:
-  CESimpleGeometry(std::vector < Vertex > vertices, std::unique_ptr<CETexture> texture);
+  // deferUpload: leave the texture, shader and buffers to upload() on the GL thread
+  CESimpleGeometry(std::vector < Vertex > vertices, std::unique_ptr<CETexture> texture, bool deferUpload = false);
   ~CESimpleGeometry();
   
   void loadObjectIntoMemoryBuffer();
+  // GL thread only; does nothing once uploaded
+  void upload();
+  bool isResident() const;
   
   CETexture* getTexture();
   ShaderProgram* getShader();
 
-  void Update(Camera& camera);
-  void UpdateInstances(std::vector<glm::mat4> transforms);
+  void UpdateInstances(const std::vector<glm::mat4>& transforms);
+  void ConfigureShaderUniforms(C2MapRscFile* rsc);
   void Update(Transform& transform, Camera& camera);
 
   void Draw();
@@ -0,0 +1,142 @@
+//
+//  CETerrainCollisionShape.cpp
+//  CE Character Lab
+//
+//  Bullet concave shape that reads terrain triangles straight from the map's height grid
+//
+
+#include "CETerrainCollisionShape.h"
+#include "C2MapFile.h"
+
+#include <LinearMath/btAabbUtil2.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+CETerrainCollisionShape::CETerrainCollisionShape(C2MapFile* mapFile, int x0, int y0, int x1, int y1)
+    : m_mapFile(mapFile)
+    , m_mapWidth(mapFile->getWidth())
+    , m_tileSize(mapFile->getTileLength())
+    , m_x0(x0), m_y0(y0), m_x1(x1), m_y1(y1)
+    , m_localScaling(1.f, 1.f, 1.f)
+{
+    m_shapeType = CUSTOM_CONCAVE_SHAPE_TYPE;
+
+    int regionsPerColumn = std::max(1, (m_y1 - m_y0 + REGION - 1) / REGION);
+    m_regionsPerRow = std::max(1, (m_x1 - m_x0 + REGION - 1) / REGION);
+    m_regionMin.assign(m_regionsPerRow * regionsPerColumn, std::numeric_limits<float>::max());
+    m_regionMax.assign(m_regionsPerRow * regionsPerColumn, std::numeric_limits<float>::lowest());
+
+    // A region's quads reach one vertex past it, so edge vertices count for both neighbours
+    for (int y = m_y0; y <= m_y1; y++) {
+        int ry0 = std::max(0, (y - m_y0 - 1) / REGION), ry1 = std::min(regionsPerColumn - 1, (y - m_y0) / REGION);
+        for (int x = m_x0; x <= m_x1; x++) {
+            int rx0 = std::max(0, (x - m_x0 - 1) / REGION), rx1 = std::min(m_regionsPerRow - 1, (x - m_x0) / REGION);
+            float h = vertexHeight(x, y);
+            for (int ry = ry0; ry <= ry1; ry++) {
+                for (int rx = rx0; rx <= rx1; rx++) {
+                    int r = (ry * m_regionsPerRow) + rx;
+                    m_regionMin[r] = std::min(m_regionMin[r], h);
+                    m_regionMax[r] = std::max(m_regionMax[r], h);
+                }
+            }
+        }
+    }
+
+    float minHeight = *std::min_element(m_regionMin.begin(), m_regionMin.end());
+    float maxHeight = *std::max_element(m_regionMax.begin(), m_regionMax.end());
+    float half = m_tileSize / 2.0f;
+    m_localAabbMin = btVector3((m_x0 * m_tileSize) + half, minHeight, (m_y0 * m_tileSize) + half);
+    m_localAabbMax = btVector3((m_x1 * m_tileSize) + half, maxHeight, (m_y1 * m_tileSize) + half);
+}
+
+float CETerrainCollisionShape::vertexHeight(int x, int y) const
+{
+    return m_mapFile->getHeightAt((y * m_mapWidth) + x);
+}
+
+void CETerrainCollisionShape::getAabb(const btTransform& t, btVector3& aabbMin, btVector3& aabbMax) const
+{
+    btTransformAabb(m_localAabbMin, m_localAabbMax, getMargin(), t, aabbMin, aabbMax);
+}
+
+/*
+ * Same vertices and diagonals as CEBulletHeightfield used to bake into its triangle mesh, so
+ * contacts, raycasts and the debug wireframe are unchanged
+ */
+void CETerrainCollisionShape::processAllTriangles(btTriangleCallback* callback, const btVector3& aabbMin, const btVector3& aabbMax) const
+{
+    const float half = m_tileSize / 2.0f;
+
+    // Quad x spans the vertices at tile centres x and x + 1. Clamp in float first: debug drawing
+    // asks for everything with a huge AABB
+    auto quadAt = [&](btScalar world) {
+        float q = std::floor((world - half) / m_tileSize);
+        return (int)std::max(-1.0f, std::min(q, (float)m_mapWidth));
+    };
+    int qx0 = std::max(m_x0, quadAt(aabbMin.x())), qx1 = std::min(m_x1 - 1, quadAt(aabbMax.x()));
+    int qy0 = std::max(m_y0, quadAt(aabbMin.z())), qy1 = std::min(m_y1 - 1, quadAt(aabbMax.z()));
+    if (qx0 > qx1 || qy0 > qy1) return;
+
+    const float minY = aabbMin.y(), maxY = aabbMax.y();
+    btVector3 triangle[3];
+
+    for (int ry = (qy0 - m_y0) / REGION; ry <= (qy1 - m_y0) / REGION; ry++) {
+        for (int rx = (qx0 - m_x0) / REGION; rx <= (qx1 - m_x0) / REGION; rx++) {
+            int r = (ry * m_regionsPerRow) + rx;
+            if (m_regionMax[r] < minY || m_regionMin[r] > maxY) continue;
+
+            int y0 = std::max(qy0, m_y0 + (ry * REGION)), y1 = std::min(qy1, m_y0 + (ry * REGION) + REGION - 1);
+            int x0 = std::max(qx0, m_x0 + (rx * REGION)), x1 = std::min(qx1, m_x0 + (rx * REGION) + REGION - 1);
+
+            for (int y = y0; y <= y1; y++) {
+                float worldZ1 = (y * m_tileSize) + half;
+                float worldZ2 = worldZ1 + m_tileSize;
+
+                for (int x = x0; x <= x1; x++) {
+                    float hLL = vertexHeight(x, y);
+                    float hLR = vertexHeight(x + 1, y);
+                    float hUL = vertexHeight(x, y + 1);
+                    float hUR = vertexHeight(x + 1, y + 1);
+                    if (std::max({hLL, hLR, hUL, hUR}) < minY || std::min({hLL, hLR, hUL, hUR}) > maxY) continue;
+
+                    float worldX1 = (x * m_tileSize) + half;
+                    float worldX2 = worldX1 + m_tileSize;
+                    btVector3 vpositionLL(worldX1, hLL, worldZ1);
+                    btVector3 vpositionLR(worldX2, hLR, worldZ1);
+                    btVector3 vpositionUL(worldX1, hUL, worldZ2);
+                    btVector3 vpositionUR(worldX2, hUR, worldZ2);
+
+                    int index = (y * m_mapWidth) + x;
+                    if (m_mapFile->isQuadRotatedAt(index)) {
+                        triangle[0] = vpositionLL; triangle[1] = vpositionUL; triangle[2] = vpositionLR;
+                        callback->processTriangle(triangle, 0, index * 2);
+                        triangle[0] = vpositionLR; triangle[1] = vpositionUL; triangle[2] = vpositionUR;
+                        callback->processTriangle(triangle, 0, (index * 2) + 1);
+                    } else {
+                        triangle[0] = vpositionLL; triangle[1] = vpositionUR; triangle[2] = vpositionLR;
+                        callback->processTriangle(triangle, 0, index * 2);
+                        triangle[0] = vpositionLL; triangle[1] = vpositionUL; triangle[2] = vpositionUR;
+                        callback->processTriangle(triangle, 0, (index * 2) + 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CETerrainCollisionShape::setLocalScaling(const btVector3& /*scaling*/)
+{
+    // Heights and tile size are already in world units
+}
+
+const btVector3& CETerrainCollisionShape::getLocalScaling() const
+{
+    return m_localScaling;
+}
+
+void CETerrainCollisionShape::calculateLocalInertia(btScalar /*mass*/, btVector3& inertia) const
+{
+    inertia = btVector3(0.f, 0.f, 0.f);
+}
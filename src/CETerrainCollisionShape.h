@@ -0,0 +1,66 @@
+//
+//  CETerrainCollisionShape.h
+//  CE Character Lab
+//
+//  Bullet concave shape that reads terrain triangles straight from the map's height grid
+//
+
+#ifndef __CE_Character_Lab__CETerrainCollisionShape__
+#define __CE_Character_Lab__CETerrainCollisionShape__
+
+#include <vector>
+
+#include <BulletCollision/CollisionShapes/btConcaveShape.h>
+#include <BulletCollision/CollisionShapes/btTriangleCallback.h>
+
+class C2MapFile;
+
+/*
+ * Covers the quads [x0, x1) x [y0, y1), each named by its lower-left tile, with vertices at tile
+ * centres like TerrainRenderer::calcWorldVertex. Triangles are made on demand for whatever AABB
+ * Bullet asks about, split the way the map flags each quad, so nothing but a height range per
+ * REGION x REGION block of quads is stored. btHeightfieldTerrainShape can't be used: it splits
+ * every quad the same way, while the map picks the diagonal per quad.
+ */
+class CETerrainCollisionShape : public btConcaveShape
+{
+public:
+    // Quads per region side; matches CETerrainPartition
+    constexpr static const int REGION = 32;
+
+private:
+    C2MapFile* m_mapFile;
+    int m_mapWidth;
+    float m_tileSize;
+    int m_x0, m_y0, m_x1, m_y1;
+
+    btVector3 m_localAabbMin;
+    btVector3 m_localAabbMax;
+    btVector3 m_localScaling;
+
+    // Height range of each region, row-major, so queries skip regions they pass above or below
+    int m_regionsPerRow;
+    std::vector<float> m_regionMin;
+    std::vector<float> m_regionMax;
+
+    float vertexHeight(int x, int y) const;
+
+public:
+    CETerrainCollisionShape(C2MapFile* mapFile, int x0, int y0, int x1, int y1);
+
+    void getAabb(const btTransform& t, btVector3& aabbMin, btVector3& aabbMax) const override;
+    void processAllTriangles(btTriangleCallback* callback, const btVector3& aabbMin, const btVector3& aabbMax) const override;
+
+    // Static terrain: scaling stays at 1 and there is no inertia
+    void setLocalScaling(const btVector3& scaling) override;
+    const btVector3& getLocalScaling() const override;
+    void calculateLocalInertia(btScalar mass, btVector3& inertia) const override;
+
+    const char* getName() const override { return "CETerrain"; }
+
+    int getTriangleCount() const { return 2 * (m_x1 - m_x0) * (m_y1 - m_y0); }
+    const btVector3& getLocalAabbMin() const { return m_localAabbMin; }
+    const btVector3& getLocalAabbMax() const { return m_localAabbMax; }
+};
+
+#endif /* defined(__CE_Character_Lab__CETerrainCollisionShape__) */
@@ -30,13 +30,27 @@ extern WORD  FadeTab[65][0x8000]; // OOoooo scary. Be careful
 
 CETexture::~CETexture()
 {
-  glDeleteTextures(1, &this->m_texture_id);
+  if (this->m_uploaded) {
+    // Drops the pixel upload if it is still queued
+    this->m_upload->cancel();
+    glDeleteTextures(1, &this->m_texture_id);
+  }
 }
 
-CETexture::CETexture(const std::vector<uint16_t>& raw_texture_data, int texture_size, int texture_height, int texture_width, bool pixelPerfect)
+CETexture::CETexture(const std::vector<uint16_t>& raw_texture_data, int texture_size, int texture_height, int texture_width, bool pixelPerfect, bool deferUpload)
 : m_raw_data(raw_texture_data), m_height(texture_height), m_width(texture_width), m_pixelPerfect(pixelPerfect)
 {
+  if (!deferUpload) {
+    this->upload();
+  }
+}
+
+void CETexture::upload()
+{
+  if (this->m_uploaded) return;
+
   this->loadTextureIntoHardwareMemory();
+  this->m_uploaded = true;
 }
 
 void CETexture::use()
@@ -45,18 +59,15 @@ void CETexture::use()
   glBindTexture(GL_TEXTURE_2D, m_texture_id);
 }
 
+/*
+ * Sampling state is set now; the pixels and mipmaps follow when the upload queue gets to them.
+ * m_raw_data stays put for the lifetime of the texture, so the queue reads it in place.
+ */
 void CETexture::loadTextureIntoHardwareMemory()
 {
     glGenTextures(1, &this->m_texture_id);
     glBindTexture(GL_TEXTURE_2D, m_texture_id);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, m_raw_data.data());
-
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cerr << "OpenGL error after glTexImage2D: " << error << std::endl;
-    }
-
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 12);
     
     // Set filtering based on pixel perfect flag
@@ -70,10 +81,13 @@ void CETexture::loadTextureIntoHardwareMemory()
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    
-    glGenerateMipmap(GL_TEXTURE_2D);
 
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    CEUploadQueue& queue = CEUploadQueue::getInstance();
+    this->m_upload = queue.createTicket();
+    queue.uploadTexture(this->m_upload, this->m_texture_id, GL_RGB5_A1, m_width, m_height, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV,
+                        m_raw_data.data(), (size_t)m_width * m_height * sizeof(uint16_t), true);
 }
 
 // Saves the CETexture as a bitmap (32 bit).
@@ -21,6 +21,8 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "CEUploadQueue.h"
+
 const int faceHasOpacity = 4;
 const int faceIsTransparent = 8;
 
@@ -30,16 +32,26 @@ class CETexture
 {
 private:
   std::vector<uint16_t> m_raw_data; // Format: argb1555 (ifA1R5G5B5)
-  GLuint m_texture_id;
+  GLuint m_texture_id = 0;
+  bool m_uploaded = false;
+  std::shared_ptr<CEUploadQueue::Ticket> m_upload;
   int m_height;
   int m_width;
   bool m_pixelPerfect;
 
   void loadTextureIntoHardwareMemory();
 public:
-  CETexture(const std::vector<uint16_t>& raw_texture_data, int texture_size = 128*128*2, int texture_height = 128, int texture_width = 128, bool pixelPerfect = false);
+  // deferUpload: keep the pixels on the CPU until upload(), so the texture can be built off the GL thread
+  CETexture(const std::vector<uint16_t>& raw_texture_data, int texture_size = 128*128*2, int texture_height = 128, int texture_width = 128, bool pixelPerfect = false, bool deferUpload = false);
   ~CETexture();
 
+  // GL thread only; does nothing once uploaded. The pixels go through CEUploadQueue, so the
+  // texture isn't resident until its ticket is
+  void upload();
+  bool isUploaded() const { return m_uploaded; }
+  bool isResident() const { return m_upload && m_upload->isReady(); }
+  const std::shared_ptr<CEUploadQueue::Ticket>& getUploadTicket() const { return m_upload; }
+
   void saveToBMPFile(std::string file_name);
   void use();
   void setPixelPerfectFiltering(); // For crisp pixel-perfect textures (weapons, UI)
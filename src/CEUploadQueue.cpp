@@ -0,0 +1,274 @@
+//
+//  CEUploadQueue.cpp
+//  CE Character Lab
+//
+//  Budgeted texture and buffer uploads, spread over frames through a staging buffer
+//
+
+#include "CEUploadQueue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+void CEUploadQueue::Ticket::onReady(std::function<void()> callback)
+{
+  if (m_cancelled) return;
+
+  if (m_pending == 0) {
+    callback();
+  } else {
+    m_on_ready.push_back(std::move(callback));
+  }
+}
+
+CEUploadQueue& CEUploadQueue::getInstance()
+{
+  static CEUploadQueue instance;
+  return instance;
+}
+
+void CEUploadQueue::configure(size_t bytes_per_frame, double ms_per_frame)
+{
+  m_bytes_per_frame = std::max(bytes_per_frame, (size_t)64 * 1024);
+  m_ms_per_frame = ms_per_frame;
+
+  // Recreated at the new size by the next process()
+  if (m_staging[0].buffer && m_staging_size != m_bytes_per_frame) {
+    this->destroyStaging();
+  }
+}
+
+std::shared_ptr<CEUploadQueue::Ticket> CEUploadQueue::createTicket()
+{
+  return std::make_shared<Ticket>();
+}
+
+void CEUploadQueue::createStaging()
+{
+  m_staging_size = m_bytes_per_frame;
+  m_persistent = GLAD_GL_VERSION_4_4 != 0;
+
+  const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  for (_StagingBuffer& staging : m_staging) {
+    glGenBuffers(1, &staging.buffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, staging.buffer);
+
+    if (m_persistent) {
+      glBufferStorage(GL_COPY_READ_BUFFER, m_staging_size, nullptr, flags);
+      staging.mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, m_staging_size, flags));
+      if (!staging.mapped) {
+        std::cerr << "Upload queue: could not map the staging buffer persistently" << std::endl;
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        this->destroyStaging();
+        m_persistent = false;
+        this->createStaging();
+        return;
+      }
+    } else {
+      glBufferData(GL_COPY_READ_BUFFER, m_staging_size, nullptr, GL_STREAM_DRAW);
+    }
+  }
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+  std::cout << "Upload queue: " << STAGING_FRAMES << " x " << (m_staging_size / 1024) << " KB staging, "
+            << (m_persistent ? "persistently mapped" : "orphaned per frame") << ", " << m_ms_per_frame << " ms per frame" << std::endl;
+}
+
+void CEUploadQueue::destroyStaging()
+{
+  for (_StagingBuffer& staging : m_staging) {
+    if (staging.fence) {
+      glDeleteSync(staging.fence);
+    }
+    if (staging.mapped) {
+      glBindBuffer(GL_COPY_READ_BUFFER, staging.buffer);
+      glUnmapBuffer(GL_COPY_READ_BUFFER);
+    }
+    if (staging.buffer) {
+      glDeleteBuffers(1, &staging.buffer);
+    }
+    staging = _StagingBuffer();
+  }
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+/*
+ * A persistent segment is reused STAGING_FRAMES frames later; if the GPU hasn't finished copying
+ * out of it yet, this frame's uploads go straight from client memory instead of waiting on it.
+ */
+bool CEUploadQueue::reserveStaging(_StagingBuffer& staging)
+{
+  if (!m_persistent) {
+    // Orphaning gives us fresh storage without waiting for last frame's copies
+    glBindBuffer(GL_COPY_READ_BUFFER, staging.buffer);
+    glBufferData(GL_COPY_READ_BUFFER, m_staging_size, nullptr, GL_STREAM_DRAW);
+    return true;
+  }
+
+  if (staging.fence) {
+    if (glClientWaitSync(staging.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+      return false;
+    }
+    glDeleteSync(staging.fence);
+    staging.fence = nullptr;
+  }
+  return true;
+}
+
+void CEUploadQueue::push(const std::shared_ptr<Ticket>& ticket, size_t bytes, const void* data, std::shared_ptr<const void> storage, std::function<void(const void*, bool)> issue)
+{
+  ticket->m_pending++;
+  m_items.push_back(_Item{ ticket, bytes, data, std::move(storage), std::move(issue) });
+}
+
+void CEUploadQueue::complete(_Item& item, const void* source, bool staged)
+{
+  item.issue(source, staged);
+  m_uploaded_bytes += item.bytes;
+
+  Ticket& ticket = *item.ticket;
+  if (--ticket.m_pending == 0 && !ticket.m_cancelled) {
+    // Callbacks may queue more work on the same ticket
+    std::vector<std::function<void()>> callbacks;
+    callbacks.swap(ticket.m_on_ready);
+    for (auto& callback : callbacks) {
+      callback();
+    }
+  }
+}
+
+void CEUploadQueue::uploadTexture(const std::shared_ptr<Ticket>& ticket, GLuint texture, GLint internal_format, GLsizei width, GLsizei height,
+                                  GLenum format, GLenum type, const void* pixels, size_t bytes, bool mipmaps, std::shared_ptr<const void> storage)
+{
+  this->push(ticket, bytes, pixels, std::move(storage), [=](const void* source, bool) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, source);
+    if (mipmaps) {
+      glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+  });
+}
+
+void CEUploadQueue::uploadTextureRegion(const std::shared_ptr<Ticket>& ticket, GLuint texture, GLint x, GLint y, GLsizei width, GLsizei height,
+                                        GLenum format, GLenum type, const void* pixels, size_t bytes, std::shared_ptr<const void> storage)
+{
+  this->push(ticket, bytes, pixels, std::move(storage), [=](const void* source, bool) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, source);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  });
+}
+
+void CEUploadQueue::uploadBuffer(const std::shared_ptr<Ticket>& ticket, GLuint buffer, const void* data, size_t bytes, GLenum usage, std::shared_ptr<const void> storage)
+{
+  this->push(ticket, bytes, data, std::move(storage), [=](const void* source, bool staged) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if (staged) {
+      glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, usage);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)(uintptr_t)source, 0, bytes);
+    } else {
+      glBufferData(GL_COPY_WRITE_BUFFER, bytes, source, usage);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  });
+}
+
+void CEUploadQueue::enqueue(const std::shared_ptr<Ticket>& ticket, std::function<void()> job)
+{
+  this->push(ticket, 0, nullptr, nullptr, [job = std::move(job)](const void*, bool) { job(); });
+}
+
+/*
+ * Items are taken in order until either budget runs out; the first is always taken, so an item
+ * bigger than the byte budget still goes (alone, from client memory). Staging offsets are aligned
+ * so every copy starts on a boundary drivers accept for buffer and pixel transfers.
+ */
+void CEUploadQueue::process()
+{
+  if (m_items.empty()) return;
+
+  if (!m_staging[0].buffer) {
+    this->createStaging();
+  }
+
+  _StagingBuffer& staging = m_staging[m_frame % STAGING_FRAMES];
+  m_frame++;
+  bool staging_free = this->reserveStaging(staging);
+  if (staging_free) {
+    glBindBuffer(GL_COPY_READ_BUFFER, staging.buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.buffer);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  size_t frame_bytes = 0;
+  size_t offset = 0;
+  bool first = true;
+
+  while (!m_items.empty()) {
+    if (m_items.front().ticket->m_cancelled) {
+      m_items.pop_front();
+      continue;
+    }
+
+    if (!first) {
+      double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      if (elapsed_ms >= m_ms_per_frame || frame_bytes + m_items.front().bytes > m_bytes_per_frame) {
+        break;
+      }
+    }
+
+    _Item item = std::move(m_items.front());
+    m_items.pop_front();
+
+    size_t aligned = (offset + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    if (staging_free && item.bytes > 0 && aligned + item.bytes <= m_staging_size) {
+      if (m_persistent) {
+        std::memcpy(staging.mapped + aligned, item.data, item.bytes);
+      } else {
+        glBufferSubData(GL_COPY_READ_BUFFER, aligned, item.bytes, item.data);
+      }
+      this->complete(item, reinterpret_cast<const void*>((uintptr_t)aligned), true);
+      offset = aligned + item.bytes;
+    } else {
+      // Pixel calls would read from the staging buffer while it is bound
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      this->complete(item, item.data, false);
+      if (staging_free) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.buffer);
+      }
+    }
+
+    frame_bytes += item.bytes;
+    first = false;
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+  if (m_persistent && staging_free && offset > 0) {
+    staging.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+}
+
+void CEUploadQueue::flush()
+{
+  while (!m_items.empty()) {
+    _Item item = std::move(m_items.front());
+    m_items.pop_front();
+
+    if (!item.ticket->m_cancelled) {
+      this->complete(item, item.data, false);
+    }
+  }
+}
+
+size_t CEUploadQueue::takeUploadedBytes()
+{
+  size_t bytes = m_uploaded_bytes;
+  m_uploaded_bytes = 0;
+  return bytes;
+}
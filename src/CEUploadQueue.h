@@ -0,0 +1,116 @@
+//
+//  CEUploadQueue.h
+//  CE Character Lab
+//
+//  Budgeted texture and buffer uploads, spread over frames through a staging buffer
+//
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/*
+ * Objects create their GL names up front and queue the data; process() copies as much as the
+ * per-frame byte and time budgets allow into the staging buffer and issues the GL copies from it.
+ * An object draws only once its Ticket is ready. Staging is persistently mapped where
+ * GL 4.4 buffer storage is available, and an orphaned buffer written with glBufferSubData otherwise.
+ * Main thread only.
+ */
+class CEUploadQueue
+{
+public:
+  // Shared by every upload of one object. The owner cancels it in its destructor so that queued
+  // copies into deleted GL names are dropped
+  class Ticket
+  {
+    friend class CEUploadQueue;
+
+    int m_pending = 0;
+    bool m_cancelled = false;
+    std::vector<std::function<void()>> m_on_ready;
+
+  public:
+    bool isReady() const { return m_pending == 0 && !m_cancelled; }
+    void cancel() { m_cancelled = true; m_on_ready.clear(); }
+    // Runs callback once everything queued on this ticket so far is resident; now if it already is
+    void onReady(std::function<void()> callback);
+  };
+
+private:
+  struct _Item {
+    std::shared_ptr<Ticket> ticket;
+    size_t bytes;
+    const void* data;
+    std::shared_ptr<const void> storage; // keeps data alive when the caller hands it over
+    // source is an offset into the bound staging buffer, or data itself when not staged
+    std::function<void(const void* source, bool staged)> issue;
+  };
+
+  struct _StagingBuffer {
+    GLuint buffer = 0;
+    uint8_t* mapped = nullptr; // persistent mapping only
+    GLsync fence = nullptr;    // GPU still reading while set
+  };
+
+  constexpr static const int STAGING_FRAMES = 3;
+  constexpr static const size_t STAGING_ALIGNMENT = 256;
+
+  std::deque<_Item> m_items;
+  std::array<_StagingBuffer, STAGING_FRAMES> m_staging;
+  size_t m_staging_size = 0;
+  bool m_persistent = false;
+  int m_frame = 0;
+
+  size_t m_bytes_per_frame = 4 * 1024 * 1024;
+  double m_ms_per_frame = 2.0;
+
+  size_t m_uploaded_bytes = 0;
+
+  // Never destroyed explicitly: the GL context is gone by the time statics are
+  CEUploadQueue() = default;
+
+  void createStaging();
+  void destroyStaging();
+  bool reserveStaging(_StagingBuffer& staging);
+  void push(const std::shared_ptr<Ticket>& ticket, size_t bytes, const void* data, std::shared_ptr<const void> storage, std::function<void(const void*, bool)> issue);
+  void complete(_Item& item, const void* source, bool staged);
+
+public:
+  static CEUploadQueue& getInstance();
+
+  CEUploadQueue(const CEUploadQueue&) = delete;
+  CEUploadQueue& operator=(const CEUploadQueue&) = delete;
+
+  // The byte budget is also the size of each frame's staging segment
+  void configure(size_t bytes_per_frame, double ms_per_frame);
+
+  std::shared_ptr<Ticket> createTicket();
+
+  // data must stay valid until the ticket is ready or cancelled, unless storage owns it
+  void uploadTexture(const std::shared_ptr<Ticket>& ticket, GLuint texture, GLint internal_format, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type, const void* pixels, size_t bytes, bool mipmaps, std::shared_ptr<const void> storage = nullptr);
+  void uploadTextureRegion(const std::shared_ptr<Ticket>& ticket, GLuint texture, GLint x, GLint y, GLsizei width, GLsizei height,
+                           GLenum format, GLenum type, const void* pixels, size_t bytes, std::shared_ptr<const void> storage = nullptr);
+  // (Re)allocates buffer at bytes and fills it
+  void uploadBuffer(const std::shared_ptr<Ticket>& ticket, GLuint buffer, const void* data, size_t bytes, GLenum usage, std::shared_ptr<const void> storage = nullptr);
+  // GL work with no data of its own, run in order with the uploads
+  void enqueue(const std::shared_ptr<Ticket>& ticket, std::function<void()> job);
+
+  // Once per frame, before drawing. Always makes progress on at least one item
+  void process();
+  // Everything now, straight from client memory; for loading screens
+  void flush();
+
+  size_t getPendingCount() const { return m_items.size(); }
+  // Since the last call, for the performance monitor
+  size_t takeUploadedBytes();
+};
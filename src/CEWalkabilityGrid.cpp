@@ -0,0 +1,157 @@
+//
+//  CEWalkabilityGrid.cpp
+//  CE Character Lab
+//
+//  One bit per tile copy of the map's walkable flags, packed for pathfinding
+//
+
+#include "CEWalkabilityGrid.h"
+
+#include "C2MapFile.h"
+#include "CEMapPage.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+#include <glm/vec2.hpp>
+
+CEWalkabilityGrid::CEWalkabilityGrid(std::shared_ptr<C2MapFile> map)
+: m_map(map),
+m_width(map->getWidth()),
+m_height(map->getHeight()),
+m_row_words((m_width + 63) / 64),
+m_column_words((m_height + 63) / 64),
+m_rows(new std::atomic<uint64_t>[(size_t)m_row_words * m_height]()),
+m_columns(new std::atomic<uint64_t>[(size_t)m_column_words * m_width]())
+{
+  // Pages that aren't resident are already all blocked
+  int page_size = m_map->getPageSize();
+  for (int page = 0; page < m_map->getPagesX() * m_map->getPagesY(); page++) {
+    if (!m_map->isPageResident(page)) continue;
+
+    int x0 = (page % m_map->getPagesX()) * page_size, y0 = (page / m_map->getPagesX()) * page_size;
+    this->refresh(x0, y0, x0 + page_size, y0 + page_size);
+  }
+}
+
+const std::atomic<uint64_t>* CEWalkabilityGrid::row(int y) const
+{
+  return (y >= 0 && y < m_height) ? &m_rows[(size_t)y * m_row_words] : nullptr;
+}
+
+const std::atomic<uint64_t>* CEWalkabilityGrid::column(int x) const
+{
+  return (x >= 0 && x < m_width) ? &m_columns[(size_t)x * m_column_words] : nullptr;
+}
+
+void CEWalkabilityGrid::refresh(int x0, int y0, int x1, int y1)
+{
+  x0 = std::max(0, x0) & ~63;
+  y0 = std::max(0, y0) & ~63;
+  x1 = std::min(m_width, x1);
+  y1 = std::min(m_height, y1);
+
+  uint64_t block[64];
+  for (int by = y0; by < y1; by += 64) {
+    for (int bx = x0; bx < x1; bx += 64) {
+      int columns = std::min(64, m_width - bx);
+
+      for (int r = 0; r < 64; r++) {
+        int y = by + r;
+        uint64_t bits = 0;
+        if (y < m_height) {
+          for (int c = 0; c < columns; c++) {
+            if (!(m_map->getWalkableFlagsAt(glm::vec2(bx + c, y)) & 0x1)) {
+              bits |= uint64_t(1) << c;
+            }
+          }
+          m_rows[((size_t)y * m_row_words) + (bx >> 6)].store(bits, std::memory_order_relaxed);
+        }
+        block[r] = bits;
+      }
+
+      // The block transposed is the same tiles column-major
+      for (int c = 0; c < columns; c++) {
+        uint64_t bits = 0;
+        for (int r = 0; r < 64; r++) {
+          bits |= ((block[r] >> c) & 1) << r;
+        }
+        m_columns[((size_t)(bx + c) * m_column_words) + (by >> 6)].store(bits, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  m_generation.fetch_add(1, std::memory_order_release);
+}
+
+void CEWalkabilityGrid::refreshPage(int page)
+{
+  int x0, y0, x1, y1;
+  this->getPageExtent(page, x0, y0, x1, y1);
+  this->refresh(x0, y0, x1, y1);
+}
+
+void CEWalkabilityGrid::getPageExtent(int page, int& x0, int& y0, int& x1, int& y1) const
+{
+  // Walkability near a page edge depends on slopes and water across it, which is why C2MapFile
+  // rebuilds the neighbours' ground regions facing a page that comes or goes
+  int page_size = m_map->getPageSize();
+  int band = CEMapPage::GROUND_REGION;
+  x0 = ((page % m_map->getPagesX()) * page_size) - band;
+  y0 = ((page / m_map->getPagesX()) * page_size) - band;
+  x1 = x0 + page_size + (band * 2);
+  y1 = y0 + page_size + (band * 2);
+}
+
+int CEWalkabilityGrid::jumpRow(int x, int y, int dx, int end_x, unsigned& steps) const
+{
+  return scan(this->row(y), this->row(y + 1), this->row(y - 1), m_row_words, x, dx, end_x, steps);
+}
+
+int CEWalkabilityGrid::jumpColumn(int x, int y, int dy, int end_y, unsigned& steps) const
+{
+  return scan(this->column(x), this->column(x + 1), this->column(x - 1), m_column_words, y, dy, end_y, steps);
+}
+
+/*
+ * Same stopping rule as jps.hpp's jumpX/jumpY, a word at a time. Tile t stops the jump when a
+ * side tile next to t + dir is walkable while the one next to t isn't (forced neighbour), when
+ * t + dir is blocked, or when t is the end. Forced neighbours and the end win over a block.
+ */
+int CEWalkabilityGrid::scan(const std::atomic<uint64_t>* line, const std::atomic<uint64_t>* side_a, const std::atomic<uint64_t>* side_b,
+                            int words, int from, int dir, int end, unsigned& steps)
+{
+  auto word = [words](const std::atomic<uint64_t>* bits, int i) -> uint64_t {
+    return (bits && i >= 0 && i < words) ? bits[i].load(std::memory_order_relaxed) : 0;
+  };
+  // Bit j of ahead(bits, i) is the tile one step along dir from bit j of word i
+  auto ahead = [&](const std::atomic<uint64_t>* bits, int i) -> uint64_t {
+    return (dir > 0) ? (word(bits, i) >> 1) | (word(bits, i + 1) << 63)
+                     : (word(bits, i) << 1) | (word(bits, i - 1) >> 63);
+  };
+
+  int first = from & 63;
+  uint64_t remaining = (dir > 0) ? ~uint64_t(0) << first : ~uint64_t(0) >> (63 - first);
+
+  for (int i = from >> 6; i >= 0 && i < words; i += dir) {
+    uint64_t forced = (ahead(side_a, i) & ~word(side_a, i)) | (ahead(side_b, i) & ~word(side_b, i));
+    uint64_t stop = forced | ~ahead(line, i);
+    if (end >= 0 && (end >> 6) == i) {
+      stop |= uint64_t(1) << (end & 63);
+    }
+    stop &= remaining;
+
+    if (stop) {
+      int bit = (dir > 0) ? std::countr_zero(stop) : 63 - std::countl_zero(stop);
+      int tile = (i << 6) + bit;
+      steps = (unsigned)std::abs(tile - from);
+      return (((forced >> bit) & 1) || tile == end) ? tile : -1;
+    }
+    remaining = ~uint64_t(0);
+  }
+
+  // Not reached: past either end of a line every bit reads blocked
+  steps = 0;
+  return -1;
+}
@@ -0,0 +1,80 @@
+//
+//  CEWalkabilityGrid.h
+//  CE Character Lab
+//
+//  One bit per tile copy of the map's walkable flags, packed for pathfinding
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+class C2MapFile;
+
+/*
+ * Bit x & 63 of word x >> 6 in row y is set when tile (x, y) is walkable; the same bits are also
+ * kept column-major, so vertical scans read whole words too. Everything outside the map, and
+ * every tile of a page that isn't resident, reads as blocked. Searches read the bits while
+ * refresh() rewrites them, so words are atomics loaded relaxed: a search that overlaps a page
+ * change sees each word either before or after it, as it would have seen the flags.
+ */
+class CEWalkabilityGrid
+{
+private:
+  std::shared_ptr<C2MapFile> m_map;
+  int m_width;
+  int m_height;
+  int m_row_words;
+  int m_column_words;
+  std::unique_ptr<std::atomic<uint64_t>[]> m_rows;
+  std::unique_ptr<std::atomic<uint64_t>[]> m_columns;
+  // Bumped after every refresh
+  std::atomic<uint64_t> m_generation{0};
+
+  // Null outside the map
+  const std::atomic<uint64_t>* row(int y) const;
+  const std::atomic<uint64_t>* column(int x) const;
+
+  static int scan(const std::atomic<uint64_t>* line, const std::atomic<uint64_t>* side_a, const std::atomic<uint64_t>* side_b,
+                  int words, int from, int dir, int end, unsigned& steps);
+
+public:
+  // Reads every resident page
+  explicit CEWalkabilityGrid(std::shared_ptr<C2MapFile> map);
+
+  inline bool operator()(unsigned x, unsigned y) const
+  {
+    // Unsigned wraps if < 0
+    if (x >= (unsigned)m_width || y >= (unsigned)m_height) return false;
+    return (m_rows[(y * m_row_words) + (x >> 6)].load(std::memory_order_relaxed) >> (x & 63)) & 1;
+  }
+
+  // JPS's moves: onto a walkable tile, and diagonally only past at least one open tile beside it
+  inline bool canStep(int x, int y, int dx, int dy) const
+  {
+    if (!(*this)(x + dx, y + dy)) return false;
+    return !(dx && dy) || (*this)(x + dx, y) || (*this)(x, y + dy);
+  }
+
+  int getWidth() const { return m_width; }
+  int getHeight() const { return m_height; }
+
+  // Rereads tiles [x0, x1) x [y0, y1), widened to whole 64 x 64 blocks, from the map's walkable
+  // flags. Callers serialise refreshes
+  void refresh(int x0, int y0, int x1, int y1);
+  // The page and the bands of its neighbours whose ground is derived from its tiles
+  void refreshPage(int page);
+  // Tiles [x0, x1) x [y0, y1) that refreshPage() rereads
+  void getPageExtent(int page, int& x0, int& y0, int& x1, int& y1) const;
+  // Thread-safe. Changes whenever refresh() has rewritten any bits, for planners that keep
+  // something derived from them
+  uint64_t getGeneration() const { return m_generation.load(std::memory_order_acquire); }
+
+  // A JPS straight jump from (x, y), 64 tiles per step: the first tile along the line whose next
+  // tile opens up beside the line (a forced neighbour), or end (-1 if not on this line). -1 when
+  // the line is blocked first. steps is how many tiles were passed either way
+  int jumpRow(int x, int y, int dx, int end_x, unsigned& steps) const;
+  int jumpColumn(int x, int y, int dy, int end_y, unsigned& steps) const;
+};
@@ -1,20 +1,110 @@
 #include "CEWalkableTerrainPathFinder.hpp"
 
-#include "C2MapFile.h"
-#include "C2MapRscFile.h"
-#include "CEWorldModel.h"
+#include <algorithm>
+#include <cstdlib>
 
-#include <glm/vec2.hpp>
+namespace JPS {
 
-bool CEWalkableTerrainPathFinder::operator()(unsigned x, unsigned y) const
+// A table jump of distance d from `from` passes `to` (all along one line, dir +-1)
+static inline bool passes(int16_t d, int from, int to, int dir)
 {
-  int xy = (y * map->getWidth()) + x;
-  // Unsigned wraps if < 0
-  if(x < map->getHeight() && y < map->getWidth()) {
-    if (map->getWalkableFlagsAt(glm::vec2(x, y)) & 0x1) return false;
-    
-    return true;
+  int j = (to - from) * dir;
+  return j >= 0 && j < std::abs(d);
+}
+
+template <> Position Searcher<CEWalkableTerrainPathFinder>::jumpX(Position p, int dx)
+{
+  if (const CEJumpPointTable* table = grid.jump_points.get()) {
+    int16_t d = table->getDistance(p.x, p.y, CEJumpPointTable::direction(dx, 0));
+    ++stepsDone;
+    --stepsRemain;
+    if (endPos.y == p.y && passes(d, p.x, endPos.x, dx)) return endPos;
+    return (d > 0) ? Pos(p.x + ((d - 1) * dx), p.y) : npos;
+  }
+
+  unsigned steps = 0;
+  int x = grid.walkability->jumpRow(p.x, p.y, dx, (endPos.y == p.y) ? (int)endPos.x : -1, steps);
+
+  stepsDone += steps;
+  stepsRemain -= steps;
+  return (x < 0) ? npos : Pos(x, p.y);
+}
+
+template <> Position Searcher<CEWalkableTerrainPathFinder>::jumpY(Position p, int dy)
+{
+  if (const CEJumpPointTable* table = grid.jump_points.get()) {
+    int16_t d = table->getDistance(p.x, p.y, CEJumpPointTable::direction(0, dy));
+    ++stepsDone;
+    --stepsRemain;
+    if (endPos.x == p.x && passes(d, p.y, endPos.y, dy)) return endPos;
+    return (d > 0) ? Pos(p.x, p.y + ((d - 1) * dy)) : npos;
+  }
+
+  unsigned steps = 0;
+  int y = grid.walkability->jumpColumn(p.x, p.y, dy, (endPos.x == p.x) ? (int)endPos.y : -1, steps);
+
+  stepsDone += steps;
+  stepsRemain -= steps;
+  return (y < 0) ? npos : Pos(p.x, y);
+}
+
+/*
+ * The table jump already knows every stop but the goal. The goal can only stop the run where the
+ * diagonal crosses its row or column: on it, or where the straight jump out of that tile reaches it
+ */
+template <> Position Searcher<CEWalkableTerrainPathFinder>::jumpD(Position p, int dx, int dy)
+{
+  if (const CEJumpPointTable* table = grid.jump_points.get()) {
+    int16_t d = table->getDistance(p.x, p.y, CEJumpPointTable::direction(dx, dy));
+    ++stepsDone;
+    --stepsRemain;
+
+    int crosses_column = ((int)endPos.x - (int)p.x) * dx, crosses_row = ((int)endPos.y - (int)p.y) * dy;
+    int crossings[2] = { std::min(crosses_column, crosses_row), std::max(crosses_column, crosses_row) };
+    for (int j : crossings) {
+      if (j < 0 || j >= std::abs(d)) continue;
+
+      Position t = Pos(p.x + (j * dx), p.y + (j * dy));
+      if (t == endPos) return t;
+      if (j == crosses_row && grid(t.x + dx, t.y) &&
+          passes(table->getDistance(t.x + dx, t.y, CEJumpPointTable::direction(dx, 0)), t.x + dx, endPos.x, dx)) return t;
+      if (j == crosses_column && grid(t.x, t.y + dy) &&
+          passes(table->getDistance(t.x, t.y + dy, CEJumpPointTable::direction(0, dy)), t.y + dy, endPos.y, dy)) return t;
+    }
+    return (d > 0) ? Pos(p.x + ((d - 1) * dx), p.y + ((d - 1) * dy)) : npos;
+  }
+
+  // jps.hpp's own jumpD, which an explicit specialisation replaces
+  const Position endpos = endPos;
+  unsigned steps = 0;
+
+  while (true) {
+    if (p == endpos) break;
+
+    ++steps;
+    const PosType x = p.x;
+    const PosType y = p.y;
+
+    if ((grid(x - dx, y + dy) && !grid(x - dx, y)) || (grid(x + dx, y - dy) && !grid(x, y - dy))) break;
+
+    const bool gdx = grid(x + dx, y);
+    const bool gdy = grid(x, y + dy);
+
+    if (gdx && jumpX(Pos(x + dx, y), dx).isValid()) break;
+    if (gdy && jumpY(Pos(x, y + dy), dy).isValid()) break;
+
+    if ((gdx || gdy) && grid(x + dx, y + dy)) {
+      p.x += dx;
+      p.y += dy;
+    } else {
+      p = npos;
+      break;
+    }
   }
-  
-  return false;
+
+  stepsDone += steps;
+  stepsRemain -= steps;
+  return p;
+}
+
 }
@@ -2,14 +2,26 @@
 
 #include <memory>
 
-class C2MapFile;
-class C2MapRscFile;
+#include "CEJumpPointTable.h"
+#include "CEWalkabilityGrid.h"
+#include "jps.hpp"
 
+// Grid for JPS::Searcher: the map's walkable flags, bit-packed
 struct CEWalkableTerrainPathFinder
 {  
-  bool operator() (unsigned x, unsigned y) const;
+  // Inline: JPS calls this for nearly every tile it looks at
+  bool operator() (unsigned x, unsigned y) const { return (*walkability)(x, y); }
 
-  std::shared_ptr<C2MapFile> map;
-  std::shared_ptr<C2MapRscFile> rsc;
+  std::shared_ptr<CEWalkabilityGrid> walkability;
+  // Precomputed jumps matching walkability, on maps that have them
+  std::shared_ptr<const CEJumpPointTable> jump_points;
 };
 
+namespace JPS {
+// With jump_points every jump is a table lookup plus a check for the goal (JPS+). Without, straight
+// jumps scan the packed rows and columns 64 tiles at a time instead of tile by tile, and diagonal
+// jumps step with those straight jumps
+template <> Position Searcher<CEWalkableTerrainPathFinder>::jumpX(Position p, int dx);
+template <> Position Searcher<CEWalkableTerrainPathFinder>::jumpY(Position p, int dy);
+template <> Position Searcher<CEWalkableTerrainPathFinder>::jumpD(Position p, int dx, int dy);
+}
@@ -8,6 +8,8 @@
 #include "vertex.h"
 #include <map>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
 #include "IndexedMeshLoader.h"
 #include "shader_program.h"
@@ -20,6 +22,7 @@
 
 #include "transform.h"
 #include "camera.h"
+#include "CEFrustum.h"
 
 SquareBoundingBox ConvertTBoundToSquareBoundingBox(const TBound& bound) {
   SquareBoundingBox bbox;
@@ -39,7 +42,46 @@ SquareBoundingBox ConvertTBoundToSquareBoundingBox(const TBound& bound) {
   return bbox;
 }
 
-CEWorldModel::CEWorldModel(const CEMapType type, std::ifstream& instream)
+/*
+ * Model records aren't length-prefixed; the size comes from the counts in the header and,
+ * for animated C2 models, the animation header after the far-view bitmap
+ */
+std::string CEWorldModel::readRecord(const CEMapType type, std::istream& instream)
+{
+  std::string record(64 + 16, '\0');
+  instream.read(&record[0], record.size());
+
+  TObjInfo info;
+  std::memcpy(&info, record.data(), 64);
+
+  int32_t counts[4]; // vcount, fcount, object count, texture size
+  std::memcpy(counts, record.data() + 64, sizeof(counts));
+
+  size_t body = ((size_t)counts[1] * 64) + ((size_t)counts[0] * 16) + ((size_t)counts[2] * 48) + (size_t)counts[3];
+  if (type == CEMapType::C2) body += 128*128*2;
+
+  size_t offset = record.size();
+  record.resize(offset + body);
+  instream.read(&record[offset], body);
+
+  if (type == CEMapType::C2 && (info.flags & objectANIMATED)) {
+    int32_t animation_header[5]; // vcount, vcount, kps, frames - 1, ms
+    offset = record.size();
+    record.resize(offset + sizeof(animation_header));
+    instream.read(&record[offset], sizeof(animation_header));
+    std::memcpy(animation_header, record.data() + offset, sizeof(animation_header));
+
+    size_t frames = (size_t)animation_header[3] + 1;
+    size_t animation = (size_t)animation_header[0] * frames * 6;
+    offset = record.size();
+    record.resize(offset + animation);
+    instream.read(&record[offset], animation);
+  }
+
+  return record;
+}
+
+CEWorldModel::CEWorldModel(const CEMapType type, std::istream& instream, bool deferUpload)
 {
   this->m_old_object_info = std::unique_ptr<TObjInfo>(new TObjInfo());
   
@@ -128,11 +170,11 @@ CEWorldModel::CEWorldModel(const CEMapType type, std::ifstream& instream)
   
   // load the geo
   std::unique_ptr<CETexture> cTexture;
-  if (type == CEMapType::C2) cTexture = std::unique_ptr<CETexture>(new CETexture(spirit_texture_data, 128*128*2, 128, 128));
+  if (type == CEMapType::C2) cTexture = std::unique_ptr<CETexture>(new CETexture(spirit_texture_data, 128*128*2, 128, 128, false, deferUpload));
   
-  std::unique_ptr<CETexture> mTexture = std::unique_ptr<CETexture>(new CETexture(texture_data, 256*256*2, 256, 256));
+  std::unique_ptr<CETexture> mTexture = std::unique_ptr<CETexture>(new CETexture(texture_data, 256*256*2, 256, 256, false, deferUpload));
   
-  std::unique_ptr<CEGeometry> mGeo = std::unique_ptr<CEGeometry>(new CEGeometry(m_loader->getVertices(), m_loader->getIndices(), std::move(mTexture), "basic_shader"));
+  std::unique_ptr<CEGeometry> mGeo = std::unique_ptr<CEGeometry>(new CEGeometry(m_loader->getVertices(), m_loader->getIndices(), std::move(mTexture), "basic_shader", deferUpload));
   mGeo->EnablePhysics();
   
   std::vector<Vertex> cVertices;
@@ -167,8 +209,14 @@ CEWorldModel::CEWorldModel(const CEMapType type, std::ifstream& instream)
   
   this->m_geometry = std::move(mGeo);
   
+  // Conservative culling radius: furthest vertex from the model origin
+  m_bounding_radius = 0.f;
+  for (const auto& vertex : this->m_geometry->GetVertices()) {
+    m_bounding_radius = std::max(m_bounding_radius, glm::length(vertex.getPos()));
+  }
+  
   if (type == CEMapType::C2) {
-    std::unique_ptr<CESimpleGeometry> cGeo = std::unique_ptr<CESimpleGeometry>(new CESimpleGeometry(cVertices, std::move(cTexture)));
+    std::unique_ptr<CESimpleGeometry> cGeo = std::unique_ptr<CESimpleGeometry>(new CESimpleGeometry(cVertices, std::move(cTexture), deferUpload));
     this->m_far_geometry = std::move(cGeo);
   }
   
@@ -197,6 +245,14 @@ CEWorldModel::CEWorldModel(const CEMapType type, std::ifstream& instream)
 //  }
 }
 
+void CEWorldModel::upload()
+{
+  this->m_geometry->upload();
+  if (this->m_far_geometry) {
+    this->m_far_geometry->upload();
+  }
+}
+
 CEGeometry* CEWorldModel::getGeometry() const
 {
   return this->m_geometry.get();
@@ -339,7 +395,7 @@ std::vector<Vertex> generateWireframeBox(const glm::vec3& min, const glm::vec3&
   return vertices;
 }
 
-void CEWorldModel::renderBoundingBox(const glm::mat4& viewProjectionMatrix) {
+void CEWorldModel::renderBoundingBox() {
   // Debug: Check model data and flags
   static bool firstDebug = true;
   if (firstDebug) {
@@ -417,7 +473,6 @@ void CEWorldModel::renderBoundingBox(const glm::mat4& viewProjectionMatrix) {
       shader->setBool("useCustomColor", true);
       shader->setVec3("customColor", glm::vec3(0.0f, 1.0f, 1.0f)); // Cyan wireframe boxes
       shader->setBool("enableShadows", false);
-      shader->setMat4("projection_view", viewProjectionMatrix); // Set the camera matrices
     }
     
     // Update instanced transforms and render
@@ -431,7 +486,7 @@ void CEWorldModel::renderBoundingBox(const glm::mat4& viewProjectionMatrix) {
   }
 }
 
-void CEWorldModel::renderRadiusCylinder(const glm::mat4& viewProjectionMatrix)
+void CEWorldModel::renderRadiusCylinder()
 {
   if (!m_old_object_info || m_old_object_info->Radius <= 0) {
     return; // No valid radius
@@ -523,7 +578,6 @@ void CEWorldModel::renderRadiusCylinder(const glm::mat4& viewProjectionMatrix)
       shader->setBool("useCustomColor", true);
       shader->setVec3("customColor", glm::vec3(1.0f, 1.0f, 0.0f)); // Yellow wireframe cylinders
       shader->setBool("enableShadows", false);
-      shader->setMat4("projection_view", viewProjectionMatrix);
     }
     
     // Update instanced transforms and render
@@ -561,27 +615,138 @@ void CEWorldModel::addFar(Transform& transform)
 
 void CEWorldModel::updateFarInstances()
 {
+  if (!m_far_geometry) {
+    this->m_far_instances.clear();
+    return;
+  }
+  
+  m_visible_far_instances = this->m_far_instances.size();
   m_far_geometry->UpdateInstances(this->m_far_instances);
   this->m_far_instances.clear();
 }
 
 void CEWorldModel::renderFarInstances()
 {
+  if (!m_far_geometry) return;
+  
   m_far_geometry->DrawInstances();
 }
 
-void CEWorldModel::addNear(Transform& transform)
+void CEWorldModel::addNear(Transform& transform, int group)
 {
   this->m_near_instances.push_back(transform.GetStaticModel());
   this->m_transforms.push_back(transform);
+  this->m_instance_groups.push_back(group);
+  
+  glm::vec3 scale = *transform.GetScale();
+  float radius = m_bounding_radius * std::max(scale.x, std::max(scale.y, scale.z));
+  this->m_instance_bounds.push_back(glm::vec4(*transform.GetPos(), radius));
+}
+
+/*
+ * Keeps the remaining instances in order; the instance lists are rebuilt by the next cullInstances()
+ */
+void CEWorldModel::removeGroup(int group)
+{
+  size_t kept = 0;
+  for (size_t i = 0; i < m_transforms.size(); i++) {
+    if (m_instance_groups[i] == group) continue;
+
+    if (kept != i) {
+      m_transforms[kept] = m_transforms[i];
+      m_instance_bounds[kept] = m_instance_bounds[i];
+      m_instance_groups[kept] = m_instance_groups[i];
+    }
+    kept++;
+  }
+
+  m_transforms.resize(kept);
+  m_instance_bounds.resize(kept);
+  m_instance_groups.resize(kept);
 }
 
 void CEWorldModel::updateNearInstances()
 {
+  m_visible_instances = this->m_near_instances.size();
   m_geometry->UpdateInstances(this->m_near_instances);
   this->m_near_instances.clear();
 }
 
+/*
+ * 0 = full geometry, 1 = far billboard. Only C2 maps ship the billboard bitmaps.
+ */
+int CEWorldModel::determineLOD(float distance, float lod_distance) const
+{
+  if (!m_far_geometry || lod_distance <= 0.f) return 0;
+  
+  return distance < lod_distance ? 0 : 1;
+}
+
+void CEWorldModel::cullInstances(const CEFrustum& frustum, const glm::vec3& camera_position, float lod_distance, float fade_band, float max_distance)
+{
+  this->m_near_instances.clear();
+  this->m_far_instances.clear();
+  
+  float half_band = fade_band * 0.5f;
+  
+  for (size_t i = 0; i < m_instance_bounds.size(); i++) {
+    const glm::vec4& bounds = m_instance_bounds[i];
+    glm::vec3 center(bounds);
+    
+    // Fully fogged beyond max_distance
+    float reach = max_distance + bounds.w;
+    glm::vec3 offset = center - camera_position;
+    float distance_squared = glm::dot(offset, offset);
+    if (distance_squared > reach * reach) continue;
+    
+    if (!frustum.intersectsSphere(center, bounds.w)) continue;
+    
+    // Inside the fade band an instance is drawn at both LODs and the shaders dither between them
+    float distance = std::sqrt(distance_squared);
+    bool draw_near = determineLOD(distance - half_band, lod_distance) == 0;
+    bool draw_far = determineLOD(distance + half_band, lod_distance) == 1;
+    
+    if (draw_near) {
+      this->m_near_instances.push_back(m_transforms[i].GetStaticModel());
+    }
+    
+    if (draw_far) {
+      // Billboard: the quad lies in the model's XY plane, so spin it about Y until +Z faces the camera
+      float yaw = std::atan2(-offset.x, -offset.z);
+      glm::mat4 billboard = glm::translate(glm::mat4(1.f), center);
+      billboard = glm::rotate(billboard, yaw, glm::vec3(0.f, 1.f, 0.f));
+      billboard = glm::scale(billboard, *m_transforms[i].GetScale());
+      this->m_far_instances.push_back(billboard);
+    }
+  }
+}
+
+/*
+ * One-off uniforms for the LOD cross-fade; both shaders must agree on the band
+ */
+void CEWorldModel::configureLOD(float lod_distance, float fade_band)
+{
+  ShaderProgram* shader = m_geometry->getShader();
+  shader->use();
+  shader->setFloat("lodDistance", lod_distance);
+  shader->setFloat("lodFadeBand", fade_band);
+  shader->setBool("lodFadeOut", true);
+  
+  if (!m_far_geometry) return;
+  
+  shader = m_far_geometry->getShader();
+  shader->use();
+  shader->setFloat("lodDistance", lod_distance);
+  shader->setFloat("lodFadeBand", fade_band);
+  shader->setBool("lodFadeOut", false);
+}
+
+void CEWorldModel::renderInstancesWithLOD()
+{
+  renderNearInstances();
+  renderFarInstances();
+}
+
 void CEWorldModel::renderNearInstances()
 {
   m_geometry->DrawInstances();
@@ -34,6 +34,7 @@ class CEAnimation;
 class CEGeometry;
 class CESimpleGeometry;
 class Vertex;
+class CEFrustum;
 
 struct Transform;
 struct Camera;
@@ -73,23 +74,43 @@ private:
   std::vector<glm::mat4> m_near_instances;
   
   std::vector<Transform> m_transforms;
+  std::vector<glm::vec4> m_instance_bounds; // world-space bounding sphere per instance (xyz = center, w = radius)
+  std::vector<int> m_instance_groups; // world page an instance was placed from, or -1
+  float m_bounding_radius; // local-space radius around the model origin, before instance scale
+  size_t m_visible_instances = 0;
+  size_t m_visible_far_instances = 0;
   
   std::unique_ptr<TObjInfo> m_old_object_info; // Easier to use old object for now
   
   void _generateBoundingBox(std::vector<Vertex>& vertex_data); // old method for bounding box. Move to geo when able
   
 public:
-  CEWorldModel(const CEMapType type, std::ifstream& instream);
+  // deferUpload: parse and build physics only, so models can be built on loader threads; call upload() on the GL thread
+  CEWorldModel(const CEMapType type, std::istream& instream, bool deferUpload = false);
   ~CEWorldModel();
 
+  // Copies one model record out of a .rsc stream without parsing it
+  static std::string readRecord(const CEMapType type, std::istream& instream);
+  void upload();
+
   void addFar(Transform& transform);
   void updateFarInstances();
   void renderFarInstances();
 
-  void addNear(Transform& transform);
+  void addNear(Transform& transform, int group = -1);
+  // Drops every instance added with this group, e.g. when its world page is evicted
+  void removeGroup(int group);
   void updateNearInstances();
   void renderNearInstances();
   
+  // Rebuild the near and far instance lists from the instances inside the frustum and closer than max_distance.
+  // Instances past lod_distance go to the far billboard; inside the fade band they are in both lists.
+  // Touches no GL state so it can run off the render thread; follow with updateNearInstances()/updateFarInstances().
+  void cullInstances(const CEFrustum& frustum, const glm::vec3& camera_position, float lod_distance, float fade_band, float max_distance);
+  size_t getVisibleInstanceCount() const { return m_visible_instances; }
+  size_t getVisibleFarInstanceCount() const { return m_visible_far_instances; }
+  bool hasFarGeometry() const { return m_far_geometry != nullptr; }
+  
   void render(Transform& transform, Camera& camera);
   void renderFar(Transform& transform, Camera& camera);
   
@@ -97,12 +118,14 @@ public:
   CESimpleGeometry* getFarGeometry();
   TObjInfo* getObjectInfo(); // TODO: Make this unnecessary
   
-  void renderInstancesWithLOD(const std::vector<Transform>& instances, const Camera& camera);
-  void renderBoundingBox(const glm::mat4& viewProjectionMatrix);
-  void renderRadiusCylinder(const glm::mat4& viewProjectionMatrix);
-  int determineLOD(const Transform& transform, const Camera& camera);
+  void configureLOD(float lod_distance, float fade_band);
+  void renderInstancesWithLOD();
+  void renderBoundingBox();
+  void renderRadiusCylinder();
+  int determineLOD(float distance, float lod_distance) const;
   
   const std::vector<Transform>& getTransforms() const;
+  int getInstanceGroup(size_t instance) const { return m_instance_groups[instance]; }
   
   bool hasBoundingBox();
   const std::array<TBound, 8>& getBoundingBoxes() const;
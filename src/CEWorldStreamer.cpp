@@ -0,0 +1,172 @@
+//
+//  CEWorldStreamer.cpp
+//  CE Character Lab
+//
+//  Keeps the pages of a streamed world resident around the player, loading them on a background thread
+//
+
+#include "CEWorldStreamer.h"
+
+#include "C2MapFile.h"
+#include "CEMapPage.h"
+#include "IWorldPageListener.h"
+
+#include <algorithm>
+#include <iostream>
+
+CEWorldStreamer::CEWorldStreamer(std::shared_ptr<C2MapFile> map, int radius)
+: m_map(map), m_radius(std::max(1, radius))
+{
+  m_requested.assign(m_map->getPagesX() * m_map->getPagesY(), false);
+  m_loader = std::thread(&CEWorldStreamer::loaderLoop, this);
+}
+
+CEWorldStreamer::~CEWorldStreamer()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_work_ready.notify_all();
+  m_loader.join();
+}
+
+void CEWorldStreamer::addListener(IWorldPageListener* listener)
+{
+  m_listeners.push_back(listener);
+}
+
+void CEWorldStreamer::removeListener(IWorldPageListener* listener)
+{
+  m_listeners.erase(std::remove(m_listeners.begin(), m_listeners.end(), listener), m_listeners.end());
+}
+
+void CEWorldStreamer::loaderLoop()
+{
+  while (true) {
+    int page;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_work_ready.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+      if (m_stopping) return;
+
+      page = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    std::unique_ptr<CEMapPage> loaded = m_map->loadPage(page);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_loaded.push_back(std::move(loaded));
+  }
+}
+
+int CEWorldStreamer::getPageAtPosition(const glm::vec3& position) const
+{
+  glm::vec2 tile = m_map->getWorldTilePosition(position);
+  int x = std::clamp((int)tile.x, 0, m_map->getWidth() - 1);
+  int y = std::clamp((int)tile.y, 0, m_map->getHeight() - 1);
+
+  return m_map->getPageAt(x, y);
+}
+
+int CEWorldStreamer::getPageDistance(int a, int b) const
+{
+  int pages_x = m_map->getPagesX();
+  return std::max(std::abs((a % pages_x) - (b % pages_x)), std::abs((a / pages_x) - (b / pages_x)));
+}
+
+std::vector<int> CEWorldStreamer::getPagesAround(int page) const
+{
+  int pages_x = m_map->getPagesX(), pages_y = m_map->getPagesY();
+  int px = page % pages_x, py = page / pages_x;
+
+  std::vector<int> pages;
+  for (int y = std::max(py - m_radius, 0); y <= std::min(py + m_radius, pages_y - 1); y++) {
+    for (int x = std::max(px - m_radius, 0); x <= std::min(px + m_radius, pages_x - 1); x++) {
+      pages.push_back((y * pages_x) + x);
+    }
+  }
+
+  std::stable_sort(pages.begin(), pages.end(), [&](int a, int b) {
+    return this->getPageDistance(a, page) < this->getPageDistance(b, page);
+  });
+  return pages;
+}
+
+void CEWorldStreamer::install(std::unique_ptr<CEMapPage> page)
+{
+  int index = page->m_index;
+  m_map->installPage(std::move(page));
+
+  for (IWorldPageListener* listener : m_listeners) {
+    listener->onPageLoaded(index);
+  }
+}
+
+void CEWorldStreamer::loadAround(const glm::vec3& position)
+{
+  m_focus_page = this->getPageAtPosition(position);
+
+  int loaded = 0;
+  for (int page : this->getPagesAround(m_focus_page)) {
+    if (m_map->isPageResident(page) || m_requested[page]) continue;
+
+    this->install(m_map->loadPage(page));
+    loaded++;
+  }
+
+  std::cout << "World: loaded " << loaded << " pages around page " << m_focus_page << std::endl;
+}
+
+void CEWorldStreamer::update(const glm::vec3& position)
+{
+  int focus = this->getPageAtPosition(position);
+
+  if (focus != m_focus_page) {
+    m_focus_page = focus;
+
+    // Evict first so the pages' memory is on its way out before new ones arrive
+    int page_count = m_map->getPagesX() * m_map->getPagesY();
+    for (int page = 0; page < page_count; page++) {
+      if (m_map->isPageResident(page) && this->getPageDistance(page, focus) > m_radius + 1) {
+        m_map->evictPage(page);
+        for (IWorldPageListener* listener : m_listeners) {
+          listener->onPageEvicted(page);
+        }
+      }
+    }
+
+    // Requeue nearest first, dropping requests the player has already left behind
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int page : m_queue) {
+      m_requested[page] = false;
+    }
+    m_queue.clear();
+
+    for (int page : this->getPagesAround(focus)) {
+      if (m_map->isPageResident(page) || m_requested[page]) continue;
+      m_requested[page] = true;
+      m_queue.push_back(page);
+    }
+    m_work_ready.notify_one();
+  }
+
+  std::vector<std::unique_ptr<CEMapPage>> loaded;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int count = std::min((int)m_loaded.size(), MAX_INSTALLS_PER_UPDATE);
+    std::move(m_loaded.begin(), m_loaded.begin() + count, std::back_inserter(loaded));
+    m_loaded.erase(m_loaded.begin(), m_loaded.begin() + count);
+  }
+
+  for (auto& page : loaded) {
+    m_requested[page->m_index] = false;
+    // Loaded for a focus the player has since moved away from
+    if (this->getPageDistance(page->m_index, m_focus_page) > m_radius + 1) continue;
+
+    this->install(std::move(page));
+  }
+
+  m_map->releaseRetiredPages();
+}
@@ -0,0 +1,70 @@
+//
+//  CEWorldStreamer.h
+//  CE Character Lab
+//
+//  Keeps the pages of a streamed world resident around the player, loading them on a background thread
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class C2MapFile;
+class CEMapPage;
+class IWorldPageListener;
+
+/*
+ * Pages within m_radius pages (Chebyshev distance) of the focus are kept resident; pages are only
+ * evicted once they are more than m_radius + 1 away, so walking along a page edge does not thrash.
+ * Page files are read and post-processed on the loader thread; installing them in the map and
+ * telling the listeners happens in update() on the main thread.
+ */
+class CEWorldStreamer
+{
+private:
+  std::shared_ptr<C2MapFile> m_map;
+  int m_radius;
+  int m_focus_page = -1;
+  std::vector<IWorldPageListener*> m_listeners;
+
+  // Queued or loading; main thread only
+  std::vector<bool> m_requested;
+
+  std::thread m_loader;
+  std::mutex m_mutex;
+  std::condition_variable m_work_ready;
+  // Nearest first
+  std::deque<int> m_queue;
+  std::vector<std::unique_ptr<CEMapPage>> m_loaded;
+  bool m_stopping = false;
+
+  void loaderLoop();
+  int getPageAtPosition(const glm::vec3& position) const;
+  int getPageDistance(int a, int b) const;
+  std::vector<int> getPagesAround(int page) const;
+  void install(std::unique_ptr<CEMapPage> page);
+
+public:
+  // Pages installed per update(); each one costs its listeners an upload
+  constexpr static const int MAX_INSTALLS_PER_UPDATE = 1;
+
+  CEWorldStreamer(std::shared_ptr<C2MapFile> map, int radius);
+  ~CEWorldStreamer();
+
+  void addListener(IWorldPageListener* listener);
+  void removeListener(IWorldPageListener* listener);
+
+  // Loads every page around position before returning; for startup and teleports
+  void loadAround(const glm::vec3& position);
+  // Once per frame on the main thread
+  void update(const glm::vec3& position);
+
+  int getRadius() const { return m_radius; }
+};
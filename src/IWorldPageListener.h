@@ -0,0 +1,29 @@
+//
+//  IWorldPageListener.h
+//  CE Character Lab
+//
+//  Interface for systems that keep per-page state for a streamed world
+//
+
+#pragma once
+
+/**
+ * Notified on the main thread by CEWorldStreamer as pages of the world come and go.
+ * Pages resident before a listener is added are not replayed to it.
+ */
+class IWorldPageListener {
+public:
+    virtual ~IWorldPageListener() = default;
+
+    /**
+     * The page has been installed in the map and its tiles can be read.
+     * @param page Row-major page number
+     */
+    virtual void onPageLoaded(int page) = 0;
+
+    /**
+     * The page has left the map; its tiles read as unloaded from now on.
+     * @param page Row-major page number
+     */
+    virtual void onPageEvicted(int page) = 0;
+};
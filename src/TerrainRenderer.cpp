@@ -17,8 +17,11 @@
 #include "CEShadowManager.h"
 
 #include "CEWaterEntity.h"
+#include "CEJobSystem.h"
 
 #include <cstdint>
+#include <limits>
+#include <thread>
 
 #include <nlohmann/json.hpp>
 #include <filesystem>
@@ -26,9 +29,20 @@
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-TerrainRenderer::TerrainRenderer(std::shared_ptr<C2MapFile> c_map_weak, std::shared_ptr<C2MapRscFile> c_rsc_weak)
-: m_cmap_data_weak(c_map_weak), m_crsc_data_weak(c_rsc_weak)
+static int nextPowerOfTwo(int value)
 {
+  int power = 1;
+  while (power < value) power <<= 1;
+  return power;
+}
+
+TerrainRenderer::TerrainRenderer(std::shared_ptr<C2MapFile> c_map_weak, std::shared_ptr<C2MapRscFile> c_rsc_weak, std::shared_ptr<CEMapCache> map_cache, int streaming_radius)
+: m_cmap_data_weak(c_map_weak), m_crsc_data_weak(c_rsc_weak), m_map_cache(map_cache), m_streaming_radius(streaming_radius)
+{
+  // Workers stay up for the renderer's lifetime, so culling starts no threads per frame
+  m_cull_jobs = std::make_unique<CEJobSystem>(std::max(1u, std::thread::hardware_concurrency()) - 1);
+  
+  this->loadConfig();
   this->loadIntoHardwareMemory();
   // this->exportAsRaw();
   this->loadShader();
@@ -37,8 +51,22 @@ TerrainRenderer::TerrainRenderer(std::shared_ptr<C2MapFile> c_map_weak, std::sha
 
 TerrainRenderer::~TerrainRenderer()
 {
+  // Queued uploads into the names below, and the callbacks into this renderer, are dropped
+  for (auto& ticket : this->m_page_uploads) {
+    if (ticket) ticket->cancel();
+  }
+  for (auto& water : this->m_waters) {
+    if (water.m_upload) water.m_upload->cancel();
+  }
+  for (auto& fog_volume : this->m_fog_volumes) {
+    if (fog_volume.m_upload) fog_volume.m_upload->cancel();
+  }
+
   glDeleteTextures(1, &this->underwaterStateTexture);
   glDeleteTextures(1, &this->heightmapTexture);
+  glDeleteTextures(1, &this->m_chunk_lod_texture);
+  glDeleteTextures(1, &this->m_terrain_height_texture);
+  glDeleteTextures(1, &this->m_tile_texture);
   glDeleteBuffers(1, &this->m_vertex_array_buffer);
   glDeleteBuffers(1, &this->m_indices_array_buffer);
   glDeleteVertexArrays(1, &this->m_vertex_array_object);
@@ -89,18 +117,62 @@ void TerrainRenderer::exportAsRaw()
  */
 void TerrainRenderer::preloadObjectMap()
 {
-  int map_square_size = this->m_cmap_data_weak->getHeight();
+  if (m_streamed) {
+    // Pages resident now; the rest arrive through onPageLoaded
+    int page_size = m_cmap_data_weak->getPageSize();
+    for (int page = 0; page < m_cmap_data_weak->getPagesX() * m_cmap_data_weak->getPagesY(); page++) {
+      if (!m_cmap_data_weak->isPageResident(page)) continue;
+
+      int x0 = (page % m_cmap_data_weak->getPagesX()) * page_size, y0 = (page / m_cmap_data_weak->getPagesX()) * page_size;
+      std::vector<CEMapCache::ObjectPlacement> placements;
+      this->collectObjectPlacements(x0, y0, x0 + page_size, y0 + page_size, placements);
+      this->addObjectInstances(placements, page);
+    }
+  } else {
+    std::vector<CEMapCache::ObjectPlacement> placements;
+    if (!(m_map_cache && m_map_cache->readVector(CEMapCache::Section::OBJECT_PLACEMENTS, placements))) {
+      std::cout << "Precalculating world object transforms" << std::endl;
+      this->collectObjectPlacements(0, 0, m_cmap_data_weak->getWidth(), m_cmap_data_weak->getHeight(), placements);
+      
+      if (m_map_cache) {
+        m_map_cache->writeVector(CEMapCache::Section::OBJECT_PLACEMENTS, placements);
+      }
+    }
+    this->addObjectInstances(placements, -1);
+  }
+
+  auto color = this->m_crsc_data_weak->getFadeColor();
+  auto dist = (m_cmap_data_weak->getTileLength() * (m_cmap_data_weak->getWidth() / 4.f));
+  auto dColor = glm::vec4(color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a);
+
+  for (int m = 0; m < this->m_crsc_data_weak->getWorldModelCount(); m++) {
+    auto model = this->m_crsc_data_weak->getWorldModel(m);
+    // Update instances
+    model->updateNearInstances();
+    // Configure shader
+    model->getGeometry()->ConfigureShaderUniforms(m_cmap_data_weak.get(), m_crsc_data_weak.get());
+    if (model->hasFarGeometry()) {
+      model->getFarGeometry()->ConfigureShaderUniforms(m_crsc_data_weak.get());
+    }
+    model->configureLOD(m_object_lod_enabled ? m_object_lod_distance : 0.f, m_object_lod_fade_band);
+  }
+}
+
+/*
+ * Object placements for the tiles in [x0, x1) x [y0, y1)
+ */
+void TerrainRenderer::collectObjectPlacements(int x0, int y0, int x1, int y1, std::vector<CEMapCache::ObjectPlacement>& placements)
+{
+  int map_width = this->m_cmap_data_weak->getWidth();
   float map_tile_length = this->m_cmap_data_weak->getTileLength();
   
-  std::cout << "Precalculating world object transforms" << std::endl;
-  
-  for (int y = 0; y < map_square_size; y++) {
-    for (int x = 0; x < map_square_size; x++) {
-      int xy = (y*map_square_size)+x;
+  for (int y = y0; y < y1; y++) {
+    for (int x = x0; x < x1; x++) {
+      int xy = (y*map_width)+x;
       int obj_id = this->m_cmap_data_weak->getObjectAt(xy);
       
       if (obj_id == 255 || obj_id == 254) continue;
-
+      
       float object_height;
       CEWorldModel* w_obj = this->m_crsc_data_weak->getWorldModel(obj_id);
       if (w_obj == nullptr) {
@@ -118,48 +190,79 @@ void TerrainRenderer::preloadObjectMap()
         object_height = this->m_cmap_data_weak->getObjectHeightAt(xy);
       }
       
-      int rotation_idx = (this->m_cmap_data_weak->getFlagsAt(xy) >> 2) & 3;
-      glm::vec3 rotation;
-      switch (rotation_idx) {
-        case 0:
-          rotation = glm::vec3(0, glm::radians(0.f), 0);
-          break;
-        case 1:
-          rotation = glm::vec3(0, glm::radians(90.f), 0);
-          break;
-        case 2:
-          rotation = glm::vec3(0, glm::radians(180.f), 0);
-          break;
-        case 3:
-          rotation = glm::vec3(0, glm::radians(270.f), 0);
-          break;
-      }
-      
-      glm::vec3 world_position = glm::vec3(((float)(x)*map_tile_length) + map_tile_length, object_height, ((float)(y)*map_tile_length) + map_tile_length);
-      
-      // Scale objects down 16x to match new world scale 
-      Transform transform_initial(
-                                  world_position,
-                                  rotation,
-                                  glm::vec3(0.0625f, 0.0625f, 0.0625f) // 1/16 scale
-                                  );
-
-      w_obj->addFar(transform_initial);
-      w_obj->addNear(transform_initial);
+      CEMapCache::ObjectPlacement placement;
+      placement.model = obj_id;
+      placement.rotation = (this->m_cmap_data_weak->getFlagsAt(xy) >> 2) & 3;
+      placement.position = glm::vec3(((float)(x)*map_tile_length) + map_tile_length, object_height, ((float)(y)*map_tile_length) + map_tile_length);
+      placements.push_back(placement);
     }
   }
+}
 
-  auto color = this->m_crsc_data_weak->getFadeColor();
-  auto dist = (m_cmap_data_weak->getTileLength() * (m_cmap_data_weak->getWidth() / 4.f));
-  auto dColor = glm::vec4(color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a);
+void TerrainRenderer::addObjectInstances(const std::vector<CEMapCache::ObjectPlacement>& placements, int page)
+{
+  for (const auto& placement : placements) {
+    CEWorldModel* w_obj = this->m_crsc_data_weak->getWorldModel(placement.model);
+    if (w_obj == nullptr) continue;
+    
+    // Quarter turns: 0, 90, 180 or 270 degrees
+    glm::vec3 rotation = glm::vec3(0, glm::radians(90.f * placement.rotation), 0);
+    
+    // Scale objects down 16x to match new world scale 
+    Transform transform_initial(
+                                placement.position,
+                                rotation,
+                                glm::vec3(0.0625f, 0.0625f, 0.0625f) // 1/16 scale
+                                );
+
+    w_obj->addNear(transform_initial, page);
+  }
+}
 
-  for (int m = 0; m < this->m_crsc_data_weak->getWorldModelCount(); m++) {
-    auto model = this->m_crsc_data_weak->getWorldModel(m);
-    // Update instances
-    model->updateNearInstances();
-    // Configure shader
-    model->getGeometry()->ConfigureShaderUniforms(m_cmap_data_weak.get(), m_crsc_data_weak.get());
+void TerrainRenderer::loadConfig()
+{
+  std::ifstream f("config.json");
+  json data = json::parse(f);
+
+  float lod_distance_tiles = (float)CHUNK_SIZE;
+  float object_lod_distance_tiles = 48.f;
+  float object_lod_fade_tiles = 4.f;
+
+  if (data.contains("video") && data["video"].is_object()) {
+    if (data["video"].contains("terrainLOD") && data["video"]["terrainLOD"].is_boolean()) {
+      m_lod_enabled = data["video"]["terrainLOD"];
+    }
+    if (data["video"].contains("terrainVertexPulling") && data["video"]["terrainVertexPulling"].is_boolean()) {
+      m_vertex_pulling = data["video"]["terrainVertexPulling"];
+    }
+    if (data["video"].contains("terrainLODDistance") && data["video"]["terrainLODDistance"].is_number()) {
+      lod_distance_tiles = data["video"]["terrainLODDistance"];
+    }
+    if (data["video"].contains("objectLOD") && data["video"]["objectLOD"].is_boolean()) {
+      m_object_lod_enabled = data["video"]["objectLOD"];
+    }
+    if (data["video"].contains("objectLODDistance") && data["video"]["objectLODDistance"].is_number()) {
+      object_lod_distance_tiles = data["video"]["objectLODDistance"];
+    }
+    if (data["video"].contains("objectLODFade") && data["video"]["objectLODFade"].is_number()) {
+      object_lod_fade_tiles = data["video"]["objectLODFade"];
+    }
+  }
+
+  // A world larger than one page has no CPU mesh to fall back on
+  m_streamed = m_cmap_data_weak->isStreamed();
+  if (m_streamed) {
+    m_vertex_pulling = true;
+    int span = ((2 * (m_streaming_radius + 1)) + 1) * m_cmap_data_weak->getPageSize();
+    m_tile_window = glm::ivec2(std::min(nextPowerOfTwo(m_cmap_data_weak->getWidth()), nextPowerOfTwo(span)),
+                               std::min(nextPowerOfTwo(m_cmap_data_weak->getHeight()), nextPowerOfTwo(span)));
+  } else {
+    m_tile_window = glm::ivec2(nextPowerOfTwo(m_cmap_data_weak->getWidth()), nextPowerOfTwo(m_cmap_data_weak->getHeight()));
   }
+
+  m_lod_distance = lod_distance_tiles * m_cmap_data_weak->getTileLength();
+  m_object_lod_distance = object_lod_distance_tiles * m_cmap_data_weak->getTileLength();
+  m_object_lod_fade_band = std::max(0.f, object_lod_fade_tiles) * m_cmap_data_weak->getTileLength();
 }
 
 void TerrainRenderer::loadShader()
@@ -170,41 +273,60 @@ void TerrainRenderer::loadShader()
   fs::path basePath = fs::path(data["basePath"].get<std::string>());
   fs::path shaderPath = basePath / "shaders";
   
-  auto color = this->m_crsc_data_weak->getFadeColor();
-  float r = color.r / 255.0f;
-  float g = color.g / 255.0f;
-  float b = color.b / 255.0f;
-  float a = color.a;
-
-  // Define a baseline brightness factor
-  float brightnessFactor = 1.0f;
-
-  // Increase the brightness
-  r = std::min(r * brightnessFactor, 1.0f);
-  g = std::min(g * brightnessFactor, 1.0f);
-  b = std::min(b * brightnessFactor, 1.0f);
-  
   float atlas_square_size = (float)this->m_crsc_data_weak->getTextureAtlasWidth();
+  int atlas_padding = this->m_crsc_data_weak->getAtlasTilePadding();
+  int atlas_tile_width = this->m_crsc_data_weak->getAtlasTileWidth();
   
   this->m_shader = std::unique_ptr<ShaderProgram>(new ShaderProgram((shaderPath / "terrain.vs").string(), (shaderPath / "terrain.fs").string()));
   this->m_water_shader = std::unique_ptr<ShaderProgram>(new ShaderProgram((shaderPath / "water_surface.vs").string(), (shaderPath / "water_surface.fs").string()));
   this->m_fog_shader = std::unique_ptr<ShaderProgram>(new ShaderProgram((shaderPath / "fog_volume.vs").string(), (shaderPath / "fog_volume.fs").string()));
 
   this->m_shader->use();
-  this->m_shader->setFloat("view_distance", (m_cmap_data_weak->getTileLength() * (m_cmap_data_weak->getWidth() / 8.f)));
-  this->m_shader->setVec4("distanceColor", glm::vec4(r, g, b, a));
   this->m_shader->setFloat("terrainWidth", this->m_cmap_data_weak->getWidth());
   this->m_shader->setFloat("terrainHeight", this->m_cmap_data_weak->getHeight());
   this->m_shader->setFloat("tileWidth", this->m_cmap_data_weak->getTileLength());
   this->m_shader->setVec2("atlasSize", glm::vec2(atlas_square_size));
+  this->m_shader->setBool("lodEnabled", m_lod_enabled);
+  this->m_shader->setInt("chunkSize", CHUNK_SIZE);
+  // Always give the LOD samplers their own units; an integer and a float sampler may not share one
+  this->m_shader->setInt("terrainHeightTexture", 4);
+  this->m_shader->setInt("chunkLodTexture", 5);
+  for (int lod = 0; lod < LOD_LEVELS; lod++) {
+    this->m_shader->setInt("lodBaseVertex[" + std::to_string(lod) + "]", m_lod_base_vertex[lod]);
+  }
+  this->m_shader->setBool("vertexPulling", m_vertex_pulling);
+  this->m_shader->setInt("chunksPerRow", m_chunks_per_row);
+  this->m_shader->setInt("terrainTileTexture", 6);
+  this->m_shader->setIVec2("tileWindowMask", m_tile_window - 1);
+  // Same inset as scaleAtlasUV, as a fraction of one atlas tile
+  this->m_shader->setFloat("atlasPadding", float(atlas_padding) / float(atlas_tile_width + (atlas_padding * 2.f)));
 
   this->m_water_shader->use();
   this->m_water_shader->setFloat("terrainWidth", this->m_cmap_data_weak->getWidth());
   this->m_water_shader->setFloat("terrainHeight", this->m_cmap_data_weak->getHeight());
   this->m_water_shader->setFloat("tileWidth", this->m_cmap_data_weak->getTileLength());
-  this->m_water_shader->setVec4("skyColor", glm::vec4(r, g, b, a));
-  this->m_water_shader->setFloat("view_distance", (m_cmap_data_weak->getTileLength() * (m_cmap_data_weak->getWidth() / 8.f)));
   this->m_water_shader->setVec2("atlasSize", glm::vec2(atlas_square_size));
+
+  m_terrain_model_uniform = this->m_shader->getUniformLocation("model");
+  m_water_mvp_uniform = this->m_water_shader->getUniformLocation("MVP");
+  m_water_model_uniform = this->m_water_shader->getUniformLocation("model");
+  m_fog_mvp_uniform = this->m_fog_shader->getUniformLocation("MVP");
+  m_fog_model_uniform = this->m_fog_shader->getUniformLocation("model");
+}
+
+/*
+ * Fog values for the FrameConstants block; terrain and water shaders fade to this colour at the view distance
+ */
+glm::vec4 TerrainRenderer::GetFogColor() const
+{
+  auto color = this->m_crsc_data_weak->getFadeColor();
+  return glm::vec4(color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a);
+}
+
+float TerrainRenderer::GetViewDistance() const
+{
+  // Streamed worlds see as far as a full-size classic map
+  return m_cmap_data_weak->getTileLength() * (std::min(m_cmap_data_weak->getWidth(), 1024) / 8.f);
 }
 
 void TerrainRenderer::Update(Transform& transform, Camera& camera)
@@ -213,32 +335,28 @@ void TerrainRenderer::Update(Transform& transform, Camera& camera)
   glm::mat4 model = transform.GetStaticModel();
   double t = glfwGetTime();
 
+  // View, projection, time and camera position come from the FrameConstants uniform buffer
   this->m_shader->use();
-  this->m_shader->setMat4("MVP", MVP);
-  this->m_shader->setMat4("model", model);
-  this->m_shader->setMat4("view", camera.GetVM());
-  this->m_shader->setMat4("projection", camera.GetProjection());
-  this->m_shader->setFloat("time", (float)t);
+  this->m_shader->setMat4(m_terrain_model_uniform, model);
 
-  // TODO: use UBO
   this->m_water_shader->use();
-  this->m_water_shader->setMat4("MVP", MVP);
-  this->m_water_shader->setMat4("model", model);
-  this->m_water_shader->setMat4("view", camera.GetVM());
-  this->m_water_shader->setMat4("projection", camera.GetProjection());
-  this->m_water_shader->setFloat("time", (float)t);
-  this->m_water_shader->setVec3("cameraPos", camera.GetPosition());
-  
-  // Set up fog shader transforms
+  this->m_water_shader->setMat4(m_water_mvp_uniform, MVP);
+  this->m_water_shader->setMat4(m_water_model_uniform, model);
+  
   this->m_fog_shader->use();
-  this->m_fog_shader->setMat4("MVP", MVP);
-  this->m_fog_shader->setMat4("model", model);
-  this->m_fog_shader->setMat4("view", camera.GetVM());
-  this->m_fog_shader->setMat4("projection", camera.GetProjection());
-  this->m_fog_shader->setFloat("time", (float)t);
-  this->m_fog_shader->setVec3("cameraPos", camera.GetPosition());
+  this->m_fog_shader->setMat4(m_fog_mvp_uniform, MVP);
+  this->m_fog_shader->setMat4(m_fog_model_uniform, model);
   
   // Water level is now set per water plane during rendering
+
+  if (m_lod_enabled) {
+    this->selectChunkLODs(camera.GetPosition());
+  }
+
+  glm::mat4 view_projection = camera.GetProjection() * camera.GetVM();
+  m_frustum.update(view_projection);
+  this->cullTerrainChunks();
+  this->cullObjectInstances(view_projection, camera.GetPosition());
   
   for (int m = 0; m < this->m_crsc_data_weak->getWorldModelCount(); m++) {
     this->m_crsc_data_weak->getWorldModel(m)->getGeometry()->Update(transform, camera);
@@ -250,7 +368,7 @@ void TerrainRenderer::Update(Transform& transform, Camera& camera)
 void TerrainRenderer::RenderObjects(Camera& camera)
 {
   for (int m = 0; m < this->m_crsc_data_weak->getWorldModelCount(); m++) {
-    this->m_crsc_data_weak->getWorldModel(m)->getGeometry()->DrawInstances();
+    this->m_crsc_data_weak->getWorldModel(m)->renderInstancesWithLOD();
   }
 }
 
@@ -278,11 +396,14 @@ void TerrainRenderer::RenderObjectsWithShadows(Camera& camera, CEShadowManager*
     if (!geometry) continue;
     
     // Check if this object should cast shadows based on metadata
+    // Billboards past the LOD distance never take part in shadowing
+    model->renderFarInstances();
+    
     if (!CEShadowManager::shouldCastShadow(model)) {
       // Render without shadows for objects that shouldn't cast them
       geometry->DrawInstances();
       regularModels++;
-      totalRegularInstances += model->getTransforms().size();
+      totalRegularInstances += model->getVisibleInstanceCount();
       continue;
     }
     
@@ -291,20 +412,13 @@ void TerrainRenderer::RenderObjectsWithShadows(Camera& camera, CEShadowManager*
     if (!shader) {
       geometry->DrawInstances();
       regularModels++;
-      totalRegularInstances += model->getTransforms().size();
+      totalRegularInstances += model->getVisibleInstanceCount();
       continue;
     }
     
     // Use the geometry's own shader but enable shadows
     shader->use();
     
-    // Set camera matrices (required for instanced rendering)
-    glm::mat4 projection_view = camera.getProjectionMatrix() * camera.getViewMatrix();
-    shader->setMat4("projection_view", projection_view);
-    shader->setMat4("view", camera.getViewMatrix());
-    shader->setMat4("projection", camera.getProjectionMatrix());
-    shader->setFloat("time", (float)glfwGetTime());
-    
     // Enable shadows
     shader->setBool("enableShadows", true);
     
@@ -324,7 +438,7 @@ void TerrainRenderer::RenderObjectsWithShadows(Camera& camera, CEShadowManager*
     // Now draw the instances with shadows enabled (keep our shader active)
     geometry->DrawInstancesWithShader(shader);
     shadowModels++;
-    totalShadowInstances += model->getTransforms().size();
+    totalShadowInstances += model->getVisibleInstanceCount();
   }
 }
 
@@ -580,20 +694,7 @@ void TerrainRenderer::loadWaterAt(int x, int y)
       
       // Expand m_waters vector if needed
       while (water_index >= this->m_waters.size()) {
-        _Water wd;
-        const CEWaterEntity& we = this->m_crsc_data_weak->getWater(this->m_waters.size());
-        
-        wd.m_height_unscaled = we.water_level;
-        wd.m_height = we.water_level * this->m_cmap_data_weak->getHeightmapScale();
-        wd.m_texture_id = we.texture_id;
-        wd.m_transparency = we.transparency;
-        
-        glGenVertexArrays(1, &wd.m_vao);
-        glBindVertexArray(wd.m_vao);
-        glGenBuffers(1, &wd.m_vab);
-        glBindVertexArray(0);
-        
-        this->m_waters.push_back(wd);
+        this->addWaterObject(this->m_crsc_data_weak->getWater(this->m_waters.size()));
         std::cout << "Created m_waters[" << (this->m_waters.size()-1) << "] for dynamic water" << std::endl;
       }
     }
@@ -690,10 +791,17 @@ void TerrainRenderer::loadWaterIntoMemory()
             }
         }
 
+        glGenBuffers(1, &water_object->m_iab);
+
+        // m_waters is complete by now, so the vertex and index vectors stay where they are
+        CEUploadQueue& queue = CEUploadQueue::getInstance();
+        water_object->m_upload = queue.createTicket();
+        queue.uploadBuffer(water_object->m_upload, water_object->m_vab, water_object->m_vertices.data(), water_object->m_vertices.size() * sizeof(Vertex), GL_STATIC_DRAW);
+        queue.uploadBuffer(water_object->m_upload, water_object->m_iab, water_object->m_indices.data(), water_object->m_indices.size() * sizeof(unsigned int), GL_STATIC_DRAW);
+
         glBindVertexArray(water_object->m_vao);
 
         glBindBuffer(GL_ARRAY_BUFFER, water_object->m_vab);
-        glBufferData(GL_ARRAY_BUFFER, (int)water_object->m_vertices.size() * sizeof(Vertex), water_object->m_vertices.data(), GL_STATIC_DRAW);
 
         // Describe vertex details
         glEnableVertexAttribArray(0); // position
@@ -707,9 +815,7 @@ void TerrainRenderer::loadWaterIntoMemory()
         glEnableVertexAttribArray(4); // flags
         glVertexAttribPointer(4, 1, GL_UNSIGNED_INT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3) + sizeof(float)));
 
-        glGenBuffers(1, &water_object->m_iab);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, water_object->m_iab);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (int)water_object->m_indices.size() * sizeof(unsigned int), water_object->m_indices.data(), GL_STATIC_DRAW);
 
         glBindVertexArray(0);
     }
@@ -749,38 +855,32 @@ void TerrainRenderer::updateUnderwaterStateTexture(const std::vector<float>& dat
   }
 }
 
-// From http://www.learnopengles.com/android-lesson-eight-an-introduction-to-index-buffer-objects-ibos/
-// using http://stackoverflow.com/questions/10114577/a-method-for-indexing-triangles-from-a-loaded-heightmap
-void TerrainRenderer::loadIntoHardwareMemory()
+/*
+ * Water render object for one RSC water entity; its geometry is added by loadWaterAt
+ */
+void TerrainRenderer::addWaterObject(const CEWaterEntity& we)
 {
-  int width = this->m_cmap_data_weak->getWidth(), height = this->m_cmap_data_weak->getHeight();
+  _Water wd;
 
-  // build water base objects
-  this->m_waters.clear();
-  for (int w = 0; w < this->m_crsc_data_weak->getWaterCount(); w++)
-  {
-    _Water wd;
-    const CEWaterEntity& we = this->m_crsc_data_weak->getWater(w);
+  wd.m_height_unscaled = we.water_level;
+  wd.m_height = we.water_level * this->m_cmap_data_weak->getHeightmapScale();
+  wd.m_texture_id = we.texture_id;
+  wd.m_transparency = we.transparency;
 
-    wd.m_height_unscaled = we.water_level;
-    wd.m_height = we.water_level * this->m_cmap_data_weak->getHeightmapScale();
-    wd.m_texture_id = we.texture_id;
-    wd.m_transparency = we.transparency;
-    
-    std::cout << "Water " << w << ": unscaled=" << we.water_level << ", scaled=" << wd.m_height 
-              << ", scale=" << this->m_cmap_data_weak->getHeightmapScale() << std::endl;
+  glGenVertexArrays(1, &wd.m_vao);
+  glBindVertexArray(wd.m_vao);
+  
+  glGenBuffers(1, &wd.m_vab);
 
-    glGenVertexArrays(1, &wd.m_vao);
-    glBindVertexArray(wd.m_vao);
-    
-    glGenBuffers(1, &wd.m_vab);
+  glBindVertexArray(0);
 
-    glBindVertexArray(0);
+  this->m_waters.push_back(wd);
+}
+
+void TerrainRenderer::buildWaterGeometry()
+{
+  int width = this->m_cmap_data_weak->getWidth(), height = this->m_cmap_data_weak->getHeight();
 
-    this->m_waters.push_back(wd);
-  }
-  
-  // Generate water geometry AFTER water objects are created
   std::cout << "Generating water geometry for " << width << "x" << height << " tiles" << std::endl;
   int waterTileCount = 0;
   for (int y = 0; y < width; y++) {
@@ -881,168 +981,293 @@ void TerrainRenderer::loadIntoHardwareMemory()
   for (int i = 0; i < std::min(5, (int)this->m_waters.size()); i++) {
     std::cout << "m_waters[" << i << "] addr=" << &this->m_waters[i] << " vertices=" << this->m_waters[i].m_vertices.size() << std::endl;
   }
-  
-  // Structures to store accumulated normals and counts for averaging
-  std::vector<glm::vec3> vertexNormals(width * height, glm::vec3(0.0f));
-  std::vector<int> normalCounts(width * height, 0);
+}
+
+/*
+ * Water meshes from the map cache, including any C1 waters registered while they were first built
+ */
+bool TerrainRenderer::restoreWaterGeometry()
+{
+  if (!m_map_cache || !m_map_cache->isLoaded()) return false;
+
+  std::vector<CEWaterEntity> entities;
+  std::vector<uint32_t> sizes;
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+
+  if (!m_map_cache->readVector(CEMapCache::Section::WATER_ENTITIES, entities) ||
+      !m_map_cache->readVector(CEMapCache::Section::WATER_MESH_SIZES, sizes) ||
+      !m_map_cache->readVector(CEMapCache::Section::WATER_VERTICES, vertices) ||
+      !m_map_cache->readVector(CEMapCache::Section::WATER_INDICES, indices)) {
+    return false;
+  }
+
+  size_t water_count = sizes.size() / 2;
+  size_t vertex_total = 0, index_total = 0;
+  for (size_t w = 0; w < water_count; w++) {
+    vertex_total += sizes[w * 2];
+    index_total += sizes[(w * 2) + 1];
+  }
+  if (water_count < this->m_waters.size() || vertex_total != vertices.size() || index_total != indices.size()) {
+    return false;
+  }
+
+  for (const auto& entity : entities) {
+    m_crsc_data_weak->registerDynamicWater(entity);
+  }
+  while (this->m_waters.size() < water_count) {
+    this->addWaterObject(this->m_crsc_data_weak->getWater((int)this->m_waters.size()));
+  }
+
+  size_t vertex_offset = 0, index_offset = 0;
+  for (size_t w = 0; w < water_count; w++) {
+    _Water& water = this->m_waters[w];
+    water.m_vertices.assign(vertices.begin() + vertex_offset, vertices.begin() + vertex_offset + sizes[w * 2]);
+    water.m_indices.assign(indices.begin() + index_offset, indices.begin() + index_offset + sizes[(w * 2) + 1]);
+    vertex_offset += sizes[w * 2];
+    index_offset += sizes[(w * 2) + 1];
+  }
+
+  std::cout << "Water geometry restored from map cache: " << water_count << " waters, " << vertices.size() << " vertices" << std::endl;
+  return true;
+}
+
+void TerrainRenderer::storeWaterGeometry()
+{
+  if (!m_map_cache) return;
+
+  std::vector<CEWaterEntity> entities;
+  for (int w = 0; w < this->m_crsc_data_weak->getWaterCount(); w++) {
+    entities.push_back(this->m_crsc_data_weak->getWater(w));
+  }
+
+  std::vector<uint32_t> sizes;
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  for (const auto& water : this->m_waters) {
+    sizes.push_back((uint32_t)water.m_vertices.size());
+    sizes.push_back((uint32_t)water.m_indices.size());
+    vertices.insert(vertices.end(), water.m_vertices.begin(), water.m_vertices.end());
+    indices.insert(indices.end(), water.m_indices.begin(), water.m_indices.end());
+  }
+
+  m_map_cache->writeVector(CEMapCache::Section::WATER_ENTITIES, entities);
+  m_map_cache->writeVector(CEMapCache::Section::WATER_MESH_SIZES, sizes);
+  m_map_cache->writeVector(CEMapCache::Section::WATER_VERTICES, vertices);
+  m_map_cache->writeVector(CEMapCache::Section::WATER_INDICES, indices);
+}
+
+/*
+ * Smooth per-vertex normals: face normals of the surrounding quads, averaged
+ */
+void TerrainRenderer::buildTerrainNormals(std::vector<glm::vec3>& vertexNormals)
+{
+  int width = this->m_cmap_data_weak->getWidth(), height = this->m_cmap_data_weak->getHeight();
+
+  vertexNormals.resize(width * height);
   
   std::cout << "Generating terrain normal map" << std::endl;
   
-  for (int y = 0; y < width; y++) {
-      for (int x = 0; x < height; x++) {
-          unsigned int base_index = (y * width) + x;
-
-          glm::vec3 vpositionLL = this->calcWorldVertex(x, y, false, 0.f);
-          glm::vec3 vpositionLR = this->calcWorldVertex(fmin(x + 1, height - 1), y, false, 0.f);
-          glm::vec3 vpositionUL = this->calcWorldVertex(x, fmin(y + 1, width - 1), false, 0.f);
-          glm::vec3 vpositionUR = this->calcWorldVertex(fmin(x + 1, height - 1), fmin(y + 1, width - 1), false, 0.f);
-
-          // Calculate face normals
-          glm::vec3 normal1, normal2;
-          if (this->m_cmap_data_weak->isQuadRotatedAt(base_index)) {
-              normal1 = calculateFaceNormal(vpositionLL, vpositionUL, vpositionLR);
-              normal2 = calculateFaceNormal(vpositionLR, vpositionUL, vpositionUR);
-          } else {
-              normal1 = calculateFaceNormal(vpositionLL, vpositionUR, vpositionLR);
-              normal2 = calculateFaceNormal(vpositionLL, vpositionUL, vpositionUR);
-          }
-
-        // Accumulate face normals for each vertex with boundary checks
-        if (y < height && x < width) {
-            vertexNormals[y * width + x] += normal1;
-            normalCounts[y * width + x]++;
-        }
-        if (y < height && x + 1 < width) {
-            vertexNormals[y * width + (x + 1)] += normal1;
-            normalCounts[y * width + (x + 1)]++;
-        }
-        if (y + 1 < height && x < width) {
-            vertexNormals[(y + 1) * width + x] += normal1;
-            normalCounts[(y + 1) * width + x]++;
-        }
-        if (y + 1 < height && x + 1 < width) {
-            vertexNormals[(y + 1) * width + (x + 1)] += normal2;
-            normalCounts[(y + 1) * width + (x + 1)]++;
-        }
-      }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      vertexNormals[(y * width) + x] = this->m_cmap_data_weak->getVertexNormalAt(x, y);
+    }
   }
+}
 
-  // Normalize accumulated normals
-  for (int i = 0; i < vertexNormals.size(); ++i) {
-      vertexNormals[i] = glm::normalize(vertexNormals[i]);
+// From http://www.learnopengles.com/android-lesson-eight-an-introduction-to-index-buffer-objects-ibos/
+// using http://stackoverflow.com/questions/10114577/a-method-for-indexing-triangles-from-a-loaded-heightmap
+void TerrainRenderer::loadIntoHardwareMemory()
+{
+  int width = this->m_cmap_data_weak->getWidth(), height = this->m_cmap_data_weak->getHeight();
+
+  // build water base objects
+  this->m_waters.clear();
+  for (int w = 0; w < this->m_crsc_data_weak->getWaterCount(); w++)
+  {
+    const CEWaterEntity& we = this->m_crsc_data_weak->getWater(w);
+    this->addWaterObject(we);
+    
+    std::cout << "Water " << w << ": unscaled=" << we.water_level << ", scaled=" << this->m_waters.back().m_height 
+              << ", scale=" << this->m_cmap_data_weak->getHeightmapScale() << std::endl;
+  }
+  
+  // Generate water geometry AFTER water objects are created
+  if (!this->restoreWaterGeometry()) {
+    this->buildWaterGeometry();
+    this->storeWaterGeometry();
+  }
+  
+  bool ground_cached = m_map_cache && m_map_cache->isLoaded() && m_cmap_data_weak->restoreGroundLayers(*m_map_cache);
+  
+  // Pulled terrain gets its normals from the height texture
+  std::vector<glm::vec3> vertexNormals;
+  if (!m_vertex_pulling && !(m_map_cache && m_map_cache->readVector(CEMapCache::Section::TERRAIN_NORMALS, vertexNormals) && vertexNormals.size() == (size_t)(width * height))) {
+    this->buildTerrainNormals(vertexNormals);
+    if (m_map_cache) {
+      m_map_cache->writeVector(CEMapCache::Section::TERRAIN_NORMALS, vertexNormals);
+    }
   }
 
-  std::cout << "Building terrain mesh" << std::endl;
-  for (int y=0; y < width; y++) {
-    for (int x=0; x < height; x++) {
-      unsigned int base_index = (y * width) + x;
-      
-      int texID = this->m_cmap_data_weak->getTextureIDAt(base_index);
-      int texID2 = this->m_cmap_data_weak->getSecondaryTextureIDAt(base_index);
-      uint16_t flags = this->m_cmap_data_weak->getFlagsAt(x, y);
+  // Indices are grouped per chunk so each chunk can be drawn (or culled) as one contiguous range
+  m_chunks_per_row = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  m_chunks_per_column = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  std::array<std::vector<std::vector<unsigned int>>, LOD_LEVELS> chunk_indices;
+  for (auto& lod_indices : chunk_indices) {
+    lod_indices.resize(m_chunks_per_row * m_chunks_per_column);
+  }
+  m_chunks.assign(m_chunks_per_row * m_chunks_per_column, _TerrainChunk());
+  for (auto& chunk : m_chunks) {
+    chunk.m_min = glm::vec3(std::numeric_limits<float>::max());
+    chunk.m_max = glm::vec3(std::numeric_limits<float>::lowest());
+  }
 
-      // Water generation moved to after water objects are created
+  std::vector<glm::vec3> chunk_bounds;
+  bool bounds_cached = m_map_cache && m_map_cache->readVector(CEMapCache::Section::TERRAIN_CHUNK_BOUNDS, chunk_bounds) && chunk_bounds.size() == m_chunks.size() * 2;
+  if (bounds_cached) {
+    for (size_t c = 0; c < m_chunks.size(); c++) {
+      m_chunks[c].m_min = chunk_bounds[c * 2];
+      m_chunks[c].m_max = chunk_bounds[(c * 2) + 1];
+    }
+  }
 
-      glm::vec3 vpositionLL = this->calcWorldVertex(x, y, false, 0.f);
-      glm::vec3 vpositionLR = this->calcWorldVertex(fmin(x + 1, height - 1), y, false, 0.f);
-      glm::vec3 vpositionUL = this->calcWorldVertex(x, fmin(y + 1, width - 1), false, 0.f);
-      glm::vec3 vpositionUR = this->calcWorldVertex(fmin(x + 1, height - 1), fmin(y + 1, width - 1), false, 0.f);
-      
-      bool quad_reverse = this->m_cmap_data_weak->isQuadRotatedAt(base_index);
-      int texture_direction = (flags & 3);
+  // Pulled terrain only needs chunk bounds from the per-tile pass; streamed chunks get theirs as pages arrive
+  if (!m_vertex_pulling || (!bounds_cached && !m_streamed)) {
+    std::cout << "Building terrain mesh" << std::endl;
+    for (int y=0; y < width; y++) {
+      for (int x=0; x < height; x++) {
+        unsigned int base_index = (y * width) + x;
+        int chunk_index = ((y / CHUNK_SIZE) * m_chunks_per_row) + (x / CHUNK_SIZE);
+        _TerrainChunk& chunk = m_chunks[chunk_index];
+        std::vector<unsigned int>& tile_indices = chunk_indices[0][chunk_index];
       
-      std::array<glm::vec2, 4> vertex_uv_mapping = this->calcUVMapForQuad(x, y, quad_reverse, texture_direction);
-      
-      glm::vec3 normalLL = vertexNormals[y * width + x];
-      glm::vec3 normalLR = (x + 1 < width) ? vertexNormals[y * width + (x + 1)] : normalLL;
-      glm::vec3 normalUL = (y + 1 < height) ? vertexNormals[(y + 1) * width + x] : normalLL;
-      glm::vec3 normalUR = (y + 1 < height && x + 1 < width) ? vertexNormals[(y + 1) * width + (x + 1)] : normalLL;
-
-      CETerrainVertex v1(vpositionLL, this->getScaledAtlasUVQuad(vertex_uv_mapping[0], texID, texID2), normalLL);
-      CETerrainVertex v2(vpositionLR, this->getScaledAtlasUVQuad(vertex_uv_mapping[1], texID, texID2), normalLR);
-      CETerrainVertex v3(vpositionUL, this->getScaledAtlasUVQuad(vertex_uv_mapping[2], texID, texID2), normalUL);
-      CETerrainVertex v4(vpositionUR, this->getScaledAtlasUVQuad(vertex_uv_mapping[3], texID, texID2), normalUR);
-      
-      m_vertices.push_back(v1);
-      m_vertices.push_back(v2);
-      m_vertices.push_back(v3);
-      m_vertices.push_back(v4);
-
-      unsigned int lower_left = (y * width * 4) + (x*4);
-      unsigned int lower_right = lower_left + 1;
-      unsigned int upper_left = lower_right + 1;
-      unsigned int upper_right = upper_left + 1;
+        // Water generation moved to after water objects are created
 
-      // If quad reverse, anchor upper right (bottom left, upper right, lower right). Otherwise, anchor upper left (bottom left, upper left, lower right)
-      // Clockwise order.
+        glm::vec3 vpositionLL = this->calcWorldVertex(x, y, false, 0.f);
+        glm::vec3 vpositionLR = this->calcWorldVertex(fmin(x + 1, height - 1), y, false, 0.f);
+        glm::vec3 vpositionUL = this->calcWorldVertex(x, fmin(y + 1, width - 1), false, 0.f);
+        glm::vec3 vpositionUR = this->calcWorldVertex(fmin(x + 1, height - 1), fmin(y + 1, width - 1), false, 0.f);
       
-      // Memoize the height
-      float centerHeight;
-      glm::vec3 avgNormal;
+        for (const glm::vec3& corner : { vpositionLL, vpositionLR, vpositionUL, vpositionUR }) {
+          chunk.m_min = glm::min(chunk.m_min, corner);
+          chunk.m_max = glm::max(chunk.m_max, corner);
+        }
       
-      if (quad_reverse) {
-        centerHeight = (vpositionLL.y + vpositionUL.y + vpositionUR.y + vpositionLR.y) / 4.0f;
-
-        m_indices.push_back(lower_left); // Face 1
-        m_indices.push_back(upper_left);
-        m_indices.push_back(lower_right);
-
-        m_indices.push_back(lower_right); // Face 2
-        m_indices.push_back(upper_left);
-        m_indices.push_back(upper_right);
+        // With vertex pulling terrain.vs derives all of the below from the tile texture
+        if (!m_vertex_pulling) {
+          bool quad_reverse = this->m_cmap_data_weak->isQuadRotatedAt(base_index);
         
-        avgNormal = glm::normalize(normalLL + normalUL + normalUR + normalLR);
-      } else {
-        centerHeight = (vpositionLL.y + vpositionLR.y + vpositionUL.y + vpositionUR.y) / 4.0f;
-
-        m_indices.push_back(lower_left); // Face 1
-        m_indices.push_back(upper_right);
-        m_indices.push_back(lower_right);
-
-        m_indices.push_back(lower_left); // Face 2
-        m_indices.push_back(upper_left);
-        m_indices.push_back(upper_right);
+          glm::vec3 normalLL = vertexNormals[y * width + x];
+          glm::vec3 normalLR = (x + 1 < width) ? vertexNormals[y * width + (x + 1)] : normalLL;
+          glm::vec3 normalUL = (y + 1 < height) ? vertexNormals[(y + 1) * width + x] : normalLL;
+          glm::vec3 normalUR = (y + 1 < height && x + 1 < width) ? vertexNormals[(y + 1) * width + (x + 1)] : normalLL;
+        
+          int texID = this->m_cmap_data_weak->getTextureIDAt(base_index);
+          int texID2 = this->m_cmap_data_weak->getSecondaryTextureIDAt(base_index);
+          uint16_t flags = this->m_cmap_data_weak->getFlagsAt(x, y);
+          int texture_direction = (flags & 3);
+        
+          std::array<glm::vec2, 4> vertex_uv_mapping = this->calcUVMapForQuad(x, y, quad_reverse, texture_direction);
+        
+          CETerrainVertex v1(vpositionLL, this->getScaledAtlasUVQuad(vertex_uv_mapping[0], texID, texID2), normalLL);
+          CETerrainVertex v2(vpositionLR, this->getScaledAtlasUVQuad(vertex_uv_mapping[1], texID, texID2), normalLR);
+          CETerrainVertex v3(vpositionUL, this->getScaledAtlasUVQuad(vertex_uv_mapping[2], texID, texID2), normalUL);
+          CETerrainVertex v4(vpositionUR, this->getScaledAtlasUVQuad(vertex_uv_mapping[3], texID, texID2), normalUR);
         
-        avgNormal = glm::normalize(normalLL + normalLR + normalUL + normalUR);
+          m_vertices.push_back(v1);
+          m_vertices.push_back(v2);
+          m_vertices.push_back(v3);
+          m_vertices.push_back(v4);
+        
+          unsigned int lower_left = (y * width * 4) + (x*4);
+          unsigned int lower_right = lower_left + 1;
+          unsigned int upper_left = lower_right + 1;
+          unsigned int upper_right = upper_left + 1;
+        
+          // If quad reverse, anchor upper right (bottom left, upper right, lower right). Otherwise, anchor upper left (bottom left, upper left, lower right)
+          // Clockwise order.
+          if (quad_reverse) {
+            tile_indices.push_back(lower_left); // Face 1
+            tile_indices.push_back(upper_left);
+            tile_indices.push_back(lower_right);
+          
+            tile_indices.push_back(lower_right); // Face 2
+            tile_indices.push_back(upper_left);
+            tile_indices.push_back(upper_right);
+          } else {
+            tile_indices.push_back(lower_left); // Face 1
+            tile_indices.push_back(upper_right);
+            tile_indices.push_back(lower_right);
+          
+            tile_indices.push_back(lower_left); // Face 2
+            tile_indices.push_back(upper_left);
+            tile_indices.push_back(upper_right);
+          }
+        }
       }
-      
-      float slopeAngle = glm::degrees(atan2(glm::length(glm::vec2(avgNormal.x, avgNormal.z)), avgNormal.y));
-
-      m_cmap_data_weak->setGroundLevelAt(x, y, centerHeight, slopeAngle);
     }
   }
   
-  std::cout << "Generating AI walkability map from terrain data" << std::endl;
-  for (int y=0; y < width; y++) {
-    for (int x=0; x < height; x++) {
-      bool walkable = true;
-      int xy = (y * width) + x;
-      if (m_cmap_data_weak->hasWaterAt(x, y))
-      {
-        walkable = false;
-      } else if (m_cmap_data_weak->hasDangerTileAt(m_crsc_data_weak, glm::vec2(x, y))) {
-        walkable = false;
-      } else if (m_cmap_data_weak->getGroundAngleAt(x, y) > 35.f) {
-        walkable = false;
+  if (!bounds_cached && m_map_cache) {
+    chunk_bounds.clear();
+    for (const auto& chunk : m_chunks) {
+      chunk_bounds.push_back(chunk.m_min);
+      chunk_bounds.push_back(chunk.m_max);
+    }
+    m_map_cache->writeVector(CEMapCache::Section::TERRAIN_CHUNK_BOUNDS, chunk_bounds);
+  }
+  
+  // Ground levels and walkability are otherwise derived lazily by C2MapFile as the map is used
+  if (!ground_cached && m_map_cache) {
+    m_cmap_data_weak->storeGroundLayers(*m_map_cache);
+  }
+  
+  if (m_vertex_pulling) {
+    this->buildPulledTerrainRanges();
+    this->createTerrainHeightTexture();
+    this->createTileTexture();
+    if (m_lod_enabled) {
+      this->createLODTextures();
+    }
+
+    if (m_streamed) {
+      for (auto& chunk : m_chunks) {
+        chunk.m_resident = false;
       }
-//      } else {
-//        auto objectIdx = m_cmap_data_weak->getObjectAt(xy);
-//        if (objectIdx < 254) {
-//          auto obj = m_crsc_data_weak->getWorldModel(objectIdx);
-//          if (obj->getObjectInfo()->Radius > 32.f) {
-//            walkable = false;
-//          }
-//        }
-//      }
-      
-      if (!walkable) {
-        m_cmap_data_weak->setWalkableFlagsAt(glm::vec2(x, y), 0x1);
-      } else {
-        m_cmap_data_weak->setWalkableFlagsAt(glm::vec2(x, y), 0x0);
+      for (int page = 0; page < m_cmap_data_weak->getPagesX() * m_cmap_data_weak->getPagesY(); page++) {
+        if (!m_cmap_data_weak->isPageResident(page)) continue;
+        this->uploadPageTiles(page);
+        m_page_uploads[page]->onReady([this, page]() { this->updatePageChunks(page); });
       }
     }
+    
+    // Core profile still needs a VAO bound to draw, even with no attributes
+    glGenVertexArrays(1, &this->m_vertex_array_object);
+    
+    this->cullTerrainChunks();
+    
+    this->loadWaterIntoMemory();
+    this->loadFogVolumesIntoMemory();
+    return;
   }
   
+  if (m_lod_enabled) {
+    std::cout << "Building terrain LOD meshes" << std::endl;
+    for (int lod = 1; lod < LOD_LEVELS; lod++) {
+      this->buildTerrainLOD(lod, vertexNormals, chunk_indices[lod]);
+    }
+  }
+
+  // Each LOD is laid out chunk by chunk so neighbouring chunks at the same LOD merge into one draw range
+  for (int lod = 0; lod < LOD_LEVELS; lod++) {
+    for (size_t c = 0; c < m_chunks.size(); c++) {
+      m_chunks[c].m_index_offset[lod] = m_indices.size();
+      m_chunks[c].m_index_count[lod] = (GLsizei)chunk_indices[lod][c].size();
+      m_indices.insert(m_indices.end(), chunk_indices[lod][c].begin(), chunk_indices[lod][c].end());
+    }
+  }
+  std::cout << "Terrain split into " << m_chunks.size() << " chunks of " << CHUNK_SIZE << "x" << CHUNK_SIZE << " tiles" << std::endl;
+
   m_num_indices = (int)m_indices.size();
   
   // generate buffers and upload
@@ -1073,10 +1298,326 @@ void TerrainRenderer::loadIntoHardwareMemory()
   
   glBindVertexArray(0);
 
+  if (m_lod_enabled) {
+    this->createTerrainHeightTexture();
+    this->createLODTextures();
+  }
+
+  // No frustum yet, so everything starts visible
+  this->cullTerrainChunks();
+
   this->loadWaterIntoMemory();
   this->loadFogVolumesIntoMemory();
 }
 
+/*
+ * Build a decimated copy of the terrain where each quad spans (1 << lod) tiles and takes the
+ * texture of its lower-left tile. Vertices are laid out row-major over the whole map so the
+ * shader can recover the grid position from gl_VertexID for seam stitching.
+ */
+void TerrainRenderer::buildTerrainLOD(int lod, const std::vector<glm::vec3>& vertex_normals, std::vector<std::vector<unsigned int>>& chunk_indices)
+{
+  int width = this->m_cmap_data_weak->getWidth(), height = this->m_cmap_data_weak->getHeight();
+  int step = 1 << lod;
+  int cells_per_row = (width + step - 1) / step;
+  int cells_per_column = (height + step - 1) / step;
+
+  m_lod_base_vertex[lod] = (GLint)m_vertices.size();
+
+  for (int cy = 0; cy < cells_per_column; cy++) {
+    for (int cx = 0; cx < cells_per_row; cx++) {
+      int x = cx * step;
+      int y = cy * step;
+      int x1 = std::min(x + step, width - 1);
+      int y1 = std::min(y + step, height - 1);
+      unsigned int base_index = (y * width) + x;
+
+      int texID = this->m_cmap_data_weak->getTextureIDAt(base_index);
+      int texID2 = this->m_cmap_data_weak->getSecondaryTextureIDAt(base_index);
+      uint16_t flags = this->m_cmap_data_weak->getFlagsAt(x, y);
+      bool quad_reverse = this->m_cmap_data_weak->isQuadRotatedAt(base_index);
+
+      std::array<glm::vec2, 4> vertex_uv_mapping = this->calcUVMapForQuad(x, y, quad_reverse, (flags & 3));
+
+      unsigned int lower_left = (unsigned int)m_vertices.size();
+      unsigned int lower_right = lower_left + 1;
+      unsigned int upper_left = lower_right + 1;
+      unsigned int upper_right = upper_left + 1;
+
+      m_vertices.push_back(CETerrainVertex(this->calcWorldVertex(x, y, false, 0.f), this->getScaledAtlasUVQuad(vertex_uv_mapping[0], texID, texID2), vertex_normals[(y * width) + x]));
+      m_vertices.push_back(CETerrainVertex(this->calcWorldVertex(x1, y, false, 0.f), this->getScaledAtlasUVQuad(vertex_uv_mapping[1], texID, texID2), vertex_normals[(y * width) + x1]));
+      m_vertices.push_back(CETerrainVertex(this->calcWorldVertex(x, y1, false, 0.f), this->getScaledAtlasUVQuad(vertex_uv_mapping[2], texID, texID2), vertex_normals[(y1 * width) + x]));
+      m_vertices.push_back(CETerrainVertex(this->calcWorldVertex(x1, y1, false, 0.f), this->getScaledAtlasUVQuad(vertex_uv_mapping[3], texID, texID2), vertex_normals[(y1 * width) + x1]));
+
+      std::vector<unsigned int>& cell_indices = chunk_indices[((y / CHUNK_SIZE) * m_chunks_per_row) + (x / CHUNK_SIZE)];
+
+      // Same winding as the full detail mesh
+      if (quad_reverse) {
+        cell_indices.insert(cell_indices.end(), { lower_left, upper_left, lower_right, lower_right, upper_left, upper_right });
+      } else {
+        cell_indices.insert(cell_indices.end(), { lower_left, upper_right, lower_right, lower_left, upper_left, upper_right });
+      }
+    }
+  }
+}
+
+/*
+ * Chunk draw ranges for vertex pulling. Each LOD is a run of chunks in row-major order and each chunk
+ * covers (CHUNK_SIZE >> lod)^2 cells of 6 vertices, so terrain.vs can decode any gl_VertexID back
+ * to its cell and corner. Cells past the map edge in partial chunks are collapsed by the shader.
+ */
+void TerrainRenderer::buildPulledTerrainRanges()
+{
+  int lod_count = m_lod_enabled ? LOD_LEVELS : 1;
+  size_t first = 0;
+
+  for (int lod = 0; lod < lod_count; lod++) {
+    int cells_per_side = CHUNK_SIZE >> lod;
+    GLsizei vertices_per_chunk = cells_per_side * cells_per_side * 6;
+
+    m_lod_base_vertex[lod] = (GLint)first;
+    for (auto& chunk : m_chunks) {
+      chunk.m_index_offset[lod] = first;
+      chunk.m_index_count[lod] = vertices_per_chunk;
+      first += vertices_per_chunk;
+    }
+  }
+
+  std::cout << "Terrain split into " << m_chunks.size() << " chunks of " << CHUNK_SIZE << "x" << CHUNK_SIZE << " tiles (vertex pulled, " << first << " vertices)" << std::endl;
+}
+
+/*
+ * Per-tile data for vertex pulling: primary and secondary texture, texture rotation and quad split direction
+ */
+void TerrainRenderer::createTileTexture()
+{
+  int width = m_cmap_data_weak->getWidth();
+  int height = m_cmap_data_weak->getHeight();
+
+  // Streamed pages are uploaded by uploadPageTiles()
+  std::vector<uint8_t> tiles(m_tile_window.x * m_tile_window.y * 4, 0);
+  for (int y = 0; y < height && !m_streamed; y++) {
+    for (int x = 0; x < width; x++) {
+      int xy = (y * width) + x;
+      int texel = ((y * m_tile_window.x) + x) * 4;
+      tiles[texel + 0] = (uint8_t)m_cmap_data_weak->getTextureIDAt(xy);
+      tiles[texel + 1] = (uint8_t)m_cmap_data_weak->getSecondaryTextureIDAt(xy);
+      tiles[texel + 2] = (uint8_t)(m_cmap_data_weak->getFlagsAt(xy) & 3);
+      tiles[texel + 3] = m_cmap_data_weak->isQuadRotatedAt(xy) ? 1 : 0;
+    }
+  }
+
+  glGenTextures(1, &m_tile_texture);
+  glBindTexture(GL_TEXTURE_2D, m_tile_texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8UI, m_tile_window.x, m_tile_window.y, 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, tiles.data());
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/*
+ * Exact vertex heights for terrain.vs, used for LOD seam stitching and vertex pulling
+ */
+void TerrainRenderer::createTerrainHeightTexture()
+{
+  int width = m_cmap_data_weak->getWidth();
+  int height = m_cmap_data_weak->getHeight();
+
+  std::vector<float> heights(m_tile_window.x * m_tile_window.y, 0.f);
+  for (int y = 0; y < height && !m_streamed; y++) {
+    for (int x = 0; x < width; x++) {
+      heights[(y * m_tile_window.x) + x] = m_cmap_data_weak->getHeightAt((y * width) + x);
+    }
+  }
+
+  glGenTextures(1, &m_terrain_height_texture);
+  glBindTexture(GL_TEXTURE_2D, m_terrain_height_texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_tile_window.x, m_tile_window.y, 0, GL_RED, GL_FLOAT, heights.data());
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/*
+ * Copies a page's heights and tile data into its slot of the texture window, or clears the slot
+ * once the page is gone. Pages never straddle the wrap since both sizes are powers of two
+ */
+void TerrainRenderer::uploadPageTiles(int page)
+{
+  int width = m_cmap_data_weak->getWidth();
+  int page_size = m_cmap_data_weak->getPageSize();
+  int x0 = (page % m_cmap_data_weak->getPagesX()) * page_size, y0 = (page / m_cmap_data_weak->getPagesX()) * page_size;
+
+  // Owned by the queue until it gets to them
+  auto heights = std::make_shared<std::vector<float>>(page_size * page_size, 0.f);
+  auto tiles = std::make_shared<std::vector<uint8_t>>(page_size * page_size * 4, 0);
+  if (m_cmap_data_weak->isPageResident(page)) {
+    for (int y = 0; y < page_size; y++) {
+      for (int x = 0; x < page_size; x++) {
+        int xy = ((y0 + y) * width) + x0 + x;
+        int texel = (y * page_size) + x;
+        (*heights)[texel] = m_cmap_data_weak->getHeightAt(xy);
+        (*tiles)[(texel * 4) + 0] = (uint8_t)m_cmap_data_weak->getTextureIDAt(xy);
+        (*tiles)[(texel * 4) + 1] = (uint8_t)m_cmap_data_weak->getSecondaryTextureIDAt(xy);
+        (*tiles)[(texel * 4) + 2] = (uint8_t)(m_cmap_data_weak->getFlagsAt(xy) & 3);
+        (*tiles)[(texel * 4) + 3] = m_cmap_data_weak->isQuadRotatedAt(xy) ? 1 : 0;
+      }
+    }
+  }
+
+  int window_x = x0 & (m_tile_window.x - 1), window_y = y0 & (m_tile_window.y - 1);
+
+  // Whatever is still queued for this page is stale now
+  if (m_page_uploads.size() <= (size_t)page) {
+    m_page_uploads.resize(m_cmap_data_weak->getPagesX() * m_cmap_data_weak->getPagesY());
+  }
+  std::shared_ptr<CEUploadQueue::Ticket>& ticket = m_page_uploads[page];
+  if (ticket) {
+    ticket->cancel();
+  }
+
+  CEUploadQueue& queue = CEUploadQueue::getInstance();
+  ticket = queue.createTicket();
+  queue.uploadTextureRegion(ticket, m_terrain_height_texture, window_x, window_y, page_size, page_size, GL_RED, GL_FLOAT,
+                            heights->data(), heights->size() * sizeof(float), heights);
+  queue.uploadTextureRegion(ticket, m_tile_texture, window_x, window_y, page_size, page_size, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE,
+                            tiles->data(), tiles->size(), tiles);
+}
+
+/*
+ * Residency and bounds for the page's chunks. The last row and column of chunks before the page
+ * reach one vertex into it, so their bounds are refreshed too
+ */
+void TerrainRenderer::updatePageChunks(int page)
+{
+  int chunks_per_page = m_cmap_data_weak->getPageSize() / CHUNK_SIZE;
+  int cx0 = (page % m_cmap_data_weak->getPagesX()) * chunks_per_page;
+  int cy0 = (page / m_cmap_data_weak->getPagesX()) * chunks_per_page;
+  bool resident = m_cmap_data_weak->isPageResident(page);
+
+  for (int cy = std::max(cy0 - 1, 0); cy < std::min(cy0 + chunks_per_page, m_chunks_per_column); cy++) {
+    for (int cx = std::max(cx0 - 1, 0); cx < std::min(cx0 + chunks_per_page, m_chunks_per_row); cx++) {
+      _TerrainChunk& chunk = m_chunks[(cy * m_chunks_per_row) + cx];
+      if (cx >= cx0 && cy >= cy0) {
+        chunk.m_resident = resident;
+      }
+      if (chunk.m_resident) {
+        this->updateChunkBounds(cx, cy);
+      }
+    }
+  }
+}
+
+void TerrainRenderer::updateChunkBounds(int chunk_x, int chunk_y)
+{
+  int width = m_cmap_data_weak->getWidth(), height = m_cmap_data_weak->getHeight();
+  _TerrainChunk& chunk = m_chunks[(chunk_y * m_chunks_per_row) + chunk_x];
+
+  chunk.m_min = glm::vec3(std::numeric_limits<float>::max());
+  chunk.m_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+  // Vertices of the chunk's tiles, including the far corners shared with the next chunks
+  int x1 = std::min((chunk_x + 1) * CHUNK_SIZE, width - 1), y1 = std::min((chunk_y + 1) * CHUNK_SIZE, height - 1);
+  for (int y = chunk_y * CHUNK_SIZE; y <= y1; y++) {
+    for (int x = chunk_x * CHUNK_SIZE; x <= x1; x++) {
+      glm::vec3 vertex = this->calcWorldVertex(x, y, false, 0.f);
+      chunk.m_min = glm::min(chunk.m_min, vertex);
+      chunk.m_max = glm::max(chunk.m_max, vertex);
+    }
+  }
+}
+
+void TerrainRenderer::onPageLoaded(int page)
+{
+  // The page's chunks stay hidden until the queue has uploaded its heights and tiles
+  this->uploadPageTiles(page);
+  m_page_uploads[page]->onReady([this, page]() { this->updatePageChunks(page); });
+
+  int page_size = m_cmap_data_weak->getPageSize();
+  int x0 = (page % m_cmap_data_weak->getPagesX()) * page_size, y0 = (page / m_cmap_data_weak->getPagesX()) * page_size;
+  std::vector<CEMapCache::ObjectPlacement> placements;
+  this->collectObjectPlacements(x0, y0, x0 + page_size, y0 + page_size, placements);
+  this->addObjectInstances(placements, page);
+
+  // Cull again even if the camera has not moved
+  m_last_object_cull_vp = glm::mat4(0.f);
+}
+
+void TerrainRenderer::onPageEvicted(int page)
+{
+  this->uploadPageTiles(page);
+  this->updatePageChunks(page);
+
+  for (int m = 0; m < this->m_crsc_data_weak->getWorldModelCount(); m++) {
+    CEWorldModel* model = this->m_crsc_data_weak->getWorldModel(m);
+    if (model) {
+      model->removeGroup(page);
+    }
+  }
+
+  m_last_object_cull_vp = glm::mat4(0.f);
+}
+
+/*
+ * The LOD chosen per chunk, read by terrain.vs to stitch chunk borders
+ */
+void TerrainRenderer::createLODTextures()
+{
+  m_chunk_lods.assign(m_chunks.size(), 0);
+
+  glGenTextures(1, &m_chunk_lod_texture);
+  glBindTexture(GL_TEXTURE_2D, m_chunk_lod_texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, m_chunks_per_row, m_chunks_per_column, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, m_chunk_lods.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/*
+ * Pick a LOD per chunk from the horizontal distance between the camera and the chunk bounds
+ */
+void TerrainRenderer::selectChunkLODs(const glm::vec3& camera_position)
+{
+  bool changed = false;
+  glm::vec2 camera_xz(camera_position.x, camera_position.z);
+
+  for (size_t c = 0; c < m_chunks.size(); c++) {
+    _TerrainChunk& chunk = m_chunks[c];
+    glm::vec2 closest = glm::clamp(camera_xz, glm::vec2(chunk.m_min.x, chunk.m_min.z), glm::vec2(chunk.m_max.x, chunk.m_max.z));
+    float distance = glm::length(camera_xz - closest);
+
+    int lod = 0;
+    float band = m_lod_distance;
+    while (lod < LOD_LEVELS - 1 && distance > band) {
+      lod++;
+      band *= 2.f;
+    }
+
+    chunk.m_lod = lod;
+    if (m_chunk_lods[c] != lod) {
+      m_chunk_lods[c] = (uint8_t)lod;
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    glBindTexture(GL_TEXTURE_2D, m_chunk_lod_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_chunks_per_row, m_chunks_per_column, GL_RED_INTEGER, GL_UNSIGNED_BYTE, m_chunk_lods.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+}
+
 // Calculate the real UV coords using the atlas
 glm::vec2 TerrainRenderer::calcAtlasUV(int texID, glm::vec2 uv)
 {
@@ -1099,24 +1640,114 @@ void TerrainRenderer::Render()
   this->m_shader->setInt("underwaterStateTexture", 1);
 
   this->m_shader->bindTexture("skyTexture", m_crsc_data_weak->getDaySky()->getTextureID(), 2);
+
+  if (m_lod_enabled || m_vertex_pulling) {
+    this->m_shader->bindTexture("terrainHeightTexture", m_terrain_height_texture, 4);
+  }
+  if (m_lod_enabled) {
+    this->m_shader->bindTexture("chunkLodTexture", m_chunk_lod_texture, 5);
+  }
+  if (m_vertex_pulling) {
+    this->m_shader->bindTexture("terrainTileTexture", m_tile_texture, 6);
+  }
+  glActiveTexture(GL_TEXTURE0);
   
   glBindVertexArray(this->m_vertex_array_object);
   
-  glDrawElementsBaseVertex(GL_TRIANGLES, m_num_indices, GL_UNSIGNED_INT, 0, 0);
+  if (m_visible_counts.empty()) {
+    // Nothing in view
+  } else if (m_vertex_pulling) {
+    glMultiDrawArrays(GL_TRIANGLES, m_visible_firsts.data(), m_visible_counts.data(), (GLsizei)m_visible_counts.size());
+  } else {
+    glMultiDrawElements(GL_TRIANGLES, m_visible_counts.data(), GL_UNSIGNED_INT, m_visible_offsets.data(), (GLsizei)m_visible_counts.size());
+  }
   
   glBindVertexArray(0);
 }
 
+/*
+ * Compact each world model's instance buffer down to the instances in view and inside the fog.
+ * Models are culled in parallel (no GL calls there); the uploads happen here on the render thread.
+ */
+void TerrainRenderer::cullObjectInstances(const glm::mat4& view_projection, const glm::vec3& camera_position)
+{
+  if (view_projection == m_last_object_cull_vp) return;
+  m_last_object_cull_vp = view_projection;
+
+  int model_count = this->m_crsc_data_weak->getWorldModelCount();
+  // Shaders reach full fog colour at the view distance
+  float max_distance = GetViewDistance();
+  float lod_distance = m_object_lod_enabled ? m_object_lod_distance : 0.f;
+
+  auto cull_models = [&](int first, int stride) {
+    for (int m = first; m < model_count; m += stride) {
+      CEWorldModel* model = this->m_crsc_data_weak->getWorldModel(m);
+      if (model) {
+        model->cullInstances(m_frustum, camera_position, lod_distance, m_object_lod_fade_band, max_distance);
+      }
+    }
+  };
+
+  // Strided so models with many instances (trees, grass) spread across workers
+  int stride = std::min((int)m_cull_jobs->getWorkerCount() + 1, model_count);
+  m_cull_jobs->parallelFor(stride, [&](size_t w) {
+    cull_models((int)w, stride);
+  });
+
+  for (int m = 0; m < model_count; m++) {
+    CEWorldModel* model = this->m_crsc_data_weak->getWorldModel(m);
+    if (model) {
+      model->updateNearInstances();
+      model->updateFarInstances();
+    }
+  }
+}
+
+/*
+ * Rebuild the list of index ranges to draw from the current frustum
+ */
+void TerrainRenderer::cullTerrainChunks()
+{
+  m_visible_counts.clear();
+  m_visible_offsets.clear();
+  m_visible_firsts.clear();
+  m_visible_chunk_count = 0;
+
+  size_t range_end = 0;
+  for (const auto& chunk : m_chunks) {
+    size_t offset = chunk.m_index_offset[chunk.m_lod];
+    GLsizei count = chunk.m_index_count[chunk.m_lod];
+
+    if (count == 0 || !chunk.m_resident || !m_frustum.intersectsAABB(chunk.m_min, chunk.m_max)) continue;
+
+    m_visible_chunk_count++;
+
+    // Neighbouring chunks in a row are adjacent in the index buffer; extend the previous range
+    if (!m_visible_counts.empty() && range_end == offset) {
+      m_visible_counts.back() += count;
+    } else {
+      m_visible_counts.push_back(count);
+      if (m_vertex_pulling) {
+        m_visible_firsts.push_back((GLint)offset);
+      } else {
+        m_visible_offsets.push_back((const void*)(offset * sizeof(unsigned int)));
+      }
+    }
+
+    range_end = offset + count;
+  }
+}
+
 void TerrainRenderer::RenderWater()
 {
   this->m_water_shader->use();
-  this->m_water_shader->setFloat("time", (float)glfwGetTime()); // Fix: Update time for water animation
   this->m_water_shader->bindTexture("skyTexture", m_crsc_data_weak->getDaySky()->getTextureID(), 2);
   this->m_water_shader->bindTexture("heightmapTexture", heightmapTexture, 3);
 
   for (int w = 0; w < this->m_waters.size(); w++) {
-    // Skip empty water planes (original logic)
+    // Skip empty water planes (original logic), and ones still in the upload queue
     if (this->m_waters[w].m_vertices.size() < 30) continue;
+    if (!this->m_waters[w].m_upload || !this->m_waters[w].m_upload->isReady()) continue;
     
     // Set the correct water level for this specific water plane
     float waterHeight = this->m_waters[w].m_height;
@@ -1174,7 +1805,6 @@ void TerrainRenderer::RenderFogVolumes()
   this->m_fog_shader->setFloat("terrainWidth", this->m_cmap_data_weak->getWidth());
   this->m_fog_shader->setFloat("terrainHeight", this->m_cmap_data_weak->getHeight());
   this->m_fog_shader->setFloat("tileWidth", this->m_cmap_data_weak->getTileLength());
-  this->m_fog_shader->setFloat("view_distance", (m_cmap_data_weak->getTileLength() * (m_cmap_data_weak->getWidth() / 8.f)));
   
   // Get sky color for fog blending
   glm::vec4 skyColor = m_crsc_data_weak->getFadeColor();
@@ -1187,8 +1817,8 @@ void TerrainRenderer::RenderFogVolumes()
   for (size_t fv_idx = 0; fv_idx < m_fog_volumes.size(); fv_idx++) {
     auto& fog_volume = m_fog_volumes[fv_idx];
     
-    // Skip empty fog volumes
-    if (fog_volume.m_vertices.empty()) {
+    // Skip empty fog volumes, and ones still in the upload queue
+    if (fog_volume.m_vertices.empty() || !fog_volume.m_upload || !fog_volume.m_upload->isReady()) {
       continue;
     }
     
@@ -1218,40 +1848,6 @@ void TerrainRenderer::RenderFogVolumes()
     this->m_fog_shader->setFloat("fogTransparency", fogTransparency);
     this->m_fog_shader->setVec3("fogColor", glm::vec3(r, g, b));
 
-    // Create and bind VAO/VBO for this fog volume if not already done
-    if (fog_volume.m_vao == 0) {
-      // Generate OpenGL objects
-      glGenVertexArrays(1, &fog_volume.m_vao);
-      glGenBuffers(1, &fog_volume.m_vab);
-      glGenBuffers(1, &fog_volume.m_iab);
-      
-      // Bind and upload vertex data
-      glBindVertexArray(fog_volume.m_vao);
-      
-      glBindBuffer(GL_ARRAY_BUFFER, fog_volume.m_vab);
-      glBufferData(GL_ARRAY_BUFFER, fog_volume.m_vertices.size() * sizeof(Vertex), fog_volume.m_vertices.data(), GL_STATIC_DRAW);
-      
-      // Set vertex attributes (same layout as water/terrain)
-      glEnableVertexAttribArray(0); // position
-      glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-      
-      glEnableVertexAttribArray(1); // texCoord
-      glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
-      
-      glEnableVertexAttribArray(2); // normal
-      glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(5 * sizeof(float)));
-      
-      glEnableVertexAttribArray(3); // alpha
-      glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(8 * sizeof(float)));
-      
-      glEnableVertexAttribArray(4); // flags
-      glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)(9 * sizeof(float)));
-      
-      // Upload index data
-      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, fog_volume.m_iab);
-      glBufferData(GL_ELEMENT_ARRAY_BUFFER, fog_volume.m_indices.size() * sizeof(unsigned int), fog_volume.m_indices.data(), GL_STATIC_DRAW);
-    }
-    
     // Bind texture (use first texture in atlas for noise)
     auto texture = this->m_crsc_data_weak->getTexture(fog_volume.m_texture_id);
     if (texture) {
@@ -1382,6 +1978,16 @@ void TerrainRenderer::loadFogVolumesIntoMemory()
   auto height = m_cmap_data_weak->getHeight();
   std::cout << "Scanning map for fog zones: " << width << "x" << height << " tiles" << std::endl;
   
+  std::vector<CEMapCache::FogZone> cachedZones;
+  if (m_map_cache && m_map_cache->readVector(CEMapCache::Section::FOG_ZONES, cachedZones)) {
+    for (const auto& zone : cachedZones) {
+      generateFogVolume(zone.fog_id, m_crsc_data_weak->getFog(zone.fog_id), zone.center, zone.size);
+    }
+    std::cout << "Generated " << m_fog_volumes.size() << " fog volumes from map cache" << std::endl;
+    this->uploadFogVolumes();
+    return;
+  }
+  
   // Find all fog zones by scanning the fog map at proper resolution
   // Fog map is at half resolution, so scan every 2nd tile to avoid duplicates
   std::map<int, std::vector<glm::vec2>> fogZones; // fog_id -> list of fog map cells (not individual tiles)
@@ -1433,6 +2039,11 @@ void TerrainRenderer::loadFogVolumesIntoMemory()
               << ") size (" << size.x << "," << size.y << ")" << std::endl;
     
     generateFogVolume(fogIndex, fogData, center, size);
+    cachedZones.push_back({ fogIndex, center, size });
+  }
+  
+  if (m_map_cache) {
+    m_map_cache->writeVector(CEMapCache::Section::FOG_ZONES, cachedZones);
   }
   
   std::cout << "Generated " << m_fog_volumes.size() << " fog volumes" << std::endl;
@@ -1454,6 +2065,52 @@ void TerrainRenderer::loadFogVolumesIntoMemory()
       std::cout << "  First vertex position: (" << pos.x << ", " << pos.y << ", " << pos.z << ")" << std::endl;
     }
   }
+
+  this->uploadFogVolumes();
+}
+
+/*
+ * VAOs now, vertex and index data through the upload queue. Runs once m_fog_volumes is complete,
+ * so the vectors the queue reads from no longer move
+ */
+void TerrainRenderer::uploadFogVolumes()
+{
+  CEUploadQueue& queue = CEUploadQueue::getInstance();
+
+  for (auto& fog_volume : m_fog_volumes) {
+    if (fog_volume.m_vertices.empty()) continue;
+
+    glGenVertexArrays(1, &fog_volume.m_vao);
+    glGenBuffers(1, &fog_volume.m_vab);
+    glGenBuffers(1, &fog_volume.m_iab);
+
+    fog_volume.m_upload = queue.createTicket();
+    queue.uploadBuffer(fog_volume.m_upload, fog_volume.m_vab, fog_volume.m_vertices.data(), fog_volume.m_vertices.size() * sizeof(Vertex), GL_STATIC_DRAW);
+    queue.uploadBuffer(fog_volume.m_upload, fog_volume.m_iab, fog_volume.m_indices.data(), fog_volume.m_indices.size() * sizeof(unsigned int), GL_STATIC_DRAW);
+
+    glBindVertexArray(fog_volume.m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, fog_volume.m_vab);
+
+    // Set vertex attributes (same layout as water/terrain)
+    glEnableVertexAttribArray(0); // position
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+
+    glEnableVertexAttribArray(1); // texCoord
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
+
+    glEnableVertexAttribArray(2); // normal
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(5 * sizeof(float)));
+
+    glEnableVertexAttribArray(3); // alpha
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(8 * sizeof(float)));
+
+    glEnableVertexAttribArray(4); // flags
+    glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)(9 * sizeof(float)));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, fog_volume.m_iab);
+  }
+
+  glBindVertexArray(0);
 }
 
 /*
@@ -12,22 +12,29 @@
 #include <map>
 #include <unordered_map>
 #include <memory>
+#include <array>
 
 #include "transform.h"
 #include "g_shared.h"
+#include "CEFrustum.h"
+#include "CEMapCache.h"
+#include "IWorldPageListener.h"
+#include "CEUploadQueue.h"
 
 class Vertex;
 class C2MapFile;
 class C2MapRscFile;
 class CEWorldModel;
+class CEJobSystem;
 class ShaderProgram;
 
 struct CETerrainVertex;
 struct Transform;
 struct Camera;
 class CEShadowManager;
+struct CEWaterEntity;
 
-class TerrainRenderer
+class TerrainRenderer : public IWorldPageListener
 {
 private:
   struct _Water {
@@ -43,6 +50,7 @@ private:
     std::vector < unsigned int > m_indices;
     int m_vertex_count = 0;
     int m_num_indices = 0;
+    std::shared_ptr<CEUploadQueue::Ticket> m_upload;
   };
 
   struct _FogVolume {
@@ -58,11 +66,73 @@ private:
     std::vector<unsigned int> m_indices;
     int m_vertex_count = 0;
     int m_num_indices = 0;
+    std::shared_ptr<CEUploadQueue::Ticket> m_upload;
+  };
+
+  constexpr static const int LOD_LEVELS = 4; // 1x, 2x, 4x and 8x decimation
+
+  // Square block of terrain tiles whose indices are contiguous in the index buffer (one range per LOD)
+  struct _TerrainChunk {
+    glm::vec3 m_min = glm::vec3(0.f);
+    glm::vec3 m_max = glm::vec3(0.f);
+    std::array<size_t, LOD_LEVELS> m_index_offset = {}; // first index (not bytes)
+    std::array<GLsizei, LOD_LEVELS> m_index_count = {};
+    int m_lod = 0;
+    bool m_resident = true; // streamed worlds: the chunk's page is loaded
   };
 
   std::vector <_Water> m_waters;
   std::vector <_FogVolume> m_fog_volumes;
 
+  std::vector <_TerrainChunk> m_chunks;
+  int m_chunks_per_row = 0;
+  int m_chunks_per_column = 0;
+  CEFrustum m_frustum;
+
+  // Geomipmapping. Coarse LOD vertices are appended after the full detail mesh; the terrain
+  // shader uses the per-chunk LOD texture to snap border vertices onto coarser neighbours
+  bool m_lod_enabled = false;
+  float m_lod_distance = 0.f; // chunks closer than this use LOD 0; each following band is twice as wide
+  std::array<GLint, LOD_LEVELS> m_lod_base_vertex = {};
+  std::vector<uint8_t> m_chunk_lods;
+  GLuint m_chunk_lod_texture = 0;
+  GLuint m_terrain_height_texture = 0;
+
+  // Vertex pulling. No vertex buffer: terrain.vs rebuilds each vertex from gl_VertexID, the height
+  // texture and the per-tile texture ids/flags. Every chunk is an implicit patch of 6 vertices per cell
+  bool m_vertex_pulling = true;
+  GLuint m_tile_texture = 0;
+
+  // Streamed worlds always pull vertices. The height and tile textures then hold a window of
+  // m_tile_window tiles around the player, addressed with wrap-around, and pages are uploaded into
+  // it as they arrive. For single-page maps the window is the whole map
+  bool m_streamed = false;
+  glm::ivec2 m_tile_window = glm::ivec2(0);
+  // Per page; a page's chunks turn resident once its texels have gone through the upload queue
+  std::vector<std::shared_ptr<CEUploadQueue::Ticket>> m_page_uploads;
+
+  // World objects past m_object_lod_distance draw as billboards, dithered across the fade band
+  bool m_object_lod_enabled = true;
+  float m_object_lod_distance = 0.f;
+  float m_object_lod_fade_band = 0.f;
+
+  // Per-frame uniforms not covered by the FrameConstants block
+  GLint m_terrain_model_uniform = -1;
+  GLint m_water_mvp_uniform = -1;
+  GLint m_water_model_uniform = -1;
+  GLint m_fog_mvp_uniform = -1;
+  GLint m_fog_model_uniform = -1;
+
+  // World object culling; skipped while the camera is still
+  glm::mat4 m_last_object_cull_vp = glm::mat4(0.f);
+  std::unique_ptr<CEJobSystem> m_cull_jobs;
+
+  // Visible chunk ranges for this frame, adjacent chunks merged into a single range
+  std::vector <GLsizei> m_visible_counts;
+  std::vector <const void*> m_visible_offsets;
+  std::vector <GLint> m_visible_firsts; // vertex pulling: first vertex of each range
+  int m_visible_chunk_count = 0;
+
   std::vector < CETerrainVertex > m_vertices;
   std::vector < unsigned int > m_indices;
   int m_num_indices;
@@ -70,8 +140,8 @@ private:
   
   GLuint m_vertex_array_object;
   
-  GLuint m_vertex_array_buffer;
-  GLuint m_indices_array_buffer;
+  GLuint m_vertex_array_buffer = 0;
+  GLuint m_indices_array_buffer = 0;
   
   GLuint underwaterStateTexture;
   GLuint heightmapTexture;
@@ -82,8 +152,15 @@ private:
   
   std::shared_ptr<C2MapFile> m_cmap_data_weak;
   std::shared_ptr<C2MapRscFile> m_crsc_data_weak;
+
+  // Optional; when loaded, derived terrain, water, fog and object data come from it instead of being rebuilt
+  std::shared_ptr<CEMapCache> m_map_cache;
+  // Pages kept loaded around the player's page on streamed worlds; sizes m_tile_window
+  int m_streaming_radius = 0;
   
   void preloadObjectMap();
+  void collectObjectPlacements(int x0, int y0, int x1, int y1, std::vector<CEMapCache::ObjectPlacement>& placements);
+  void addObjectInstances(const std::vector<CEMapCache::ObjectPlacement>& placements, int page);
   void loadShader();
   void loadIntoHardwareMemory();
   void exportAsRaw();
@@ -91,6 +168,10 @@ private:
   void loadWaterIntoMemory();
   void loadWaterAt(int x, int y);
   void loadWaterAtWithIndex(int x, int y, int forceWaterIndex);
+  void addWaterObject(const CEWaterEntity& water_entity);
+  void buildWaterGeometry();
+  bool restoreWaterGeometry();
+  void storeWaterGeometry();
 
   glm::vec2 calcAtlasUV(int texID, glm::vec2 uv);
   glm::vec2 scaleAtlasUV(glm::vec2 atlas_uv, int texture_id);
@@ -100,17 +181,37 @@ private:
 
   std::array<glm::vec2, 4> calcUVMapForQuad(int x, int y, bool quad_reversed, int rotation_code);
   void updateUnderwaterStateTexture(const std::vector<float>& data);
+  void loadConfig();
+  void buildTerrainLOD(int lod, const std::vector<glm::vec3>& vertex_normals, std::vector<std::vector<unsigned int>>& chunk_indices);
+  void buildTerrainNormals(std::vector<glm::vec3>& vertex_normals);
+  void createLODTextures();
+  void createTerrainHeightTexture();
+  void createTileTexture();
+  void uploadPageTiles(int page);
+  void updatePageChunks(int page);
+  void updateChunkBounds(int chunk_x, int chunk_y);
+  void buildPulledTerrainRanges();
+  void selectChunkLODs(const glm::vec3& camera_position);
+  void cullTerrainChunks();
+  void cullObjectInstances(const glm::mat4& view_projection, const glm::vec3& camera_position);
   void createHeightmapTexture();
   
   void loadFogVolumesIntoMemory();
+  void uploadFogVolumes();
   void generateFogVolume(int fog_id, const FogData& fog_data, glm::vec2 center, glm::vec2 size);
   void createFogVolumeGeometry(_FogVolume& fog_volume, int num_layers = 3);
 public:
   constexpr static const float TCMAX = 255.5f;
   constexpr static const float TCMIN = 0.5f;
   constexpr static const float _ZSCALE = (16.f*65534.f); // MAX_UNSIGNED_SHORT*16 - original engine used this for scaling heights
-  TerrainRenderer(std::shared_ptr<C2MapFile> cMapWeak, std::shared_ptr<C2MapRscFile> cRscWeak);
+  constexpr static const int CHUNK_SIZE = 32; // tiles per chunk side; matches CETerrainPartition
+  // streamingRadius: pages kept around the player by CEWorldStreamer, for streamed worlds
+  TerrainRenderer(std::shared_ptr<C2MapFile> cMapWeak, std::shared_ptr<C2MapRscFile> cRscWeak, std::shared_ptr<CEMapCache> mapCache = nullptr, int streamingRadius = 0);
   ~TerrainRenderer();
+
+  // IWorldPageListener
+  void onPageLoaded(int page) override;
+  void onPageEvicted(int page) override;
   
   void RenderObjects(Camera& camera);
   void RenderObjectsWithShadows(Camera& camera, CEShadowManager* shadowManager);
@@ -119,4 +220,10 @@ public:
   void Update(Transform& transform, Camera& camera);
   void RenderWater();
   void RenderFogVolumes();
+
+  glm::vec4 GetFogColor() const;
+  float GetViewDistance() const;
+
+  int GetChunkCount() const { return (int)m_chunks.size(); }
+  int GetVisibleChunkCount() const { return m_visible_chunk_count; }
 };
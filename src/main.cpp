@@ -53,6 +53,10 @@
 #include "CELocalPlayerController.hpp"
 #include "CERemotePlayerController.hpp"
 #include "CEAIGenericAmbientManager.hpp"
+#include "CEPathfindingService.h"
+#include "CEFlowFieldService.h"
+#include "CEMapCache.h"
+#include "CEWorldStreamer.h"
 
 #include "C2Sky.h"
 
@@ -66,6 +70,11 @@
 
 #include "CEAnimation.h"
 #include "CEShadowManager.h"
+#include "CEFrameConstants.h"
+#include "CECharacterBatch.h"
+#include "CEJobSystem.h"
+#include "CELoadPipeline.h"
+#include "CEUploadQueue.h"
 #include "CEUIRenderer.h"
 #include "CEBulletProjectileManager.h"
 #include "CEPhysicsWorld.h"
@@ -814,6 +823,13 @@ void CalculateFrameRate() {
 
 int main(int argc, const char * argv[])
 {
+  bool rebuildMapCache = false;
+  for (int a = 1; a < argc; a++) {
+    if (std::string(argv[a]) == "--rebuild-map-cache") {
+      rebuildMapCache = true;
+    }
+  }
+  
   std::ifstream f("config.json");
   if (!f.is_open()) {
     std::cerr << "Unable to open config.json!" << std::endl;
@@ -852,6 +868,61 @@ int main(int argc, const char * argv[])
     }
   }
   
+  // AI thinks on worker threads; the render thread joins in, so leave it a core
+  unsigned int aiWorkerThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  if (data.contains("ai") && data["ai"].is_object()) {
+    if (data["ai"].contains("workerThreads") && data["ai"]["workerThreads"].is_number_unsigned()) {
+      aiWorkerThreads = data["ai"]["workerThreads"];
+    }
+  }
+  
+  // Path searches run on their own threads so a long search never stalls a frame
+  unsigned int pathfindingThreads = 2;
+  if (data.contains("ai") && data["ai"].is_object()) {
+    if (data["ai"].contains("pathfindingThreads") && data["ai"]["pathfindingThreads"].is_number_unsigned()) {
+      pathfindingThreads = std::max(1u, data["ai"]["pathfindingThreads"].get<unsigned int>());
+    }
+  }
+  
+  // Startup loading threads; 0 loads everything on the main thread, one step after another
+  unsigned int loadingWorkerThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  if (data.contains("loading") && data["loading"].is_object()) {
+    if (data["loading"].contains("workerThreads") && data["loading"]["workerThreads"].is_number_unsigned()) {
+      loadingWorkerThreads = data["loading"]["workerThreads"];
+    }
+  }
+  
+  // Textures and buffers reach the GPU through a queue that spends at most this much per frame
+  unsigned int uploadBudgetKB = 4096;
+  double uploadBudgetMs = 2.0;
+  if (data.contains("video") && data["video"].is_object()) {
+    if (data["video"].contains("uploadBudgetKB") && data["video"]["uploadBudgetKB"].is_number_unsigned()) {
+      uploadBudgetKB = data["video"]["uploadBudgetKB"];
+    }
+    if (data["video"].contains("uploadBudgetMs") && data["video"]["uploadBudgetMs"].is_number()) {
+      uploadBudgetMs = data["video"]["uploadBudgetMs"];
+    }
+  }
+  CEUploadQueue::getInstance().configure((size_t)uploadBudgetKB * 1024, uploadBudgetMs);
+  
+  // World object collision bodies only exist within this many tiles of the player and AI
+  float objectActivationRadius = 8.0f;
+  CEPhysicsWorld::SimulationSettings physicsSettings;
+  if (data.contains("physics") && data["physics"].is_object()) {
+    if (data["physics"].contains("objectActivationRadius") && data["physics"]["objectActivationRadius"].is_number()) {
+      objectActivationRadius = std::max(1.0f, data["physics"]["objectActivationRadius"].get<float>());
+    }
+    if (data["physics"].contains("multithreaded") && data["physics"]["multithreaded"].is_boolean()) {
+      physicsSettings.multithreaded = data["physics"]["multithreaded"];
+    }
+    if (data["physics"].contains("workerThreads") && data["physics"]["workerThreads"].is_number_unsigned()) {
+      physicsSettings.workerThreads = data["physics"]["workerThreads"];
+    }
+    if (data["physics"].contains("steppingThread") && data["physics"]["steppingThread"].is_boolean()) {
+      physicsSettings.steppingThread = data["physics"]["steppingThread"];
+    }
+  }
+  
   // Parse UI configuration
   std::string compassPath;
   if (data.contains("ui") && data["ui"].is_object()) {
@@ -966,20 +1037,90 @@ int main(int argc, const char * argv[])
   std::shared_ptr<C2MapRscFile> cMapRsc;
   std::shared_ptr<C2MapFile> cMap;
   
+  // shared loader to minimize resource usage
+  std::unique_ptr<C2CarFilePreloader> cFileLoad(new C2CarFilePreloader);
+  
+  // CAR files don't depend on the map, so they parse while it loads; one entry per fetch() below
+  std::vector<std::pair<fs::path, bool>> preloadCars;
+  for (size_t i = 0; i < spawns.size() && i < 512; i++) {
+    preloadCars.emplace_back(spawns[i].file, false);
+  }
+  if (!compassPath.empty()) {
+    preloadCars.emplace_back(compassPath, false);
+  }
+  if (!primaryWeaponPath.empty()) {
+    preloadCars.emplace_back(primaryWeaponPath, true);
+  }
+  preloadCars.emplace_back(basePath / "DEAD.CAR", false);
+  std::unique_ptr<CEPhysicsWorld::StaticShapes> physicsShapes;
+  std::shared_ptr<CEPathfindingService> pathService;
+  
+  // Declared after everything its jobs use, so it finishes them before those go away
+  CELoadPipeline loader(loadingWorkerThreads);
+  std::shared_future<void> carsLoaded = loader.async("cars", [&]() {
+    cFileLoad->preload(preloadCars, loader);
+  });
+  
+  // Derived map data (water, ground levels, object placement...) is cached per .map/.rsc pair.
+  // Paged .world maps derive each page as it streams in, so they have no cache
+  bool pagedWorld = mapPath.extension() == ".world";
+  std::shared_ptr<CEMapCache> mapCache;
+  if (data["map"].value("cache", true) && !pagedWorld) {
+    fs::path cachePath = fs::path("cache") / (mapPath.stem().string() + (mapType == CEMapType::C1 ? ".c1" : ".c2") + ".cemc");
+    mapCache = std::make_shared<CEMapCache>(mapPath.string(), mapRscPath.string(), cachePath.string(), rebuildMapCache);
+  }
+  
   try {
-    cMapRsc = std::make_shared<C2MapRscFile>(mapType, mapRscPath.string(), basePath.string());
-    cMap = std::make_shared<C2MapFile>(mapType, mapPath.string(), cMapRsc);
+    loader.run("rsc", [&]() {
+      cMapRsc = std::make_shared<C2MapRscFile>(mapType, mapRscPath.string(), basePath.string(), &loader);
+    });
+    // The main thread has nothing else to do until the map is in, so it uploads CAR files meanwhile
+    loader.wait(loader.async("map", [&]() {
+      cMap = std::make_shared<C2MapFile>(mapType, mapPath.string(), cMapRsc, mapCache, data["map"].value("memoryMapped", true));
+    }));
   } catch (const std::exception& e) {
     std::cerr << "Error loading map files: " << e.what() << std::endl;
     return 1;
   }
   alDistanceModel(AL_LINEAR_DISTANCE);
   
-  std::unique_ptr<TerrainRenderer> terrain = std::make_unique<TerrainRenderer>(cMap, cMapRsc);
+  // Load the pages around the start before anything reads the map
+  std::unique_ptr<CEWorldStreamer> worldStreamer;
+  int streamingRadius = 0;
+  if (cMap->isStreamed()) {
+    streamingRadius = std::max(1, data["map"].value("streamingRadius", 1));
+    worldStreamer = std::make_unique<CEWorldStreamer>(cMap, streamingRadius);
+    glm::vec2 startTile = cMap->getStartTile();
+    worldStreamer->loadAround(glm::vec3(startTile.x * cMap->getTileLength(), 0.f, startTile.y * cMap->getTileLength()));
+  }
+  
+  // Collision shapes only read heights and model meshes, so they build while the terrain uploads.
+  // Object bodies need the instances TerrainRenderer places, so those wait for the physics world
+  std::shared_future<void> physicsShapesBuilt = loader.async("physics shapes", [&]() {
+    physicsShapes = CEPhysicsWorld::buildStaticShapes(cMap.get(), cMapRsc.get(), &loader);
+  });
+  
+  std::unique_ptr<TerrainRenderer> terrain;
+  loader.run("terrain", [&]() {
+    terrain = std::make_unique<TerrainRenderer>(cMap, cMapRsc, mapCache, streamingRadius);
+  });
+  
+  // Needs the walkable flags the terrain has derived or restored; the cache is saved once its
+  // jump point table is in too
+  std::shared_future<void> pathTablesBuilt = loader.async("path tables", [&]() {
+    pathService = std::make_shared<CEPathfindingService>(cMap, pathfindingThreads, mapCache);
+    if (mapCache) {
+      mapCache->save();
+    }
+  });
   
   // Initialize shadow manager
   std::unique_ptr<CEShadowManager> shadowManager(new CEShadowManager());
   
+  // Camera, time and fog uniforms shared by the world shaders, uploaded once per frame
+  std::unique_ptr<CEFrameConstants> frameConstants = std::make_unique<CEFrameConstants>();
+  frameConstants->setFog(terrain->GetFogColor(), terrain->GetViewDistance());
+  
   // Initialize Bullet Physics projectile manager
   std::unique_ptr<CEBulletProjectileManager> projectileManager;
   
@@ -991,18 +1132,26 @@ int main(int argc, const char * argv[])
   dieAudioSrc->setClampDistance(16*6); // Scaled down 16x (was 256*6)
   dieAudioSrc->setMaxDistance(16*80); // Scaled down 16x (was 256*80)
   
-  // shared loader to minimize resource usage
-  std::unique_ptr<C2CarFilePreloader> cFileLoad(new C2CarFilePreloader);
-  
   std::vector<std::shared_ptr<CERemotePlayerController>> characters = {};
   std::vector<std::unique_ptr<CEAIGenericAmbientManager>> ambients = {};
+  std::unique_ptr<CEJobSystem> aiJobs = std::make_unique<CEJobSystem>(aiWorkerThreads);
+  
+  loader.wait(carsLoaded);
+  loader.wait(pathTablesBuilt);
+  
+  // One field towards the local player, followed by every AI attacking it
+  std::shared_ptr<CEFlowFieldService> flowFields = std::make_shared<CEFlowFieldService>(pathService->getWalkability());
+  
+  // Fetched once and shared by every body, so dying doesn't read the disk or upload anything
+  std::shared_ptr<C2CarFile> deadBodyCar = cFileLoad->fetch(basePath / "DEAD.CAR");
   
   int dCount = 0;
   for (const auto& spawn : spawns) {
     if (dCount < 512) {
+      std::shared_ptr<C2CarFile> carFile = cFileLoad->fetch(spawn.file);
       auto character = std::make_shared<CERemotePlayerController>(
                                                                   g_audio_manager,
-                                                                  cFileLoad->fetch(spawn.file),
+                                                                  carFile,
                                                                   cMap,
                                                                   cMapRsc,
                                                                   spawn.animation
@@ -1018,13 +1167,15 @@ int main(int argc, const char * argv[])
       
       if (spawn.aiControllerName == "GenericAmbient") {
         auto aiArgs = spawn.data["attachAI"]["args"];
-        auto carFile = cFileLoad->fetch(spawn.file); // Get the same car file used for character
+        // The AI manager shares the character's car file
         auto ambientMg = std::make_unique<CEAIGenericAmbientManager>(
                                                                      aiArgs,
                                                                      character,
                                                                      cMap,
                                                                      cMapRsc,
-                                                                     carFile);
+                                                                     carFile,
+                                                                     pathService,
+                                                                     flowFields);
         // AI manager manages collision directly - no reference needed in character
         ambients.push_back(std::move(ambientMg));
       }
@@ -1081,7 +1232,11 @@ int main(int argc, const char * argv[])
   shadowManager->initialize();
   
   // Initialize Bullet Physics projectile manager
-  projectileManager = std::make_unique<CEBulletProjectileManager>(cMap.get(), cMapRsc.get(), g_audio_manager.get()); // Re-enabled with performance optimizations
+  loader.wait(physicsShapesBuilt);
+  loader.run("physics world", [&]() {
+    projectileManager = std::make_unique<CEBulletProjectileManager>(cMap.get(), cMapRsc.get(), g_audio_manager.get(), std::move(physicsShapes), physicsSettings); // Re-enabled with performance optimizations
+    projectileManager->getPhysicsWorld()->setObjectActivationRadius(objectActivationRadius * cMap->getTileLength());
+  });
   
   // Initialize collision detection for all AI characters through their managers
   std::cout << "💀 Initializing collision detection for " << ambients.size() << " AI characters" << std::endl;
@@ -1101,12 +1256,17 @@ int main(int argc, const char * argv[])
         dynamicsWorld,
         cMap->getTileLength() * 0.2f,   // Radius: even narrower for tighter collision
         cMap->getTileLength() * 1.0f,   // Height: roughly body height  
-        g_player_controller->getPosition()  // Initial position
+        g_player_controller->getPosition(),  // Initial position
+        &projectileManager->getPhysicsWorld()->getWorldMutex()
       );
       
       // Set the capsule collision component on the player controller
       g_player_controller->setCapsuleCollision(std::move(capsuleCollision));
       
+      // Objects around the spawn point, so the first frame's movement collides with them
+      projectileManager->getPhysicsWorld()->addActivator(g_player_controller->getPosition());
+      projectileManager->getPhysicsWorld()->updateObjectActivation();
+      
       std::cout << "Player capsule collision initialized successfully" << std::endl;
     } else {
       std::cerr << "Warning: Failed to get dynamics world for player collision" << std::endl;
@@ -1114,6 +1274,15 @@ int main(int argc, const char * argv[])
   } else {
     std::cerr << "Warning: Failed to initialize player capsule collision - no physics world available" << std::endl;
   }
+  
+  // Terrain first: it places a page's object instances, which physics then gives bodies
+  if (worldStreamer) {
+    worldStreamer->addListener(terrain.get());
+    if (projectileManager && projectileManager->getPhysicsWorld()) {
+      worldStreamer->addListener(projectileManager->getPhysicsWorld());
+    }
+    worldStreamer->addListener(pathService.get());
+  }
     
   // Initialize impact marker geometry (bullet impact crater for collision visualization)
   std::vector<Vertex> impactVertices = generateBulletImpact(1.0f, 16); // Larger bullet impact, good detail
@@ -1290,10 +1459,19 @@ int main(int argc, const char * argv[])
   // grab a character
   auto charac = characters.at(1);
   g_player_controller->update(glfwGetTime(), 0.0);
+  
+  // Still behind the loading screen, so the first frame doesn't pay for startup uploads
+  loader.run("gpu upload", [&]() {
+    CEUploadQueue::getInstance().flush();
+  });
+  loader.report();
 
   while (!glfwWindowShouldClose(window) && !input_manager->GetShouldShutdown()) {
     glfwMakeContextCurrent(window);
     
+    // Whatever was loaded since last frame, within the per-frame budget
+    CEUploadQueue::getInstance().process();
+    
     // Process input before rendering
     auto frameStart = std::chrono::high_resolution_clock::now();
     double currentTime = glfwGetTime();
@@ -1303,8 +1481,21 @@ int main(int argc, const char * argv[])
     input_manager->ProcessLocalInput(window, timeDelta);
     g_player_controller->update(currentTime, timeDelta);
     
+    if (worldStreamer) {
+      worldStreamer->update(g_player_controller->getPosition());
+    }
+    
     // Update projectile physics simulation (Re-enabled with performance optimizations)
     if (projectileManager) {
+      // Only the player and the AI activate object bodies; projectiles test hits against the grid instead
+      CEPhysicsWorld* physicsWorld = projectileManager->getPhysicsWorld();
+      physicsWorld->addActivator(g_player_controller->getPosition());
+      for (const auto& ambient : ambients) {
+        if (ambient && !ambient->isDead()) {
+          physicsWorld->addActivator(ambient->GetPlayerController()->getPosition());
+        }
+      }
+      
       projectileManager->update(currentTime, timeDelta);
     }
     
@@ -1355,42 +1546,48 @@ int main(int argc, const char * argv[])
     
     glm::vec3 currentPosition = g_player_controller->getPosition();
     
+    // AI decisions, target selection and path stepping run in parallel against a snapshot of the world...
+    AIWorldSnapshot aiWorld;
+    aiWorld.currentTime = currentTime;
+    aiWorld.localPlayerPosition = currentPosition;
+    aiWorld.localPlayerAlive = g_player_controller->isAlive(currentTime);
+    // Rebuilt off-thread only when the player enters another tile
+    if (aiWorld.localPlayerAlive && !ambients.empty()) {
+      flowFields->setTarget(glm::ivec2(player_world_pos));
+    } else {
+      flowFields->clearTarget();
+    }
+    aiJobs->parallelFor(ambients.size(), [&](size_t i) {
+      if (ambients[i]) {
+        ambients[i]->Think(aiWorld);
+      }
+    });
+    
+    // ...then their queued side effects are applied here, in spawn order
     for (const auto& ambient : ambients) {
       if (ambient) {
-        ambient->Process(currentTime);
+        ambient->ApplyCommands();
         
-        // TODO: totally change this for multi-player?
-        // For now, it's only enabled if you spawn GenericAmbients, but we'd probably want to update it to track all "players" or entities.
-        if (ambient->IsDangerous()) {
-          auto character = ambient->GetPlayerController();
-          auto contactDist = glm::distance(character->getPosition(), g_player_controller->getPosition());
-          if (contactDist < cMap->getTileLength() && g_player_controller->isAlive(currentTime)) {
-            g_player_controller->kill(currentTime);
-            auto body = std::make_shared<CERemotePlayerController>(
-                                                                   g_audio_manager,
-                                                                   cFileLoad->fetch(basePath / "DEAD.CAR"),
-                                                                   cMap,
-                                                                   cMapRsc,
-                                                                   "Hr_dead1"
-                                                                   );
-            auto bodyPos = g_player_controller->getPosition();
-            bodyPos.y = cMap->getPlaceGroundHeight(player_world_pos.x, player_world_pos.y) + 0.75f; // Scaled down 16x (was 12.f)
-            body->setPosition(bodyPos);
-            body->setNextAnimation("Hr_dead1");
-            body->StopMovement();
-            body->uploadStateToHardware();
-            characters.push_back(body);
-            
-            dieAudioSrc->setPosition(bodyPos);
-            g_audio_manager->play(dieAudioSrc);
-            ambient->ReportNotableEvent(currentPosition, "PLAYER_ELIMINATED", currentTime);
-          }
-        }
-        
-        if (ambient->NoticesLocalPlayer(g_player_controller)) {
-          if (g_player_controller->isAlive(currentTime)) {
-            ambient->ReportNotableEvent(currentPosition, "PLAYER_SPOTTED", currentTime);
-          }
+        if (ambient->TouchedLocalPlayer() && g_player_controller->isAlive(currentTime)) {
+          g_player_controller->kill(currentTime);
+          auto body = std::make_shared<CERemotePlayerController>(
+                                                                 g_audio_manager,
+                                                                 deadBodyCar,
+                                                                 cMap,
+                                                                 cMapRsc,
+                                                                 "Hr_dead1"
+                                                                 );
+          auto bodyPos = g_player_controller->getPosition();
+          bodyPos.y = cMap->getPlaceGroundHeight(player_world_pos.x, player_world_pos.y) + 0.75f; // Scaled down 16x (was 12.f)
+          body->setPosition(bodyPos);
+          body->setNextAnimation("Hr_dead1");
+          body->StopMovement();
+          body->uploadStateToHardware();
+          characters.push_back(body);
+          
+          dieAudioSrc->setPosition(bodyPos);
+          g_audio_manager->play(dieAudioSrc);
+          ambient->ReportNotableEvent(currentPosition, "PLAYER_ELIMINATED", currentTime);
         }
       }
     }
@@ -1455,6 +1652,8 @@ int main(int argc, const char * argv[])
       }
     }
     
+    frameConstants->update(*camera, (float)glfwGetTime());
+    
     // Render the terrain
     terrain->Update(g_terrain_transform, *camera);
     
@@ -1498,15 +1697,12 @@ int main(int argc, const char * argv[])
       glDepthFunc(GL_LESS);
       glEnable(GL_DEPTH_TEST);
       
-      // Get view-projection matrix for shader setup (if needed)
-      glm::mat4 viewProjectionMatrix = camera->getProjectionMatrix() * camera->getViewMatrix();
-      
       // Render bounding boxes for all world object models
       for (int m = 0; m < cMapRsc->getWorldModelCount(); m++) {
         CEWorldModel* model = cMapRsc->getWorldModel(m);
         if (model) {
-          model->renderBoundingBox(viewProjectionMatrix);
-          model->renderRadiusCylinder(viewProjectionMatrix);
+          model->renderBoundingBox();
+          model->renderRadiusCylinder();
         }
       }
     }
@@ -1548,6 +1744,8 @@ int main(int argc, const char * argv[])
           character->Render();
         }
       }
+      // Characters sharing a CAR are drawn together, one instanced call per CAR
+      CECharacterBatch::RenderAll(g_terrain_transform, *camera);
       
       glEnable(GL_CULL_FACE);
     }
@@ -1567,7 +1765,6 @@ int main(int argc, const char * argv[])
       
       // Update instanced transforms for markers
       impactMarkerGeometry->UpdateInstances(impactMarkerTransforms);
-      impactMarkerGeometry->Update(*camera);
       impactMarkerGeometry->DrawInstances();
       
       // Texture is already being used, no need to reset
@@ -1609,7 +1806,6 @@ int main(int argc, const char * argv[])
           }
           
           impactMarkerGeometry->UpdateInstances(startTransforms);
-          impactMarkerGeometry->Update(*camera);
           impactMarkerGeometry->DrawInstances();
           
           // Render end point as large sphere with slightly different color
@@ -1625,7 +1821,6 @@ int main(int argc, const char * argv[])
           }
           
           impactMarkerGeometry->UpdateInstances(endTransforms);
-          impactMarkerGeometry->Update(*camera);
           impactMarkerGeometry->DrawInstances();
         }
         
@@ -1649,7 +1844,7 @@ int main(int argc, const char * argv[])
       
       glDepthMask(GL_FALSE); // Disable depth writes
       
-      cMapRsc->getDaySky()->Render(window, *camera);
+      cMapRsc->getDaySky()->Render(window);
       
       glDepthMask(GL_TRUE); // Re-enable depth writes
       
@@ -1682,11 +1877,35 @@ int main(int argc, const char * argv[])
         static int cachedFps = 0;
         static double cachedAvgFrameTime = 0;
         static float cachedPerfPercent = 0;
+#if CE_ANIMATION_TIMING
+        static double cachedAnimationUs = 0;
+        static double cachedAnimationMsPerFrame = 0;
+#endif
+        static double cachedUploadKBPerSecond = 0;
+        static size_t cachedUploadsPending = 0;
+        static double cachedPathCacheHitPercent = 0;
+        static uint64_t cachedPathCacheLookups = 0;
         
         if (currentTime - lastFpsUpdate > 0.5) { // Update every 0.5 seconds instead of every frame
           cachedFps = fps;
           cachedAvgFrameTime = fps > 0 ? 1000.0 / fps : 0.0;
           cachedPerfPercent = fps > 0 ? (100.0f * fps / FPS) : 0.0f;
+          
+          double interval = currentTime - lastFpsUpdate;
+#if CE_ANIMATION_TIMING
+          // Animation cost accumulated since the last refresh
+          CEGeometry::AnimationTiming animationTiming = CEGeometry::TakeAnimationTiming();
+          cachedAnimationUs = animationTiming.samples > 0 ? (animationTiming.total_ns / 1000.0) / animationTiming.samples : 0.0;
+          cachedAnimationMsPerFrame = (fps > 0 && interval > 0) ? (animationTiming.total_ns / 1.0e6) / (interval * fps) : 0.0;
+#endif
+          
+          size_t uploadedBytes = CEUploadQueue::getInstance().takeUploadedBytes();
+          cachedUploadKBPerSecond = interval > 0 ? (uploadedBytes / 1024.0) / interval : 0.0;
+          cachedUploadsPending = CEUploadQueue::getInstance().getPendingCount();
+          
+          CEPathCache::Stats pathCacheStats = pathService->getCacheStats();
+          cachedPathCacheLookups = pathCacheStats.hits + pathCacheStats.misses;
+          cachedPathCacheHitPercent = cachedPathCacheLookups > 0 ? (100.0 * pathCacheStats.hits) / cachedPathCacheLookups : 0.0;
           lastFpsUpdate = currentTime;
         }
         
@@ -1707,6 +1926,11 @@ int main(int argc, const char * argv[])
             
             ImGui::Text("Frame Time: %.1f ms", cachedAvgFrameTime);
             ImGui::Text("Performance: %.0f%% of target", cachedPerfPercent);
+#if CE_ANIMATION_TIMING
+            ImGui::Text("Animation: %.1f us/character, %.2f ms/frame", cachedAnimationUs, cachedAnimationMsPerFrame);
+#endif
+            ImGui::Text("GPU uploads: %.0f KB/s, %zu queued", cachedUploadKBPerSecond, cachedUploadsPending);
+            ImGui::Text("Path cache: %.0f%% hits of %llu lookups", cachedPathCacheHitPercent, (unsigned long long)cachedPathCacheLookups);
           }
           ImGui::End();
         }
@@ -1716,12 +1940,16 @@ int main(int argc, const char * argv[])
         static glm::vec3 cachedPlayerPos;
         static glm::vec2 cachedWorldPos;
         static int cachedActiveProjectiles = 0;
+        static size_t cachedActiveObjects = 0;
+        static size_t cachedObjectInstances = 0;
         
         if (currentTime - lastCollisionUpdate > 0.1) { // Update every 0.1 seconds instead of every frame
           cachedPlayerPos = g_player_controller->getPosition();
           cachedWorldPos = g_player_controller->getWorldPosition();
           if (projectileManager) {
             cachedActiveProjectiles = static_cast<int>(projectileManager->getActiveProjectileCount());
+            cachedActiveObjects = projectileManager->getPhysicsWorld()->getActiveObjectCount();
+            cachedObjectInstances = projectileManager->getPhysicsWorld()->getObjectInstanceCount();
           }
           lastCollisionUpdate = currentTime;
         }
@@ -1735,6 +1963,7 @@ int main(int argc, const char * argv[])
             ImGui::Text("Player Pos: %.1f, %.1f, %.1f", cachedPlayerPos.x, cachedPlayerPos.y, cachedPlayerPos.z);
             ImGui::Text("World Pos: %.1f, %.1f", cachedWorldPos.x, cachedWorldPos.y);
             ImGui::Text("Active Projectiles: %d", cachedActiveProjectiles);
+            ImGui::Text("Object Bodies: %zu of %zu", cachedActiveObjects, cachedObjectInstances);
             ImGui::Text("Impact Markers: %zu", visualImpactMarkers.size());
           }
           ImGui::End();
@@ -1889,6 +2118,9 @@ int main(int argc, const char * argv[])
   characters.clear();
   characters.shrink_to_fit();
   
+  // Stop the page loader before the listeners go away
+  worldStreamer.reset();
+  
   // Cleanup ImGui
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplGlfw_Shutdown();
@@ -8,6 +8,9 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -17,6 +20,9 @@
 class ShaderProgram
 {
 public:
+    // Uniform buffer binding point of the shared per-frame constants block (see CEFrameConstants)
+    constexpr static const GLuint FRAME_CONSTANTS_BINDING = 0;
+
     unsigned int ID;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
@@ -94,6 +100,8 @@ public:
 //            glAttachShader(ID, geometry);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        cacheUniformLocations();
+        bindFrameConstants();
         // delete the shaders as they're linked into our program now and no longer necessery
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -107,63 +115,108 @@ public:
     {
         glUseProgram(ID);
     }
+    // uniform locations are resolved once at link time; -1 means the uniform is not active
+    // ------------------------------------------------------------------------
+    GLint getUniformLocation(const std::string &name) const
+    {
+        auto it = m_uniform_locations.find(name);
+        return it == m_uniform_locations.end() ? -1 : it->second;
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setBool(getUniformLocation(name), value);
+    }
+    void setBool(GLint location, bool value) const
+    {
+        if (location >= 0) glUniform1i(location, (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(getUniformLocation(name), value);
+    }
+    void setInt(GLint location, int value) const
+    {
+        if (location >= 0) glUniform1i(location, value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setFloat(getUniformLocation(name), value);
+    }
+    void setFloat(GLint location, float value) const
+    {
+        if (location >= 0) glUniform1f(location, value);
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec2(getUniformLocation(name), value);
+    }
+    void setVec2(GLint location, const glm::vec2 &value) const
+    {
+        if (location >= 0) glUniform2fv(location, 1, &value[0]);
     }
     void setVec2(const std::string &name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        GLint location = getUniformLocation(name);
+        if (location >= 0) glUniform2f(location, x, y);
+    }
+    void setIVec2(const std::string &name, const glm::ivec2 &value) const
+    {
+        GLint location = getUniformLocation(name);
+        if (location >= 0) glUniform2i(location, value.x, value.y);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec3(getUniformLocation(name), value);
+    }
+    void setVec3(GLint location, const glm::vec3 &value) const
+    {
+        if (location >= 0) glUniform3fv(location, 1, &value[0]);
     }
     void setVec3(const std::string &name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        GLint location = getUniformLocation(name);
+        if (location >= 0) glUniform3f(location, x, y, z);
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec4(getUniformLocation(name), value);
+    }
+    void setVec4(GLint location, const glm::vec4 &value) const
+    {
+        if (location >= 0) glUniform4fv(location, 1, &value[0]);
     }
     void setVec4(const std::string &name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        GLint location = getUniformLocation(name);
+        if (location >= 0) glUniform4f(location, x, y, z, w);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        GLint location = getUniformLocation(name);
+        if (location >= 0) glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        GLint location = getUniformLocation(name);
+        if (location >= 0) glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(getUniformLocation(name), mat);
+    }
+    void setMat4(GLint location, const glm::mat4 &mat) const
+    {
+        if (location >= 0) glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
     }
 
     void bindTexture(const std::string& uniformName, GLuint textureID, GLuint textureUnit)
@@ -182,6 +235,54 @@ public:
     }
     
 private:
+    std::unordered_map<std::string, GLint> m_uniform_locations;
+
+    // Ask the driver for every active uniform once, instead of glGetUniformLocation per set call
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        GLint count = 0;
+        GLint max_length = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+        std::vector<GLchar> name_buffer(std::max(max_length, 1));
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size = 0;
+            GLenum type = 0;
+            GLsizei length = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)name_buffer.size(), &length, &size, &type, name_buffer.data());
+
+            std::string name(name_buffer.data(), length);
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0) continue; // uniform block members have no location
+
+            m_uniform_locations[name] = location;
+
+            // Arrays are reported once as "name[0]"; register the bare name and every element
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                std::string base = name.substr(0, name.size() - 3);
+                m_uniform_locations[base] = location;
+                for (GLint e = 1; e < size; e++)
+                {
+                    std::string element = base + "[" + std::to_string(e) + "]";
+                    m_uniform_locations[element] = glGetUniformLocation(ID, element.c_str());
+                }
+            }
+        }
+    }
+
+    void bindFrameConstants()
+    {
+        GLuint block = glGetUniformBlockIndex(ID, "FrameConstants");
+        if (block != GL_INVALID_INDEX)
+        {
+            glUniformBlockBinding(ID, block, FRAME_CONSTANTS_BINDING);
+        }
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -0,0 +1,111 @@
+//
+//  animation_bench.cpp
+//  CE Character Lab
+//
+//  Times CEGeometry::SetAnimation on a .CAR over many frames, to catch animation regressions
+//
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "C2CarFile.h"
+#include "CEAnimation.h"
+#include "CEGeometry.h"
+#include "CEUploadQueue.h"
+
+/*
+ * Usage: CEAnimationBench <file.car> [frames] [animation]
+ *
+ * Run from the runtime directory: the geometry reads its shaders and video.gpuAnimation from
+ * config.json, as the game does. Every frame samples the animation at the next 1/60 s step, so each
+ * call does the full sampling and vertex upload rather than skipping ahead.
+ */
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file.car> [frames] [animation]" << std::endl;
+    return 1;
+  }
+  std::string carPath = argv[1];
+  int frames = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 10000;
+  std::string onlyAnimation = (argc > 3) ? argv[3] : "";
+
+  // Geometry needs a GL context for its shader and buffers; the window itself is never shown
+  if (!glfwInit()) {
+    std::cerr << "Failed to initialize GLFW" << std::endl;
+    return 1;
+  }
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  GLFWwindow* window = glfwCreateWindow(64, 64, "CEAnimationBench", nullptr, nullptr);
+  if (!window) {
+    std::cerr << "Failed to create a GL context" << std::endl;
+    glfwTerminate();
+    return 1;
+  }
+  glfwMakeContextCurrent(window);
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    std::cerr << "Failed to initialize GLAD" << std::endl;
+    glfwTerminate();
+    return 1;
+  }
+
+  int status = 0;
+  {
+    // Deferred, so only the geometry is uploaded; the sounds would need an audio device
+    C2CarFile car(carPath, false, true);
+    std::shared_ptr<CEGeometry> geometry = car.getGeometry();
+    geometry->upload();
+    CEUploadQueue::getInstance().flush();
+
+    std::cout << std::fixed << std::setprecision(2);
+    double totalUs = 0.0;
+    int totalSamples = 0;
+
+    for (const auto& entry : car.getAnimations()) {
+      if (!onlyAnimation.empty() && entry.first != onlyAnimation) continue;
+
+      const double step = 1.0 / 60.0;
+      int sampled = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int frame = 0; frame < frames; frame++) {
+        double atTime = frame * step;
+        if (geometry->SetAnimation(entry.second, atTime, 0.0, atTime - step, false, true, false, 1.f, true)) {
+          sampled++;
+        }
+      }
+      glFinish();
+      double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+      std::cout << std::left << std::setw(16) << entry.first << std::right
+                << std::setw(10) << (sampled > 0 ? us / sampled : 0.0) << " us/frame  "
+                << sampled << " of " << frames << " frames sampled" << std::endl;
+      totalUs += us;
+      totalSamples += sampled;
+    }
+
+    if (totalSamples == 0) {
+      std::cerr << "No animation was sampled" << (onlyAnimation.empty() ? "" : " (unknown animation name?)") << std::endl;
+      status = 1;
+    } else {
+      std::cout << std::left << std::setw(16) << "all" << std::right
+                << std::setw(10) << totalUs / totalSamples << " us/frame" << std::endl;
+    }
+  }
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+  return status;
+}
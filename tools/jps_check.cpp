@@ -0,0 +1,159 @@
+//
+//  jps_check.cpp
+//  CE Character Lab
+//
+//  Checks that JPS over the bit-packed walkability grid, with and without its jump point table,
+//  finds the same paths as the stock searcher
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "C2MapFile.h"
+#include "CEJumpPointTable.h"
+#include "CEWalkabilityGrid.h"
+#include "CEWalkableTerrainPathFinder.hpp"
+#include "jps.hpp"
+
+// The walkable test CEWalkableTerrainPathFinder made before the grid was packed: one flags lookup
+// per tile, searched with jps.hpp's own jumps
+struct StockGrid
+{
+  bool operator()(unsigned x, unsigned y) const
+  {
+    if (x >= (unsigned)map->getWidth() || y >= (unsigned)map->getHeight()) return false;
+    return !(map->getWalkableFlagsAt(glm::vec2(x, y)) & 0x1);
+  }
+
+  C2MapFile* map;
+};
+
+/*
+ * Usage: CEPathfindingCheck <file.map> [queries] [c1]
+ *
+ * Every query runs three searches: the stock one, the packed grid's word-wide jumps, and the packed
+ * grid with a JPS+ table. Half the queries run on the map as loaded. The other half run after random
+ * rectangles of tiles have been blocked and opened through setWalkableFlagsAt(), with the grid
+ * refreshed and the table patched per rectangle as the pathfinding service does; the patched table
+ * must then equal one built from scratch. Each query is a walkable start and goal at most
+ * MAX_OFFSET tiles apart. Exits non-zero on any difference.
+ */
+int main(int argc, char** argv)
+{
+  const int MAX_OFFSET = 256;
+  const int EDITS = 200;
+
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file.map> [queries] [c1]" << std::endl;
+    return 1;
+  }
+  int queries = (argc > 2) ? std::max(2, std::atoi(argv[2])) : 6000;
+  CEMapType mapType = (argc > 3 && std::string(argv[3]) == "c1") ? CEMapType::C1 : CEMapType::C2;
+
+  // No resource file: walkable flags then come from the heights alone
+  auto map = std::make_shared<C2MapFile>(mapType, argv[1], std::weak_ptr<C2MapRscFile>());
+  int width = map->getWidth(), height = map->getHeight();
+  if (width > CEJumpPointTable::MAX_SIZE || height > CEJumpPointTable::MAX_SIZE) {
+    std::cerr << "Map too large for a jump point table" << std::endl;
+    return 1;
+  }
+
+  CEWalkableTerrainPathFinder packed;
+  packed.walkability = std::make_shared<CEWalkabilityGrid>(map);
+  auto table = std::make_shared<CEJumpPointTable>(width, height);
+  table->build(*packed.walkability);
+  CEWalkableTerrainPathFinder tabled;
+  tabled.walkability = packed.walkability;
+  tabled.jump_points = table;
+  StockGrid stock = { map.get() };
+  JPS::Searcher<CEWalkableTerrainPathFinder> packedSearcher(packed);
+  JPS::Searcher<CEWalkableTerrainPathFinder> tabledSearcher(tabled);
+  JPS::Searcher<StockGrid> stockSearcher(stock);
+
+  std::mt19937 rng(1);
+  auto randomTile = [&](glm::ivec2 around, int range) {
+    glm::ivec2 low = glm::max(around - range, glm::ivec2(0));
+    glm::ivec2 high = glm::min(around + range, glm::ivec2(width - 1, height - 1));
+    return glm::ivec2(low.x + (int)(rng() % (high.x - low.x + 1)), low.y + (int)(rng() % (high.y - low.y + 1)));
+  };
+
+  int found = 0, mismatches = 0, tableMismatches = 0, run = 0, attempts = 0;
+  bool edited = false;
+  while (run < queries && attempts < queries * 100) {
+    attempts++;
+
+    if (!edited && run == queries / 2) {
+      edited = true;
+      for (int e = 0; e < EDITS; e++) {
+        glm::ivec2 corner = randomTile(glm::ivec2(0), std::max(width, height));
+        glm::ivec2 size = glm::ivec2(1 + (rng() % 48), 1 + (rng() % 48));
+        int x1 = std::min(corner.x + size.x, width), y1 = std::min(corner.y + size.y, height);
+        bool block = rng() % 2;
+        for (int y = corner.y; y < y1; y++) {
+          for (int x = corner.x; x < x1; x++) {
+            if (rng() % 3 == 0) {
+              map->setWalkableFlagsAt(glm::vec2(x, y), block ? 0x1 : 0x0);
+            }
+          }
+        }
+        packed.walkability->refresh(corner.x, corner.y, x1, y1);
+        table->patch(*packed.walkability, corner.x, corner.y, x1 - 1, y1 - 1);
+      }
+      map->takeWalkabilityChanges();
+
+      CEJumpPointTable fresh(width, height);
+      fresh.build(*packed.walkability);
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+          for (int direction = 0; direction < 8; direction++) {
+            if (table->getDistance(x, y, direction) != fresh.getDistance(x, y, direction)) {
+              if (tableMismatches < 10) {
+                std::cerr << "Patched table differs at [" << x << "," << y << "] direction " << direction << ": "
+                          << table->getDistance(x, y, direction) << " != " << fresh.getDistance(x, y, direction) << std::endl;
+              }
+              tableMismatches++;
+            }
+          }
+        }
+      }
+    }
+
+    glm::ivec2 start = randomTile(glm::ivec2(0), std::max(width, height));
+    glm::ivec2 goal = randomTile(start, MAX_OFFSET);
+    if (!stock(start.x, start.y) || !stock(goal.x, goal.y)) continue;
+    run++;
+
+    JPS::PathVector stockPath, packedPath, tabledPath;
+    bool stockFound = stockSearcher.findPath(stockPath, JPS::Pos(start.x, start.y), JPS::Pos(goal.x, goal.y), 1);
+    bool packedFound = packedSearcher.findPath(packedPath, JPS::Pos(start.x, start.y), JPS::Pos(goal.x, goal.y), 1);
+    bool tabledFound = tabledSearcher.findPath(tabledPath, JPS::Pos(start.x, start.y), JPS::Pos(goal.x, goal.y), 1);
+    found += stockFound;
+
+    auto same = [&](bool pathFound, const JPS::PathVector& path) {
+      if (pathFound != stockFound || path.size() != stockPath.size()) return false;
+      for (size_t i = 0; i < path.size(); i++) {
+        if (path[i].x != stockPath[i].x || path[i].y != stockPath[i].y) return false;
+      }
+      return true;
+    };
+    if (!same(packedFound, packedPath) || !same(tabledFound, tabledPath)) {
+      if (mismatches < 10) {
+        std::cerr << "Mismatch [" << start.x << "," << start.y << "] -> [" << goal.x << "," << goal.y << "]: stock "
+                  << (stockFound ? "found " : "failed ") << stockPath.size() << " tiles, packed "
+                  << (packedFound ? "found " : "failed ") << packedPath.size() << " tiles, JPS+ "
+                  << (tabledFound ? "found " : "failed ") << tabledPath.size() << " tiles" << std::endl;
+      }
+      mismatches++;
+    }
+  }
+
+  std::cout << run << " queries (" << found << " reachable), " << mismatches << " mismatches, "
+            << tableMismatches << " patched table differences" << std::endl;
+  return (mismatches == 0 && tableMismatches == 0 && run > 0) ? 0 : 1;
+}